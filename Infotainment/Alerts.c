@@ -0,0 +1,129 @@
+/* =========================================================================
+ *  Alerts.c — evaluates AlertRules.def on every decoded sample
+ * -------------------------------------------------------------------------
+ *  • Rules compile into a const table; per-rule state is a small array
+ *    beside it.  BELOW / FALL rules are stored with the sign flipped, so
+ *    every rule is one "x > limit" test.
+ *  • Rate rules difference consecutive samples of their PID; a gap longer
+ *    than RATE_MAX_GAP_US (link drop, paused polling) restarts the rate.
+ *  • A firing only queues a HUD update (Popup.c coalesces on an idle), so
+ *    the alert reaches the screen one main-loop turn after its frame.
+ * ========================================================================= */
+#include "Alerts.h"
+#include "Popup.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "EventLog.h"
+
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Rules                                                             */
+/* ------------------------------------------------------------------ */
+typedef enum {
+    ALERT_ABOVE,
+    ALERT_BELOW,
+    ALERT_RISE,
+    ALERT_FALL,
+} AlertKind;
+
+typedef struct {
+    const char *id;
+    const char *message;
+    PidId       pid;
+    gboolean    rate;          /* RISE / FALL  */
+    gdouble     sign;          /* −1 for BELOW / FALL */
+    gdouble     limit;         /* sign * limit */
+    gdouble     rearm;         /* sign * limit − hysteresis */
+    gint64      debounce_us;
+} AlertRule;
+
+#define ALERT_SIGN(kind)  ((ALERT_##kind == ALERT_BELOW || ALERT_##kind == ALERT_FALL) ? -1.0 : 1.0)
+
+static const AlertRule RULES[] = {
+#define ALERT_DEF(id, pid, kind, limit, hyst, debounce_ms, message)            \
+    { #id, message, PID_##pid,                                                 \
+      ALERT_##kind == ALERT_RISE || ALERT_##kind == ALERT_FALL,                \
+      ALERT_SIGN(kind), ALERT_SIGN(kind) * (limit),                            \
+      ALERT_SIGN(kind) * (limit) - (hyst), (gint64)(debounce_ms) * 1000 },
+#include "AlertRules.def"
+#undef ALERT_DEF
+};
+
+#define RULE_COUNT G_N_ELEMENTS(RULES)
+
+static const gint64 RATE_MAX_GAP_US = 2 * G_USEC_PER_SEC;
+
+/* ------------------------------------------------------------------ */
+/*  State                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    gdouble  prev;             /* last sample (rate rules)       */
+    gint64   prev_us;          /* 0 → no previous sample         */
+    gint64   since_us;         /* condition true since, 0 → not  */
+    gboolean active;           /* fired, not yet re-armed        */
+} AlertState;
+
+static AlertState g_state[RULE_COUNT];
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+guint64 alerts_pid_mask(void)
+{
+    guint64 mask = 0;
+    for (guint i = 0; i < RULE_COUNT; i++)
+        mask |= G_GUINT64_CONSTANT(1) << RULES[i].pid;
+    return mask;
+}
+
+void alerts_reset(void)
+{
+    memset(g_state, 0, sizeof g_state);
+}
+
+static void fire(const AlertRule *r, gdouble value)
+{
+    TRACE_INSTANT("alert");
+    metrics_inc(METRIC_ALERTS_FIRED);
+    EVLOG(ALERT_FIRED, r->id, PID_TABLE[r->pid].name, value, PID_TABLE[r->pid].unit);
+    show_temp_popup(r->message);
+}
+
+void alerts_feed(const ObdFrame *frame, gint64 now_us)
+{
+    for (guint i = 0; i < RULE_COUNT; i++) {
+        const AlertRule *r  = &RULES[i];
+        AlertState      *st = &g_state[i];
+        if (!(frame->present & (G_GUINT64_CONSTANT(1) << r->pid)))
+            continue;
+
+        gdouble v = frame->value[r->pid];
+        gdouble x = v;
+        if (r->rate) {
+            gint64 dt = now_us - st->prev_us;
+            gboolean have_prev = st->prev_us && dt > 0 && dt <= RATE_MAX_GAP_US;
+            x = have_prev ? (v - st->prev) * G_USEC_PER_SEC / dt : 0;
+            st->prev    = v;
+            st->prev_us = now_us;
+            if (!have_prev) { st->since_us = 0; continue; }
+        }
+        x *= r->sign;
+
+        if (!st->active) {
+            if (x > r->limit) {
+                if (!st->since_us)
+                    st->since_us = now_us;
+                if (now_us - st->since_us >= r->debounce_us) {
+                    st->active = TRUE;
+                    fire(r, v);
+                }
+            } else {
+                st->since_us = 0;
+            }
+        } else if (x < r->rearm) {
+            st->active   = FALSE;
+            st->since_us = 0;
+        }
+    }
+}
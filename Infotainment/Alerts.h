@@ -0,0 +1,32 @@
+/* =========================================================================
+ *  Alerts.h — rule engine behind the vehicle-data alerts
+ * -------------------------------------------------------------------------
+ *  alerts_pid_mask()
+ *      PIDs the rules in AlertRules.def look at (bit i = PidId i).
+ *
+ *  alerts_feed(frame, now_us)
+ *      Runs every rule whose PID is in `frame` (one decoded sample set,
+ *      monotonic time in µs).  A rule fires once per episode: after its
+ *      condition has held for debounce_ms, and again only after the value
+ *      has come back past the hysteresis band.  Firing logs "[Alert] …"
+ *      and puts the message on the HUD (Popup.h).
+ *
+ *      Per frame this is a few compares per rule over a fixed table —
+ *      no allocation, no strings — see the alert_eval microbenchmark.
+ *
+ *  alerts_reset()
+ *      Forgets debounce / rate history, e.g. after the link dropped.
+ *
+ *  GTK thread only (frames are delivered there).
+ * ========================================================================= */
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <glib.h>
+#include "ObdFrame.h"
+
+guint64 alerts_pid_mask(void);
+void    alerts_feed    (const ObdFrame *frame, gint64 now_us);
+void    alerts_reset   (void);
+
+#endif /* ALERTS_H */
@@ -0,0 +1,143 @@
+/* =========================================================================
+ *  ApplyChannel.c — single-slot mailbox + worker thread
+ * -------------------------------------------------------------------------
+ *  The mailbox holds one value and the time it was first left unapplied.
+ *  The worker sleeps on a GCond until a value is present *and* the rate
+ *  limit allows another write, then takes the newest value and applies it
+ *  outside the lock.  Latency is measured from the oldest submit the
+ *  write covers (the one that found the mailbox empty) to the end of
+ *  apply(), so coalescing never hides how long a drag waited.
+ * ========================================================================= */
+#include "ApplyChannel.h"
+#include "Trace.h"
+#include "Metrics.h"
+
+/* ---------------------------------------------------------------------- */
+/*  Types                                                                 */
+/* ---------------------------------------------------------------------- */
+struct ApplyChannel {
+    const char *name;
+    ApplyFunc   apply;
+    gpointer    user_data;
+
+    GMutex      lock;
+    GCond       cond;
+    gboolean    has_value;
+    int         value;
+    gint64      submitted_us;     /* first submit since the last take    */
+    gint64      min_gap_us;       /* 1 s / max_rate_hz                   */
+    gint64      last_start_us;
+
+    /* Statistics since the last report (guarded by lock) */
+    guint64     coalesced;        /* submits replaced before applying    */
+    guint64     applied;
+    gint64      lat_sum_us;
+    gint64      lat_max_us;
+    gint64      lat_min_us;
+};
+
+static gpointer apply_worker(gpointer data);
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+ApplyChannel *apply_channel_new(const char *name, ApplyFunc apply,
+                                gpointer user_data, guint max_rate_hz)
+{
+    ApplyChannel *ch = g_new0(ApplyChannel, 1);
+    ch->name       = name;
+    ch->apply      = apply;
+    ch->user_data  = user_data;
+    ch->lat_min_us = G_MAXINT64;
+    g_mutex_init(&ch->lock);
+    g_cond_init(&ch->cond);
+    apply_channel_set_max_rate(ch, max_rate_hz);
+
+    g_thread_unref(g_thread_new(name, apply_worker, ch));
+    return ch;
+}
+
+void apply_channel_submit(ApplyChannel *ch, int value)
+{
+    g_mutex_lock(&ch->lock);
+    if (ch->has_value)
+        ch->coalesced++;
+    else
+        ch->submitted_us = g_get_monotonic_time();
+    ch->value     = value;
+    ch->has_value = TRUE;
+    metrics_inc(METRIC_APPLY_SUBMITTED);
+    g_cond_signal(&ch->cond);
+    g_mutex_unlock(&ch->lock);
+}
+
+void apply_channel_set_max_rate(ApplyChannel *ch, guint max_rate_hz)
+{
+    g_mutex_lock(&ch->lock);
+    ch->min_gap_us = max_rate_hz ? G_USEC_PER_SEC / max_rate_hz : 0;
+    g_mutex_unlock(&ch->lock);
+}
+
+void apply_channel_report(ApplyChannel *ch)
+{
+    g_mutex_lock(&ch->lock);
+    if (ch->applied)
+        g_print("[Apply] %-10s %" G_GUINT64_FORMAT " applied, %" G_GUINT64_FORMAT
+                " coalesced, latency min %.1f / avg %.1f / max %.1f ms\n",
+                ch->name, ch->applied, ch->coalesced,
+                ch->lat_min_us / 1e3,
+                ch->lat_sum_us / 1e3 / (double)ch->applied,
+                ch->lat_max_us / 1e3);
+
+    /* Next report covers only what happens from here on */
+    ch->coalesced  = 0;
+    ch->applied    = 0;
+    ch->lat_sum_us = 0;
+    ch->lat_max_us = 0;
+    ch->lat_min_us = G_MAXINT64;
+    g_mutex_unlock(&ch->lock);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Worker                                                                */
+/* ---------------------------------------------------------------------- */
+static gpointer apply_worker(gpointer data)
+{
+    ApplyChannel *ch = data;
+    TRACE_THREAD_NAME(ch->name);
+
+    g_mutex_lock(&ch->lock);
+    for (;;) {
+        while (!ch->has_value)
+            g_cond_wait(&ch->cond, &ch->lock);
+
+        /* Rate limit — newer values may replace the pending one meanwhile */
+        gint64 not_before = ch->last_start_us + ch->min_gap_us;
+        if (g_get_monotonic_time() < not_before) {
+            g_cond_wait_until(&ch->cond, &ch->lock, not_before);
+            continue;
+        }
+
+        int    value     = ch->value;
+        gint64 submitted = ch->submitted_us;
+        ch->has_value     = FALSE;
+        ch->last_start_us = g_get_monotonic_time();
+        g_mutex_unlock(&ch->lock);
+
+        {
+            TRACE_SCOPE("apply_channel_write");
+            ch->apply(value, ch->user_data);
+        }
+        gint64 latency = g_get_monotonic_time() - submitted;
+        TRACE_COUNTER("apply-latency-us", latency);
+        metrics_inc(METRIC_APPLY_WRITES);
+        metrics_observe_us(METRIC_APPLY_LATENCY, latency);
+
+        g_mutex_lock(&ch->lock);
+        ch->applied++;
+        ch->lat_sum_us += latency;
+        if (latency > ch->lat_max_us) ch->lat_max_us = latency;
+        if (latency < ch->lat_min_us) ch->lat_min_us = latency;
+    }
+    return NULL;
+}
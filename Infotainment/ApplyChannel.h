@@ -0,0 +1,36 @@
+/* =========================================================================
+ *  ApplyChannel.h — latest-value-wins, rate-limited asynchronous writer
+ * -------------------------------------------------------------------------
+ *  A channel owns one worker thread that calls `apply(value)` for values
+ *  submitted from the GTK thread (or anywhere else):
+ *
+ *      • apply_channel_submit() never blocks — it only stores the value.
+ *      • At most one apply() is in flight at any time.
+ *      • If several values arrive while a write is running, only the
+ *        newest is applied afterwards (older ones are "coalesced").
+ *      • apply() starts at most `max_rate_hz` times per second.
+ *
+ *  Intended for slow, fork/exec-backed setters such as
+ *  set_sink_volume_percent() (pactl) and set_backlight_brightness() (sudo).
+ *
+ *  apply_channel_report()
+ *      Prints applied / coalesced counts and submit-to-effect latency
+ *      since the previous report, then clears them.
+ * ========================================================================= */
+#ifndef APPLYCHANNEL_H
+#define APPLYCHANNEL_H
+
+#include <glib.h>
+
+typedef void (*ApplyFunc)(int value, gpointer user_data);
+
+typedef struct ApplyChannel ApplyChannel;
+
+ApplyChannel *apply_channel_new(const char *name, ApplyFunc apply,
+                                gpointer user_data, guint max_rate_hz);
+
+void apply_channel_submit      (ApplyChannel *ch, int value);
+void apply_channel_set_max_rate(ApplyChannel *ch, guint max_rate_hz);
+void apply_channel_report      (ApplyChannel *ch);
+
+#endif /* APPLYCHANNEL_H */
@@ -1,20 +1,22 @@
 /* =========================================================================
  *  AudioManager.c — PulseAudio utility layer for Vroom Infotainment
+ * -------------------------------------------------------------------------
+ *  The public helpers validate arguments, keep the current sink name in
+ *  DeviceState.h (readable from any thread) and forward to hal_audio().
+ *  The `pactl` implementation at the bottom of the file is the real
+ *  backend (PACTL_AUDIO_BACKEND).
  * ========================================================================= */
 #include "AudioManager.h"
+#include "Hal.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "EventLog.h"
+#include "DeviceState.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
-/* -------------------------------------------------------------------------
- *  g_current_sink
- *  ------------------------------------------------------------------------
- *  Keeps track of the last sink chosen by set_default_sink() so that the UI
- *  can query or modify it without reparsing `pactl info` each time.
- * ------------------------------------------------------------------------- */
-static char *g_current_sink = NULL;
-
 /* --------------------------------------------------------------------- */
 void audio_manager_init(void)
 /* ---------------------------------------------------------------------
@@ -22,36 +24,121 @@ void audio_manager_init(void)
  *  non-NULL from the very beginning (rotary encoder works right away).
  * --------------------------------------------------------------------- */
 {
-    if (g_current_sink)                /* already done */
+    TRACE_SCOPE("audio_manager_init");
+    if (device_state_get().sink)       /* already done */
         return;
 
+    gchar *sink = hal_audio()->default_sink();
+    device_state_set_sink(sink);
+    g_free(sink);
+}
+
+
+/* ------------------------------------------------------------------------- */
+GSList *get_audio_sinks(void)
+/* -------------------------------------------------------------------------
+ *  Returns the backend's sink names as a GSList of owned strings.
+ * ------------------------------------------------------------------------- */
+{
+    TRACE_SCOPE("get_audio_sinks");
+    gint64  t0    = g_get_monotonic_time();
+    GSList *sinks = hal_audio()->list_sinks();
+    metrics_observe_since(METRIC_AUDIO_CALL, t0);
+    return sinks;
+}
+
+/* ------------------------------------------------------------------------- */
+void set_default_sink(const char *sink_name)
+/* -------------------------------------------------------------------------
+ *  Sets the default sink and records it locally.
+ * ------------------------------------------------------------------------- */
+{
+    TRACE_SCOPE("set_default_sink");
+    if (!sink_name) return;
+
+    /* Remember the new sink name (the knob ISR reads it concurrently) */
+    device_state_set_sink(sink_name);
+
+    gint64 t0 = g_get_monotonic_time();
+    hal_audio()->set_default_sink(sink_name);
+    metrics_observe_since(METRIC_AUDIO_CALL, t0);
+}
+
+/* ------------------------------------------------------------------------- */
+const char *get_current_sink(void)
+/* -------------------------------------------------------------------------
+ *  Returns the cached sink name, or NULL if none has been set yet.
+ * ------------------------------------------------------------------------- */
+{
+    return device_state_get().sink;
+}
+
+/* ------------------------------------------------------------------------- */
+int get_sink_volume_percent(const char *sink_name)
+/* -------------------------------------------------------------------------
+ *  Reads the volume percentage of the given sink.
+ * ------------------------------------------------------------------------- */
+{
+    TRACE_SCOPE("get_sink_volume_percent");
+    if (!sink_name) return -1;
+
+    gint64 t0  = g_get_monotonic_time();
+    int    vol = hal_audio()->get_volume(sink_name);
+    metrics_observe_since(METRIC_AUDIO_CALL, t0);
+    return vol;
+}
+
+/* ------------------------------------------------------------------------- */
+void set_sink_volume_percent(const char *sink_name, int volume)
+/* -------------------------------------------------------------------------
+ *  Clamps the volume to 0-100 % and applies it.
+ * ------------------------------------------------------------------------- */
+{
+    TRACE_SCOPE("set_sink_volume_percent");
+    if (!sink_name) return;
+    if (volume < 0)   volume = 0;
+    if (volume > 100) volume = 100;
+
+    gint64 t0 = g_get_monotonic_time();
+    hal_audio()->set_volume(sink_name, volume);
+    metrics_observe_since(METRIC_AUDIO_CALL, t0);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  pactl backend                                                         */
+/* ---------------------------------------------------------------------- */
+static gchar *pactl_default_sink(void)
+/* ----------------------------------------------------------------------
+ *  Scans `pactl info` for the "Default Sink:" line.
+ * ---------------------------------------------------------------------- */
+{
     FILE *fp = popen("pactl info", "r");
     if (!fp)
-        return;
+        return NULL;
 
-    char line[256];
+    gchar *sink = NULL;
+    char   line[256];
     while (fgets(line, sizeof line, fp)) {
         if (g_str_has_prefix(line, "Default Sink:")) {
             char *name = line + strlen("Default Sink:");
             g_strstrip(name);          /* trim spaces/newline */
-            g_current_sink = g_strdup(name);
+            sink = g_strdup(name);
             break;
         }
     }
     pclose(fp);
+    return sink;
 }
 
-
-/* ------------------------------------------------------------------------- */
-GSList *get_audio_sinks(void)
-/* -------------------------------------------------------------------------
+static GSList *pactl_list_sinks(void)
+/* ----------------------------------------------------------------------
  *  Parse `pactl list short sinks` and return a GSList of sink names.
- * ------------------------------------------------------------------------- */
+ * ---------------------------------------------------------------------- */
 {
     GSList *sink_list = NULL;
     FILE   *fp = popen("pactl list short sinks", "r");
     if (!fp) {
-        g_printerr("AudioManager: cannot list sinks.\n");
+        EVLOG(AUDIO_NO_SINKS);
         return NULL;
     }
 
@@ -70,47 +157,24 @@ GSList *get_audio_sinks(void)
     return sink_list;
 }
 
-/* ------------------------------------------------------------------------- */
-void set_default_sink(const char *sink_name)
-/* -------------------------------------------------------------------------
- *  Sets the PulseAudio default sink and records it locally.
- * ------------------------------------------------------------------------- */
+static void pactl_set_default_sink(const char *sink_name)
 {
-    if (!sink_name) return;
-
-    /* Remember the new sink name */
-    free(g_current_sink);
-    g_current_sink = strdup(sink_name);
-
-    /* Tell PulseAudio */
     char *cmd = g_strdup_printf("pactl set-default-sink %s", sink_name);
     system(cmd);
     g_free(cmd);
 }
 
-/* ------------------------------------------------------------------------- */
-const char *get_current_sink(void)
-/* -------------------------------------------------------------------------
- *  Returns the cached sink name, or NULL if none has been set yet.
- * ------------------------------------------------------------------------- */
-{
-    return g_current_sink;
-}
-
-/* ------------------------------------------------------------------------- */
-int get_sink_volume_percent(const char *sink_name)
-/* -------------------------------------------------------------------------
- *  Reads the volume percentage of the given sink via `pactl`.
- * ------------------------------------------------------------------------- */
+static int pactl_get_volume(const char *sink_name)
+/* ----------------------------------------------------------------------
+ *  Runs `pactl get-sink-volume` and grabs the first “NN%” token.
+ * ---------------------------------------------------------------------- */
 {
-    if (!sink_name) return -1;
-
     char *cmd = g_strdup_printf("pactl get-sink-volume %s", sink_name);
     FILE *fp  = popen(cmd, "r");
     g_free(cmd);
 
     if (!fp) {
-        g_printerr("AudioManager: cannot read sink volume.\n");
+        EVLOG(AUDIO_NO_VOLUME);
         return -1;
     }
 
@@ -132,18 +196,19 @@ int get_sink_volume_percent(const char *sink_name)
     return volume;
 }
 
-/* ------------------------------------------------------------------------- */
-void set_sink_volume_percent(const char *sink_name, int volume)
-/* -------------------------------------------------------------------------
- *  Clamps the volume to 0-100 % and applies it with `pactl`.
- * ------------------------------------------------------------------------- */
+static void pactl_set_volume(const char *sink_name, int volume)
 {
-    if (!sink_name) return;
-    if (volume < 0)   volume = 0;
-    if (volume > 100) volume = 100;
-
     char *cmd = g_strdup_printf("pactl set-sink-volume %s %d%%",
                                 sink_name, volume);
     system(cmd);
     g_free(cmd);
 }
+
+const AudioBackend PACTL_AUDIO_BACKEND = {
+    .name             = "pactl",
+    .default_sink     = pactl_default_sink,
+    .list_sinks       = pactl_list_sinks,
+    .set_default_sink = pactl_set_default_sink,
+    .get_volume       = pactl_get_volume,
+    .set_volume       = pactl_set_volume,
+};
@@ -39,8 +39,9 @@ void audio_manager_init(void);
  *  get_current_sink
  *  ------------------------------------------------------------------------
  *  Returns the sink name that was most recently passed to
- *  set_default_sink().  The string is owned by the AudioManager and must
- *  not be freed or modified by the caller.
+ *  set_default_sink().  Safe from any thread; the string stays valid for
+ *  the life of the process (DeviceState.h) and must not be freed or
+ *  modified by the caller.
  * ------------------------------------------------------------------------- */
 const char *get_current_sink(void);
 
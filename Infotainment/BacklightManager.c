@@ -1,7 +1,12 @@
 /* =========================================================================
  *  BacklightManager.c — thin wrapper around the back-light sysfs node
+ * -------------------------------------------------------------------------
+ *  The public helpers clamp and forward to hal_backlight(); the sysfs
+ *  implementation below is the real backend (SYSFS_BACKLIGHT_BACKEND).
  * ========================================================================= */
 #include "BacklightManager.h"
+#include "Hal.h"
+#include "Metrics.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -14,18 +19,10 @@ static const int  BACKLIGHT_MAX_VALUE    = 31;   /* panel’s hard limit */
 /* ---------------------------------------------------------------------- */
 int read_backlight_brightness(void)
 /* ----------------------------------------------------------------------
- *  Reads the integer inside the sysfs node, clamps it to [0-31], and
- *  returns the result.  On failure (e.g., file missing), the function
- *  assumes full brightness so the UI sliders still display something.
+ *  Asks the active backend for the level and clamps it to [0-31].
  * ---------------------------------------------------------------------- */
 {
-    FILE *fp = fopen(BACKLIGHT_SYSFS_PATH, "r");
-    if (!fp)
-        return BACKLIGHT_MAX_VALUE;                /* fall-back */
-
-    int val = BACKLIGHT_MAX_VALUE;
-    fscanf(fp, "%d", &val);
-    fclose(fp);
+    int val = hal_backlight()->read();
 
     if (val < 0)                   val = 0;
     if (val > BACKLIGHT_MAX_VALUE) val = BACKLIGHT_MAX_VALUE;
@@ -35,17 +32,53 @@ int read_backlight_brightness(void)
 /* ---------------------------------------------------------------------- */
 void set_backlight_brightness(int brightness)
 /* ----------------------------------------------------------------------
- *  Clamps `brightness` to [0-31] and pushes it into the sysfs file via a
- *  shell one-liner.  The write uses `sudo sh -c 'echo … > path'`, so the
- *  user running Vroom must have a matching entry in /etc/sudoers.
+ *  Clamps `brightness` to [0-31] and hands it to the active backend.
  * ---------------------------------------------------------------------- */
 {
     if (brightness < 0)                   brightness = 0;
     if (brightness > BACKLIGHT_MAX_VALUE) brightness = BACKLIGHT_MAX_VALUE;
 
+    gint64 t0 = g_get_monotonic_time();
+    hal_backlight()->write(brightness);
+    metrics_observe_since(METRIC_BACKLIGHT_WRITE, t0);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  sysfs backend                                                         */
+/* ---------------------------------------------------------------------- */
+static int sysfs_read(void)
+/* ----------------------------------------------------------------------
+ *  Reads the integer inside the sysfs node.  On failure (e.g., file
+ *  missing), assumes full brightness so the UI sliders still display
+ *  something.
+ * ---------------------------------------------------------------------- */
+{
+    FILE *fp = fopen(BACKLIGHT_SYSFS_PATH, "r");
+    if (!fp)
+        return BACKLIGHT_MAX_VALUE;                /* fall-back */
+
+    int val = BACKLIGHT_MAX_VALUE;
+    fscanf(fp, "%d", &val);
+    fclose(fp);
+    return val;
+}
+
+static void sysfs_write(int brightness)
+/* ----------------------------------------------------------------------
+ *  Pushes the value into the sysfs file via a shell one-liner.  The write
+ *  uses `sudo sh -c 'echo … > path'`, so the user running Vroom must have
+ *  a matching entry in /etc/sudoers.
+ * ---------------------------------------------------------------------- */
+{
     char cmd[128];
     snprintf(cmd, sizeof cmd,
              "sudo sh -c 'echo %d > %s'",
              brightness, BACKLIGHT_SYSFS_PATH);
     system(cmd);
 }
+
+const BacklightBackend SYSFS_BACKLIGHT_BACKEND = {
+    .name  = "sysfs",
+    .read  = sysfs_read,
+    .write = sysfs_write,
+};
@@ -0,0 +1,430 @@
+/* =========================================================================
+ *  CanReader.c — passive vehicle-data backend (SocketCAN + DBC)
+ * -------------------------------------------------------------------------
+ *  • Listens on a raw CAN socket and decodes the ECUs' own periodic
+ *    broadcasts with a DBC file compiled by Dbc.c — no OBD requests, no
+ *    ELM327 round trips.  Nothing is ever transmitted; put the interface
+ *    in listen-only mode as well (docs/Setup.MD) so the controller does
+ *    not even acknowledge frames.
+ *  • Kernel CAN_RAW_FILTERs pass only the IDs that carry a wanted PID,
+ *    re-applied on every set_pids(), so the rest of the bus never reaches
+ *    userspace.
+ *  • A reader thread drains the socket with recvmmsg() in batches of
+ *    RX_BATCH and decodes every frame into one value per PID under a
+ *    mutex taken once per batch.  The receive buffer is enlarged and the
+ *    kernel's drop counter (SO_RXQ_OVFL) feeds
+ *    vroom_can_frames_dropped_total.
+ *  • The GTK side hands the latest values to on_frame() as one
+ *    "V id:value …" line (ObdFrame.h) every EMIT_INTERVAL_MS, or the
+ *    set_min_period() floor if that is slower: a 100 Hz RPM broadcast is
+ *    fully decoded, but the UI sees it coalesced.  The line is stamped
+ *    with the newest decode in it, so --sources can order it against
+ *    the OBD adapter's frames (Merge.h).
+ *  • The link is up while decoded frames arrive and down after
+ *    LINK_TIMEOUT_MS of silence (ignition off).  A socket error (the
+ *    interface went down) drops the link and retries every
+ *    RETRY_INTERVAL_SEC, like VehicleReader.c.
+ *  • Exposed as SOCKETCAN_VEHICLE_BACKEND (see Hal.h) once
+ *    can_reader_configure() has loaded the DBC.
+ * ========================================================================= */
+#define _GNU_SOURCE                     /* recvmmsg() */
+#include "Hal.h"
+#include "Dbc.h"
+#include "Trace.h"
+#include "Metrics.h"
+
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can/raw.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+enum {
+    RX_BATCH           = 64,            /* frames per recvmmsg()         */
+    RX_BUFFER_BYTES    = 1 << 20,       /* SO_RCVBUF: ~2 s of a full bus */
+    EMIT_INTERVAL_MS   = 50,            /* values → UI, at most 20 Hz    */
+    LINK_TIMEOUT_MS    = 3000,          /* silence before link down      */
+    RETRY_INTERVAL_SEC = 10,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Session state                                                     */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    /* Configuration (can_reader_configure) */
+    gchar            *iface;
+    DbcTable         *dbc;
+
+    /* GTK thread only */
+    gboolean          active;           /* start() called, stop() not yet */
+    VehicleFrameFunc  on_frame;
+    VehicleLinkFunc   on_link;
+    gpointer          user_data;
+    guint64           pids;             /* PIDs to pass on */
+    gboolean          pids_set;         /* FALSE → every PID */
+    guint             min_period_ms;
+    gboolean          link_up;
+    guint             emit_tag;
+    guint             retry_tag;
+    GString          *line;             /* reused "V …" buffer */
+
+    /* Reader thread */
+    GThread          *thread;
+    int               sock;             /* -1 while closed */
+    int               stop_fd;          /* eventfd, wakes the thread */
+
+    /* Shared, under `lock` */
+    GMutex            lock;
+    gdouble           values[PID_COUNT];
+    guint64           fresh;            /* PIDs decoded since last emit */
+    gint64            last_rx_us;
+    int               error;            /* errno that ended the thread */
+} CanSession;
+
+static CanSession g_can = { .sock = -1, .stop_fd = -1 };
+
+/* ------------------------------------------------------------------ */
+/*  Forward declarations                                              */
+/* ------------------------------------------------------------------ */
+static gboolean open_socket(gpointer);
+static void     close_socket(void);
+static void     apply_filters(void);
+static void     arm_emit(void);
+static void     schedule_retry(void);
+static gboolean emit_values(gpointer);
+static gpointer reader_thread(gpointer);
+
+/* ------------------------------------------------------------------ */
+/*  Configuration                                                     */
+/* ------------------------------------------------------------------ */
+gboolean can_reader_configure(const char *iface, const char *dbc_path,
+                              const char *map)
+{
+    DbcTable *dbc = dbc_load(dbc_path, map);
+    if (!dbc)
+        return FALSE;
+
+    dbc_free(g_can.dbc);
+    g_free(g_can.iface);
+    g_can.dbc   = dbc;
+    g_can.iface = g_strdup(iface);
+    return TRUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Backend entry points                                              */
+/* ------------------------------------------------------------------ */
+static void can_start(VehicleFrameFunc on_frame, VehicleLinkFunc on_link,
+                      gpointer user_data)
+{
+    g_can.on_frame  = on_frame;
+    g_can.on_link   = on_link;
+    g_can.user_data = user_data;
+    g_can.active    = TRUE;
+    if (!g_can.line)
+        g_can.line = g_string_sized_new(256);
+    open_socket(NULL);
+}
+
+static void can_stop(void)
+/* Close the socket (if open) without scheduling a retry. */
+{
+    g_can.active = FALSE;
+    if (g_can.retry_tag) {
+        g_source_remove(g_can.retry_tag);
+        g_can.retry_tag = 0;
+    }
+    close_socket();
+}
+
+static void can_set_pids(guint64 pid_mask)
+{
+    if (g_can.pids_set && g_can.pids == pid_mask)
+        return;
+    g_can.pids     = pid_mask;
+    g_can.pids_set = TRUE;
+    apply_filters();                    /* no-op until the socket is open */
+}
+
+static void can_set_min_period(guint ms)
+/* Re-arm a running emit timer so the new rate applies now. */
+{
+    if (g_can.min_period_ms == ms)
+        return;
+    g_can.min_period_ms = ms;
+    if (g_can.emit_tag) {
+        g_source_remove(g_can.emit_tag);
+        arm_emit();
+    }
+}
+
+const VehicleBackend SOCKETCAN_VEHICLE_BACKEND = {
+    .name           = "socketcan",
+    .start          = can_start,
+    .stop           = can_stop,
+    .set_pids       = can_set_pids,
+    .set_min_period = can_set_min_period,
+    /* no .request: the bus is only listened to, never queried */
+};
+
+/* ------------------------------------------------------------------ */
+/*  Socket                                                            */
+/* ------------------------------------------------------------------ */
+static gboolean open_socket(gpointer)
+{
+    TRACE_SCOPE("can_open");
+    g_can.retry_tag = 0;                            /* this timeout is done */
+    if (!g_can.active || g_can.sock >= 0)
+        return G_SOURCE_REMOVE;
+
+    unsigned ifindex = if_nametoindex(g_can.iface);
+    int      sock    = ifindex ? socket(PF_CAN, SOCK_RAW, CAN_RAW) : -1;
+    if (sock < 0) {
+        g_printerr("[CAN] %s: %s\n", g_can.iface,
+                   g_strerror(ifindex ? errno : ENODEV));
+        schedule_retry();
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Best effort: the default buffer holds well under a second of a
+     * saturated 500 kbit/s bus if the reader is ever descheduled. */
+    int rcvbuf = RX_BUFFER_BYTES, on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf);
+    setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof on);
+
+    struct sockaddr_can addr = { .can_family = AF_CAN, .can_ifindex = (int)ifindex };
+    if (bind(sock, (struct sockaddr *)&addr, sizeof addr) < 0) {
+        g_printerr("[CAN] bind %s: %s\n", g_can.iface, g_strerror(errno));
+        close(sock);
+        schedule_retry();
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Without it close_socket() could never wake the reader to join it */
+    int stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd < 0) {
+        g_printerr("[CAN] eventfd: %s\n", g_strerror(errno));
+        close(sock);
+        schedule_retry();
+        return G_SOURCE_REMOVE;
+    }
+
+    g_can.sock    = sock;
+    g_can.stop_fd = stop_fd;
+    g_can.error   = 0;
+    g_can.fresh   = 0;
+    apply_filters();
+
+    g_can.thread = g_thread_new("can-reader", reader_thread, NULL);
+    arm_emit();
+    g_print("[CAN] listening on %s\n", g_can.iface);
+    return G_SOURCE_REMOVE;
+}
+
+static void close_socket(void)
+{
+    if (g_can.emit_tag) {
+        g_source_remove(g_can.emit_tag);
+        g_can.emit_tag = 0;
+    }
+    if (g_can.thread) {
+        eventfd_write(g_can.stop_fd, 1);
+        g_thread_join(g_can.thread);
+        g_can.thread = NULL;
+    }
+    if (g_can.stop_fd >= 0) { close(g_can.stop_fd); g_can.stop_fd = -1; }
+    if (g_can.sock >= 0)    { close(g_can.sock);    g_can.sock    = -1; }
+    g_can.link_up = FALSE;
+}
+
+static void apply_filters(void)
+/* ----------------------------------------------------------------------
+ *  One exact-match filter per message carrying a wanted PID.  An empty
+ *  list is valid and receives nothing — nothing is on screen.
+ * ---------------------------------------------------------------------- */
+{
+    if (g_can.sock < 0)
+        return;
+
+    guint64 want = g_can.pids_set ? g_can.pids : dbc_pids(g_can.dbc);
+    guint   max  = dbc_n_messages(g_can.dbc);
+    struct can_filter *filters = g_new(struct can_filter, MAX(max, 1));
+    guint   n    = dbc_filters(g_can.dbc, want, filters, max);
+
+    if (setsockopt(g_can.sock, SOL_CAN_RAW, CAN_RAW_FILTER,
+                   filters, (socklen_t)(n * sizeof *filters)) < 0)
+        g_printerr("[CAN] filter: %s\n", g_strerror(errno));
+    g_free(filters);
+}
+
+static void schedule_retry(void)
+{
+    if (g_can.active && !g_can.retry_tag) {
+        g_can.retry_tag = g_timeout_add_seconds(RETRY_INTERVAL_SEC,
+                                                open_socket, NULL);
+        g_source_set_name_by_id(g_can.retry_tag, "can-retry");
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  GTK side: values → on_frame()                                     */
+/* ------------------------------------------------------------------ */
+static void arm_emit(void)
+{
+    g_can.emit_tag = g_timeout_add(MAX((guint)EMIT_INTERVAL_MS, g_can.min_period_ms),
+                                   emit_values, NULL);
+    g_source_set_name_by_id(g_can.emit_tag, "can-emit");
+}
+
+static void set_link(gboolean up)
+{
+    if (g_can.link_up == up)
+        return;
+    g_can.link_up = up;
+    if (g_can.on_link)
+        g_can.on_link(up, g_can.user_data);
+}
+
+static gboolean emit_values(gpointer)
+{
+    TRACE_SCOPE("can_emit");
+    gdouble values[PID_COUNT];
+
+    g_mutex_lock(&g_can.lock);
+    guint64 fresh = g_can.fresh;
+    gint64  last  = g_can.last_rx_us;
+    int     error = g_can.error;
+    memcpy(values, g_can.values, sizeof values);
+    g_can.fresh = 0;
+    g_mutex_unlock(&g_can.lock);
+
+    if (error) {                        /* thread has already exited */
+        g_printerr("[CAN] %s: %s\n", g_can.iface, g_strerror(error));
+        g_can.emit_tag = 0;             /* removed by return */
+        set_link(FALSE);
+        close_socket();
+        schedule_retry();
+        return G_SOURCE_REMOVE;
+    }
+
+    fresh &= g_can.pids_set ? g_can.pids : G_MAXUINT64;
+    if (!fresh) {
+        if (g_can.link_up && g_get_monotonic_time() - last > LINK_TIMEOUT_MS * 1000)
+            set_link(FALSE);
+        return G_SOURCE_CONTINUE;
+    }
+
+    GString *s = g_can.line;
+    g_string_printf(s, "@%" G_GINT64_FORMAT " V", last);
+    for (guint id = 0; id < PID_COUNT; id++) {
+        if (!(fresh & (G_GUINT64_CONSTANT(1) << id)))
+            continue;
+        gchar num[G_ASCII_DTOSTR_BUF_SIZE];
+        g_string_append_printf(s, " %u:%s", id,
+                               g_ascii_formatd(num, sizeof num, "%.6g", values[id]));
+    }
+    g_string_append_c(s, '\n');
+
+    set_link(TRUE);
+    g_can.on_frame(s->str, s->len, g_can.user_data);
+    return G_SOURCE_CONTINUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Reader thread                                                     */
+/* ------------------------------------------------------------------ */
+static void decode_batch(const struct mmsghdr *msgs, const struct can_frame *frames,
+                         int n)
+{
+    guint64 fresh = 0;
+    int     valid = 0;
+
+    g_mutex_lock(&g_can.lock);
+    for (int i = 0; i < n; i++) {
+        if (msgs[i].msg_len != CAN_MTU)             /* CAN FD or short read */
+            continue;
+        fresh |= dbc_decode(g_can.dbc, frames[i].can_id, frames[i].data,
+                            frames[i].can_dlc, g_can.values);
+        valid++;
+    }
+    g_can.fresh |= fresh;
+    if (fresh)
+        g_can.last_rx_us = g_get_monotonic_time();
+    g_mutex_unlock(&g_can.lock);
+
+    metrics_add(METRIC_CAN_FRAMES, valid);
+}
+
+static guint32 read_drop_count(const struct msghdr *msg, guint32 previous)
+/* SO_RXQ_OVFL: the socket's cumulative drop count rides on every frame. */
+{
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(msg); c; c = CMSG_NXTHDR((struct msghdr *)msg, c))
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+            guint32 count;
+            memcpy(&count, CMSG_DATA(c), sizeof count);
+            return count;
+        }
+    return previous;
+}
+
+static gpointer reader_thread(gpointer)
+{
+    struct can_frame frames[RX_BATCH];
+    char             control[RX_BATCH][CMSG_SPACE(sizeof(guint32))];
+    struct mmsghdr   msgs[RX_BATCH];
+    struct iovec     iov[RX_BATCH];
+    guint32          drops = 0;
+    int              error;
+
+    for (int i = 0; i < RX_BATCH; i++)
+        iov[i] = (struct iovec){ &frames[i], sizeof frames[i] };
+
+    struct pollfd fds[2] = {
+        { .fd = g_can.sock,    .events = POLLIN },
+        { .fd = g_can.stop_fd, .events = POLLIN },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            error = errno;
+            break;
+        }
+        if (fds[1].revents)
+            return NULL;                            /* stop() */
+
+        /* msg_controllen is overwritten by every receive */
+        for (int i = 0; i < RX_BATCH; i++)
+            msgs[i].msg_hdr = (struct msghdr){
+                .msg_iov = &iov[i], .msg_iovlen = 1,
+                .msg_control = control[i], .msg_controllen = sizeof control[i],
+            };
+
+        int n = recvmmsg(g_can.sock, msgs, RX_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EINTR) continue;
+            error = errno;                          /* e.g. ENETDOWN */
+            break;
+        }
+        if (n == 0)
+            continue;
+        decode_batch(msgs, frames, n);
+
+        guint32 now = read_drop_count(&msgs[n - 1].msg_hdr, drops);
+        if (now != drops) {
+            metrics_add(METRIC_CAN_DROPPED, (gint64)(guint32)(now - drops));
+            drops = now;
+        }
+    }
+
+    g_mutex_lock(&g_can.lock);
+    g_can.error = error ? error : EIO;
+    g_mutex_unlock(&g_can.lock);
+    return NULL;
+}
@@ -0,0 +1,359 @@
+/* =========================================================================
+ *  Dbc.c — DBC parser + compiled signal extraction
+ * -------------------------------------------------------------------------
+ *  Bit numbering (classic CAN, 8 data bytes):
+ *
+ *      Intel     (@1)  start bit = LSB, bit b of byte k is k*8 + b.  In
+ *                      the payload read as a little-endian word that is
+ *                      simply bit k*8 + b, so shift = start.
+ *      Motorola  (@0)  start bit = MSB, same k*8 + b naming.  Read as a
+ *                      big-endian word, byte 0 is the top byte and the
+ *                      MSB sits (k*8 + 7 - b) bits from the top; the LSB
+ *                      is len − 1 further down, so
+ *                      shift = 63 − (k*8 + 7 − b + len − 1).
+ * ========================================================================= */
+#include "Dbc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+enum {
+    STD_IDS   = CAN_SFF_MASK + 1,          /* 2048 */
+    NAME_MAX_ = 64,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Types                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    guint64  mask;                         /* after the shift          */
+    gdouble  factor, offset;
+    guint8   shift;
+    guint8   need;                         /* payload bytes required   */
+    guint    big_endian : 1;
+    guint    is_signed  : 1;
+    guint8   bits;
+    PidId    pid;
+} DbcSignal;
+
+typedef struct {
+    canid_t  id;                           /* incl. CAN_EFF_FLAG       */
+    guint    first, count;                 /* into signals[]           */
+    guint64  pids;
+} DbcMessage;
+
+struct DbcTable {
+    DbcMessage *messages;                  /* sorted by id             */
+    guint       n_messages;
+    DbcSignal  *signals;
+    guint       n_signals;
+    guint64     pids;
+    guint16     std_index[STD_IDS];        /* message index + 1, 0 = none */
+};
+
+/* ------------------------------------------------------------------ */
+/*  Parsing                                                           */
+/* ------------------------------------------------------------------ */
+static GHashTable *parse_map(const char *map)
+/* "Sig=PID NAME,…" → signal name → PidId + 1; NULL on an unknown PID */
+{
+    GHashTable *h = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    if (!map)
+        return h;
+
+    gchar  **pairs = g_strsplit(map, ",", -1);
+    gboolean ok    = TRUE;
+    for (guint i = 0; ok && pairs[i]; i++) {
+        gchar *eq = strchr(pairs[i], '=');
+        if (!eq) {
+            if (*g_strstrip(pairs[i]))
+                g_printerr("[DBC] map entry '%s' is not SIGNAL=PID\n", pairs[i]);
+            ok = *pairs[i] == '\0';
+            continue;
+        }
+        *eq = '\0';
+        const gchar *sig = g_strstrip(pairs[i]);
+        const gchar *pid = g_strstrip(eq + 1);
+        gint id = pid_lookup(pid);
+        if (id < 0) {
+            g_printerr("[DBC] unknown PID '%s' for signal %s\n", pid, sig);
+            ok = FALSE;
+        } else {
+            g_hash_table_insert(h, g_strdup(sig), GINT_TO_POINTER(id + 1));
+        }
+    }
+    g_strfreev(pairs);
+
+    if (!ok) {
+        g_hash_table_unref(h);
+        return NULL;
+    }
+    return h;
+}
+
+static gboolean compile_signal(DbcSignal *s, guint start, guint len,
+                               gboolean big_endian)
+/* Fills shift / mask / need; FALSE if the signal is outside 8 bytes. */
+{
+    if (len == 0 || len > 64 || start > 63)
+        return FALSE;
+
+    guint lsb_from_top;
+    if (big_endian) {
+        guint msb_from_top = (start / 8) * 8 + (7 - start % 8);
+        lsb_from_top = msb_from_top + len - 1;
+        if (lsb_from_top > 63)
+            return FALSE;
+        s->shift = (guint8)(63 - lsb_from_top);
+        s->need  = (guint8)(lsb_from_top / 8 + 1);
+    } else {
+        if (start + len > 64)
+            return FALSE;
+        s->shift = (guint8)start;
+        s->need  = (guint8)((start + len - 1) / 8 + 1);
+    }
+    s->bits       = (guint8)len;
+    s->big_endian = big_endian;
+    s->mask       = len == 64 ? G_MAXUINT64 : (G_GUINT64_CONSTANT(1) << len) - 1;
+    return TRUE;
+}
+
+static gboolean parse_signal(const char *line, GHashTable *map,
+                             DbcSignal *s, gboolean *multiplexed)
+/* " SG_ Name [M|mN] : start|len@order sign (factor,offset) …" */
+{
+    *multiplexed = FALSE;
+
+    const char *p = strstr(line, "SG_");
+    if (!p)
+        return FALSE;
+    p += 3;
+    while (*p == ' ' || *p == '\t') p++;
+
+    const char *name_end = p;
+    while (*name_end && *name_end != ' ' && *name_end != '\t' && *name_end != ':')
+        name_end++;
+    gchar name[NAME_MAX_];
+    g_strlcpy(name, p, MIN((gsize)(name_end - p) + 1, sizeof name));
+
+    const char *colon = strchr(name_end, ':');
+    if (!colon)
+        return FALSE;
+    for (const char *q = name_end; q < colon; q++)
+        if (*q != ' ' && *q != '\t')
+            *multiplexed = TRUE;           /* M / mN indicator */
+
+    gpointer hit = g_hash_table_lookup(map, name);
+    gint pid = hit ? GPOINTER_TO_INT(hit) - 1 : pid_lookup(name);
+    if (pid < 0 || *multiplexed)
+        return FALSE;
+
+    /* start|len@order sign — integers only, so sscanf is locale-safe */
+    guint start, len;
+    char  order, sign;
+    int   used = 0;
+    if (sscanf(colon + 1, " %u|%u@%c%c %n", &start, &len, &order, &sign, &used) < 4
+        || (order != '0' && order != '1') || (sign != '+' && sign != '-'))
+        return FALSE;
+
+    /* (factor,offset) — g_ascii_strtod: GTK may have set a ',' locale */
+    const char *q = colon + 1 + used;
+    if (*q++ != '(')
+        return FALSE;
+    char *end;
+    s->factor = g_ascii_strtod(q, &end);
+    if (end == q || *end != ',')
+        return FALSE;
+    q = end + 1;
+    s->offset = g_ascii_strtod(q, &end);
+    if (end == q || *end != ')')
+        return FALSE;
+
+    if (!compile_signal(s, start, len, order == '0'))
+        return FALSE;
+    s->is_signed = sign == '-';
+    s->pid       = (PidId)pid;
+    return TRUE;
+}
+
+static int cmp_message(const void *a, const void *b)
+{
+    const DbcMessage *x = a, *y = b;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+DbcTable *dbc_load(const char *path, const char *map_spec)
+{
+    gchar *text = NULL;
+    if (!g_file_get_contents(path, &text, NULL, NULL)) {
+        g_printerr("[DBC] cannot read %s\n", path);
+        return NULL;
+    }
+    GHashTable *map = parse_map(map_spec);
+    if (!map) {
+        g_free(text);
+        return NULL;
+    }
+
+    GArray  *messages = g_array_new(FALSE, FALSE, sizeof(DbcMessage));
+    GArray  *signals  = g_array_new(FALSE, FALSE, sizeof(DbcSignal));
+    gboolean in_msg   = FALSE;
+    guint    skipped_mux = 0;
+
+    gchar **lines = g_strsplit(text, "\n", -1);
+    for (guint i = 0; lines[i]; i++) {
+        const gchar *l = lines[i];
+        while (*l == ' ' || *l == '\t') l++;
+
+        if (g_str_has_prefix(l, "BO_ ")) {
+            /* BO_ <id> <name>: <dlc> <sender> */
+            guint raw_id, dlc;
+            in_msg = sscanf(l, "BO_ %u %*[^:]: %u", &raw_id, &dlc) == 2
+                     && dlc <= CAN_MAX_DLEN;
+            if (!in_msg)
+                continue;
+            DbcMessage m = { .first = signals->len };
+            m.id = (raw_id & 0x80000000u)
+                 ? (raw_id & CAN_EFF_MASK) | CAN_EFF_FLAG
+                 : (raw_id & CAN_SFF_MASK);
+            g_array_append_val(messages, m);
+        } else if (g_str_has_prefix(l, "SG_ ") && in_msg) {
+            DbcSignal s = { 0 };
+            gboolean  mux;
+            if (parse_signal(l, map, &s, &mux)) {
+                g_array_append_val(signals, s);
+                DbcMessage *m = &g_array_index(messages, DbcMessage, messages->len - 1);
+                m->count++;
+                m->pids |= G_GUINT64_CONSTANT(1) << s.pid;
+            } else if (mux) {
+                skipped_mux++;
+            }
+        } else if (*l && !g_str_has_prefix(l, "SG_")) {
+            in_msg = FALSE;                /* signals only follow their BO_ */
+        }
+    }
+    g_strfreev(lines);
+    g_hash_table_unref(map);
+    g_free(text);
+
+    /* Drop messages without a kept signal, index the rest */
+    DbcTable *t = g_new0(DbcTable, 1);
+    guint     n = 0;
+    for (guint i = 0; i < messages->len; i++) {
+        DbcMessage m = g_array_index(messages, DbcMessage, i);
+        if (m.count)
+            g_array_index(messages, DbcMessage, n++) = m;
+    }
+    g_array_set_size(messages, n);
+    g_array_sort(messages, cmp_message);
+
+    t->n_messages = messages->len;
+    t->messages   = (DbcMessage *)g_array_free(messages, FALSE);
+    t->n_signals  = signals->len;
+    t->signals    = (DbcSignal *)g_array_free(signals, FALSE);
+
+    for (guint i = 0; i < t->n_messages; i++) {
+        const DbcMessage *m = &t->messages[i];
+        t->pids |= m->pids;
+        if (!(m->id & CAN_EFF_FLAG))
+            t->std_index[m->id] = (guint16)(i + 1);
+    }
+
+    if (!t->n_signals) {
+        g_printerr("[DBC] %s: no signal maps to a PID (use --can-map)\n", path);
+        dbc_free(t);
+        return NULL;
+    }
+    g_print("[DBC] %s: %u signals in %u messages", path, t->n_signals, t->n_messages);
+    if (skipped_mux)
+        g_print(", %u multiplexed signals skipped", skipped_mux);
+    g_print("\n");
+    return t;
+}
+
+void dbc_free(DbcTable *t)
+{
+    if (!t)
+        return;
+    g_free(t->messages);
+    g_free(t->signals);
+    g_free(t);
+}
+
+guint   dbc_n_messages(const DbcTable *t) { return t->n_messages; }
+guint   dbc_n_signals (const DbcTable *t) { return t->n_signals;  }
+guint64 dbc_pids      (const DbcTable *t) { return t->pids;       }
+
+guint dbc_filters(const DbcTable *t, guint64 pid_mask,
+                  struct can_filter *filters, guint max)
+{
+    guint n = 0;
+    for (guint i = 0; i < t->n_messages && n < max; i++) {
+        const DbcMessage *m = &t->messages[i];
+        if (!(m->pids & pid_mask))
+            continue;
+        /* Exact ID, same frame format, no remote frames */
+        filters[n].can_id   = m->id;
+        filters[n].can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG |
+                              ((m->id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK);
+        n++;
+    }
+    return n;
+}
+
+static const DbcMessage *find_message(const DbcTable *t, canid_t id)
+{
+    if (!(id & CAN_EFF_FLAG)) {
+        guint16 i = t->std_index[id & CAN_SFF_MASK];
+        return i ? &t->messages[i - 1] : NULL;
+    }
+
+    canid_t key = id & (CAN_EFF_FLAG | CAN_EFF_MASK);
+    guint lo = 0, hi = t->n_messages;
+    while (lo < hi) {
+        guint mid = (lo + hi) / 2;
+        if (t->messages[mid].id < key) lo = mid + 1;
+        else                           hi = mid;
+    }
+    return lo < t->n_messages && t->messages[lo].id == key ? &t->messages[lo] : NULL;
+}
+
+guint64 dbc_decode(const DbcTable *t, canid_t can_id, const guint8 *data,
+                   guint8 dlc, gdouble *values)
+{
+    if (can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))
+        return 0;
+    const DbcMessage *m = find_message(t, can_id);
+    if (!m)
+        return 0;
+
+    guint64 word;
+    memcpy(&word, data, sizeof word);
+    const guint64 le = GUINT64_FROM_LE(word);
+    const guint64 be = GUINT64_FROM_BE(word);
+
+    guint64 got = 0;
+    for (const DbcSignal *s = &t->signals[m->first],
+                         *e = s + m->count; s < e; s++) {
+        if (s->need > dlc)
+            continue;
+        guint64 raw = ((s->big_endian ? be : le) >> s->shift) & s->mask;
+        gdouble v;
+        if (s->is_signed && s->bits < 64 && (raw >> (s->bits - 1)) & 1)
+            v = (gdouble)(gint64)(raw | ~s->mask);
+        else if (s->is_signed)
+            v = (gdouble)(gint64)raw;
+        else
+            v = (gdouble)raw;
+        values[s->pid] = v * s->factor + s->offset;
+        got |= G_GUINT64_CONSTANT(1) << s->pid;
+    }
+    return got;
+}
@@ -0,0 +1,53 @@
+/* =========================================================================
+ *  Dbc.h — DBC signal definitions compiled into per-ID extraction tables
+ * -------------------------------------------------------------------------
+ *  dbc_load(path, map)
+ *      Reads the BO_ / SG_ lines of a DBC file and keeps the signals that
+ *      feed a PidTable.def PID: those named in `map`
+ *          "EngineSpeed=RPM,VehSpeed=SPEED,AccelPedal=THROTTLE POSITION"
+ *      plus any whose DBC name is itself a PID name (case-insensitive).
+ *      Messages left without a signal are dropped.  Multiplexed signals
+ *      and CAN FD payloads (> 8 bytes) are not supported and skipped.
+ *      DBC values are taken to be in the PID's unit (PidTable.def).
+ *      Returns NULL (and logs) on a missing file, a bad map or no usable
+ *      signal.
+ *
+ *  Each kept signal becomes one DbcSignal: whether to read the 8 payload
+ *  bytes as a little-endian (Intel) or big-endian (Motorola) word, the
+ *  shift and mask that isolate it in that word, the bytes it needs, and
+ *  factor / offset.  Standard IDs index a 2048-entry table directly;
+ *  extended IDs are binary-searched.  Decoding a frame is one lookup,
+ *  one 64-bit load and a shift / mask / multiply per signal.
+ *
+ *  dbc_filters(table, pid_mask, filters, max)
+ *      Kernel CAN_RAW_FILTER entries matching exactly the IDs that carry
+ *      a PID in `pid_mask`.  Returns how many were written.
+ *
+ *  dbc_decode(table, can_id, data, dlc, values)
+ *      Decodes one classic CAN frame (can_id as in struct can_frame,
+ *      including CAN_EFF_FLAG).  Writes values[pid] for every signal the
+ *      frame carries and returns their PID bits, 0 for unknown IDs.
+ *
+ *  No GTK or sockets here, so MicroBench can time dbc_decode() alone.
+ * ========================================================================= */
+#ifndef DBC_H
+#define DBC_H
+
+#include <glib.h>
+#include <linux/can.h>
+#include "PidTable.h"
+
+typedef struct DbcTable DbcTable;
+
+DbcTable *dbc_load      (const char *path, const char *map);
+void      dbc_free      (DbcTable *table);
+guint     dbc_n_messages(const DbcTable *table);
+guint     dbc_n_signals (const DbcTable *table);
+guint64   dbc_pids      (const DbcTable *table);     /* PIDs any signal feeds */
+
+guint     dbc_filters   (const DbcTable *table, guint64 pid_mask,
+                         struct can_filter *filters, guint max);
+guint64   dbc_decode    (const DbcTable *table, canid_t can_id,
+                         const guint8 *data, guint8 dlc, gdouble *values);
+
+#endif /* DBC_H */
@@ -0,0 +1,196 @@
+/* =========================================================================
+ *  DeviceState.c — lock-free device state + coalesced notifications
+ * -------------------------------------------------------------------------
+ *  • The whole state is one 64-bit word, 16 bits per field:
+ *        bits  0-15  sink index + 1     (0 = unknown)
+ *             16-31  volume + 1         (0 = unknown)
+ *             32-47  brightness + 1     (0 = unknown)
+ *             48-63  mode
+ *    Readers do one atomic load; writers CAS the field they change.  A
+ *    snapshot can never mix two updates.
+ *  • Sink names go into an append-only table (SINKS_MAX entries), written
+ *    before any word refers to them and never freed, so a reader holding
+ *    an old snapshot never sees a freed string.  Only adding a name not
+ *    seen before takes a mutex.
+ *  • A change queues the dispatch idle unless one is already queued.
+ *    The idle clears the flag *before* loading the word, so an update
+ *    racing with it queues the next one instead of being lost.
+ * ========================================================================= */
+#include "DeviceState.h"
+#include "Trace.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+enum {
+    SINKS_MAX       = 64,       /* distinct sink names per run */
+    SUBSCRIBERS_MAX = 8,
+
+    SINK_SHIFT       = 0,
+    VOLUME_SHIFT     = 16,
+    BRIGHTNESS_SHIFT = 32,
+    MODE_SHIFT       = 48,
+};
+
+/* ------------------------------------------------------------------ */
+/*  State                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    DeviceStateFunc func;
+    guint           mask;
+    gpointer        user_data;
+} Subscriber;
+
+/* Any thread */
+static atomic_uint_fast64_t   g_word;
+static _Atomic(const char *)  g_sinks[SINKS_MAX];
+static atomic_uint            g_n_sinks;
+static GMutex                 g_sink_lock;         /* appends only */
+static atomic_bool            g_dispatch_queued;
+
+/* GTK thread only */
+static Subscriber g_subs[SUBSCRIBERS_MAX];
+static guint      g_n_subs;
+static guint64    g_delivered;                      /* word last dispatched */
+
+/* ------------------------------------------------------------------ */
+/*  Helpers                                                           */
+/* ------------------------------------------------------------------ */
+static guint field(guint64 word, guint shift)
+{
+    return (guint)(word >> shift) & 0xFFFF;
+}
+
+static DeviceState unpack(guint64 word)
+{
+    guint sink = field(word, SINK_SHIFT);
+    return (DeviceState){
+        .sink       = sink ? atomic_load_explicit(&g_sinks[sink - 1],
+                                                  memory_order_acquire) : NULL,
+        .volume     = (int)field(word, VOLUME_SHIFT) - 1,
+        .brightness = (int)field(word, BRIGHTNESS_SHIFT) - 1,
+        .mode       = (DeviceMode)field(word, MODE_SHIFT),
+    };
+}
+
+static guint changed_fields(guint64 a, guint64 b)
+{
+    guint64 diff = a ^ b;
+    return (field(diff, SINK_SHIFT)       ? DEVICE_CHANGED_SINK       : 0)
+         | (field(diff, VOLUME_SHIFT)     ? DEVICE_CHANGED_VOLUME     : 0)
+         | (field(diff, BRIGHTNESS_SHIFT) ? DEVICE_CHANGED_BRIGHTNESS : 0)
+         | (field(diff, MODE_SHIFT)       ? DEVICE_CHANGED_MODE       : 0);
+}
+
+static gboolean dispatch(gpointer)
+/* GTK thread: hand the newest word to every interested subscriber. */
+{
+    TRACE_SCOPE("device_state_dispatch");
+    atomic_store(&g_dispatch_queued, false);
+    guint64 word    = atomic_load(&g_word);
+    guint   changed = changed_fields(word, g_delivered);
+    g_delivered = word;
+    if (!changed)
+        return G_SOURCE_REMOVE;
+
+    DeviceState state = unpack(word);
+    for (guint i = 0; i < g_n_subs; i++)
+        if (g_subs[i].mask & changed)
+            g_subs[i].func(&state, changed, g_subs[i].user_data);
+    return G_SOURCE_REMOVE;
+}
+
+static void queue_dispatch(void)
+{
+    if (!atomic_exchange(&g_dispatch_queued, true))
+        g_source_set_name_by_id(g_idle_add(dispatch, NULL), "device-state");
+}
+
+static void store_field(guint shift, guint value)
+/* CAS `value` into one field; queue a dispatch if the word changed. */
+{
+    guint64 mask = G_GUINT64_CONSTANT(0xFFFF) << shift;
+    guint64 old  = atomic_load(&g_word), next;
+    do {
+        next = (old & ~mask) | ((guint64)(value & 0xFFFF) << shift);
+        if (next == old)
+            return;
+    } while (!atomic_compare_exchange_weak(&g_word, &old, next));
+    queue_dispatch();
+}
+
+static guint sink_index(const char *sink)
+/* 1-based table index of `sink`, adding it on first sight; 0 if full. */
+{
+    guint n = atomic_load_explicit(&g_n_sinks, memory_order_acquire);
+    for (guint i = 0; i < n; i++)
+        if (strcmp(atomic_load_explicit(&g_sinks[i], memory_order_acquire), sink) == 0)
+            return i + 1;
+
+    g_mutex_lock(&g_sink_lock);
+    guint idx = 0;
+    n = atomic_load(&g_n_sinks);
+    for (guint i = 0; i < n && !idx; i++)           /* added meanwhile? */
+        if (strcmp(atomic_load(&g_sinks[i]), sink) == 0)
+            idx = i + 1;
+    if (!idx && n < SINKS_MAX) {
+        atomic_store_explicit(&g_sinks[n], g_strdup(sink), memory_order_release);
+        atomic_store_explicit(&g_n_sinks, n + 1, memory_order_release);
+        idx = n + 1;
+    }
+    g_mutex_unlock(&g_sink_lock);
+
+    if (!idx)
+        g_printerr("[State] more than %d sinks; '%s' not recorded\n",
+                   SINKS_MAX, sink);
+    return idx;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+DeviceState device_state_get(void)
+{
+    return unpack(atomic_load(&g_word));
+}
+
+void device_state_set_sink(const char *sink)
+{
+    guint idx = sink ? sink_index(sink) : 0;
+    if (idx || !sink)
+        store_field(SINK_SHIFT, idx);
+}
+
+void device_state_set_volume(int pct_0_100)
+{
+    store_field(VOLUME_SHIFT, (guint)CLAMP(pct_0_100, 0, 100) + 1);
+}
+
+void device_state_set_brightness(int raw_0_31)
+{
+    store_field(BRIGHTNESS_SHIFT, (guint)CLAMP(raw_0_31, 0, 31) + 1);
+}
+
+DeviceMode device_state_toggle_mode(void)
+{
+    guint64 mask = G_GUINT64_CONSTANT(0xFFFF) << MODE_SHIFT;
+    guint64 old  = atomic_load(&g_word), next;
+    DeviceMode mode;
+    do {
+        mode = field(old, MODE_SHIFT) == DEVICE_MODE_VOLUME
+             ? DEVICE_MODE_BRIGHTNESS : DEVICE_MODE_VOLUME;
+        next = (old & ~mask) | ((guint64)mode << MODE_SHIFT);
+    } while (!atomic_compare_exchange_weak(&g_word, &old, next));
+    queue_dispatch();
+    return mode;
+}
+
+void device_state_subscribe(DeviceStateFunc func, guint mask, gpointer user_data)
+{
+    g_return_if_fail(g_n_subs < SUBSCRIBERS_MAX);
+    g_subs[g_n_subs++] = (Subscriber){ func, mask, user_data };
+}
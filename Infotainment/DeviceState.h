@@ -0,0 +1,61 @@
+/* =========================================================================
+ *  DeviceState.h — current sink, volume, brightness and knob mode
+ * -------------------------------------------------------------------------
+ *  One store for the values the knob ISRs, the worker threads and the
+ *  GTK widgets all touch.
+ *
+ *  device_state_get()
+ *      A consistent snapshot of all four values, from any thread: one
+ *      atomic 64-bit load, no lock.  `sink` points at a copy the store
+ *      keeps for the life of the process, so it stays valid after the
+ *      default sink changes again.
+ *
+ *  device_state_set_sink(name) / _set_volume(pct) / _set_brightness(raw)
+ *  device_state_toggle_mode()
+ *      Publish a new value from any thread (a compare-and-swap on the same
+ *      word).  Setting the value already stored does nothing.
+ *
+ *  device_state_subscribe(func, mask, user_data)
+ *      GTK thread.  func(state, changed, user_data) runs on the GTK main
+ *      loop when a value in `mask` has changed.  However many updates
+ *      arrive in between, subscribers see one dispatch per main-loop
+ *      idle carrying only the latest snapshot — a fast knob spin does
+ *      not queue one idle per detent.
+ * ========================================================================= */
+#ifndef DEVICESTATE_H
+#define DEVICESTATE_H
+
+#include <glib.h>
+
+typedef enum {
+    DEVICE_MODE_VOLUME,
+    DEVICE_MODE_BRIGHTNESS,
+} DeviceMode;
+
+typedef struct {
+    const char *sink;           /* NULL until known                  */
+    int         volume;         /* 0-100 %, −1 until known           */
+    int         brightness;     /* 0-31,    −1 until known           */
+    DeviceMode  mode;           /* what the knob turns               */
+} DeviceState;
+
+enum {
+    DEVICE_CHANGED_SINK       = 1 << 0,
+    DEVICE_CHANGED_VOLUME     = 1 << 1,
+    DEVICE_CHANGED_BRIGHTNESS = 1 << 2,
+    DEVICE_CHANGED_MODE       = 1 << 3,
+};
+
+typedef void (*DeviceStateFunc)(const DeviceState *state, guint changed,
+                                gpointer user_data);
+
+DeviceState device_state_get           (void);
+void        device_state_set_sink      (const char *sink);
+void        device_state_set_volume    (int pct_0_100);
+void        device_state_set_brightness(int raw_0_31);
+DeviceMode  device_state_toggle_mode   (void);          /* the new mode */
+
+void        device_state_subscribe     (DeviceStateFunc func, guint mask,
+                                        gpointer user_data);
+
+#endif /* DEVICESTATE_H */
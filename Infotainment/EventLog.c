@@ -0,0 +1,411 @@
+/* =========================================================================
+ *  EventLog.c — per-thread event rings, deferred formatting, dumps
+ * -------------------------------------------------------------------------
+ *  Rings
+ *  -----
+ *      Each thread lazily gets an EvRing on its first EVLOG(); rings are
+ *      pushed onto a lock-free list and never freed.  A ring has a single
+ *      writer, its thread.  Every slot carries a sequence word: 0 while
+ *      the writer fills it, position + 1 once complete.  Readers copy a
+ *      slot and re-check the word, so a slot overwritten mid-copy is
+ *      skipped rather than shown torn.
+ *
+ *  Flusher
+ *  -------
+ *      Wakes every FLUSH_INTERVAL_MS, gathers the OUT / ERR events every
+ *      ring has gained since the last pass, orders them by timestamp and
+ *      formats them to stdout / stderr.  Events the writer lapped before
+ *      they were flushed are counted and reported.  It also serves the
+ *      SIGQUIT dump, so that works while the GTK loop is stuck.
+ *
+ *  Formatting
+ *  ----------
+ *      format_event() walks the EventLog.def format and hands each
+ *      conversion with its one argument to snprintf() on a stack buffer.
+ *      No allocation, so the crash handler can use it too.
+ * ========================================================================= */
+#include "EventLog.h"
+
+#include <glib.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+/* ---------------------------------------------------------------------- */
+/*  Constants                                                             */
+/* ---------------------------------------------------------------------- */
+enum {
+    FLUSH_INTERVAL_MS = 250,
+    MAX_DUMP_RINGS    = 32,       /* threads merged by evlog_dump()       */
+    LINE_MAX_BYTES    = 256,
+};
+
+#define RING_MASK  (EVLOG_RING_EVENTS - 1)
+G_STATIC_ASSERT((EVLOG_RING_EVENTS & RING_MASK) == 0);
+
+/* ---------------------------------------------------------------------- */
+/*  Table                                                                 */
+/* ---------------------------------------------------------------------- */
+typedef enum { OUT, ERR, RING } EventSink;
+
+typedef struct {
+    EventSink   sink;
+    const char *format;
+} EventInfo;
+
+static const EventInfo EVENT_INFO[EV_COUNT] = {
+#define EVENT_DEF(id, sink, nargs, format) [EV_##id] = { sink, format },
+#include "EventLog.def"
+#undef EVENT_DEF
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Types                                                                 */
+/* ---------------------------------------------------------------------- */
+typedef struct {
+    uint64_t    ts_ns;
+    uint16_t    id;
+    uint8_t     nargs;
+    uint8_t     type[EVLOG_MAX_ARGS];
+    EvValue     arg [EVLOG_MAX_ARGS];
+} EvRecord;
+
+typedef struct {
+    _Atomic uint64_t seq;                 /* 0 = being written          */
+    EvRecord         rec;
+} EvSlot;
+
+typedef struct EvRing {
+    struct EvRing   *next;
+    int              tid;
+    char             name[16];
+    _Atomic uint64_t head;                /* next position to write      */
+    uint64_t         flushed;             /* flusher: next to format     */
+    EvSlot           slot[EVLOG_RING_EVENTS];
+} EvRing;
+
+/* ---------------------------------------------------------------------- */
+/*  Module-wide state                                                     */
+/* ---------------------------------------------------------------------- */
+static _Atomic(EvRing *) g_rings          = NULL;
+static __thread EvRing  *t_ring           = NULL;
+static pthread_mutex_t   g_flush_lock     = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool       g_flusher_up     = false;
+static volatile sig_atomic_t g_dump_requested = 0;
+
+/* Forward declarations */
+static EvRing  *thread_ring   (void);
+static void     start_flusher (void);
+static gpointer flusher_thread(gpointer);
+static bool     read_slot     (const EvRing *r, uint64_t pos, EvRecord *out);
+static int      format_event  (const EvRecord *e, char *buf, size_t size);
+static void     on_quit_signal (int);
+static void     on_fatal_signal(int sig);
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+void evlog_init(void)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sigemptyset(&sa.sa_mask);
+
+    sa.sa_handler = on_quit_signal;
+    sa.sa_flags   = SA_RESTART;
+    sigaction(SIGQUIT, &sa, NULL);
+
+    /* One dump, then the default action (core / exit status) */
+    static const int FATAL[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+    sa.sa_handler = on_fatal_signal;
+    sa.sa_flags   = SA_RESETHAND;
+    for (guint i = 0; i < G_N_ELEMENTS(FATAL); i++)
+        sigaction(FATAL[i], &sa, NULL);
+
+    start_flusher();
+}
+
+void evlog_write(EventId id, int nargs, const EvArg *args)
+{
+    EvRing *r = t_ring ? t_ring : thread_ring();
+    if (!r)
+        return;
+
+    uint64_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    EvSlot  *s   = &r->slot[pos & RING_MASK];
+
+    atomic_store_explicit(&s->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    s->rec.ts_ns = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    s->rec.id    = (uint16_t)id;
+    s->rec.nargs = (uint8_t)nargs;
+    for (int i = 0; i < nargs; i++) {
+        s->rec.type[i] = (uint8_t)args[i].type;
+        s->rec.arg[i]  = args[i].v;
+    }
+
+    atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+    atomic_store_explicit(&r->head, pos + 1, memory_order_release);
+}
+
+static int cmp_ts(gconstpointer a, gconstpointer b)
+{
+    const EvRecord *x = a, *y = b;
+    return (x->ts_ns > y->ts_ns) - (x->ts_ns < y->ts_ns);
+}
+
+void evlog_flush(void)
+{
+    pthread_mutex_lock(&g_flush_lock);
+
+    GArray  *batch = g_array_new(FALSE, FALSE, sizeof(EvRecord));
+    gboolean lost  = FALSE;
+
+    for (EvRing *r = atomic_load(&g_rings); r; r = r->next) {
+        uint64_t head  = atomic_load_explicit(&r->head, memory_order_acquire);
+        uint64_t start = r->flushed;
+        if (head - start > EVLOG_RING_EVENTS) {
+            /* Counts RING events too — the ring cannot tell them apart */
+            fprintf(stderr, "[EventLog] thread %d (%s): %" G_GUINT64_FORMAT
+                    " events overwritten before the flusher reached them\n",
+                    r->tid, r->name,
+                    (guint64)(head - start - EVLOG_RING_EVENTS));
+            lost  = TRUE;
+            start = head - EVLOG_RING_EVENTS;
+        }
+        for (uint64_t p = start; p < head; p++) {
+            EvRecord e;
+            if (read_slot(r, p, &e) && EVENT_INFO[e.id].sink != RING)
+                g_array_append_val(batch, e);
+        }
+        r->flushed = head;
+    }
+
+    g_array_sort(batch, cmp_ts);
+    for (guint i = 0; i < batch->len; i++) {
+        const EvRecord *e = &g_array_index(batch, EvRecord, i);
+        char line[LINE_MAX_BYTES];
+        format_event(e, line, sizeof line);
+        fputs(line, EVENT_INFO[e->id].sink == ERR ? stderr : stdout);
+    }
+    if (batch->len || lost) {
+        fflush(stdout);
+        fflush(stderr);
+    }
+    g_array_free(batch, TRUE);
+
+    pthread_mutex_unlock(&g_flush_lock);
+}
+
+/* Next record of `r` at or after *pos that is not older than `cutoff` */
+static bool peek_from(const EvRing *r, uint64_t *pos, uint64_t head,
+                      uint64_t cutoff, EvRecord *out)
+{
+    for (; *pos < head; (*pos)++)
+        if (read_slot(r, *pos, out) && out->ts_ns >= cutoff)
+            return true;
+    return false;
+}
+
+void evlog_dump(int fd, unsigned int seconds)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now    = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    uint64_t span   = (uint64_t)seconds * 1000000000ull;
+    uint64_t cutoff = now > span ? now - span : 0;
+
+    /* Cursor per ring, then a k-way merge by timestamp */
+    const EvRing *ring[MAX_DUMP_RINGS];
+    uint64_t      pos [MAX_DUMP_RINGS], head[MAX_DUMP_RINGS];
+    EvRecord      next[MAX_DUMP_RINGS];
+    bool          have[MAX_DUMP_RINGS];
+    int           n = 0;
+
+    for (EvRing *r = atomic_load(&g_rings); r && n < MAX_DUMP_RINGS; r = r->next) {
+        ring[n] = r;
+        head[n] = atomic_load_explicit(&r->head, memory_order_acquire);
+        pos[n]  = head[n] > EVLOG_RING_EVENTS ? head[n] - EVLOG_RING_EVENTS : 0;
+        have[n] = peek_from(r, &pos[n], head[n], cutoff, &next[n]);
+        n++;
+    }
+
+    char line[LINE_MAX_BYTES + 64];
+    int  len = snprintf(line, sizeof line,
+                        "[EventLog] last %u s, %d thread(s):\n", seconds, n);
+    if (write(fd, line, (size_t)len) < 0)
+        return;
+
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < n; i++)
+            if (have[i] && (best < 0 || next[i].ts_ns < next[best].ts_ns))
+                best = i;
+        if (best < 0)
+            break;
+
+        const EvRing *r = ring[best];
+        len = snprintf(line, sizeof line, "  %8.3f s  %5d %-15s ",
+                       -((double)(now - next[best].ts_ns) / 1e9), r->tid, r->name);
+        len += format_event(&next[best], line + len, sizeof line - (size_t)len);
+        if (write(fd, line, (size_t)len) < 0)
+            return;
+
+        pos[best]++;
+        have[best] = peek_from(r, &pos[best], head[best], cutoff, &next[best]);
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Rings                                                                 */
+/* ---------------------------------------------------------------------- */
+static EvRing *thread_ring(void)
+/* First EVLOG() on this thread: allocate and publish its ring. */
+{
+    EvRing *r = calloc(1, sizeof *r);
+    if (!r)
+        return NULL;
+
+    r->tid = (int)syscall(SYS_gettid);
+    if (prctl(PR_GET_NAME, r->name) != 0)  /* name[] is the 16 it needs */
+        r->name[0] = '\0';
+
+    r->next = atomic_load(&g_rings);
+    while (!atomic_compare_exchange_weak(&g_rings, &r->next, r))
+        ;
+    t_ring = r;
+
+    start_flusher();
+    return r;
+}
+
+static bool read_slot(const EvRing *r, uint64_t pos, EvRecord *out)
+{
+    const EvSlot *s = &r->slot[pos & RING_MASK];
+    if (atomic_load_explicit(&s->seq, memory_order_acquire) != pos + 1)
+        return false;
+
+    *out = s->rec;
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&s->seq, memory_order_relaxed) != pos + 1)
+        return false;                      /* lapped while copying */
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Flusher                                                               */
+/* ---------------------------------------------------------------------- */
+static void start_flusher(void)
+{
+    if (atomic_exchange(&g_flusher_up, true))
+        return;
+    atexit(evlog_flush);
+    g_thread_unref(g_thread_new("evlog-flush", flusher_thread, NULL));
+}
+
+static gpointer flusher_thread(gpointer)
+{
+    for (;;) {
+        g_usleep(FLUSH_INTERVAL_MS * 1000);
+        evlog_flush();
+
+        if (g_dump_requested) {
+            g_dump_requested = 0;
+            evlog_dump(STDERR_FILENO, EVLOG_DUMP_SECONDS);
+        }
+    }
+    return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Signal handlers                                                       */
+/* ---------------------------------------------------------------------- */
+static void on_quit_signal(int)
+{
+    g_dump_requested = 1;                  /* the flusher does the work */
+}
+
+static void on_fatal_signal(int sig)
+{
+    char msg[64];
+    int  len = snprintf(msg, sizeof msg, "[EventLog] fatal signal %d\n", sig);
+    if (write(STDERR_FILENO, msg, (size_t)len) >= 0)
+        evlog_dump(STDERR_FILENO, EVLOG_DUMP_SECONDS);
+    raise(sig);                            /* SA_RESETHAND: default now */
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Formatting                                                            */
+/* ---------------------------------------------------------------------- */
+static int format_event(const EvRecord *e, char *buf, size_t size)
+/* One line, '\n'-terminated; returns its length (≤ size - 1). */
+{
+    const char *f   = EVENT_INFO[e->id].format;
+    size_t      len = 0;
+    int         k   = 0;
+
+#define ROOM  (len < size ? size - len : 0)
+#define PUT(n) do { int n_ = (n); if (n_ > 0) len += (size_t)n_;            \
+                    if (len >= size) len = size - 1; } while (0)
+
+    while (*f && len + 1 < size) {
+        if (*f != '%') { buf[len++] = *f++; continue; }
+        if (f[1] == '%') { buf[len++] = '%'; f += 2; continue; }
+
+        /* %[flags][width][.prec]conv → spec, with "ll" for integers */
+        char spec[24];
+        size_t n = 0;
+        spec[n++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && n < sizeof spec - 4)
+            spec[n++] = *f++;
+        char conv = *f ? *f++ : 's';
+
+        if (k >= e->nargs) {
+            PUT(snprintf(buf + len, ROOM, "?"));
+            continue;
+        }
+        int     type = e->type[k];
+        int64_t iv   = e->arg[k].i;
+        double  dv   = e->arg[k].d;
+        const char *sv = e->arg[k].s;
+        k++;
+
+        switch (conv) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+            spec[n++] = 'l'; spec[n++] = 'l'; spec[n++] = conv; spec[n] = '\0';
+            if (type == EVARG_DOUBLE) iv = (int64_t)dv;
+            if (type == EVARG_STR) { PUT(snprintf(buf + len, ROOM, "?")); break; }
+            PUT(snprintf(buf + len, ROOM, spec, (long long)iv));
+            break;
+        case 'f': case 'F': case 'g': case 'G': case 'e': case 'E':
+            spec[n++] = conv; spec[n] = '\0';
+            if (type == EVARG_INT) dv = (double)iv;
+            if (type == EVARG_STR) { PUT(snprintf(buf + len, ROOM, "?")); break; }
+            PUT(snprintf(buf + len, ROOM, spec, dv));
+            break;
+        default:                           /* 's' */
+            spec[n++] = 's'; spec[n] = '\0';
+            PUT(snprintf(buf + len, ROOM, spec,
+                         type == EVARG_STR && sv ? sv : "?"));
+            break;
+        }
+    }
+#undef PUT
+#undef ROOM
+
+    if (len >= size - 1) len = size - 2;
+    buf[len++] = '\n';
+    buf[len]   = '\0';
+    return (int)len;
+}
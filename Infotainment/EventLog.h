@@ -0,0 +1,105 @@
+/* =========================================================================
+ *  EventLog.h — lock-free binary event log for hot paths
+ * -------------------------------------------------------------------------
+ *  EVLOG(ID, args…)
+ *      Records event EV_<ID> from EventLog.def with up to four integer,
+ *      double or static-string arguments.  Nothing is formatted: the
+ *      caller stores a timestamp, the format ID and the raw arguments in
+ *      its own thread's ring and moves on — no lock, no allocation, no
+ *      stdio — so it is safe in the knob ISRs and per-frame callbacks.
+ *      The argument count is checked against the table at compile time.
+ *
+ *  Each thread's ring holds the last EVLOG_RING_EVENTS events and
+ *  overwrites the oldest.  A background flusher formats OUT / ERR events
+ *  to stdout / stderr a few times a second (and at exit), so the console
+ *  reads as it did with g_print().  RING events are kept for dumps only.
+ *
+ *  evlog_init()
+ *      Installs the dump triggers; call first thing in main().
+ *          kill -QUIT <pid>    → last EVLOG_DUMP_SECONDS of every thread
+ *                                to stderr; Vroom keeps running
+ *          SIGSEGV / SIGBUS / SIGFPE / SIGILL / SIGABRT
+ *                              → the same dump, then the default action
+ *      Without it EVLOG() still records and flushes, there are just no
+ *      dumps.
+ *
+ *  evlog_flush()
+ *      Formats everything not yet flushed, now.
+ *
+ *  evlog_dump(fd, seconds)
+ *      Every thread's events from the last `seconds`, oldest first,
+ *      including RING events and ones already flushed.  Allocation-free,
+ *      which is what lets the crash handler use it.
+ * ========================================================================= */
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+
+enum { EVLOG_RING_EVENTS = 1024, EVLOG_DUMP_SECONDS = 10, EVLOG_MAX_ARGS = 4 };
+
+typedef enum {
+#define EVENT_DEF(id, sink, nargs, format) EV_##id,
+#include "EventLog.def"
+#undef EVENT_DEF
+    EV_COUNT
+} EventId;
+
+enum {
+#define EVENT_DEF(id, sink, nargs, format) EV_ARGC_##id = nargs,
+#include "EventLog.def"
+#undef EVENT_DEF
+};
+
+void evlog_init (void);
+void evlog_flush(void);
+void evlog_dump (int fd, unsigned int seconds);
+
+/* Low-level hooks used by the macro ------------------------------------ */
+typedef enum { EVARG_INT, EVARG_DOUBLE, EVARG_STR } EvArgType;
+
+typedef union {
+    int64_t     i;
+    double      d;
+    const char *s;
+} EvValue;
+
+typedef struct {
+    EvArgType type;
+    EvValue   v;
+} EvArg;
+
+static inline EvArg evarg_int   (int64_t v)     { return (EvArg){ EVARG_INT,    { .i = v } }; }
+static inline EvArg evarg_double(double v)      { return (EvArg){ EVARG_DOUBLE, { .d = v } }; }
+static inline EvArg evarg_str   (const char *v) { return (EvArg){ EVARG_STR,    { .s = v } }; }
+
+void evlog_write(EventId id, int nargs, const EvArg *args);
+
+/* Convenience macro ---------------------------------------------------- */
+#define EVARG(x) _Generic((x),                                             \
+        float: evarg_double, double: evarg_double,                         \
+        char *: evarg_str, const char *: evarg_str,                        \
+        default: evarg_int)(x)
+
+#define EVLOG_NARGS_(a, b, c, d, n, ...) n
+#define EVLOG_NARGS(...)  EVLOG_NARGS_(__VA_OPT__(__VA_ARGS__,) 4, 3, 2, 1, 0)
+
+#define EVLOG_MAP_0()
+#define EVLOG_MAP_1(a)          EVARG(a)
+#define EVLOG_MAP_2(a, b)       EVARG(a), EVARG(b)
+#define EVLOG_MAP_3(a, b, c)    EVARG(a), EVARG(b), EVARG(c)
+#define EVLOG_MAP_4(a, b, c, d) EVARG(a), EVARG(b), EVARG(c), EVARG(d)
+#define EVLOG_CAT_(a, b) a##b
+#define EVLOG_CAT(a, b)  EVLOG_CAT_(a, b)
+
+#define EVLOG(id, ...)                                                     \
+    do {                                                                   \
+        _Static_assert(EV_ARGC_##id == EVLOG_NARGS(__VA_ARGS__),           \
+                       "EVLOG(" #id "): argument count differs from EventLog.def"); \
+        const EvArg evlog_args_[EVLOG_MAX_ARGS] = {                        \
+            EVLOG_CAT(EVLOG_MAP_, EVLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)   \
+        };                                                                 \
+        evlog_write(EV_##id, EV_ARGC_##id, evlog_args_);                   \
+    } while (0)
+
+#endif /* EVENTLOG_H */
@@ -0,0 +1,71 @@
+/* =========================================================================
+ *  Hal.c — backend selection (real hardware vs. --simulate)
+ * ========================================================================= */
+#include "Hal.h"
+
+/* ---------------------------------------------------------------------- */
+/*  Module-wide state                                                     */
+/* ---------------------------------------------------------------------- */
+static gboolean                g_simulate  = FALSE;
+static const InputBackend     *g_input     = &WIRINGPI_INPUT_BACKEND;
+static const BacklightBackend *g_backlight = &SYSFS_BACKLIGHT_BACKEND;
+static const AudioBackend     *g_audio     = &PACTL_AUDIO_BACKEND;
+static const VehicleBackend   *g_vehicle[HAL_MAX_VEHICLES] = { &OBD_READER_VEHICLE_BACKEND };
+static guint                   g_n_vehicles = 1;
+static const PowerBackend     *g_power     = &SYSFS_POWER_BACKEND;
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+void hal_init(gboolean simulate)
+{
+    g_simulate = simulate;
+
+    if (simulate) {
+        g_input     = &SIM_INPUT_BACKEND;
+        g_backlight = &SIM_BACKLIGHT_BACKEND;
+        g_audio     = &SIM_AUDIO_BACKEND;
+        g_vehicle[0] = &SIM_VEHICLE_BACKEND;
+        g_power     = &SIM_POWER_BACKEND;
+    } else {
+        g_input     = &WIRINGPI_INPUT_BACKEND;
+        g_backlight = &SYSFS_BACKLIGHT_BACKEND;
+        g_audio     = &PACTL_AUDIO_BACKEND;
+        g_vehicle[0] = &OBD_READER_VEHICLE_BACKEND;
+        g_power     = &SYSFS_POWER_BACKEND;
+    }
+
+    g_print("[HAL] input=%s backlight=%s audio=%s vehicle=%s power=%s\n",
+            g_input->name, g_backlight->name, g_audio->name, g_vehicle[0]->name,
+            g_power->name);
+}
+
+void hal_set_vehicle(const VehicleBackend *backend)
+{
+    g_vehicle[0] = backend;
+    g_print("[HAL] vehicle=%s\n", backend->name);
+}
+
+gboolean hal_add_vehicle(const VehicleBackend *backend)
+{
+    if (g_n_vehicles == HAL_MAX_VEHICLES)
+        return FALSE;
+    g_vehicle[g_n_vehicles++] = backend;
+    g_print("[HAL] vehicle+=%s\n", backend->name);
+    return TRUE;
+}
+
+gboolean hal_simulated(void) { return g_simulate; }
+
+const InputBackend     *hal_input    (void) { return g_input;     }
+const BacklightBackend *hal_backlight(void) { return g_backlight; }
+const AudioBackend     *hal_audio    (void) { return g_audio;     }
+const VehicleBackend   *hal_vehicle  (void) { return g_vehicle[0]; }
+const PowerBackend     *hal_power    (void) { return g_power;     }
+
+guint hal_vehicle_count(void) { return g_n_vehicles; }
+
+const VehicleBackend *hal_vehicle_at(guint i)
+{
+    return i < g_n_vehicles ? g_vehicle[i] : NULL;
+}
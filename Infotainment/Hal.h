@@ -0,0 +1,157 @@
+/* =========================================================================
+ *  Hal.h — thin backend interfaces for everything that touches hardware
+ * -------------------------------------------------------------------------
+ *  Five subsystems sit behind a small table of function pointers:
+ *
+ *      InputBackend      rotary encoder pins + edge interrupts
+ *      BacklightBackend  panel brightness 0-31
+ *      AudioBackend      PulseAudio-style sinks and volumes
+ *      VehicleBackend    stream of one-line OBD frames, polling the
+ *                        PIDs the UI asks for (or, with --can, decoded
+ *                        from the CAN broadcasts the ECUs already send)
+ *      PowerBackend      CPU frequency governor
+ *
+ *  Real implementations live next to the code that used to call the
+ *  hardware directly (RotaryEncoder.c → wiringPi, BacklightManager.c →
+ *  sysfs, AudioManager.c → pactl, VehicleReader.c → obd_reader.py,
+ *  CanReader.c → SocketCAN, IdleManager.c → cpufreq sysfs).  Simulation.c provides in-process
+ *  stand-ins: a scripted encoder, an in-memory backlight, a fake sink
+ *  set, a synthetic ECU and a governor that is only remembered.
+ *
+ *  hal_init(simulate) must run before any manager is used; it selects
+ *  the real backends, or the simulators for `--simulate`.
+ *  hal_set_vehicle() then swaps just the vehicle backend (--can), and
+ *  hal_add_vehicle() runs more next to it (--sources=obd,can): up to
+ *  HAL_MAX_VEHICLES, index 0 first, merged by Telemetry (Merge.h).
+ *
+ *  Builds without -lwiringPi (dev workstations) define VROOM_NO_WIRINGPI;
+ *  the real input backend is then unavailable and only --simulate has a
+ *  working knob.
+ * ========================================================================= */
+#ifndef HAL_H
+#define HAL_H
+
+#include <glib.h>
+
+/* ------------------------------------------------------------------ */
+/*  Input                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    int a, b, sw;                           /* wiringPi pin numbers      */
+} EncoderPins;
+
+typedef void (*PinIsr)(void);
+
+typedef struct {
+    const char *name;
+    /* Configure pins as pulled-up inputs and attach edge ISRs.  The ISRs
+     * run on a backend-owned thread, never on the GTK thread.          */
+    gboolean (*start)   (const EncoderPins *pins, PinIsr ab_isr, PinIsr sw_isr);
+    int      (*read_pin)(int pin);          /* 0 = LOW, 1 = HIGH         */
+} InputBackend;
+
+/* ------------------------------------------------------------------ */
+/*  Backlight                                                         */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    const char *name;
+    int  (*read) (void);                    /* 0-31                       */
+    void (*write)(int brightness_0_to_31);  /* already clamped            */
+} BacklightBackend;
+
+/* ------------------------------------------------------------------ */
+/*  Audio                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    const char *name;
+    gchar  *(*default_sink)    (void);                   /* g_free()     */
+    GSList *(*list_sinks)      (void);                   /* of gchar*    */
+    void    (*set_default_sink)(const char *sink);
+    int     (*get_volume)      (const char *sink);       /* −1 on error  */
+    void    (*set_volume)      (const char *sink, int pct_0_100);
+} AudioBackend;
+
+/* ------------------------------------------------------------------ */
+/*  Vehicle data                                                      */
+/* ------------------------------------------------------------------ */
+/* Both callbacks run on the GTK main loop. */
+typedef enum {
+    VEHICLE_PRIORITY_LOW,       /* only while no streaming PID is due   */
+    VEHICLE_PRIORITY_NORMAL,    /* after the current poll round         */
+    VEHICLE_PRIORITY_HIGH,      /* next free adapter turn               */
+} VehiclePriority;
+
+typedef void (*VehicleFrameFunc)(const gchar *line, gsize len, gpointer user_data);
+typedef void (*VehicleLinkFunc) (gboolean up, gpointer user_data);
+
+typedef struct {
+    const char *name;
+    void (*start)   (VehicleFrameFunc on_frame, VehicleLinkFunc on_link,
+                     gpointer user_data);
+    void (*stop)    (void);
+    /* PIDs to poll, bit i = PidId i.  May be called before start(); while
+     * running, PIDs outside the mask stop being queried straight away. */
+    void (*set_pids)(guint64 pid_mask);
+    /* Floor on every PID's poll interval, 0 = the table rates.  Used as
+     * a heartbeat while parked; may be called before start(). */
+    void (*set_min_period)(guint ms);
+    /* One-off query (hex, "03", "0902" …) slotted in between streaming
+     * polls; answered by one "A tag …" line through on_frame (ObdFrame.h).
+     * Kept across reconnects until answered or cancelled.  NULL for
+     * backends that only listen (SocketCAN). */
+    void (*request)(guint tag, VehiclePriority priority, const char *command);
+    void (*cancel) (guint tag);
+} VehicleBackend;
+
+/* ------------------------------------------------------------------ */
+/*  Power                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    const char *name;
+    gchar *(*get_governor)(void);                   /* g_free(); NULL on error */
+    void   (*set_governor)(const char *governor);   /* all CPU policies        */
+} PowerBackend;
+
+/* ------------------------------------------------------------------ */
+/*  Selection                                                         */
+/* ------------------------------------------------------------------ */
+#define HAL_MAX_VEHICLES 4                  /* = MERGE_MAX_SOURCES */
+
+void     hal_init       (gboolean simulate);
+void     hal_set_vehicle(const VehicleBackend *backend);  /* after hal_init */
+gboolean hal_add_vehicle(const VehicleBackend *backend);  /* FALSE if full  */
+gboolean hal_simulated  (void);
+
+const InputBackend     *hal_input    (void);
+const BacklightBackend *hal_backlight(void);
+const AudioBackend     *hal_audio    (void);
+const VehicleBackend   *hal_vehicle  (void);               /* = hal_vehicle_at(0) */
+guint                   hal_vehicle_count(void);
+const VehicleBackend   *hal_vehicle_at   (guint i);
+const PowerBackend     *hal_power    (void);
+
+/* Real backends (defined by the respective managers) */
+extern const InputBackend     WIRINGPI_INPUT_BACKEND;
+extern const BacklightBackend SYSFS_BACKLIGHT_BACKEND;
+extern const AudioBackend     PACTL_AUDIO_BACKEND;
+extern const VehicleBackend   OBD_READER_VEHICLE_BACKEND;
+extern const VehicleBackend   SOCKETCAN_VEHICLE_BACKEND;    /* CanReader.c */
+extern const PowerBackend     SYSFS_POWER_BACKEND;
+
+/* Simulators (Simulation.c) */
+extern const InputBackend     SIM_INPUT_BACKEND;
+extern const BacklightBackend SIM_BACKLIGHT_BACKEND;
+extern const AudioBackend     SIM_AUDIO_BACKEND;
+extern const VehicleBackend   SIM_VEHICLE_BACKEND;
+extern const PowerBackend     SIM_POWER_BACKEND;
+
+/* Simulator tuning (optional, call before hal_init) */
+void sim_set_input_script(const char *path);    /* NULL → built-in demo */
+void sim_set_ecu_rate    (guint frames_per_second);
+
+/* SocketCAN backend: interface, DBC file and "Signal=PID,…" map (see
+ * Dbc.h).  FALSE if the DBC yields no usable signal. */
+gboolean can_reader_configure(const char *iface, const char *dbc_path,
+                              const char *map);
+
+#endif /* HAL_H */
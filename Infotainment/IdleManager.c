@@ -0,0 +1,466 @@
+/* =========================================================================
+ *  IdleManager.c — implementation of the parked / no-input sleep
+ * -------------------------------------------------------------------------
+ *  • Awake, the only cost is one timestamp per input and a single
+ *    timeout that fires once per no-input period; the engine-off check
+ *    rides on frames telemetry decodes anyway.
+ *  • Asleep, the manager owns no sources at all.  Waking is event
+ *    driven: the input path posts one high-priority idle to the GTK
+ *    thread, which restores the heartbeat and animations and hands the
+ *    slow sudo writes (backlight, governor) to the "idle-power" apply
+ *    channel so the main loop never blocks on them.
+ *  • The worker keeps the pre-sleep backlight level and governor, so a
+ *    sleep → wake → sleep burst always restores what the user had.
+ *  • The real governor backend (SYSFS_POWER_BACKEND) lives at the
+ *    bottom of this file.
+ * ========================================================================= */
+#include "IdleManager.h"
+#include "ApplyChannel.h"
+#include "BacklightManager.h"
+#include "Hal.h"
+#include "Metrics.h"
+#include "Telemetry.h"
+#include "Trace.h"
+
+#include <gtk/gtk.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+static const guint  IDLE_DEFAULT_MINUTES = 10;
+static const int    IDLE_DIM_LEVEL       = 3;      /* backlight 0-31      */
+static const guint  IDLE_HEARTBEAT_MS    = 5000;   /* vehicle polling     */
+static const char   IDLE_GOVERNOR[]      = "powersave";
+static const double ENGINE_OFF_RPM       = 100;    /* below → not running */
+static const double ENGINE_CHARGING_V    = 13.2;   /* alternator output   */
+static const guint  ENGINE_OFF_HOLD_SEC  = 60;
+static const double WAKE_BUDGET_MS       = 250;    /* wake → screen back  */
+
+static const char CPUFREQ_GLOB[] = "/sys/devices/system/cpu/cpufreq/policy*";
+static const char GOVERNOR_PATH[] =
+    "/sys/devices/system/cpu/cpufreq/policy0/scaling_governor";
+
+/* ------------------------------------------------------------------ */
+/*  State                                                             */
+/* ------------------------------------------------------------------ */
+typedef enum { IDLE_AWAKE, IDLE_NO_INPUT, IDLE_ENGINE_OFF } IdleReason;
+
+static const char *REASON_NAMES[] = { "awake", "no input", "engine off" };
+
+/* GTK thread only */
+typedef struct {
+    IdleReason    reason;
+    gboolean      inhibited;
+    guint         timeout_min;
+    gboolean      timeout_set;
+    guint         check_tag;          /* no-input timeout, 0 while asleep */
+    ApplyChannel *power;
+
+    double        rpm, volts;         /* latest values, NAN = unknown */
+    gint64        engine_off_since_us;
+
+    gint64        phase_start_us;     /* entered the current phase */
+    gint64        phase_start_cpu_us;
+    gdouble       awake_cpu_pct;      /* last awake phase, for the report */
+} IdleState;
+
+static IdleState g_idle = { .rpm = NAN, .volts = NAN };
+
+/* Shared with the knob ISRs and the apply worker (g_input_lock) */
+static GMutex   g_input_lock;
+static gint64   g_last_input_us;
+static gboolean g_asleep;
+static gboolean g_wake_posted;
+static gint64   g_wake_input_us;      /* input that started the wake */
+
+/* Apply worker only */
+static gboolean g_dimmed;
+static int      g_saved_level;
+static gchar   *g_saved_governor;
+
+/* ------------------------------------------------------------------ */
+/*  Forward declarations                                              */
+/* ------------------------------------------------------------------ */
+static void     enter_idle    (IdleReason reason);
+static void     leave_idle    (void);
+static void     arm_check     (void);
+static gboolean check_cb      (gpointer);
+static gboolean wake_cb       (gpointer);
+static void     on_gdk_event  (GdkEvent *ev, gpointer);
+static void     on_frame      (const ObdFrame *frame, gpointer);
+static void     on_link       (gboolean up, gpointer);
+static void     apply_power   (int level, gpointer);
+static gint64   cpu_time_us   (void);
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+void idle_manager_set_timeout(guint minutes)
+{
+    g_idle.timeout_min = minutes;
+    g_idle.timeout_set = TRUE;
+}
+
+void idle_manager_init(void)
+{
+    if (g_idle.power)
+        return;
+    if (!g_idle.timeout_set)
+        g_idle.timeout_min = IDLE_DEFAULT_MINUTES;
+
+    g_idle.power              = apply_channel_new("idle-power", apply_power, NULL, 0);
+    g_idle.phase_start_us     = g_get_monotonic_time();
+    g_idle.phase_start_cpu_us = cpu_time_us();
+
+    g_mutex_lock(&g_input_lock);
+    g_last_input_us = g_idle.phase_start_us;
+    g_mutex_unlock(&g_input_lock);
+
+    gdk_event_handler_set(on_gdk_event, NULL, NULL);
+    telemetry_attach_view(TELEMETRY_VIEW_IDLE,
+                          (G_GUINT64_CONSTANT(1) << PID_RPM) |
+                          (G_GUINT64_CONSTANT(1) << PID_MODULE_VOLTAGE),
+                          on_frame, on_link, NULL);
+    arm_check();
+}
+
+gboolean idle_manager_note_input(void)
+/* ----------------------------------------------------------------------
+ *  Runs for every detent, press and touch, so it only stamps the time.
+ *  The first input while asleep posts the wake; later ones (the rest of
+ *  a fast spin) are swallowed too until the GTK thread has woken up.
+ * ---------------------------------------------------------------------- */
+{
+    gint64   now  = g_get_monotonic_time();
+    gboolean post = FALSE;
+
+    g_mutex_lock(&g_input_lock);
+    g_last_input_us = now;
+    gboolean asleep = g_asleep;
+    if (asleep && !g_wake_posted) {
+        g_wake_posted   = TRUE;
+        g_wake_input_us = now;
+        post            = TRUE;
+    }
+    g_mutex_unlock(&g_input_lock);
+
+    if (post)
+        g_source_set_name_by_id(
+            g_idle_add_full(G_PRIORITY_HIGH, wake_cb, NULL, NULL), "idle-wake");
+    return asleep;
+}
+
+void idle_manager_inhibit(gboolean inhibit)
+{
+    g_idle.inhibited           = inhibit;
+    g_idle.engine_off_since_us = 0;
+
+    if (inhibit) {
+        leave_idle();
+        if (g_idle.check_tag) {
+            g_source_remove(g_idle.check_tag);
+            g_idle.check_tag = 0;
+        }
+    } else {
+        g_mutex_lock(&g_input_lock);
+        g_last_input_us = g_get_monotonic_time();   /* full period from now */
+        g_mutex_unlock(&g_input_lock);
+        arm_check();
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  Sleep / wake                                                      */
+/* ------------------------------------------------------------------ */
+static void set_animations(gboolean on)
+{
+    GtkSettings *gs = gtk_settings_get_default();
+    if (gs)
+        g_object_set(gs, "gtk-enable-animations", on, "gtk-cursor-blink", on, NULL);
+}
+
+static void enter_idle(IdleReason reason)
+{
+    TRACE_SCOPE("idle_enter");
+
+    /* Engine switched off while already dimmed: just go dark */
+    if (g_idle.reason != IDLE_AWAKE) {
+        if (reason == IDLE_ENGINE_OFF && g_idle.reason == IDLE_NO_INPUT) {
+            g_idle.reason = IDLE_ENGINE_OFF;
+            apply_channel_submit(g_idle.power, 0);
+            g_print("[Idle] engine off, backlight off\n");
+        }
+        return;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    gint64 cpu = cpu_time_us();
+    gint64 wall_us = now - g_idle.phase_start_us;
+    g_idle.awake_cpu_pct = wall_us > 0
+        ? 100.0 * (cpu - g_idle.phase_start_cpu_us) / wall_us : 0.0;
+    g_idle.phase_start_us     = now;
+    g_idle.phase_start_cpu_us = cpu;
+    g_idle.reason             = reason;
+
+    g_mutex_lock(&g_input_lock);
+    g_asleep      = TRUE;
+    g_wake_posted = FALSE;
+    g_mutex_unlock(&g_input_lock);
+
+    if (g_idle.check_tag) {
+        g_source_remove(g_idle.check_tag);
+        g_idle.check_tag = 0;
+    }
+    apply_channel_submit(g_idle.power, reason == IDLE_ENGINE_OFF ? 0 : IDLE_DIM_LEVEL);
+    telemetry_set_heartbeat(IDLE_HEARTBEAT_MS);
+    set_animations(FALSE);
+    metrics_set(METRIC_IDLE_ASLEEP, 1);
+
+    TRACE_INSTANT("idle-enter");
+    g_print("[Idle] enter (%s) after %.0f s awake, Vroom CPU %.2f %%\n",
+            REASON_NAMES[reason], wall_us / 1e6, g_idle.awake_cpu_pct);
+}
+
+static void leave_idle(void)
+{
+    if (g_idle.reason == IDLE_AWAKE)
+        return;
+    TRACE_SCOPE("idle_leave");
+
+    gint64 now = g_get_monotonic_time();
+
+    g_mutex_lock(&g_input_lock);
+    if (!g_wake_posted)
+        g_wake_input_us = now;          /* engine start, inhibit: no input */
+    g_asleep        = FALSE;
+    g_wake_posted   = FALSE;
+    g_last_input_us = now;
+    g_mutex_unlock(&g_input_lock);
+
+    apply_channel_submit(g_idle.power, -1);         /* restore */
+    telemetry_set_heartbeat(0);
+    set_animations(TRUE);
+    metrics_set(METRIC_IDLE_ASLEEP, 0);
+
+    gint64  cpu     = cpu_time_us();
+    gint64  wall_us = now - g_idle.phase_start_us;
+    gdouble cpu_s   = (cpu - g_idle.phase_start_cpu_us) / 1e6;
+    TRACE_INSTANT("idle-leave");
+    g_print("[Idle] wake after %.0f s asleep (%s): Vroom CPU %.2f s = %.2f %%"
+            " (awake %.2f %%)\n",
+            wall_us / 1e6, REASON_NAMES[g_idle.reason], cpu_s,
+            wall_us > 0 ? 100.0 * cpu_s * 1e6 / wall_us : 0.0,
+            g_idle.awake_cpu_pct);
+
+    g_idle.reason             = IDLE_AWAKE;
+    g_idle.phase_start_us     = now;
+    g_idle.phase_start_cpu_us = cpu;
+    arm_check();
+}
+
+static gboolean wake_cb(gpointer)
+{
+    leave_idle();
+    return G_SOURCE_REMOVE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  No-input trigger                                                  */
+/* ------------------------------------------------------------------ */
+static void arm_check(void)
+/* One timeout for the rest of the period since the last input. */
+{
+    if (g_idle.check_tag || !g_idle.timeout_min || g_idle.inhibited
+            || g_idle.reason != IDLE_AWAKE)
+        return;
+
+    g_mutex_lock(&g_input_lock);
+    gint64 last = g_last_input_us;
+    g_mutex_unlock(&g_input_lock);
+
+    gint64 due_us  = last + (gint64)g_idle.timeout_min * 60 * G_USEC_PER_SEC;
+    gint64 left_us = MAX(due_us - g_get_monotonic_time(), 0);
+    g_idle.check_tag = g_timeout_add_seconds((guint)(left_us / G_USEC_PER_SEC) + 1,
+                                             check_cb, NULL);
+    g_source_set_name_by_id(g_idle.check_tag, "idle-check");
+}
+
+static gboolean check_cb(gpointer)
+{
+    g_idle.check_tag = 0;
+
+    g_mutex_lock(&g_input_lock);
+    gint64 idle_us = g_get_monotonic_time() - g_last_input_us;
+    g_mutex_unlock(&g_input_lock);
+
+    if (idle_us >= (gint64)g_idle.timeout_min * 60 * G_USEC_PER_SEC)
+        enter_idle(IDLE_NO_INPUT);
+    else
+        arm_check();                    /* input came in meanwhile */
+    return G_SOURCE_REMOVE;
+}
+
+static void on_gdk_event(GdkEvent *ev, gpointer)
+/* Every GTK event passes here first; the touch that wakes goes no further. */
+{
+    switch (ev->type) {
+    case GDK_BUTTON_PRESS:
+    case GDK_TOUCH_BEGIN:
+    case GDK_KEY_PRESS:
+    case GDK_SCROLL:
+        if (idle_manager_note_input())
+            return;
+        break;
+    default:
+        break;
+    }
+    gtk_main_do_event(ev);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Engine-off trigger                                                */
+/* ------------------------------------------------------------------ */
+static void on_frame(const ObdFrame *frame, gpointer)
+/* ----------------------------------------------------------------------
+ *  RPM and voltage may arrive in different lines (their poll rates
+ *  differ), so the latest of each is kept.  The engine must have been
+ *  off, and the screen untouched, for ENGINE_OFF_HOLD_SEC.  A running
+ *  engine ends an engine-off sleep; it does not end a no-input dim.
+ * ---------------------------------------------------------------------- */
+{
+    if (frame->present & (G_GUINT64_CONSTANT(1) << PID_RPM))
+        g_idle.rpm = frame->value[PID_RPM];
+    if (frame->present & (G_GUINT64_CONSTANT(1) << PID_MODULE_VOLTAGE))
+        g_idle.volts = frame->value[PID_MODULE_VOLTAGE];
+    if (isnan(g_idle.rpm) || isnan(g_idle.volts))
+        return;
+
+    gboolean off = g_idle.rpm < ENGINE_OFF_RPM && g_idle.volts < ENGINE_CHARGING_V;
+    if (!off) {
+        g_idle.engine_off_since_us = 0;
+        if (g_idle.reason == IDLE_ENGINE_OFF && g_idle.rpm >= ENGINE_OFF_RPM)
+            leave_idle();
+        return;
+    }
+
+    gint64 now  = g_get_monotonic_time();
+    gint64 hold = (gint64)ENGINE_OFF_HOLD_SEC * G_USEC_PER_SEC;
+    if (!g_idle.engine_off_since_us)
+        g_idle.engine_off_since_us = now;
+    if (g_idle.inhibited || g_idle.reason == IDLE_ENGINE_OFF
+            || now - g_idle.engine_off_since_us < hold)
+        return;
+
+    /* Woken by hand in a parked car: give the user the hold time again */
+    g_mutex_lock(&g_input_lock);
+    gint64 last_input = g_last_input_us;
+    g_mutex_unlock(&g_input_lock);
+    if (now - last_input >= hold)
+        enter_idle(IDLE_ENGINE_OFF);
+}
+
+static void on_link(gboolean up, gpointer)
+{
+    if (up)
+        return;
+    g_idle.rpm   = NAN;
+    g_idle.volts = NAN;
+    g_idle.engine_off_since_us = 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Apply worker                                                      */
+/* ------------------------------------------------------------------ */
+static void apply_power(int level, gpointer)
+/* ----------------------------------------------------------------------
+ *  level ≥ 0 → sleep at that backlight level, −1 → wake.  On wake the
+ *  backlight goes first: it is what the user is waiting for.
+ * ---------------------------------------------------------------------- */
+{
+    const PowerBackend *pw = hal_power();
+
+    if (level >= 0) {
+        if (!g_dimmed) {
+            g_saved_level    = read_backlight_brightness();
+            g_saved_governor = pw->get_governor();
+            if (g_saved_governor)
+                pw->set_governor(IDLE_GOVERNOR);
+            g_dimmed = TRUE;
+        }
+        set_backlight_brightness(MIN(level, g_saved_level));
+        return;
+    }
+    if (!g_dimmed)
+        return;
+
+    set_backlight_brightness(g_saved_level);
+
+    g_mutex_lock(&g_input_lock);
+    gint64 input_us = g_wake_input_us;
+    g_mutex_unlock(&g_input_lock);
+    gdouble ms = (g_get_monotonic_time() - input_us) / 1e3;
+
+    if (g_saved_governor) {
+        pw->set_governor(g_saved_governor);
+        g_clear_pointer(&g_saved_governor, g_free);
+    }
+    g_dimmed = FALSE;
+
+    TRACE_COUNTER("idle-wake-ms", (gint64)ms);
+    if (ms > WAKE_BUDGET_MS)
+        g_printerr("[Idle] screen back %.0f ms after wake-up (budget %.0f ms)\n",
+                   ms, WAKE_BUDGET_MS);
+    else
+        g_print("[Idle] screen back %.0f ms after wake-up\n", ms);
+}
+
+static gint64 cpu_time_us(void)
+/* User + system time of the Vroom process (all threads). */
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (gint64)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * G_USEC_PER_SEC
+         + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+/* ------------------------------------------------------------------ */
+/*  cpufreq sysfs backend                                             */
+/* ------------------------------------------------------------------ */
+static gchar *sysfs_get_governor(void)
+{
+    gchar *text = NULL;
+    if (!g_file_get_contents(GOVERNOR_PATH, &text, NULL, NULL))
+        return NULL;                    /* no cpufreq: leave it alone */
+    return g_strstrip(text);
+}
+
+static void sysfs_set_governor(const char *governor)
+/* ----------------------------------------------------------------------
+ *  Same sudo one-liner as the backlight, once per policy (the Pi 5 has
+ *  one for all four cores).  The name goes into a shell command, so
+ *  anything but [a-z0-9_] is refused.
+ * ---------------------------------------------------------------------- */
+{
+    for (const char *p = governor; *p; p++)
+        if (!g_ascii_isalnum(*p) && *p != '_') {
+            g_printerr("[Idle] refusing governor '%s'\n", governor);
+            return;
+        }
+
+    char cmd[256];
+    snprintf(cmd, sizeof cmd,
+             "sudo sh -c 'for p in %s; do echo %s > $p/scaling_governor; done'",
+             CPUFREQ_GLOB, governor);
+    if (system(cmd) != 0)
+        g_printerr("[Idle] could not set governor '%s'\n", governor);
+}
+
+const PowerBackend SYSFS_POWER_BACKEND = {
+    .name         = "cpufreq",
+    .get_governor = sysfs_get_governor,
+    .set_governor = sysfs_set_governor,
+};
@@ -0,0 +1,44 @@
+/* =========================================================================
+ *  IdleManager.h — low-power mode while the car is parked
+ * -------------------------------------------------------------------------
+ *  Two triggers put Vroom to sleep:
+ *      engine off   RPM at 0 and CONTROL MODULE VOLTAGE below the
+ *                   charging level for a minute, with no input in that
+ *                   minute either                        → backlight off
+ *      no input     no knob or touch for N minutes       → backlight dim
+ *  Asleep, the CPU governor drops to "powersave", vehicle polling falls
+ *  to a heartbeat (Telemetry.h) and GTK animations are switched off.
+ *  A knob detent, a press or a touch wakes everything again; that input
+ *  is swallowed so the first touch never presses a button the user
+ *  could not see.  The engine starting also wakes an engine-off sleep.
+ *
+ *  idle_manager_set_timeout(minutes)
+ *      No-input delay; 0 leaves only the engine-off trigger.  Call
+ *      before idle_manager_init().  Default 10.
+ *
+ *  idle_manager_init()
+ *      After telemetry_init(), on the GTK thread.  Routes GDK events
+ *      through the manager and attaches the engine-off detector.
+ *
+ *  idle_manager_note_input()
+ *      Any thread (the knob ISRs call it).  Returns TRUE while asleep:
+ *      the caller must then drop the input — it has woken the screen.
+ *
+ *  idle_manager_inhibit(on)
+ *      GTK thread.  Android Auto takes the touches, so neither trigger
+ *      fires while autoapp is on screen.
+ *
+ *  Entering and leaving sleep log Vroom's CPU time for both phases and
+ *  how long the screen took to come back.
+ * ========================================================================= */
+#ifndef IDLEMANAGER_H
+#define IDLEMANAGER_H
+
+#include <glib.h>
+
+void     idle_manager_set_timeout(guint minutes);
+void     idle_manager_init       (void);
+gboolean idle_manager_note_input (void);
+void     idle_manager_inhibit    (gboolean inhibit);
+
+#endif /* IDLEMANAGER_H */
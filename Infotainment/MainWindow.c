@@ -5,13 +5,19 @@
  *        1) Android Auto   → spawns external autoapp process
  *        2) Vehicle Info   → opens live OBD-II dashboard window
  *        3) Settings       → opens modal Settings window
+ *  • Both secondary windows are built here once and only shown / hidden
+ *    afterwards, so a tap paints the next screen without construction.
  *  • Assets live in Infotainment/images/
  *  • Esc or window close quits; cursor hidden on realise.
  * ========================================================================= */
 #include "MainWindow.h"
 #include "SettingsWindow.h"       /* open_settings_window()            */
-#include "VehicleInfoWindow.h"    /* create_vehicle_info_window()      */
+#include "VehicleInfoWindow.h"    /* open_vehicle_info_window()        */
+#include "Overlay.h"              /* overlay_show() / overlay_hide()   */
+#include "IdleManager.h"          /* no sleep while autoapp is up      */
 #include "Popup.h"                /* transient on-screen messages      */
+#include "Trace.h"                /* TRACE_SCOPE / TRACE_INSTANT       */
+#include "EventLog.h"             /* EVLOG                             */
 
 #include <glib.h>
 #include <gdk/gdkkeysyms.h>
@@ -47,6 +53,7 @@ static void on_settings_button_clicked     (GtkWidget *, gpointer);
 /* ------------------------------------------------------------------ */
 GtkWidget *create_main_window(void)
 {
+    TRACE_SCOPE("create_main_window");
     GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window), "Vroom Infotainment");
     gtk_window_fullscreen(GTK_WINDOW(window));
@@ -79,6 +86,13 @@ GtkWidget *create_main_window(void)
     gtk_box_pack_start(GTK_BOX(main_box), vehicle_box, TRUE, TRUE, 20);
     gtk_box_pack_start(GTK_BOX(main_box), settings_box, TRUE, TRUE, 20);
 
+    /* Pre-build the pooled secondary screens (hidden until opened) */
+    {
+        TRACE_SCOPE("prebuild_secondary_windows");
+        vehicle_info_window_init(GTK_WINDOW(window));
+        settings_window_init(GTK_WINDOW(window));
+    }
+
     return window;                 /* main.c will gtk_widget_show_all() */
 }
 
@@ -175,13 +189,17 @@ static GtkWidget *create_button_with_label_and_image(const gchar *img,
 static void on_autoapp_child_exit(GPid pid, gint status, gpointer user_data)
 {
     GtkWindow *main = GTK_WINDOW(user_data);
+    TRACE_INSTANT("autoapp-exit");
     g_spawn_close_pid(pid);
-    g_print("autoapp exited status=%d\n", status);
+    EVLOG(AUTOAPP_EXIT, status);
+    overlay_hide();
+    idle_manager_inhibit(FALSE);
     gtk_widget_show(GTK_WIDGET(main));
 }
 
 static void on_AndroidAuto_button_clicked(GtkWidget *w, gpointer)
 {
+    TRACE_SCOPE("on_AndroidAuto_button_clicked");
     GtkWindow *main = GTK_WINDOW(gtk_widget_get_toplevel(w));
     gtk_widget_hide(GTK_WIDGET(main));
 
@@ -197,6 +215,8 @@ static void on_AndroidAuto_button_clicked(GtkWidget *w, gpointer)
         return;
     }
     g_child_watch_add(pid, (GChildWatchFunc)on_autoapp_child_exit, main);
+    overlay_show();                /* speed / RPM strip over Android Auto */
+    idle_manager_inhibit(TRUE);    /* its touches never reach GTK        */
 }
 
 /* ------------------------------------------------------------------ */
@@ -204,13 +224,14 @@ static void on_AndroidAuto_button_clicked(GtkWidget *w, gpointer)
 /* ------------------------------------------------------------------ */
 static void on_vehicle_info_button_clicked(GtkWidget *w, gpointer)
 {
+    TRACE_SCOPE("on_vehicle_info_button_clicked");
     GtkWindow *parent = GTK_WINDOW(gtk_widget_get_toplevel(w));
-    GtkWidget *vw = create_vehicle_info_window(parent);
-    gtk_widget_show_all(vw);
+    open_vehicle_info_window(parent);
 }
 
 static void on_settings_button_clicked(GtkWidget *w, gpointer)
 {
+    TRACE_SCOPE("on_settings_button_clicked");
     GtkWindow *top = GTK_WINDOW(gtk_widget_get_toplevel(w));
     open_settings_window(top);
 }
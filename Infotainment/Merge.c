@@ -0,0 +1,369 @@
+/* =========================================================================
+ *  Merge.c — k-way merge of the vehicle sources, per-PID source choice
+ * -------------------------------------------------------------------------
+ *  • One ring of MERGE_QUEUE_LEN frames per source.  Pushes only append
+ *    (stamps are made monotonic per source), so each ring is sorted and
+ *    the merge only compares ring heads.
+ *  • The oldest head is released when every live source has a frame
+ *    queued — nothing older can still arrive from them — or it has
+ *    waited the reorder window.  A g_timeout wakes the merge for the
+ *    second case; a full ring forces releases.
+ *  • On release each PID is checked against its ranking: a sample is
+ *    dropped while a better-ranked source delivered that PID within the
+ *    quiet time.  Derived PIDs are computed from what survived.
+ * ========================================================================= */
+#include "Merge.h"
+#include "Metrics.h"
+#include "EventLog.h"
+
+#include <string.h>
+
+#define DERIVED_SOURCE  MERGE_MAX_SOURCES        /* rank / history index */
+#define NO_SOURCE       0xFF
+
+/* ------------------------------------------------------------------ */
+/*  Derived PIDs                                                      */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    PidId   out, in;
+    gdouble scale;
+} DerivedRule;
+
+static const DerivedRule DERIVED[] = {
+    /* Petrol at stoichiometric 14.7:1, 745 g/L: L/h = g/s × 3600 / (14.7 × 745) */
+    { PID_FUEL_RATE, PID_MAF, 3600.0 / (14.7 * 745.0) },
+};
+
+/* ------------------------------------------------------------------ */
+/*  State (GTK thread only)                                           */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    ObdFrame  frame[MERGE_QUEUE_LEN];
+    gint64    arrived_us[MERGE_QUEUE_LEN];
+    guint     head, len;
+    gboolean  link_up;
+    gint64    last_t;               /* newest stamp pushed               */
+} SourceQueue;
+
+typedef struct {
+    guint          n_sources;
+    const char    *names[MERGE_MAX_SOURCES + 1];
+    MergeEmitFunc  emit;
+    gpointer       user_data;
+    guint          window_ms;
+    guint          min_period_ms;
+
+    /* rank[p][s]: lower is better.  Source order unless a spec says */
+    guint8         rank[PID_COUNT][MERGE_MAX_SOURCES + 1];
+    gint64         last_seen[PID_COUNT][MERGE_MAX_SOURCES + 1];
+    guint8         active[PID_COUNT];       /* source feeding p, NO_SOURCE */
+
+    SourceQueue    q[MERGE_MAX_SOURCES];
+    gint64         released_t;              /* newest stamp released     */
+    guint          timer;
+    gint64         timer_due;
+} MergeState;
+
+static MergeState g_merge = {
+    .n_sources = 1,
+    .names     = { "vehicle", [DERIVED_SOURCE] = "derived" },
+    .window_ms = MERGE_WINDOW_MS,
+};
+static gboolean g_ready;                    /* tables below filled in    */
+
+static void init_tables(void)
+/* Ranks in source order, derived last; no source active yet */
+{
+    for (guint p = 0; p < PID_COUNT; p++) {
+        for (guint s = 0; s < g_merge.n_sources; s++)
+            g_merge.rank[p][s] = (guint8)s;
+        g_merge.rank[p][DERIVED_SOURCE] = (guint8)g_merge.n_sources;
+    }
+    memset(g_merge.active, NO_SOURCE, sizeof g_merge.active);
+    g_ready = TRUE;
+}
+
+static guint source_lookup(const char *name)
+/* → source index, DERIVED_SOURCE, or NO_SOURCE */
+{
+    if (g_ascii_strcasecmp(name, "derived") == 0)
+        return DERIVED_SOURCE;
+    for (guint s = 0; s < g_merge.n_sources; s++)
+        if (g_ascii_strcasecmp(name, g_merge.names[s]) == 0)
+            return s;
+    return NO_SOURCE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Source choice                                                     */
+/* ------------------------------------------------------------------ */
+static gint64 quiet_us(guint p)
+/* How long a source may go without delivering p before others take over */
+{
+    gdouble ms = MERGE_FAILOVER_MS;
+    if (PID_TABLE[p].rate_hz > 0)
+        ms = MAX(ms, 3000.0 / PID_TABLE[p].rate_hz);
+    ms = MAX(ms, 3.0 * g_merge.min_period_ms);
+    return (gint64)(ms * 1000);
+}
+
+static gboolean accept(guint p, guint s, gint64 t)
+/* TRUE unless a better-ranked source delivered p recently */
+{
+    gint64 quiet = quiet_us(p);
+    for (guint o = 0; o <= DERIVED_SOURCE; o++) {
+        if (o == s || (o >= g_merge.n_sources && o != DERIVED_SOURCE))
+            continue;
+        if (g_merge.rank[p][o] < g_merge.rank[p][s]
+            && g_merge.last_seen[p][o] && t - g_merge.last_seen[p][o] <= quiet)
+            return FALSE;
+    }
+
+    if (g_merge.active[p] != s) {
+        if (g_merge.active[p] != NO_SOURCE) {
+            EVLOG(MERGE_FAILOVER, PID_TABLE[p].name,
+                  g_merge.names[g_merge.active[p]], g_merge.names[s]);
+            metrics_inc(METRIC_MERGE_FAILOVERS);
+        }
+        g_merge.active[p] = (guint8)s;
+    }
+    return TRUE;
+}
+
+static void release(guint s, const ObdFrame *in, gint64 arrived_us)
+{
+    ObdFrame out = { .t_us = in->t_us };
+    for (guint64 bits = in->present; bits; bits &= bits - 1) {
+        guint p = (guint)__builtin_ctzll(bits);
+        g_merge.last_seen[p][s] = in->t_us;
+        if (accept(p, s, in->t_us)) {
+            out.value[p]  = in->value[p];
+            out.present  |= G_GUINT64_CONSTANT(1) << p;
+        }
+    }
+
+    for (guint i = 0; i < G_N_ELEMENTS(DERIVED); i++) {
+        const DerivedRule *r = &DERIVED[i];
+        if (!(out.present >> r->in & 1) || out.present >> r->out & 1)
+            continue;
+        g_merge.last_seen[r->out][DERIVED_SOURCE] = in->t_us;
+        if (accept(r->out, DERIVED_SOURCE, in->t_us)) {
+            out.value[r->out]  = out.value[r->in] * r->scale;
+            out.present       |= G_GUINT64_CONSTANT(1) << r->out;
+        }
+    }
+
+    g_merge.released_t = in->t_us;
+    metrics_observe_since(METRIC_MERGE_HOLD, arrived_us);
+    if (out.present && g_merge.emit)
+        g_merge.emit(&out, g_merge.user_data);
+}
+
+/* ------------------------------------------------------------------ */
+/*  K-way merge                                                       */
+/* ------------------------------------------------------------------ */
+static guint oldest_head(void)
+/* Source whose queued head has the smallest stamp; NO_SOURCE if all empty */
+{
+    guint  best   = NO_SOURCE;
+    gint64 best_t = G_MAXINT64;
+    for (guint s = 0; s < g_merge.n_sources; s++) {
+        SourceQueue *q = &g_merge.q[s];
+        if (q->len && q->frame[q->head].t_us < best_t) {
+            best   = s;
+            best_t = q->frame[q->head].t_us;
+        }
+    }
+    return best;
+}
+
+static void release_head(guint s)
+{
+    SourceQueue *q = &g_merge.q[s];
+    guint i = q->head;
+    q->head = (q->head + 1) % MERGE_QUEUE_LEN;
+    q->len--;
+    release(s, &q->frame[i], q->arrived_us[i]);
+}
+
+static gboolean all_live_queued(void)
+{
+    for (guint s = 0; s < g_merge.n_sources; s++)
+        if (g_merge.q[s].link_up && !g_merge.q[s].len)
+            return FALSE;
+    return TRUE;
+}
+
+static gboolean on_window_timer(gpointer);
+
+static void drain(void)
+{
+    gint64 now    = g_get_monotonic_time();
+    gint64 window = (gint64)g_merge.window_ms * 1000;
+    guint  s;
+    while ((s = oldest_head()) != NO_SOURCE) {
+        SourceQueue *q = &g_merge.q[s];
+        if (!all_live_queued() && q->frame[q->head].t_us > now - window)
+            break;
+        release_head(s);
+    }
+    if (s == NO_SOURCE)
+        return;
+
+    /* Wake when the head left waiting reaches the window */
+    gint64 due = g_merge.q[s].frame[g_merge.q[s].head].t_us + window;
+    if (g_merge.timer && g_merge.timer_due <= due)
+        return;
+    if (g_merge.timer)
+        g_source_remove(g_merge.timer);
+    g_merge.timer     = g_timeout_add((guint)MAX((due - now + 999) / 1000, 1),
+                                      on_window_timer, NULL);
+    g_merge.timer_due = due;
+}
+
+static gboolean on_window_timer(gpointer)
+{
+    g_merge.timer = 0;
+    drain();
+    return G_SOURCE_REMOVE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+void merge_configure(guint n_sources, const char *const *names)
+{
+    merge_reset();
+    g_merge.n_sources = CLAMP(n_sources, 1, MERGE_MAX_SOURCES);
+    for (guint s = 0; s < g_merge.n_sources; s++)
+        g_merge.names[s] = names[s];
+    g_merge.names[DERIVED_SOURCE] = "derived";
+    init_tables();
+}
+
+void merge_set_output(MergeEmitFunc emit, gpointer user_data)
+{
+    g_merge.emit      = emit;
+    g_merge.user_data = user_data;
+}
+
+gboolean merge_set_priority(const char *spec)
+/* "PID=src,src;PID=src" — validated in full before anything changes */
+{
+    if (!g_ready)
+        init_tables();
+
+    guint8   rank[PID_COUNT][MERGE_MAX_SOURCES + 1];
+    gboolean ok = TRUE;
+    memcpy(rank, g_merge.rank, sizeof rank);
+
+    gchar **rules = g_strsplit(spec, ";", -1);
+    for (guint r = 0; ok && rules[r]; r++) {
+        gchar *rule = g_strstrip(rules[r]);
+        if (!*rule)
+            continue;
+        gchar *eq = strchr(rule, '=');
+        if (eq)
+            *eq = '\0';
+        gint p = pid_lookup(g_strstrip(rule));
+        if (!eq || p < 0) {
+            g_printerr("[Merge] bad priority rule '%s'\n", rule);
+            ok = FALSE;
+            break;
+        }
+
+        /* Listed sources first, in order; the rest keep their order */
+        guint8 next = 0;
+        gboolean listed[MERGE_MAX_SOURCES + 1] = { FALSE };
+        gchar **names = g_strsplit(eq + 1, ",", -1);
+        for (guint i = 0; names[i]; i++) {
+            guint s = source_lookup(g_strstrip(names[i]));
+            if (s == NO_SOURCE) {
+                g_printerr("[Merge] %s: unknown source '%s'\n",
+                           PID_TABLE[p].name, names[i]);
+                ok = FALSE;
+                break;
+            }
+            if (!listed[s])
+                rank[p][s] = next++;
+            listed[s] = TRUE;
+        }
+        g_strfreev(names);
+        for (guint s = 0; ok && s <= DERIVED_SOURCE; s++)
+            if (!listed[s] && (s < g_merge.n_sources || s == DERIVED_SOURCE))
+                rank[p][s] = next++;
+    }
+    g_strfreev(rules);
+
+    if (ok)
+        memcpy(g_merge.rank, rank, sizeof rank);
+    return ok;
+}
+
+void merge_set_window(guint ms)
+{
+    g_merge.window_ms = ms;
+}
+
+void merge_set_min_period(guint ms)
+{
+    g_merge.min_period_ms = ms;
+}
+
+void merge_push(guint source, const ObdFrame *frame)
+{
+    if (source >= g_merge.n_sources)
+        return;
+    if (!g_ready)
+        init_tables();
+
+    SourceQueue *q   = &g_merge.q[source];
+    gint64       now = g_get_monotonic_time();
+
+    while (q->len == MERGE_QUEUE_LEN)       /* window longer than the ring */
+        release_head(oldest_head());
+
+    gint64 t = frame->t_us ? frame->t_us : now;
+    t = MAX(t, q->last_t);
+    q->last_t = t;
+    if (t < g_merge.released_t) {
+        metrics_inc(METRIC_MERGE_LATE);
+        t = g_merge.released_t;
+        if (!q->len) {
+            /* Nothing of this source can be queued ahead of it (that would
+             * be older still), so it goes out now, in order. */
+            ObdFrame late = *frame;
+            late.t_us = t;
+            release(source, &late, now);
+            return;
+        }
+    }
+
+    guint i = (q->head + q->len++) % MERGE_QUEUE_LEN;
+    q->frame[i]      = *frame;
+    q->frame[i].t_us = t;
+    q->arrived_us[i] = now;
+    drain();
+}
+
+void merge_set_link(guint source, gboolean up)
+{
+    if (source >= g_merge.n_sources)
+        return;
+    g_merge.q[source].link_up = up;
+    if (!up)
+        for (guint p = 0; p < PID_COUNT; p++)
+            g_merge.last_seen[p][source] = 0;
+    drain();                                /* may no longer be waited on */
+}
+
+void merge_reset(void)
+{
+    if (g_merge.timer)
+        g_source_remove(g_merge.timer);
+    g_merge.timer      = 0;
+    g_merge.released_t = 0;
+    memset(g_merge.q, 0, sizeof g_merge.q);
+    memset(g_merge.last_seen, 0, sizeof g_merge.last_seen);
+    memset(g_merge.active, NO_SOURCE, sizeof g_merge.active);
+}
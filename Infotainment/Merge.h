@@ -0,0 +1,81 @@
+/* =========================================================================
+ *  Merge.h — several vehicle-data sources merged into one ordered stream
+ * -------------------------------------------------------------------------
+ *  With --sources=obd,can the ELM327 and the passive CAN decoder run side
+ *  by side (Hal.h, hal_add_vehicle()).  Each decoded frame is tagged with
+ *  its source index and a CLOCK_MONOTONIC stamp (ObdFrame.t_us) and
+ *  pushed here; Telemetry gets back one stream in which
+ *
+ *    • stamps never go backwards — a k-way merge of the per-source
+ *      queues, releasing the oldest head once every live source has
+ *      something queued or that head is older than the reorder window;
+ *    • each PID comes from one source at a time — the best-ranked source
+ *      that delivered it recently.  When it goes quiet the next one is
+ *      used (failover) until it delivers again;
+ *    • PIDs no source delivers may be derived from ones that are
+ *      (FUEL RATE from MAF).  "derived" ranks last unless a priority
+ *      spec says otherwise.
+ *
+ *  merge_configure(n_sources, names)
+ *      Source 0 … n−1 (hal_vehicle_at()) and the names priority specs and
+ *      logs use ("obd", "can", "sim").  Names must be static strings:
+ *      the event log keeps only the pointer.  Resets everything.
+ *      Without it there is one source, "vehicle".
+ *
+ *  merge_set_output(emit, user_data)
+ *      Where merged frames go (Telemetry).
+ *
+ *  merge_set_priority(spec)
+ *      "RPM=can,obd;FUEL RATE=obd,derived" — per-PID ranking, best first.
+ *      Sources left out rank after the listed ones, in source order.
+ *      FALSE (and logs) on an unknown PID or source; nothing changes.
+ *
+ *  merge_set_window(ms)
+ *      Longest a frame is held waiting for a slower source (default
+ *      MERGE_WINDOW_MS).  A frame stamped before one already released —
+ *      its source lagged by more than the window — is late: released at
+ *      once, re-stamped to keep the order, and counted.
+ *
+ *  merge_set_min_period(ms)
+ *      The Telemetry heartbeat; failover then waits at least three of
+ *      them before declaring a source quiet.
+ *
+ *  merge_push(source, frame)
+ *      A decoded frame.  t_us = 0 stamps it on receipt.  May call the
+ *      emit function before returning.
+ *
+ *  merge_set_link(source, up)
+ *      A source whose link is down holds nothing back, and its PIDs fail
+ *      over at once instead of after the quiet time.
+ *
+ *  merge_reset()
+ *      Drops queued frames and source history (the session stopped).
+ *
+ *  With a single source frames pass straight through: it is the only
+ *  live source, so its head is always releasable.
+ *
+ *  GTK thread only.
+ * ========================================================================= */
+#ifndef MERGE_H
+#define MERGE_H
+
+#include <glib.h>
+#include "ObdFrame.h"
+
+#define MERGE_MAX_SOURCES   4
+#define MERGE_QUEUE_LEN     32        /* frames held per source         */
+#define MERGE_WINDOW_MS     200
+#define MERGE_FAILOVER_MS   1000      /* quiet time before failing over */
+
+typedef void (*MergeEmitFunc)(const ObdFrame *frame, gpointer user_data);
+
+void     merge_configure     (guint n_sources, const char *const *names);
+void     merge_set_output    (MergeEmitFunc emit, gpointer user_data);
+gboolean merge_set_priority  (const char *spec);
+void     merge_set_window    (guint ms);
+void     merge_set_min_period(guint ms);
+void     merge_push          (guint source, const ObdFrame *frame);
+void     merge_set_link      (guint source, gboolean up);
+void     merge_reset         (void);
+
+#endif /* MERGE_H */
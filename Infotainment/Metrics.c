@@ -0,0 +1,251 @@
+/* =========================================================================
+ *  Metrics.c — atomic metric table + Prometheus text endpoint
+ * -------------------------------------------------------------------------
+ *  Storage
+ *  -------
+ *      One MetricSlot per Metrics.def row, all static.  Counters and
+ *      gauges use `value`; histograms add their observation to `value`
+ *      (sum, µs) and to one bucket.  Every update is a relaxed
+ *      atomic add or store: a scrape may see a histogram whose sum and
+ *      buckets are one observation apart, which Prometheus tolerates.
+ *
+ *  Endpoint
+ *  --------
+ *      A GThreadedSocketService: each connection gets a pool thread that
+ *      reads the request, renders the table and writes an HTTP/1.0
+ *      response.  Nothing runs between scrapes, and the GTK loop is
+ *      never involved.  Any path is answered — curl http://x/metrics and
+ *      a bare GET / both work.
+ * ========================================================================= */
+#include "Metrics.h"
+
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib/gstdio.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------- */
+/*  Settings                                                              */
+/* ---------------------------------------------------------------------- */
+/* Upper bounds (µs, inclusive) of the histogram buckets; +Inf implied.
+ * Spans a fast GTK dispatch (50 µs) to a hung pactl (2.5 s).            */
+static const gint64 METRIC_BUCKETS_US[] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000,
+};
+#define N_BUCKETS  G_N_ELEMENTS(METRIC_BUCKETS_US)
+
+enum {
+    SCRAPE_THREADS   = 2,
+    SCRAPE_TIMEOUT_S = 2,
+    REQUEST_MAX      = 4096,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Table                                                                 */
+/* ---------------------------------------------------------------------- */
+typedef enum { COUNTER, GAUGE, HISTOGRAM } MetricKind;
+
+typedef struct {
+    MetricKind  kind;
+    const char *name;
+    const char *help;
+} MetricInfo;
+
+static const MetricInfo METRIC_INFO[METRIC_COUNT] = {
+#define METRIC_DEF(id, kind, name, help) [METRIC_##id] = { kind, name, help },
+#include "Metrics.def"
+#undef METRIC_DEF
+};
+
+typedef struct {
+    atomic_llong value;                    /* counter / gauge / sum µs   */
+    atomic_llong bucket[N_BUCKETS + 1];    /* per bucket, last is +Inf   */
+} MetricSlot;
+
+static MetricSlot          g_slots[METRIC_COUNT];
+static GSocketService     *g_service  = NULL;
+
+/* Forward declarations */
+static gboolean on_scrape(GThreadedSocketService *, GSocketConnection *conn,
+                          GObject *, gpointer);
+static gboolean add_address(GSocketService *svc, const char *address,
+                            GError **err);
+
+/* ---------------------------------------------------------------------- */
+/*  Updates (any thread)                                                  */
+/* ---------------------------------------------------------------------- */
+void metrics_inc(MetricId id)
+{
+    atomic_fetch_add_explicit(&g_slots[id].value, 1, memory_order_relaxed);
+}
+
+void metrics_add(MetricId id, gint64 n)
+{
+    atomic_fetch_add_explicit(&g_slots[id].value, n, memory_order_relaxed);
+}
+
+void metrics_set(MetricId id, gint64 value)
+{
+    atomic_store_explicit(&g_slots[id].value, value, memory_order_relaxed);
+}
+
+void metrics_observe_us(MetricId id, gint64 us)
+{
+    if (us < 0) us = 0;
+
+    guint b = 0;
+    while (b < N_BUCKETS && us > METRIC_BUCKETS_US[b])
+        b++;
+
+    MetricSlot *s = &g_slots[id];
+    atomic_fetch_add_explicit(&s->bucket[b], 1,  memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->value,     us, memory_order_relaxed);
+}
+
+void metrics_observe_since(MetricId id, gint64 t0_us)
+{
+    metrics_observe_us(id, g_get_monotonic_time() - t0_us);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Rendering                                                             */
+/* ---------------------------------------------------------------------- */
+static const char *const KIND_NAME[] = { "counter", "gauge", "histogram" };
+
+gchar *metrics_render(void)
+{
+    GString *out = g_string_sized_new(4096);
+
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricInfo *m = &METRIC_INFO[i];
+        MetricSlot       *s = &g_slots[i];
+
+        g_string_append_printf(out, "# HELP %s %s\n# TYPE %s %s\n",
+                               m->name, m->help, m->name, KIND_NAME[m->kind]);
+
+        long long v = atomic_load_explicit(&s->value, memory_order_relaxed);
+        if (m->kind != HISTOGRAM) {
+            g_string_append_printf(out, "%s %lld\n", m->name, v);
+            continue;
+        }
+
+        /* Prometheus buckets are cumulative and in seconds.  Numbers go
+         * through g_ascii_formatd: gtk_init() has set LC_NUMERIC, and a
+         * comma decimal point makes the scrape unparseable. */
+        char      num[G_ASCII_DTOSTR_BUF_SIZE];
+        long long cum = 0;
+        for (guint b = 0; b < N_BUCKETS; b++) {
+            cum += atomic_load_explicit(&s->bucket[b], memory_order_relaxed);
+            g_ascii_formatd(num, sizeof num, "%g", METRIC_BUCKETS_US[b] / 1e6);
+            g_string_append_printf(out, "%s_bucket{le=\"%s\"} %lld\n",
+                                   m->name, num, cum);
+        }
+        cum += atomic_load_explicit(&s->bucket[N_BUCKETS], memory_order_relaxed);
+        g_ascii_formatd(num, sizeof num, "%.6f", v / 1e6);
+        g_string_append_printf(out, "%s_bucket{le=\"+Inf\"} %lld\n"
+                                    "%s_sum %s\n%s_count %lld\n",
+                               m->name, cum, m->name, num, m->name, cum);
+    }
+    return g_string_free(out, FALSE);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Endpoint                                                              */
+/* ---------------------------------------------------------------------- */
+gboolean metrics_serve(const char *address)
+{
+    if (g_service || !address || !*address)
+        return FALSE;
+
+    GError         *err = NULL;
+    GSocketService *svc = g_threaded_socket_service_new(SCRAPE_THREADS);
+
+    if (!add_address(svc, address, &err)) {
+        g_printerr("[Metrics] cannot listen on %s: %s\n", address,
+                   err ? err->message : "bad address");
+        g_clear_error(&err);
+        g_object_unref(svc);
+        return FALSE;
+    }
+
+    g_signal_connect(svc, "run", G_CALLBACK(on_scrape), NULL);
+    g_socket_service_start(svc);
+    g_service = svc;
+
+    g_print("[Metrics] serving %d metrics on %s\n", METRIC_COUNT, address);
+    return TRUE;
+}
+
+/* "unix:/path", "PORT" or "127.0.0.1:PORT".  TCP only ever binds the
+ * loopback address — the numbers are not meant to leave the car.       */
+static gboolean add_address(GSocketService *svc, const char *address,
+                            GError **err)
+{
+    GSocketListener *ls = G_SOCKET_LISTENER(svc);
+
+    if (g_str_has_prefix(address, "unix:")) {
+        const char *path = address + 5;
+        if (!*path)
+            return FALSE;
+        g_unlink(path);                    /* stale socket from a crash  */
+
+        GSocketAddress *sa = g_unix_socket_address_new(path);
+        gboolean ok = g_socket_listener_add_address(ls, sa, G_SOCKET_TYPE_STREAM,
+                                                    G_SOCKET_PROTOCOL_DEFAULT,
+                                                    NULL, NULL, err);
+        g_object_unref(sa);
+        return ok;
+    }
+
+    const char *port_str = address;
+    if (g_str_has_prefix(address, "127.0.0.1:"))
+        port_str = address + 10;
+    else if (g_str_has_prefix(address, "localhost:"))
+        port_str = address + 10;
+
+    char   *end  = NULL;
+    gulong  port = strtoul(port_str, &end, 10);
+    if (end == port_str || *end || port == 0 || port > 65535)
+        return FALSE;
+
+    GInetAddress   *lo = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+    GSocketAddress *sa = g_inet_socket_address_new(lo, (guint16)port);
+    gboolean ok = g_socket_listener_add_address(ls, sa, G_SOCKET_TYPE_STREAM,
+                                                G_SOCKET_PROTOCOL_TCP,
+                                                NULL, NULL, err);
+    g_object_unref(sa);
+    g_object_unref(lo);
+    return ok;
+}
+
+/* Runs on a service pool thread, once per connection */
+static gboolean on_scrape(GThreadedSocketService *, GSocketConnection *conn,
+                          GObject *, gpointer)
+{
+    GSocket *sock = g_socket_connection_get_socket(conn);
+    g_socket_set_timeout(sock, SCRAPE_TIMEOUT_S);
+
+    /* The request itself is irrelevant; read what arrived so closing the
+     * socket doesn't reset the connection under the client.              */
+    char buf[REQUEST_MAX];
+    g_input_stream_read(g_io_stream_get_input_stream(G_IO_STREAM(conn)),
+                        buf, sizeof buf, NULL, NULL);
+
+    gchar *body = metrics_render();
+    gsize  len  = strlen(body);
+    gchar *head = g_strdup_printf("HTTP/1.0 200 OK\r\n"
+                                  "Content-Type: text/plain; version=0.0.4\r\n"
+                                  "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                  "Connection: close\r\n\r\n", len);
+
+    GOutputStream *os = g_io_stream_get_output_stream(G_IO_STREAM(conn));
+    if (g_output_stream_write_all(os, head, strlen(head), NULL, NULL, NULL))
+        g_output_stream_write_all(os, body, len, NULL, NULL, NULL);
+
+    g_free(head);
+    g_free(body);
+    return TRUE;
+}
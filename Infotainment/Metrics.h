@@ -0,0 +1,47 @@
+/* =========================================================================
+ *  Metrics.h — lock-free runtime counters, gauges and histograms
+ * -------------------------------------------------------------------------
+ *  MetricId
+ *      METRIC_ENCODER_DETENTS, … in Metrics.def order, then METRIC_COUNT.
+ *
+ *  metrics_inc(id) / metrics_add(id, n)     counters
+ *  metrics_set(id, v)                       gauges
+ *  metrics_observe_us(id, us)               histograms
+ *  metrics_observe_since(id, t0_us)         histogram of now − t0
+ *      Any thread, including the knob ISRs.  Each is one or two relaxed
+ *      atomic adds on a fixed table — no locks, no allocation — so they
+ *      stay in the hot paths whether or not anything is scraping.
+ *
+ *  metrics_serve(address)
+ *      Starts the endpoint: "9105" or "127.0.0.1:9105" for HTTP on
+ *      localhost, "unix:/run/user/1000/vroom-metrics.sock" for a Unix
+ *      socket.  Either way a plain HTTP GET returns the Prometheus text
+ *      format; it is rendered on a service thread per scrape, so the GTK
+ *      loop never sees it.  Returns FALSE (and logs) if the address
+ *      cannot be bound.  Without a call nothing listens.
+ *
+ *  metrics_render()
+ *      The Prometheus text itself, for tests and dumps (g_free()).
+ * ========================================================================= */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <glib.h>
+
+typedef enum {
+#define METRIC_DEF(id, kind, name, help) METRIC_##id,
+#include "Metrics.def"
+#undef METRIC_DEF
+    METRIC_COUNT
+} MetricId;
+
+void     metrics_inc          (MetricId id);
+void     metrics_add          (MetricId id, gint64 n);
+void     metrics_set          (MetricId id, gint64 value);
+void     metrics_observe_us   (MetricId id, gint64 us);
+void     metrics_observe_since(MetricId id, gint64 t0_us);
+
+gboolean metrics_serve (const char *address);
+gchar   *metrics_render(void);
+
+#endif /* METRICS_H */
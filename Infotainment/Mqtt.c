@@ -0,0 +1,357 @@
+/* =========================================================================
+ *  Mqtt.c — minimal blocking MQTT 3.1.1 client
+ * -------------------------------------------------------------------------
+ *  • Plain TCP with TCP_NODELAY: a batch is one small PUBLISH, and Nagle
+ *    would hold it back for the PUBACK of the previous one.
+ *  • Every read and write is bounded by MQTT_TIMEOUT_MS (poll() before
+ *    each chunk), so a broker that stops answering costs the calling
+ *    thread at most that long before the call fails.
+ *  • Packets are built in one reused GByteArray and sent with a single
+ *    send(); incoming packets above PACKET_MAX are treated as an error.
+ *  • Only one packet is ever in flight: mqtt_publish() waits for its
+ *    PUBACK before returning.  Against a local broker that is a few
+ *    tens of µs, and the publisher batches many samples per message.
+ * ========================================================================= */
+#include "Mqtt.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+enum {
+    PACKET_MAX = 1 << 20,               /* largest packet we accept      */
+
+    /* Control packet types (high nibble of the first byte) */
+    CONNECT     = 1,  CONNACK  = 2,  PUBLISH  = 3,  PUBACK   = 4,
+    SUBSCRIBE   = 8,  SUBACK   = 9,  PINGREQ  = 12, PINGRESP = 13,
+    DISCONNECT  = 14,
+};
+
+struct MqttClient {
+    int          fd;
+    guint16      next_id;               /* packet identifier, never 0 */
+    GByteArray  *out;                   /* reused outgoing packet */
+    guint8      *in;                    /* last incoming body */
+    gsize        in_cap;
+};
+
+/* ------------------------------------------------------------------ */
+/*  Forward declarations                                              */
+/* ------------------------------------------------------------------ */
+static int      open_socket (const char *address);
+static void     begin_packet(MqttClient *c, guint8 first);
+static void     put_u16     (MqttClient *c, guint16 v);
+static void     put_string  (MqttClient *c, const char *s);
+static gboolean send_packet (MqttClient *c);
+static gint     read_packet (MqttClient *c, guint8 *first, gsize *len,
+                             guint timeout_ms);
+static gboolean wait_for    (MqttClient *c, guint type, gint id);
+static guint16  take_id     (MqttClient *c);
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+MqttClient *mqtt_connect(const char *address, const char *client_id,
+                         guint keepalive_s)
+{
+    int fd = open_socket(address);
+    if (fd < 0)
+        return NULL;
+
+    MqttClient *c = g_new0(MqttClient, 1);
+    c->fd  = fd;
+    c->out = g_byte_array_sized_new(2048);
+
+    begin_packet(c, CONNECT << 4);
+    put_string(c, "MQTT");
+    g_byte_array_append(c->out, (const guint8[]){ 4, 0x02 }, 2);   /* 3.1.1, clean */
+    put_u16(c, (guint16)MIN(keepalive_s, G_MAXUINT16));
+    put_string(c, client_id);
+
+    guint8 first;
+    gsize  len;
+    if (!send_packet(c) || read_packet(c, &first, &len, MQTT_TIMEOUT_MS) != 1
+            || first >> 4 != CONNACK || len != 2 || c->in[1] != 0) {
+        g_printerr("[MQTT] %s refused the connection\n", address);
+        mqtt_close(c);
+        return NULL;
+    }
+    return c;
+}
+
+gboolean mqtt_publish(MqttClient *c, const char *topic,
+                      const void *payload, gsize len, guint qos)
+{
+    begin_packet(c, PUBLISH << 4 | (qos ? 1 : 0) << 1);
+    put_string(c, topic);
+    guint16 id = qos ? take_id(c) : 0;
+    if (qos)
+        put_u16(c, id);
+    g_byte_array_append(c->out, payload, len);
+
+    return send_packet(c) && (!qos || wait_for(c, PUBACK, id));
+}
+
+gboolean mqtt_subscribe(MqttClient *c, const char *filter, guint qos)
+{
+    begin_packet(c, SUBSCRIBE << 4 | 0x02);
+    guint16 id = take_id(c);
+    put_u16(c, id);
+    put_string(c, filter);
+    g_byte_array_append(c->out, (const guint8[]){ MIN(qos, 1) }, 1);
+
+    return send_packet(c) && wait_for(c, SUBACK, id) && c->in[2] != 0x80;
+}
+
+gint mqtt_receive(MqttClient *c, gchar **topic, gchar **payload, gsize *len,
+                  guint timeout_ms)
+{
+    for (;;) {
+        guint8 first;
+        gsize  n;
+        gint   r = read_packet(c, &first, &n, timeout_ms);
+        if (r != 1)
+            return r;
+        if (first >> 4 != PUBLISH)
+            continue;                   /* stray PINGRESP etc. */
+
+        guint  qos = (first >> 1) & 3;
+        gsize  tlen = n >= 2 ? (gsize)c->in[0] << 8 | c->in[1] : 0;
+        gsize  off  = 2 + tlen + (qos ? 2 : 0);
+        if (n < 2 || off > n)
+            return -1;
+
+        if (qos) {
+            begin_packet(c, PUBACK << 4);
+            g_byte_array_append(c->out, c->in + 2 + tlen, 2);
+            if (!send_packet(c))
+                return -1;
+        }
+        *topic   = g_strndup((const gchar *)c->in + 2, tlen);
+        *payload = g_strndup((const gchar *)c->in + off, n - off);
+        *len     = n - off;
+        return 1;
+    }
+}
+
+gboolean mqtt_ping(MqttClient *c)
+{
+    begin_packet(c, PINGREQ << 4);
+    return send_packet(c) && wait_for(c, PINGRESP, -1);
+}
+
+void mqtt_close(MqttClient *c)
+{
+    if (!c)
+        return;
+    begin_packet(c, DISCONNECT << 4);
+    send_packet(c);
+    close(c->fd);
+    g_byte_array_unref(c->out);
+    g_free(c->in);
+    g_free(c);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Socket                                                            */
+/* ------------------------------------------------------------------ */
+static gboolean wait_fd(int fd, short events, gint64 deadline_us)
+{
+    for (;;) {
+        gint64 left = deadline_us - g_get_monotonic_time();
+        if (left <= 0)
+            return FALSE;
+        struct pollfd p = { .fd = fd, .events = events };
+        int r = poll(&p, 1, (int)((left + 999) / 1000));
+        if (r > 0)
+            return TRUE;
+        if (r == 0 || errno != EINTR)
+            return FALSE;
+    }
+}
+
+static int open_socket(const char *address)
+/* "host[:port]" → connected, non-blocking TCP socket, or −1. */
+{
+    gchar *host = g_strdup(address);
+    gchar *port = strrchr(host, ':');
+    if (port)
+        *port++ = '\0';
+    gchar *port_buf = port ? NULL : g_strdup_printf("%d", MQTT_DEFAULT_PORT);
+
+    struct addrinfo  hints = { .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res   = NULL;
+    int rc = getaddrinfo(host, port ? port : port_buf, &hints, &res);
+    g_free(port_buf);
+    if (rc != 0) {
+        g_printerr("[MQTT] %s: %s\n", address, gai_strerror(rc));
+        g_free(host);
+        return -1;
+    }
+
+    int fd  = -1;
+    int err = 0;
+    for (struct addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) { err = errno; continue; }
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        err = errno;
+        socklen_t n = sizeof err;
+        if (err == EINPROGRESS
+                && wait_fd(fd, POLLOUT, g_get_monotonic_time() + MQTT_TIMEOUT_MS * 1000)
+                && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &n) == 0 && err == 0)
+            break;
+        if (err == EINPROGRESS)
+            err = ETIMEDOUT;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    g_free(host);
+
+    if (fd < 0) {
+        g_printerr("[MQTT] %s: %s\n", address, g_strerror(err));
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    return fd;
+}
+
+static gboolean write_all(int fd, const guint8 *p, gsize n)
+{
+    gint64 deadline = g_get_monotonic_time() + MQTT_TIMEOUT_MS * 1000;
+    while (n) {
+        ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+        if (w > 0) { p += w; n -= (gsize)w; continue; }
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w < 0 && errno == EAGAIN && wait_fd(fd, POLLOUT, deadline))
+            continue;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gint read_all(int fd, guint8 *p, gsize n, gint64 deadline_us)
+/* 1 when all `n` bytes arrived, 0 on timeout, −1 on error / EOF. */
+{
+    while (n) {
+        if (!wait_fd(fd, POLLIN, deadline_us))
+            return 0;
+        ssize_t r = recv(fd, p, n, 0);
+        if (r > 0) { p += r; n -= (gsize)r; continue; }
+        if (r < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+        return -1;
+    }
+    return 1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Packets                                                           */
+/* ------------------------------------------------------------------ */
+static void begin_packet(MqttClient *c, guint8 first)
+/* Reserve 5 bytes (first byte + longest length) and fill them in send. */
+{
+    g_byte_array_set_size(c->out, 5);
+    c->out->data[0] = first;
+}
+
+static void put_u16(MqttClient *c, guint16 v)
+{
+    g_byte_array_append(c->out, (const guint8[]){ v >> 8, v & 0xFF }, 2);
+}
+
+static void put_string(MqttClient *c, const char *s)
+{
+    gsize n = strlen(s);
+    put_u16(c, (guint16)n);
+    g_byte_array_append(c->out, (const guint8 *)s, n);
+}
+
+static gboolean send_packet(MqttClient *c)
+/* Encode the remaining length right-aligned into the reserved bytes. */
+{
+    gsize  rem = c->out->len - 5;
+    guint8 len[4];
+    guint  n = 0;
+    do {
+        len[n] = rem & 0x7F;
+        rem  >>= 7;
+        if (rem) len[n] |= 0x80;
+        n++;
+    } while (rem && n < 4);
+
+    guint8 *start = c->out->data + 4 - n;
+    start[0] = c->out->data[0];
+    memcpy(start + 1, len, n);
+    return write_all(c->fd, start, c->out->len - (4 - n));
+}
+
+static gint read_packet(MqttClient *c, guint8 *first, gsize *len,
+                        guint timeout_ms)
+/* Body lands in c->in.  1 = packet, 0 = nothing within timeout_ms. */
+{
+    gint r = read_all(c->fd, first, 1, g_get_monotonic_time() + timeout_ms * 1000);
+    if (r != 1)
+        return r;
+
+    /* The rest of the packet is already on its way. */
+    gint64 deadline = g_get_monotonic_time() + MQTT_TIMEOUT_MS * 1000;
+    gsize  n = 0;
+    for (guint shift = 0; ; shift += 7) {
+        guint8 b;
+        if (shift > 21 || read_all(c->fd, &b, 1, deadline) != 1)
+            return -1;
+        n |= (gsize)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+    if (n > PACKET_MAX)
+        return -1;
+    if (n + 1 > c->in_cap) {
+        c->in_cap = MAX(n + 1, 256);
+        c->in     = g_realloc(c->in, c->in_cap);
+    }
+    if (n && read_all(c->fd, c->in, n, deadline) != 1)
+        return -1;
+    c->in[n] = 0;
+    *len = n;
+    return 1;
+}
+
+static gboolean wait_for(MqttClient *c, guint type, gint id)
+/* Skip other packets until `type` (with packet identifier `id`, if ≥ 0). */
+{
+    for (;;) {
+        guint8 first;
+        gsize  len;
+        if (read_packet(c, &first, &len, MQTT_TIMEOUT_MS) != 1)
+            return FALSE;
+        if (first >> 4 != type)
+            continue;
+        if (id < 0)
+            return TRUE;
+        if (len >= 2 && ((guint)c->in[0] << 8 | c->in[1]) == (guint)id)
+            return TRUE;
+    }
+}
+
+static guint16 take_id(MqttClient *c)
+{
+    if (!++c->next_id)
+        c->next_id = 1;
+    return c->next_id;
+}
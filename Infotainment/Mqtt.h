@@ -0,0 +1,53 @@
+/* =========================================================================
+ *  Mqtt.h — minimal blocking MQTT 3.1.1 client (one thread per client)
+ * -------------------------------------------------------------------------
+ *  Just enough MQTT for the publisher (Publisher.h) and its benchmark:
+ *  clean-session connect, QoS 0 / 1 publish, subscribe, receive, ping.
+ *  No TLS, no authentication, no will — the broker is a local
+ *  mosquitto on the Pi or the home network.
+ *
+ *  mqtt_connect(address, client_id, keepalive_s)
+ *      "host" or "host:port" (default port 1883).  Connects, sends
+ *      CONNECT and waits for CONNACK, each within MQTT_TIMEOUT_MS.
+ *      Returns NULL (and logs) on failure.
+ *
+ *  mqtt_publish(client, topic, payload, len, qos)
+ *      QoS 1 returns once the broker's PUBACK arrived, so a TRUE return
+ *      means the broker has the message.  FALSE on any socket or
+ *      protocol error: the connection is dead, mqtt_close() it.
+ *
+ *  mqtt_subscribe(client, filter, qos)
+ *      Waits for the SUBACK.
+ *
+ *  mqtt_receive(client, topic, payload, len, timeout_ms)
+ *      Next PUBLISH from a subscription; QoS 1 ones are acknowledged.
+ *      Returns 1 with `topic` / `payload` (g_free() both, payload is
+ *      NUL-terminated past `len`), 0 on timeout, −1 on error.
+ *
+ *  mqtt_ping(client)
+ *      PINGREQ / PINGRESP round trip; call within every keepalive.
+ *
+ *  mqtt_close(client)
+ *      Sends DISCONNECT (best effort) and frees the client.  NULL is ok.
+ * ========================================================================= */
+#ifndef MQTT_H
+#define MQTT_H
+
+#include <glib.h>
+
+#define MQTT_DEFAULT_PORT  1883
+#define MQTT_TIMEOUT_MS    2000
+
+typedef struct MqttClient MqttClient;
+
+MqttClient *mqtt_connect  (const char *address, const char *client_id,
+                           guint keepalive_s);
+gboolean    mqtt_publish  (MqttClient *client, const char *topic,
+                           const void *payload, gsize len, guint qos);
+gboolean    mqtt_subscribe(MqttClient *client, const char *filter, guint qos);
+gint        mqtt_receive  (MqttClient *client, gchar **topic,
+                           gchar **payload, gsize *len, guint timeout_ms);
+gboolean    mqtt_ping     (MqttClient *client);
+void        mqtt_close    (MqttClient *client);
+
+#endif /* MQTT_H */
@@ -0,0 +1,208 @@
+/* =========================================================================
+ *  ObdFrame.c — raw / JSON frame decode, request replies and per-PID
+ *               display formatting
+ * ========================================================================= */
+#include "ObdFrame.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Raw frames                                                        */
+/* ------------------------------------------------------------------ */
+static inline gint hex_nibble(gchar c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static gboolean parse_raw(const gchar *p, const gchar *end, ObdFrame *frame)
+/* "R id:HEX id:HEX …" — ids index PID_TABLE directly */
+{
+    for (p++; p < end; ) {
+        while (p < end && (*p == ' ' || *p == '\r' || *p == '\n')) p++;
+        if (p >= end) break;
+
+        guint id = 0;
+        const gchar *digits = p;
+        while (p < end && *p >= '0' && *p <= '9')
+            id = id * 10 + (guint)(*p++ - '0');
+        if (p == digits || p >= end || *p++ != ':')
+            return FALSE;
+
+        guint8 data[PID_MAX_BYTES];
+        guint  n = 0;
+        while (p + 1 < end && n < PID_MAX_BYTES) {
+            gint hi = hex_nibble(p[0]), lo = hex_nibble(p[1]);
+            if (hi < 0 || lo < 0) break;
+            data[n++] = (guint8)(hi << 4 | lo);
+            p += 2;
+        }
+        while (p < end && *p != ' ') p++;       /* extra reply bytes */
+
+        if (id < PID_COUNT && n >= PID_TABLE[id].bytes) {
+            frame->value[id]  = PID_TABLE[id].decode(data);
+            frame->present   |= G_GUINT64_CONSTANT(1) << id;
+        }
+    }
+    return TRUE;
+}
+
+static gboolean parse_values(const gchar *p, const gchar *end, ObdFrame *frame)
+/* "V id:value id:value …" — values already in the PID's unit */
+{
+    for (p++; p < end; ) {
+        while (p < end && (*p == ' ' || *p == '\r' || *p == '\n')) p++;
+        if (p >= end) break;
+
+        guint id = 0;
+        const gchar *digits = p;
+        while (p < end && *p >= '0' && *p <= '9')
+            id = id * 10 + (guint)(*p++ - '0');
+        if (p == digits || p >= end || *p++ != ':')
+            return FALSE;
+
+        /* Copy the token: `line` need not be NUL-terminated at `end` */
+        gchar num[32];
+        gsize n = 0;
+        while (p < end && *p != ' ' && *p != '\r' && *p != '\n' && n < sizeof num - 1)
+            num[n++] = *p++;
+        num[n] = '\0';
+
+        gchar  *stop;
+        gdouble v = g_ascii_strtod(num, &stop);
+        if (stop == num || *stop)
+            return FALSE;
+        if (id < PID_COUNT) {
+            frame->value[id]  = v;
+            frame->present   |= G_GUINT64_CONSTANT(1) << id;
+        }
+    }
+    return TRUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  JSON frames                                                       */
+/* ------------------------------------------------------------------ */
+static gboolean parse_json(JsonParser *parser, const gchar *line, gsize len,
+                           ObdFrame *frame)
+{
+    if (!json_parser_load_from_data(parser, line, (gssize)len, NULL))
+        return FALSE;
+
+    JsonNode *root = json_parser_get_root(parser);
+    if (!root || !JSON_NODE_HOLDS_OBJECT(root))
+        return FALSE;
+
+    JsonObject *obj = json_node_get_object(root);
+    for (guint i = 0; i < OBD_FRAME_COLUMNS; i++) {
+        JsonNode *n = json_object_get_member(obj, PID_TABLE[i].name);
+        if (!n) continue;
+        frame->value[i]  = json_node_get_double(n);
+        frame->present  |= G_GUINT64_CONSTANT(1) << i;
+    }
+    return TRUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+gboolean obd_frame_parse(JsonParser *parser, const gchar *line, gsize len,
+                         ObdFrame *frame)
+{
+    frame->present = 0;
+    frame->t_us    = 0;
+    if (len && line[0] == '@') {                /* "@<µs> " sample stamp */
+        gsize i = 1;
+        while (i < len && line[i] >= '0' && line[i] <= '9')
+            frame->t_us = frame->t_us * 10 + (line[i++] - '0');
+        if (i == 1 || i >= len || line[i] != ' ')
+            return FALSE;
+        line += i + 1;
+        len  -= i + 1;
+    }
+    if (len && line[0] == 'R')
+        return parse_raw(line, line + len, frame);
+    if (len && line[0] == 'V')
+        return parse_values(line, line + len, frame);
+    return parse_json(parser, line, len, frame);
+}
+
+gboolean obd_reply_parse(const gchar *line, gsize len, ObdReply *reply)
+/* "A tag STATUS wait run stall [HEX,HEX,…]" */
+{
+    static const char *const STATUS[] = {
+        [OBD_REPLY_OK] = "OK", [OBD_REPLY_NO_DATA] = "NODATA", [OBD_REPLY_ERROR] = "ERROR",
+    };
+    memset(reply, 0, sizeof *reply);
+    if (!len || line[0] != 'A')
+        return FALSE;
+
+    gchar *copy = g_strndup(line, len);             /* sscanf needs a NUL */
+    gchar  status[16];
+    int    hex_at = 0;
+    gboolean ok = sscanf(copy, "A %u %15s %u %u %u %n", &reply->tag, status,
+                         &reply->wait_ms, &reply->run_ms, &reply->stall_ms,
+                         &hex_at) == 5 && hex_at > 0;
+
+    guint s = 0;
+    while (ok && s < G_N_ELEMENTS(STATUS) && strcmp(status, STATUS[s]) != 0)
+        s++;
+    ok = ok && s < G_N_ELEMENTS(STATUS);
+    reply->status = (ObdReplyStatus)s;
+
+    for (const gchar *p = copy + hex_at; ok && *p && *p != '\n' && *p != '\r'; ) {
+        if (reply->n_ecus == OBD_REPLY_MAX_ECUS) {
+            reply->truncated = TRUE;
+            break;
+        }
+        guint e = reply->n_ecus++;
+        for (; *p && *p != ',' && *p != '\n' && *p != '\r'; p += 2) {
+            gint hi = hex_nibble(p[0]), lo = hi < 0 ? -1 : hex_nibble(p[1]);
+            if (hi < 0 || lo < 0) {
+                ok = FALSE;
+                break;
+            }
+            if (reply->len[e] < OBD_REPLY_MAX_BYTES)
+                reply->data[e][reply->len[e]++] = (guint8)(hi << 4 | lo);
+            else
+                reply->truncated = TRUE;
+        }
+        if (*p == ',')
+            p++;
+    }
+    g_free(copy);
+    return ok;
+}
+
+guint obd_reply_dtcs(const ObdReply *reply, ObdDtc *codes, guint max)
+/* ----------------------------------------------------------------------
+ *  Each code is two bytes: 2 bits system (P C B U), then 14 bits shown
+ *  as four hex digits.  CAN replies put a count byte in front, so an odd
+ *  length means "skip one".  0000 is padding.
+ * ---------------------------------------------------------------------- */
+{
+    guint n = 0;
+    for (guint e = 0; e < reply->n_ecus; e++) {
+        const guint8 *d   = reply->data[e];
+        guint         len = reply->len[e];
+        for (guint i = len % 2; i + 1 < len && n < max; i += 2) {
+            if (!d[i] && !d[i + 1])
+                continue;
+            g_snprintf(codes[n++], sizeof codes[0], "%c%X%X%02X",
+                       "PCBU"[d[i] >> 6], (d[i] >> 4) & 0x3, d[i] & 0xF, d[i + 1]);
+        }
+    }
+    return n;
+}
+
+gsize obd_format_value(guint id, gdouble v, gchar *buf, gsize size)
+{
+    if (id >= PID_COUNT) {
+        if (size) buf[0] = '\0';
+        return 0;
+    }
+    return PID_TABLE[id].format(v, buf, size);
+}
@@ -0,0 +1,92 @@
+/* =========================================================================
+ *  ObdFrame.h — decode and format obd_reader.py frames
+ * -------------------------------------------------------------------------
+ *  Three frame formats arrive from the vehicle backends:
+ *
+ *      R 0:1AF8 1:3C 7:3A98
+ *          raw frame (obd_reader.py --raw): dense PidId : reply data bytes
+ *          in hex.  Decoded by the PidTable functions — no string work.
+ *      V 0:1726.25 1:60 7:14.2
+ *          decoded values (the SocketCAN backend, CanReader.c): PidId :
+ *          value in the PID's unit, C locale.
+ *      {"RPM": 1726.0, "SPEED": 60.0, …}
+ *          JSON frame keyed by PID name (obd_reader.py default, captured
+ *          logs, the --simulate ECU and UiBench).
+ *
+ *  Any of them may start with "@<µs> ", the CLOCK_MONOTONIC time the
+ *  source sampled the values (obd_reader.py --raw, CanReader.c), so
+ *  frames from several sources can be put in order (Merge.h):
+ *
+ *      @81234567 R 0:1AF8 1:3C
+ *
+ *  plus the answer to a one-off request (Telemetry.h):
+ *
+ *      A 7 OK 12 48 0 02013304200000
+ *          tag, OK / NODATA / ERROR, ms queued in the reader, ms on the
+ *          adapter, ms it held up a due streaming PID, then each ECU's
+ *          reply in hex (response mode byte removed), comma-separated.
+ *
+ *  obd_frame_parse(parser, line, len, frame)
+ *      Fills `frame` with every PID present in any format, and t_us with
+ *      the "@" stamp (0 if none).  The caller-owned JsonParser is reused
+ *      for JSON lines.  Returns FALSE for a malformed line.
+ *
+ *  obd_format_value(id, value, buf, size)
+ *      Renders a value the way the dashboard shows it ("2150", "62 mph",
+ *      "14.1 V" …).  Returns the string length.
+ *
+ *  obd_reply_parse(line, len, reply)
+ *      Decodes an "A …" line.  FALSE if malformed.  Replies longer than
+ *      OBD_REPLY_MAX_BYTES are cut short and marked `truncated`.
+ *
+ *  obd_reply_dtcs(reply, codes, max)
+ *      Mode 03 / 07 / 0A reply → "P0133"-style codes, every ECU; returns
+ *      how many were written.
+ *
+ *  No GTK here, so the microbenchmarks measure exactly what the window
+ *  runs per frame.
+ * ========================================================================= */
+#ifndef OBDFRAME_H
+#define OBDFRAME_H
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+#include "PidTable.h"
+
+#define OBD_FRAME_COLUMNS PID_COUNT
+
+typedef struct {
+    guint64 present;                        /* bit i ⇒ value[i] valid */
+    gint64  t_us;                           /* sampled, monotonic; 0 = unknown */
+    gdouble value[OBD_FRAME_COLUMNS];
+} ObdFrame;
+
+#define OBD_REPLY_MAX_ECUS  8
+#define OBD_REPLY_MAX_BYTES 64
+
+typedef enum {
+    OBD_REPLY_OK,
+    OBD_REPLY_NO_DATA,          /* no ECU answered                      */
+    OBD_REPLY_ERROR,            /* adapter or request error             */
+    OBD_REPLY_UNSUPPORTED,      /* backend cannot query (set by Vroom)  */
+} ObdReplyStatus;
+
+typedef struct {
+    guint           tag;
+    ObdReplyStatus  status;
+    guint           wait_ms, run_ms, stall_ms;
+    guint           n_ecus;
+    guint8          len[OBD_REPLY_MAX_ECUS];
+    guint8          data[OBD_REPLY_MAX_ECUS][OBD_REPLY_MAX_BYTES];
+    gboolean        truncated;
+} ObdReply;
+
+typedef gchar ObdDtc[6];                    /* "P0133" */
+
+gboolean obd_frame_parse (JsonParser *parser, const gchar *line, gsize len,
+                          ObdFrame *frame);
+gsize    obd_format_value(guint id, gdouble value, gchar *buf, gsize size);
+gboolean obd_reply_parse (const gchar *line, gsize len, ObdReply *reply);
+guint    obd_reply_dtcs  (const ObdReply *reply, ObdDtc *codes, guint max);
+
+#endif /* OBDFRAME_H */
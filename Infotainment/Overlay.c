@@ -0,0 +1,300 @@
+/* =========================================================================
+ *  Overlay.c — implementation of the Android Auto telemetry strip
+ * -------------------------------------------------------------------------
+ *  • One GTK_WINDOW_POPUP holding one GtkDrawingArea; each PID is a
+ *    fixed-size cell with a caption and a value PangoLayout, both built
+ *    once.  The window is opaque, so the compositor never blends it.
+ *  • Frames only update a `pending` string per cell.  A single flush
+ *    timeout, armed on the first change and spaced by the redraw cap,
+ *    copies pending → layout and queues a draw of just the dirty cells;
+ *    unchanged values cost a snprintf + strcmp and nothing else.
+ *  • While hidden the strip is detached from telemetry and owns no
+ *    sources.
+ * ========================================================================= */
+#include "Overlay.h"
+#include "ObdFrame.h"
+#include "Telemetry.h"
+#include "Trace.h"
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Style constants                                                   */
+/* ------------------------------------------------------------------ */
+#define OVERLAY_MAX_CELLS 4
+
+static const char  OVERLAY_CAPTION_FONT[] = "Sans 10";
+static const char  OVERLAY_VALUE_FONT[]   = "Sans Bold 22";
+static const int   OVERLAY_CELL_WIDTH     = 150;
+static const int   OVERLAY_HEIGHT         = 52;
+static const int   OVERLAY_PAD            = 8;
+static const guint OVERLAY_MAX_HZ         = 4;
+
+static const char OVERLAY_DEFAULT_PIDS[] = "SPEED,RPM,CONTROL MODULE VOLTAGE";
+
+/* ------------------------------------------------------------------ */
+/*  State (GTK thread only)                                           */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    PidId        pid;
+    PangoLayout *caption;
+    PangoLayout *value;
+    gchar        pending[32];      /* latest text from telemetry     */
+    gchar        shown[32];        /* text currently in `value`      */
+} OverlayCell;
+
+static OverlayCell g_cells[OVERLAY_MAX_CELLS];
+static guint       g_n_cells   = 0;
+static gboolean    g_pids_set  = FALSE;
+
+static GtkWidget  *g_win       = NULL;
+static GtkWidget  *g_area      = NULL;
+static gboolean    g_visible   = FALSE;
+static guint       g_flush_tag = 0;
+static gint64      g_last_flush_us;
+
+/* Redraw accounting for the current session */
+static guint       g_redraws;
+static gint64      g_shown_at_us;
+
+/* ------------------------------------------------------------------ */
+/*  Forward declarations                                              */
+/* ------------------------------------------------------------------ */
+static void     set_pending  (OverlayCell *cell, const char *text);
+static gboolean flush_cb     (gpointer);
+static gboolean on_draw      (GtkWidget *, cairo_t *cr, gpointer);
+static void     on_realize   (GtkWidget *w, gpointer);
+static void     on_frame     (const ObdFrame *frame, gpointer);
+static void     on_link      (gboolean up, gpointer);
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+gboolean overlay_set_pids(const char *pid_names)
+{
+    if (g_win) {
+        g_printerr("[Overlay] PIDs must be set before overlay_init()\n");
+        return FALSE;
+    }
+
+    OverlayCell cells[OVERLAY_MAX_CELLS];
+    guint       n     = 0;
+    gchar     **names = g_strsplit(pid_names, ",", -1);
+    gboolean    ok    = TRUE;
+
+    for (guint i = 0; ok && names[i]; i++) {
+        const gchar *want = g_strstrip(names[i]);
+        if (!*want) continue;
+
+        gint id = pid_lookup(want);
+        if (id < 0) {
+            g_printerr("[Overlay] unknown PID '%s'\n", want);
+            ok = FALSE;
+        } else if (n == OVERLAY_MAX_CELLS) {
+            g_printerr("[Overlay] at most %d PIDs\n", OVERLAY_MAX_CELLS);
+            ok = FALSE;
+        } else {
+            cells[n++] = (OverlayCell){ .pid = (PidId)id };
+        }
+    }
+    g_strfreev(names);
+
+    if (ok) {
+        memcpy(g_cells, cells, n * sizeof cells[0]);
+        g_n_cells  = n;
+        g_pids_set = TRUE;
+    }
+    return ok;
+}
+
+void overlay_init(void)
+/* Build the strip once (GTK thread).  Hidden until overlay_show(). */
+{
+    if (g_win)
+        return;
+    if (!g_pids_set)
+        overlay_set_pids(OVERLAY_DEFAULT_PIDS);
+    if (!g_n_cells)
+        return;                                 /* overlay disabled */
+
+    int width = (int)g_n_cells * OVERLAY_CELL_WIDTH;
+
+    g_win = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_set_default_size(GTK_WINDOW(g_win), width, OVERLAY_HEIGHT);
+    gtk_window_set_accept_focus(GTK_WINDOW(g_win), FALSE);
+    gtk_window_set_type_hint(GTK_WINDOW(g_win), GDK_WINDOW_TYPE_HINT_NOTIFICATION);
+    g_signal_connect(g_win, "realize", G_CALLBACK(on_realize), NULL);
+
+    g_area = gtk_drawing_area_new();
+    gtk_widget_set_size_request(g_area, width, OVERLAY_HEIGHT);
+    g_signal_connect(g_area, "draw", G_CALLBACK(on_draw), NULL);
+    gtk_container_add(GTK_CONTAINER(g_win), g_area);
+
+    /* Layouts are created once; only set_text() runs afterwards */
+    PangoFontDescription *cap_fd = pango_font_description_from_string(OVERLAY_CAPTION_FONT);
+    PangoFontDescription *val_fd = pango_font_description_from_string(OVERLAY_VALUE_FONT);
+    for (guint i = 0; i < g_n_cells; i++) {
+        OverlayCell *cell = &g_cells[i];
+        int text_w = (OVERLAY_CELL_WIDTH - 2 * OVERLAY_PAD) * PANGO_SCALE;
+
+        cell->caption = gtk_widget_create_pango_layout(g_area, PID_TABLE[cell->pid].name);
+        pango_layout_set_font_description(cell->caption, cap_fd);
+        pango_layout_set_width(cell->caption, text_w);
+        pango_layout_set_ellipsize(cell->caption, PANGO_ELLIPSIZE_END);
+
+        cell->value = gtk_widget_create_pango_layout(g_area, "--");
+        pango_layout_set_font_description(cell->value, val_fd);
+        pango_layout_set_width(cell->value, text_w);
+        pango_layout_set_ellipsize(cell->value, PANGO_ELLIPSIZE_END);
+
+        g_strlcpy(cell->pending, "--", sizeof cell->pending);
+        g_strlcpy(cell->shown,   "--", sizeof cell->shown);
+    }
+    pango_font_description_free(cap_fd);
+    pango_font_description_free(val_fd);
+
+    gtk_widget_show(g_area);
+    gtk_widget_realize(g_win);
+}
+
+void overlay_show(void)
+{
+    if (!g_win || g_visible)
+        return;
+
+    /* Top-right corner of the primary monitor */
+    GdkDisplay  *display = gtk_widget_get_display(g_win);
+    GdkMonitor  *monitor = gdk_display_get_primary_monitor(display);
+    if (!monitor)
+        monitor = gdk_display_get_monitor(display, 0);
+    GdkRectangle geo = { 0, 0, 800, 480 };
+    if (monitor)
+        gdk_monitor_get_geometry(monitor, &geo);
+    gtk_window_move(GTK_WINDOW(g_win),
+                    geo.x + geo.width - (int)g_n_cells * OVERLAY_CELL_WIDTH, geo.y);
+
+    for (guint i = 0; i < g_n_cells; i++)
+        set_pending(&g_cells[i], "--");
+
+    g_visible     = TRUE;
+    g_redraws     = 0;
+    g_shown_at_us = g_get_monotonic_time();
+    gtk_widget_show(g_win);
+
+    guint64 mask = 0;
+    for (guint i = 0; i < g_n_cells; i++)
+        mask |= G_GUINT64_CONSTANT(1) << g_cells[i].pid;
+    telemetry_attach_view(TELEMETRY_VIEW_OVERLAY, mask, on_frame, on_link, NULL);
+}
+
+void overlay_hide(void)
+{
+    if (!g_win || !g_visible)
+        return;
+
+    telemetry_detach_view(TELEMETRY_VIEW_OVERLAY);
+    if (g_flush_tag) {
+        g_source_remove(g_flush_tag);
+        g_flush_tag = 0;
+    }
+    gtk_widget_hide(g_win);
+    g_visible = FALSE;
+
+    gdouble secs = (g_get_monotonic_time() - g_shown_at_us) / 1e6;
+    g_print("[Overlay] %u redraws in %.1f s (%.2f/s)\n",
+            g_redraws, secs, secs > 0 ? g_redraws / secs : 0.0);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Telemetry callbacks                                               */
+/* ------------------------------------------------------------------ */
+static void on_frame(const ObdFrame *frame, gpointer)
+{
+    for (guint i = 0; i < g_n_cells; i++) {
+        OverlayCell *cell = &g_cells[i];
+        if (!(frame->present & (G_GUINT64_CONSTANT(1) << cell->pid)))
+            continue;
+        gchar txt[sizeof cell->pending];
+        obd_format_value(cell->pid, frame->value[cell->pid], txt, sizeof txt);
+        set_pending(cell, txt);
+    }
+}
+
+static void on_link(gboolean up, gpointer)
+{
+    if (!up)
+        for (guint i = 0; i < g_n_cells; i++)
+            set_pending(&g_cells[i], "--");
+}
+
+/* ------------------------------------------------------------------ */
+/*  Capped redraw                                                     */
+/* ------------------------------------------------------------------ */
+static void set_pending(OverlayCell *cell, const char *text)
+/* Record the new text; arm the flush if it differs from what is shown. */
+{
+    if (!strcmp(cell->pending, text))
+        return;
+    g_strlcpy(cell->pending, text, sizeof cell->pending);
+
+    if (g_flush_tag || !strcmp(cell->pending, cell->shown))
+        return;
+
+    gint64 period_us = G_USEC_PER_SEC / OVERLAY_MAX_HZ;
+    gint64 wait_us   = g_last_flush_us + period_us - g_get_monotonic_time();
+    g_flush_tag = g_timeout_add((guint)(MAX(wait_us, 0) / 1000), flush_cb, NULL);
+    g_source_set_name_by_id(g_flush_tag, "overlay-flush");
+}
+
+static gboolean flush_cb(gpointer)
+{
+    TRACE_SCOPE("overlay_flush");
+    g_flush_tag     = 0;
+    g_last_flush_us = g_get_monotonic_time();
+
+    for (guint i = 0; i < g_n_cells; i++) {
+        OverlayCell *cell = &g_cells[i];
+        if (!strcmp(cell->pending, cell->shown))
+            continue;
+        g_strlcpy(cell->shown, cell->pending, sizeof cell->shown);
+        pango_layout_set_text(cell->value, cell->shown, -1);
+        gtk_widget_queue_draw_area(g_area, (int)i * OVERLAY_CELL_WIDTH, 0,
+                                   OVERLAY_CELL_WIDTH, OVERLAY_HEIGHT);
+        g_redraws++;
+    }
+    return G_SOURCE_REMOVE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Drawing                                                           */
+/* ------------------------------------------------------------------ */
+static gboolean on_draw(GtkWidget *, cairo_t *cr, gpointer)
+/* Cairo is clipped to the invalidated cells; everything else is skipped. */
+{
+    TRACE_SCOPE("overlay_draw");
+
+    cairo_set_source_rgb(cr, 0.06, 0.06, 0.08);
+    cairo_paint(cr);
+
+    for (guint i = 0; i < g_n_cells; i++) {
+        int x = (int)i * OVERLAY_CELL_WIDTH + OVERLAY_PAD;
+
+        cairo_set_source_rgb(cr, 0.65, 0.65, 0.70);
+        cairo_move_to(cr, x, 4);
+        pango_cairo_show_layout(cr, g_cells[i].caption);
+
+        cairo_set_source_rgb(cr, 0.0, 0.67, 1.0);          /* #00AAFF */
+        cairo_move_to(cr, x, 18);
+        pango_cairo_show_layout(cr, g_cells[i].value);
+    }
+    return TRUE;
+}
+
+static void on_realize(GtkWidget *w, gpointer)
+/* Empty input shape → touches and clicks fall through to autoapp. */
+{
+    cairo_region_t *none = cairo_region_create();
+    gtk_widget_input_shape_combine_region(w, none);
+    cairo_region_destroy(none);
+}
@@ -0,0 +1,34 @@
+/* =========================================================================
+ *  Overlay.h — telemetry strip drawn over Android Auto
+ * -------------------------------------------------------------------------
+ *  overlay_set_pids("SPEED,RPM,…")
+ *      Chooses the PIDs in the strip (PidTable.def names, at most 4);
+ *      an empty list disables the overlay.  Call before overlay_init().
+ *      Returns FALSE on a bad list (the default set is kept).
+ *
+ *  overlay_init()
+ *      Builds the strip once (hidden): a small opaque band in the top-
+ *      right corner, override-redirect so it stays above autoapp, and
+ *      with an empty input shape so every touch goes through to the
+ *      Android Auto surface underneath.
+ *
+ *  overlay_show() / overlay_hide()
+ *      Called around an autoapp session.  While shown the strip is a
+ *      telemetry view (Telemetry.h) for its PIDs.  Values are redrawn
+ *      only when their text changes, at most 4 times a second
+ *      (OVERLAY_MAX_HZ), and only the changed cells are invalidated;
+ *      hiding logs the redraw count.
+ *
+ *  GTK thread only.
+ * ========================================================================= */
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <glib.h>
+
+gboolean overlay_set_pids(const char *pid_names);
+void     overlay_init    (void);
+void     overlay_show    (void);
+void     overlay_hide    (void);
+
+#endif /* OVERLAY_H */
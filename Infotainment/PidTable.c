@@ -0,0 +1,55 @@
+/* =========================================================================
+ *  PidTable.c — expands PidTable.def into per-PID functions
+ * -------------------------------------------------------------------------
+ *  Every row becomes a decode_<id>() with its formula inlined over the
+ *  reply bytes and a format_<id>() with its printf format as a literal
+ *  (so -Wformat checks each one).  PID_TABLE[] then points at them by
+ *  dense ID: no name lookups, no per-column switch.
+ * ========================================================================= */
+#include "PidTable.h"
+
+G_STATIC_ASSERT(PID_COUNT <= 64);      /* PID sets are guint64 masks (PidTable.def) */
+
+/* ------------------------------------------------------------------ */
+/*  Generated decoders + formatters                                   */
+/* ------------------------------------------------------------------ */
+#define PID_DEF(id, name, mode, pid, bytes, formula, unit, fmt, scale, rate)  \
+    G_STATIC_ASSERT((bytes) >= 1 && (bytes) <= PID_MAX_BYTES);                \
+    static gdouble decode_##id(const guint8 *d)                               \
+    {                                                                         \
+        const gdouble A = d[0];                                               \
+        const gdouble B = (bytes) > 1 ? d[(bytes) > 1 ? 1 : 0] : 0;           \
+        const gdouble C = (bytes) > 2 ? d[(bytes) > 2 ? 2 : 0] : 0;           \
+        const gdouble D = (bytes) > 3 ? d[(bytes) > 3 ? 3 : 0] : 0;           \
+        (void)A; (void)B; (void)C; (void)D;                                   \
+        return (formula);                                                     \
+    }                                                                         \
+    static gsize format_##id(gdouble v, gchar *buf, gsize size)               \
+    {                                                                         \
+        gint n = g_snprintf(buf, size, fmt, v * (scale));                     \
+        return n < 0 ? 0 : MIN((gsize)n, size ? size - 1 : 0);                \
+    }
+#include "PidTable.def"
+#undef PID_DEF
+
+/* ------------------------------------------------------------------ */
+/*  Table                                                             */
+/* ------------------------------------------------------------------ */
+const PidInfo PID_TABLE[PID_COUNT] = {
+#define PID_DEF(id, name, mode, pid, bytes, formula, unit, fmt, scale, rate)  \
+    [PID_##id] = { name, mode, pid, bytes, unit, rate,                        \
+                   decode_##id, format_##id },
+#include "PidTable.def"
+#undef PID_DEF
+};
+
+/* ------------------------------------------------------------------ */
+/*  Lookup                                                            */
+/* ------------------------------------------------------------------ */
+gint pid_lookup(const char *name)
+{
+    for (guint i = 0; i < PID_COUNT; i++)
+        if (!g_ascii_strcasecmp(name, PID_TABLE[i].name))
+            return (gint)i;
+    return -1;
+}
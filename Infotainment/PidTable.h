@@ -0,0 +1,51 @@
+/* =========================================================================
+ *  PidTable.h — dense IDs, decoders and formatters generated from
+ *               PidTable.def
+ * -------------------------------------------------------------------------
+ *  PidId
+ *      PID_RPM, PID_SPEED, … in table order, then PID_COUNT.
+ *
+ *  PID_TABLE[id]
+ *      Static description of each PID plus two functions compiled from
+ *      its row:
+ *          decode(data)        ECU reply bytes (A, B, …) → value in `unit`
+ *          format(v, buf, n)   value → display text ("62 mph"), returns
+ *                              the string length
+ *
+ *  pid_lookup(name)
+ *      PidTable.def name ("RPM", "oil temp" …, case-insensitive) → PidId,
+ *      −1 if unknown.  For command-line PID lists.
+ *
+ *  Adding a PID — standard or Mode 22 — is a one-line edit of
+ *  PidTable.def; nothing here or in the callers changes.
+ * ========================================================================= */
+#ifndef PIDTABLE_H
+#define PIDTABLE_H
+
+#include <glib.h>
+
+typedef enum {
+#define PID_DEF(id, name, mode, pid, bytes, formula, unit, fmt, scale, rate) PID_##id,
+#include "PidTable.def"
+#undef PID_DEF
+    PID_COUNT
+} PidId;
+
+#define PID_MAX_BYTES 4
+
+typedef struct {
+    const char *name;
+    guint8      mode;
+    guint16     pid;
+    guint8      bytes;
+    const char *unit;
+    gdouble     rate_hz;
+    gdouble   (*decode)(const guint8 *data);
+    gsize     (*format)(gdouble value, gchar *buf, gsize size);
+} PidInfo;
+
+extern const PidInfo PID_TABLE[PID_COUNT];
+
+gint pid_lookup(const char *name);
+
+#endif /* PIDTABLE_H */
@@ -1,71 +1,196 @@
 /* =========================================================================
- *  Popup.c — implementation of the transient HUD popup
+ *  Popup.c — implementation of the persistent HUD overlay
+ * -------------------------------------------------------------------------
+ *  • One GTK_WINDOW_POPUP (override-redirect, so it also sits above
+ *    autoapp) with a text label and a level bar, built once.
+ *  • Producers write the wanted state into `g_pending` under a mutex and
+ *    queue at most one idle; the idle applies the newest state only.
+ *  • Visible text uses a fixed PangoAttrList, so updates are plain
+ *    gtk_label_set_text() calls — no markup parsing per event.
+ *  • Hide deadline is a timestamp; the single hide timeout re-arms itself
+ *    for the remainder instead of being removed / re-added per event.
  * ========================================================================= */
 #include "Popup.h"
+#include "Trace.h"
 #include <gtk/gtk.h>
-#include <stdlib.h>
-#include <string.h>     /* strlen, strcpy */
+#include <string.h>
 
 /* -------------------------------------------------------------------------
  *  Style constants
  * ------------------------------------------------------------------------- */
 static const char POPUP_FONT_DESC[]   = "Sans 36";
-static const char POPUP_TEXT_COLOR[]  = "#FFFFFF";
 static const int  POPUP_WINDOW_WIDTH  = 300;
 static const int  POPUP_WINDOW_HEIGHT = 100;
+static const int  POPUP_VISIBLE_MS    = 1500;
+
+static const char *const MODE_NAMES[] = {
+    [HUD_MODE_VOLUME]     = "Volume",
+    [HUD_MODE_BRIGHTNESS] = "Brightness",
+};
+
+/* -------------------------------------------------------------------------
+ *  State
+ * ------------------------------------------------------------------------- */
+typedef struct {
+    char text[64];
+    int  level;               /* 0-100, −1 → no bar */
+} HudState;
+
+/* Written by any thread, guarded by g_lock */
+static GMutex   g_lock;
+static HudState g_pending;
+static gboolean g_apply_queued = FALSE;
+static int      g_last_level[G_N_ELEMENTS(MODE_NAMES)] = { -1, -1 };
+
+/* GTK thread only */
+static GtkWidget *g_popup     = NULL;
+static GtkWidget *g_label     = NULL;
+static GtkWidget *g_bar       = NULL;
+static HudState   g_shown     = { "", -2 };
+static gint64     g_hide_at   = 0;
+static guint      g_hide_tag  = 0;
 
 /* -------------------------------------------------------------------------
  *  Forward declarations
  * ------------------------------------------------------------------------- */
-static gboolean create_popup_in_mainloop(gpointer user_data);
-static gboolean hide_popup_callback     (gpointer w);
+static void     queue_state        (const char *text, int level);
+static gboolean apply_in_mainloop  (gpointer user_data);
+static gboolean hide_popup_callback(gpointer user_data);
 
 /* -------------------------------------------------------------------------
  *  Public API
  * ------------------------------------------------------------------------- */
+void popup_init(void)
+/* Build the HUD once (GTK thread).  Hidden until the first event. */
+{
+    if (g_popup)
+        return;
+
+    g_popup = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_set_default_size(GTK_WINDOW(g_popup),
+                                POPUP_WINDOW_WIDTH,
+                                POPUP_WINDOW_HEIGHT);
+    gtk_window_set_position(GTK_WINDOW(g_popup), GTK_WIN_POS_CENTER_ALWAYS);
+    gtk_window_set_accept_focus(GTK_WINDOW(g_popup), FALSE);
+
+    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
+    gtk_container_set_border_width(GTK_CONTAINER(box), 12);
+    gtk_container_add(GTK_CONTAINER(g_popup), box);
+
+    g_label = gtk_label_new(NULL);
+    PangoAttrList        *attrs = pango_attr_list_new();
+    PangoFontDescription *fd    = pango_font_description_from_string(POPUP_FONT_DESC);
+    pango_attr_list_insert(attrs, pango_attr_font_desc_new(fd));
+    pango_attr_list_insert(attrs, pango_attr_foreground_new(0xFFFF, 0xFFFF, 0xFFFF));
+    gtk_label_set_attributes(GTK_LABEL(g_label), attrs);
+    pango_font_description_free(fd);
+    pango_attr_list_unref(attrs);
+    gtk_box_pack_start(GTK_BOX(box), g_label, TRUE, TRUE, 0);
+
+    g_bar = gtk_level_bar_new_for_interval(0, 100);
+    gtk_level_bar_set_mode(GTK_LEVEL_BAR(g_bar), GTK_LEVEL_BAR_MODE_CONTINUOUS);
+    gtk_widget_set_size_request(g_bar, POPUP_WINDOW_WIDTH - 24, 16);
+    gtk_box_pack_start(GTK_BOX(box), g_bar, FALSE, FALSE, 0);
+
+    gtk_widget_show_all(box);
+    gtk_widget_realize(g_popup);
+}
+
+void popup_show_mode(HudMode mode)
+{
+    g_mutex_lock(&g_lock);
+    int level = g_last_level[mode];
+    g_mutex_unlock(&g_lock);
+
+    queue_state(MODE_NAMES[mode], level);
+}
+
+void popup_show_level(HudMode mode, int percent)
+{
+    percent = CLAMP(percent, 0, 100);
+
+    g_mutex_lock(&g_lock);
+    g_last_level[mode] = percent;
+    g_mutex_unlock(&g_lock);
+
+    queue_state(MODE_NAMES[mode], percent);
+}
+
 void show_temp_popup(const char *message)
-/* Queue the popup creation on the GTK main thread. */
 {
-    char *msg_copy = malloc(strlen(message) + 1);
-    strcpy(msg_copy, message);
-    g_idle_add(create_popup_in_mainloop, msg_copy);
+    queue_state(message, -1);
 }
 
 /* -------------------------------------------------------------------------
  *  Helpers
  * ------------------------------------------------------------------------- */
-static gboolean create_popup_in_mainloop(gpointer user_data)
-/* Build and display the popup window (runs in GTK thread). */
+static void queue_state(const char *text, int level)
+/* Latest state wins; at most one idle is outstanding. */
 {
-    char *message = (char *)user_data;
+    TRACE_INSTANT("hud-event");
 
-    GtkWidget *popup = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-    gtk_window_set_title(GTK_WINDOW(popup), "Popup");
-    gtk_window_set_default_size(GTK_WINDOW(popup),
-                                POPUP_WINDOW_WIDTH,
-                                POPUP_WINDOW_HEIGHT);
-    gtk_window_set_position(GTK_WINDOW(popup), GTK_WIN_POS_CENTER_ALWAYS);
+    g_mutex_lock(&g_lock);
+    g_strlcpy(g_pending.text, text, sizeof g_pending.text);
+    g_pending.level = level;
 
-    GtkWidget *label = gtk_label_new(NULL);
-    char *markup = g_strdup_printf(
-        "<span font_desc='%s' foreground='%s'>%s</span>",
-        POPUP_FONT_DESC, POPUP_TEXT_COLOR, message);
-    gtk_label_set_markup(GTK_LABEL(label), markup);
-    g_free(markup);
+    gboolean need_idle = !g_apply_queued;
+    g_apply_queued = TRUE;
+    g_mutex_unlock(&g_lock);
 
-    gtk_container_add(GTK_CONTAINER(popup), label);
-    gtk_widget_show_all(popup);
+    if (need_idle)
+        g_source_set_name_by_id(g_idle_add(apply_in_mainloop, NULL),
+                                "hud-apply");
+}
+
+static gboolean apply_in_mainloop(gpointer)
+/* Push the newest pending state into the HUD (runs in GTK thread). */
+{
+    TRACE_SCOPE("hud_apply");
+
+    g_mutex_lock(&g_lock);
+    HudState st    = g_pending;
+    g_apply_queued = FALSE;
+    g_mutex_unlock(&g_lock);
 
-    /* Auto-hide after 1.5 s */
-    g_timeout_add(1500, hide_popup_callback, popup);
+    if (!g_popup)
+        popup_init();
 
-    free(message);
+    if (strcmp(st.text, g_shown.text) != 0)
+        gtk_label_set_text(GTK_LABEL(g_label), st.text);
+
+    if (st.level != g_shown.level) {
+        if (st.level >= 0) {
+            gtk_level_bar_set_value(GTK_LEVEL_BAR(g_bar), st.level);
+            gtk_widget_set_visible(g_bar, TRUE);
+        } else {
+            gtk_widget_set_visible(g_bar, FALSE);
+        }
+    }
+    g_shown = st;
+
+    if (!gtk_widget_get_visible(g_popup))
+        gtk_widget_show(g_popup);
+
+    /* Extend the hide deadline; the one timeout picks it up */
+    g_hide_at = g_get_monotonic_time() + POPUP_VISIBLE_MS * 1000;
+    if (!g_hide_tag) {
+        g_hide_tag = g_timeout_add(POPUP_VISIBLE_MS, hide_popup_callback, NULL);
+        g_source_set_name_by_id(g_hide_tag, "hud-hide");
+    }
     return G_SOURCE_REMOVE;
 }
 
-static gboolean hide_popup_callback(gpointer w)
-/* Destroy the popup and stop the timeout. */
+static gboolean hide_popup_callback(gpointer)
+/* Hide once the deadline has really passed, else wait for the rest. */
 {
-    gtk_widget_destroy(GTK_WIDGET(w));
+    gint64 remaining_ms = (g_hide_at - g_get_monotonic_time()) / 1000;
+
+    if (remaining_ms > 0) {
+        g_hide_tag = g_timeout_add((guint)remaining_ms, hide_popup_callback, NULL);
+        g_source_set_name_by_id(g_hide_tag, "hud-hide");
+    } else {
+        gtk_widget_hide(g_popup);
+        g_hide_tag = 0;
+    }
     return G_SOURCE_REMOVE;
 }
@@ -1,17 +1,39 @@
 /* =========================================================================
- *  Popup.h — tiny transient message window
+ *  Popup.h — single persistent HUD overlay
  * -------------------------------------------------------------------------
+ *  popup_init()
+ *      Builds the one HUD window (300 × 100 px, centered, hidden) at
+ *      startup.  Every later call only updates it in place.
+ *
+ *  popup_show_mode(mode)
+ *      Shows the knob mode ("Volume" / "Brightness") together with the
+ *      last level reported for that mode, if any.
+ *
+ *  popup_show_level(mode, percent)
+ *      Shows the mode plus a live 0-100 % bar — fed by knob movement.
+ *
  *  show_temp_popup(message)
- *      Creates a 300 × 100 px window with large white text centered on
- *      screen.  The popup disappears automatically after ~1.5 s.
+ *      Shows a plain text message (no bar).
  *
- *      Thread-safe: if this function is called from a non-GTK thread
- *      (e.g., rotary-encoder ISR thread), the popup is scheduled on the
- *      GTK main loop via g_idle_add().
+ *  The HUD hides itself ~1.5 s after the *last* event; new events extend
+ *  the timeout instead of stacking windows.  While hidden it owns no
+ *  timers or idles.
+ *
+ *  Thread-safe: all functions may be called from a non-GTK thread (e.g.,
+ *  rotary-encoder ISR thread).  Bursts coalesce into a single idle
+ *  callback on the GTK main loop that applies only the latest state.
  * ========================================================================= */
 #ifndef POPUP_H
 #define POPUP_H
 
-void show_temp_popup(const char *message);
+typedef enum {
+    HUD_MODE_VOLUME,
+    HUD_MODE_BRIGHTNESS,
+} HudMode;
+
+void popup_init      (void);
+void popup_show_mode (HudMode mode);
+void popup_show_level(HudMode mode, int percent);
+void show_temp_popup (const char *message);
 
 #endif /* POPUP_H */
@@ -0,0 +1,510 @@
+/* =========================================================================
+ *  Publisher.c — vehicle data → MQTT, with a bounded on-disk spool
+ * -------------------------------------------------------------------------
+ *  GTK thread
+ *      publisher_feed() appends each sample to its PID's `fill` buffer
+ *      and, if that crossed PUBLISH_FLUSH_BYTES, wakes the thread.
+ *
+ *  Publisher thread ("mqtt-publish")
+ *      Sleeps until the oldest batch is flush_ms old, a batch is full,
+ *      the spool has something to replay or a keepalive is due.  Under
+ *      the lock it only swaps the due `fill` buffers with its own empty
+ *      `send` buffers; publishing happens after the lock is dropped.
+ *      A batch that cannot be published (no broker, PUBACK timeout) is
+ *      appended to the spool instead.  Reconnects are tried every
+ *      RETRY_INTERVAL_SEC, and then SPOOL_REPLAY_BATCH spooled messages
+ *      go out per pass, so live batches never wait behind a long spool.
+ *
+ *  Spool
+ *      <cache>/vroom/mqtt-spool/<seq>.seg, seq in hex so the names sort
+ *      oldest first.  Each record is a 2-byte topic length and a 4-byte
+ *      payload length (big endian), then topic and payload, written with
+ *      one writev().  A segment is closed at SPOOL_SEGMENT_BYTES; the
+ *      oldest is deleted while the total is over PUBLISH_SPOOL_MAX.  A
+ *      torn record at the end of a segment (power cut) ends its replay.
+ * ========================================================================= */
+#include "Publisher.h"
+#include "Mqtt.h"
+#include "Metrics.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+static const char TOPIC_PREFIX[] = "vroom/pid/";
+
+enum {
+    RETRY_INTERVAL_SEC  = 10,
+    KEEPALIVE_SEC       = 60,           /* ping after half of it idle    */
+    SPOOL_SEGMENT_BYTES = 1024 * 1024,
+    SPOOL_REPLAY_BATCH  = 32,           /* spooled messages per pass     */
+    SPOOL_RECORD_HEADER = 6,
+};
+
+/* ------------------------------------------------------------------ */
+/*  State                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    gchar    *topic;
+    GString  *fill;                     /* GTK side, under `lock`        */
+    gint64    first_us;                 /* monotonic, first sample in fill */
+    gint64    last_ms;                  /* wall clock, last sample in fill */
+    GString  *send;                     /* thread side                   */
+} PubBatch;
+
+typedef struct {
+    guint64   seq;
+    gsize     size;
+} SpoolSegment;
+
+typedef struct {
+    /* Configuration (main) */
+    gchar        *broker;
+    guint64       pids;
+    guint         flush_ms;
+    GThread      *thread;
+
+    /* Shared, under `lock` */
+    GMutex        lock;
+    GCond         wake;
+    gboolean      stop;
+    gboolean      full;                 /* a batch reached FLUSH_BYTES */
+    PubBatch      batch[PID_COUNT];
+
+    /* Publisher thread only */
+    MqttClient   *client;
+    gint64        retry_us;             /* next connect attempt */
+    gint64        last_io_us;
+    gchar        *spool_dir;
+    GQueue        segments;             /* SpoolSegment *, oldest first */
+    gsize         spool_bytes;
+    guint64       next_seq;
+    int           spool_fd;             /* newest segment, −1 = closed */
+    gchar        *replay;               /* oldest segment, being replayed */
+    gsize         replay_len, replay_off;
+} Publisher;
+
+static Publisher g_pub = { .spool_fd = -1 };
+
+/* ------------------------------------------------------------------ */
+/*  Forward declarations                                              */
+/* ------------------------------------------------------------------ */
+static gpointer publisher_thread(gpointer);
+static gint64   next_wake       (gint64 now_us);
+static gboolean publish         (const char *topic, const char *payload, gsize len);
+static void     keep_alive      (gint64 now_us);
+static void     spool_open      (void);
+static void     spool_append    (const char *topic, const char *payload, gsize len);
+static void     spool_replay    (void);
+static void     spool_close     (void);
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+gboolean publisher_configure(const char *broker, const char *pid_names,
+                             guint flush_ms)
+{
+    guint64   mask  = 0;
+    gchar   **names = g_strsplit(pid_names ? pid_names : PUBLISH_DEFAULT_PIDS, ",", -1);
+    gboolean  ok    = TRUE;
+
+    for (guint i = 0; ok && names[i]; i++) {
+        const gchar *want = g_strstrip(names[i]);
+        if (!*want) continue;
+
+        gint id = pid_lookup(want);
+        if (id < 0) {
+            g_printerr("[MQTT] unknown PID '%s'\n", want);
+            ok = FALSE;
+        } else {
+            mask |= G_GUINT64_CONSTANT(1) << id;
+        }
+    }
+    g_strfreev(names);
+    if (!ok)
+        return FALSE;
+
+    g_free(g_pub.broker);
+    g_pub.broker   = g_strdup(broker);
+    g_pub.pids     = mask;
+    g_pub.flush_ms = flush_ms ? flush_ms : PUBLISH_FLUSH_MS;
+    return TRUE;
+}
+
+guint64 publisher_pid_mask(void)
+{
+    return g_pub.broker ? g_pub.pids : 0;
+}
+
+void publisher_start(void)
+{
+    if (!g_pub.broker || g_pub.thread)
+        return;
+
+    for (guint p = 0; p < PID_COUNT; p++) {
+        PubBatch *b = &g_pub.batch[p];
+        gchar    *name = g_ascii_strdown(PID_TABLE[p].name, -1);
+        g_strdelimit(name, " ", '_');
+        b->topic = g_strconcat(TOPIC_PREFIX, name, NULL);
+        b->fill  = g_string_sized_new(PUBLISH_FLUSH_BYTES + 64);
+        b->send  = g_string_sized_new(PUBLISH_FLUSH_BYTES + 64);
+        g_free(name);
+    }
+    spool_open();
+    g_pub.thread = g_thread_new("mqtt-publish", publisher_thread, NULL);
+}
+
+void publisher_feed(const ObdFrame *frame)
+{
+    if (!g_pub.thread)
+        return;
+
+    gint64   now_us = g_get_monotonic_time();
+    gint64   now_ms = g_get_real_time() / 1000;
+    gboolean full   = FALSE;
+    guint    n      = 0;
+    gchar    text[64];
+
+    g_mutex_lock(&g_pub.lock);
+    for (guint p = 0; p < PID_COUNT; p++) {
+        if (!(frame->present & (G_GUINT64_CONSTANT(1) << p)))
+            continue;
+        PubBatch *b = &g_pub.batch[p];
+        if (b->fill->len >= PUBLISH_BATCH_MAX) {
+            metrics_inc(METRIC_MQTT_DROPPED);
+            continue;
+        }
+
+        gchar value[G_ASCII_DTOSTR_BUF_SIZE];
+        g_ascii_formatd(value, sizeof value, "%.7g", frame->value[p]);
+        int len;
+        if (b->fill->len) {
+            len = snprintf(text, sizeof text, " +%" G_GINT64_FORMAT ":%s",
+                           now_ms - b->last_ms, value);
+        } else {
+            len = snprintf(text, sizeof text, "%" G_GINT64_FORMAT ":%s", now_ms, value);
+            b->first_us = now_us;
+        }
+        g_string_append_len(b->fill, text, MIN(len, (int)sizeof text - 1));
+        b->last_ms = now_ms;
+        full |= b->fill->len >= PUBLISH_FLUSH_BYTES;
+        n++;
+    }
+    if (full) {
+        g_pub.full = TRUE;
+        g_cond_signal(&g_pub.wake);
+    }
+    g_mutex_unlock(&g_pub.lock);
+    metrics_add(METRIC_MQTT_SAMPLES, n);
+}
+
+void publisher_shutdown(void)
+{
+    if (!g_pub.thread)
+        return;
+
+    g_mutex_lock(&g_pub.lock);
+    g_pub.stop = TRUE;
+    g_cond_signal(&g_pub.wake);
+    g_mutex_unlock(&g_pub.lock);
+    g_thread_join(g_pub.thread);
+    g_pub.thread = NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Publisher thread                                                  */
+/* ------------------------------------------------------------------ */
+static gpointer publisher_thread(gpointer)
+{
+    guint taken[PID_COUNT];
+
+    for (;;) {
+        g_mutex_lock(&g_pub.lock);
+        gint64 wake_at = next_wake(g_get_monotonic_time());
+        while (!g_pub.stop && !g_pub.full
+               && g_cond_wait_until(&g_pub.wake, &g_pub.lock, wake_at))
+            ;
+
+        /* Swap out every batch that is full, old enough, or — on
+         * shutdown — not empty. */
+        gboolean stopping = g_pub.stop;
+        gint64   now      = g_get_monotonic_time();
+        guint    n        = 0;
+        for (guint p = 0; p < PID_COUNT; p++) {
+            PubBatch *b = &g_pub.batch[p];
+            if (!b->fill->len)
+                continue;
+            if (stopping || b->fill->len >= PUBLISH_FLUSH_BYTES
+                    || now - b->first_us >= (gint64)g_pub.flush_ms * 1000) {
+                GString *s = b->send;
+                b->send = b->fill;
+                b->fill = s;
+                taken[n++] = p;
+            }
+        }
+        g_pub.full = FALSE;
+        g_mutex_unlock(&g_pub.lock);
+
+        for (guint i = 0; i < n; i++) {
+            PubBatch *b = &g_pub.batch[taken[i]];
+            if (!publish(b->topic, b->send->str, b->send->len))
+                spool_append(b->topic, b->send->str, b->send->len);
+            g_string_truncate(b->send, 0);
+        }
+        if (stopping)
+            break;
+        spool_replay();
+        keep_alive(g_get_monotonic_time());
+    }
+
+    mqtt_close(g_pub.client);
+    g_pub.client = NULL;
+    metrics_set(METRIC_MQTT_CONNECTED, 0);
+    spool_close();
+    return NULL;
+}
+
+static gint64 next_wake(gint64 now_us)
+/* Under `lock`: when the thread has something to do next. */
+{
+    gint64 wake = now_us + (gint64)g_pub.flush_ms * 1000;
+    for (guint p = 0; p < PID_COUNT; p++)
+        if (g_pub.batch[p].fill->len)
+            wake = MIN(wake, g_pub.batch[p].first_us + (gint64)g_pub.flush_ms * 1000);
+
+    if (!g_queue_is_empty(&g_pub.segments))
+        wake = MIN(wake, g_pub.client ? now_us : g_pub.retry_us);
+    if (g_pub.client)
+        wake = MIN(wake, g_pub.last_io_us + KEEPALIVE_SEC * G_USEC_PER_SEC / 2);
+    return wake;
+}
+
+static gboolean connect_broker(gint64 now_us)
+{
+    if (g_pub.client)
+        return TRUE;
+    if (now_us < g_pub.retry_us)
+        return FALSE;
+
+    gchar *id = g_strdup_printf("vroom-%d", (int)getpid());
+    g_pub.client = mqtt_connect(g_pub.broker, id, KEEPALIVE_SEC);
+    g_free(id);
+    if (!g_pub.client) {
+        g_pub.retry_us = now_us + RETRY_INTERVAL_SEC * G_USEC_PER_SEC;
+        return FALSE;
+    }
+    g_print("[MQTT] connected to %s, %zu KiB spooled\n",
+            g_pub.broker, g_pub.spool_bytes / 1024);
+    g_pub.last_io_us = now_us;
+    metrics_set(METRIC_MQTT_CONNECTED, 1);
+    return TRUE;
+}
+
+static void drop_broker(void)
+{
+    g_printerr("[MQTT] lost %s; spooling to %s\n", g_pub.broker, g_pub.spool_dir);
+    mqtt_close(g_pub.client);
+    g_pub.client   = NULL;
+    g_pub.retry_us = g_get_monotonic_time() + RETRY_INTERVAL_SEC * G_USEC_PER_SEC;
+    metrics_set(METRIC_MQTT_CONNECTED, 0);
+}
+
+static gboolean publish(const char *topic, const char *payload, gsize len)
+{
+    gint64 t0 = g_get_monotonic_time();
+    if (!connect_broker(t0))
+        return FALSE;
+    if (!mqtt_publish(g_pub.client, topic, payload, len, 1)) {
+        drop_broker();
+        return FALSE;
+    }
+    g_pub.last_io_us = g_get_monotonic_time();
+    metrics_observe_us(METRIC_MQTT_PUBLISH_TIME, g_pub.last_io_us - t0);
+    metrics_inc(METRIC_MQTT_MESSAGES);
+    metrics_add(METRIC_MQTT_BYTES, (gint64)len);
+    return TRUE;
+}
+
+static void keep_alive(gint64 now_us)
+{
+    if (!g_pub.client
+            || now_us - g_pub.last_io_us < KEEPALIVE_SEC * G_USEC_PER_SEC / 2)
+        return;
+    if (mqtt_ping(g_pub.client))
+        g_pub.last_io_us = g_get_monotonic_time();
+    else
+        drop_broker();
+}
+
+/* ------------------------------------------------------------------ */
+/*  Spool                                                             */
+/* ------------------------------------------------------------------ */
+static gchar *segment_path(guint64 seq)
+{
+    gchar name[32];
+    g_snprintf(name, sizeof name, "%016" G_GINT64_MODIFIER "x.seg", seq);
+    return g_build_filename(g_pub.spool_dir, name, NULL);
+}
+
+static gint compare_segments(gconstpointer a, gconstpointer b, gpointer)
+{
+    guint64 x = ((const SpoolSegment *)a)->seq, y = ((const SpoolSegment *)b)->seq;
+    return x < y ? -1 : x > y;
+}
+
+static void spool_open(void)
+/* Pick up segments left by an earlier run (the broker was away). */
+{
+    g_pub.spool_dir = g_build_filename(g_get_user_cache_dir(), "vroom",
+                                       "mqtt-spool", NULL);
+    if (g_mkdir_with_parents(g_pub.spool_dir, 0700) != 0)
+        g_printerr("[MQTT] %s: %s\n", g_pub.spool_dir, g_strerror(errno));
+
+    GDir *dir = g_dir_open(g_pub.spool_dir, 0, NULL);
+    for (const gchar *name; dir && (name = g_dir_read_name(dir)); ) {
+        gchar  *end;
+        guint64 seq = g_ascii_strtoull(name, &end, 16);
+        if (end == name || strcmp(end, ".seg") != 0)
+            continue;
+
+        gchar   *path = segment_path(seq);
+        GStatBuf st;
+        if (g_stat(path, &st) == 0) {
+            SpoolSegment *seg = g_new(SpoolSegment, 1);
+            *seg = (SpoolSegment){ seq, (gsize)st.st_size };
+            g_queue_insert_sorted(&g_pub.segments, seg, compare_segments, NULL);
+            g_pub.spool_bytes += seg->size;
+            g_pub.next_seq     = MAX(g_pub.next_seq, seq + 1);
+        }
+        g_free(path);
+    }
+    if (dir)
+        g_dir_close(dir);
+    metrics_set(METRIC_MQTT_SPOOL_BYTES, (gint64)g_pub.spool_bytes);
+}
+
+static void close_segment(void)
+{
+    if (g_pub.spool_fd >= 0) {
+        close(g_pub.spool_fd);
+        g_pub.spool_fd = -1;
+    }
+}
+
+static void drop_oldest(void)
+/* Remove the oldest segment — replayed, or evicted to stay in budget. */
+{
+    SpoolSegment *seg = g_queue_pop_head(&g_pub.segments);
+    if (g_queue_is_empty(&g_pub.segments))
+        close_segment();                /* it was also the newest */
+
+    gchar *path = segment_path(seg->seq);
+    g_unlink(path);
+    g_free(path);
+    g_pub.spool_bytes -= seg->size;
+    g_free(seg);
+
+    g_clear_pointer(&g_pub.replay, g_free);
+    g_pub.replay_len = g_pub.replay_off = 0;
+    metrics_set(METRIC_MQTT_SPOOL_BYTES, (gint64)g_pub.spool_bytes);
+}
+
+static void spool_append(const char *topic, const char *payload, gsize len)
+{
+    SpoolSegment *tail = g_queue_peek_tail(&g_pub.segments);
+    if (g_pub.spool_fd < 0 || !tail || tail->size >= SPOOL_SEGMENT_BYTES) {
+        close_segment();
+        gchar *path = segment_path(g_pub.next_seq);
+        g_pub.spool_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+        g_free(path);
+        if (g_pub.spool_fd < 0) {
+            g_printerr("[MQTT] spool: %s\n", g_strerror(errno));
+            metrics_inc(METRIC_MQTT_DROPPED);
+            return;
+        }
+        tail  = g_new(SpoolSegment, 1);
+        *tail = (SpoolSegment){ g_pub.next_seq++, 0 };
+        g_queue_push_tail(&g_pub.segments, tail);
+    }
+
+    gsize  tlen = strlen(topic);
+    guint8 head[SPOOL_RECORD_HEADER] = {
+        tlen >> 8, tlen, len >> 24, len >> 16, len >> 8, len,
+    };
+    struct iovec iov[] = {
+        { head, sizeof head }, { (void *)topic, tlen }, { (void *)payload, len },
+    };
+    ssize_t w = writev(g_pub.spool_fd, iov, G_N_ELEMENTS(iov));
+    if (w < 0) {
+        g_printerr("[MQTT] spool: %s\n", g_strerror(errno));
+        metrics_inc(METRIC_MQTT_DROPPED);
+        return;
+    }
+    tail->size        += (gsize)w;
+    g_pub.spool_bytes += (gsize)w;
+
+    while (g_pub.spool_bytes > PUBLISH_SPOOL_MAX && g_pub.segments.length > 1) {
+        metrics_inc(METRIC_MQTT_SPOOL_EVICTED);
+        drop_oldest();
+    }
+    metrics_set(METRIC_MQTT_SPOOL_BYTES, (gint64)g_pub.spool_bytes);
+}
+
+static void spool_replay(void)
+{
+    if (g_queue_is_empty(&g_pub.segments)
+            || !connect_broker(g_get_monotonic_time()))
+        return;
+
+    for (guint n = 0; n < SPOOL_REPLAY_BATCH && g_pub.client; ) {
+        SpoolSegment *seg = g_queue_peek_head(&g_pub.segments);
+        if (!seg)
+            return;
+
+        if (!g_pub.replay) {
+            if (g_pub.segments.length == 1)
+                close_segment();        /* new batches start a new file */
+            gchar *path = segment_path(seg->seq);
+            if (!g_file_get_contents(path, &g_pub.replay, &g_pub.replay_len, NULL))
+                g_pub.replay = g_strdup("");
+            g_pub.replay_off = 0;
+            g_free(path);
+        }
+
+        const guint8 *r    = (const guint8 *)g_pub.replay + g_pub.replay_off;
+        gsize         left = g_pub.replay_len - g_pub.replay_off;
+        gsize         tlen = left >= SPOOL_RECORD_HEADER ? (gsize)r[0] << 8 | r[1] : 0;
+        gsize         plen = left >= SPOOL_RECORD_HEADER
+                           ? (gsize)r[2] << 24 | (gsize)r[3] << 16 | (gsize)r[4] << 8 | r[5] : 0;
+        if (left < SPOOL_RECORD_HEADER || !tlen
+                || left - SPOOL_RECORD_HEADER < tlen + plen) {
+            drop_oldest();              /* replayed (or torn at the end) */
+            continue;
+        }
+
+        gchar *topic = g_strndup((const gchar *)r + SPOOL_RECORD_HEADER, tlen);
+        gboolean ok  = publish(topic, (const gchar *)r + SPOOL_RECORD_HEADER + tlen, plen);
+        g_free(topic);
+        if (!ok)
+            return;                     /* resume here after the reconnect */
+        g_pub.replay_off += SPOOL_RECORD_HEADER + tlen + plen;
+        n++;
+    }
+}
+
+static void spool_close(void)
+{
+    close_segment();
+    g_clear_pointer(&g_pub.replay, g_free);
+    g_queue_clear_full(&g_pub.segments, g_free);
+    g_pub.spool_bytes = 0;
+}
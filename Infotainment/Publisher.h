@@ -0,0 +1,68 @@
+/* =========================================================================
+ *  Publisher.h — batched vehicle data to an MQTT broker, spooled offline
+ * -------------------------------------------------------------------------
+ *  publisher_configure(broker, pid_names, flush_ms)
+ *      Enables the publisher: "host[:port]" of the broker (Mqtt.h), the
+ *      PIDs to keep polling for it even when no screen shows them
+ *      (PidTable.def names; NULL = PUBLISH_DEFAULT_PIDS, "" = only what
+ *      is polled anyway) and the longest a sample may wait in a batch
+ *      (0 = PUBLISH_FLUSH_MS).  FALSE on a bad PID list.
+ *
+ *  publisher_pid_mask()
+ *      Those PIDs (bit i = PidId i); 0 unless configured.  Telemetry
+ *      polls them for the whole session, like the alert PIDs.
+ *
+ *  publisher_start()
+ *      Opens the spool and starts the publisher thread.  No-op unless
+ *      configured.
+ *
+ *  publisher_feed(frame)
+ *      Adds every PID in `frame` to its topic's batch; Telemetry calls it
+ *      for each decoded frame.  Never waits on the network: it appends
+ *      text under a lock the thread holds only to swap buffers.  Samples
+ *      for a batch already at PUBLISH_BATCH_MAX (the thread is stuck on
+ *      a dead broker) are dropped and counted.
+ *
+ *  publisher_shutdown()
+ *      Publishes — or spools — whatever is batched and stops the thread.
+ *
+ *  Topics and payloads
+ *  -------------------
+ *      vroom/pid/<name>    lower-case PidTable.def name, spaces → '_'
+ *                          ("vroom/pid/rpm", "vroom/pid/coolant_temp")
+ *
+ *      1729350000123:812.5 +200:815 +201:818.25
+ *          wall-clock ms of the first sample : value in the PID's unit,
+ *          then ms since the previous sample : value.  C locale.
+ *
+ *      A batch is published (QoS 1) when it reaches PUBLISH_FLUSH_BYTES
+ *      or its first sample is flush_ms old.  While the broker is
+ *      unreachable batches go to a spool of append-only segment files in
+ *      ~/.cache/vroom/mqtt-spool, capped at PUBLISH_SPOOL_MAX bytes by
+ *      deleting the oldest segment.  After a reconnect the spool is
+ *      replayed oldest first between live batches, so spooled messages
+ *      arrive after newer live ones — order by the timestamps.  Delivery
+ *      is at least once: a crash mid-replay resends that segment.
+ *
+ *  publisher_feed() on the GTK thread; the rest from main().
+ * ========================================================================= */
+#ifndef PUBLISHER_H
+#define PUBLISHER_H
+
+#include <glib.h>
+#include "ObdFrame.h"
+
+#define PUBLISH_DEFAULT_PIDS  "SPEED,RPM,COOLANT TEMP,FUEL LEVEL"
+#define PUBLISH_FLUSH_MS      1000
+#define PUBLISH_FLUSH_BYTES   1024
+#define PUBLISH_BATCH_MAX     (64 * 1024)
+#define PUBLISH_SPOOL_MAX     (32 * 1024 * 1024)
+
+gboolean publisher_configure(const char *broker, const char *pid_names,
+                             guint flush_ms);
+guint64  publisher_pid_mask (void);
+void     publisher_start    (void);
+void     publisher_feed     (const ObdFrame *frame);
+void     publisher_shutdown (void);
+
+#endif /* PUBLISHER_H */
@@ -0,0 +1,44 @@
+/* =========================================================================
+ *  Quadrature.h — pure state decode for the rotary encoder
+ * -------------------------------------------------------------------------
+ *  quad_decode(state, curAB)
+ *      Feeds one A/B sample (bit 1 = A, bit 0 = B) into the decoder.
+ *      Invalid transitions (both pins changed, i.e. a missed edge) and
+ *      repeats count as zero.  Four valid steps in one direction make a
+ *      detent:
+ *          returns +1  detent "up"   (volume / brightness up)
+ *          returns −1  detent "down"
+ *          returns  0  no complete detent yet
+ *
+ *  Kept free of I/O and inline so the ISR and the microbenchmarks share
+ *  exactly the same code.
+ * ========================================================================= */
+#ifndef QUADRATURE_H
+#define QUADRATURE_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t last_ab;        /* previous A/B sample          */
+    int8_t  acc;            /* valid steps since last detent */
+} QuadState;
+
+/* Indexed by (lastAB << 2) | curAB */
+static const int8_t QUAD_STEP[16] = {
+     0, +1, -1,  0,
+    -1,  0,  0, +1,
+    +1,  0,  0, -1,
+     0, -1, +1,  0,
+};
+
+static inline int quad_decode(QuadState *q, uint8_t cur_ab)
+{
+    q->acc    += QUAD_STEP[((q->last_ab << 2) | cur_ab) & 0xF];
+    q->last_ab = cur_ab;
+
+    if (q->acc <= -4) { q->acc = 0; return +1; }
+    if (q->acc >=  4) { q->acc = 0; return -1; }
+    return 0;
+}
+
+#endif /* QUADRATURE_H */
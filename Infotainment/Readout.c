@@ -0,0 +1,147 @@
+/* =========================================================================
+ *  Readout.c — fixed-width numeric value widget for the PID grid
+ * -------------------------------------------------------------------------
+ *  • A GtkDrawingArea with one PangoLayout, built once.  Digits use the
+ *    font's tabular figures ("tnum"), so every digit has one advance and
+ *    812 → 814 never changes the text width.
+ *  • The size request is set once, from the widest text the PID can show:
+ *    its decoder is run over every byte value 0x00-0xFF, each result is
+ *    formatted and turned into a digit template ("215 °C" → "000 °C"),
+ *    and each distinct template is measured.
+ *  • An update replaces the layout's text and invalidates this widget
+ *    only — no markup parse, no size request, no grid relayout.  A
+ *    GtkLabel's set_markup does all three.
+ * ========================================================================= */
+#include "Readout.h"
+#include "ObdFrame.h"
+#include "Trace.h"
+
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  State                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    PidId        pid;
+    PangoLayout *layout;
+    GdkRGBA      color;
+    int          width;           /* reserved, px                   */
+    int          text_width;      /* of `shown`, px                 */
+    gchar        shown[32];
+} Readout;
+
+static GQuark g_readout_quark;
+
+/* ------------------------------------------------------------------ */
+/*  Helpers                                                           */
+/* ------------------------------------------------------------------ */
+static Readout *get_readout(GtkWidget *w)
+{
+    return g_object_get_qdata(G_OBJECT(w), g_readout_quark);
+}
+
+static void readout_free(gpointer data)
+{
+    Readout *rd = data;
+    g_clear_object(&rd->layout);
+    g_free(rd);
+}
+
+static int text_width(PangoLayout *layout, const char *text)
+{
+    int w;
+    pango_layout_set_text(layout, text, -1);
+    pango_layout_get_pixel_size(layout, &w, NULL);
+    return w;
+}
+
+static int widest_value(Readout *rd)
+/* Width of the widest digit template the PID's decoder can produce. */
+{
+    gchar   txt[sizeof rd->shown], last[sizeof rd->shown] = "";
+    guint8  data[PID_MAX_BYTES];
+    int     widest = text_width(rd->layout, "--");
+
+    for (guint b = 0; b <= 0xFF; b++) {
+        memset(data, (int)b, sizeof data);
+        obd_format_value(rd->pid, PID_TABLE[rd->pid].decode(data), txt, sizeof txt);
+        for (gchar *p = txt; *p; p++)
+            if (g_ascii_isdigit(*p))
+                *p = '0';
+        if (strcmp(txt, last) != 0) {             /* templates change rarely */
+            widest = MAX(widest, text_width(rd->layout, txt));
+            g_strlcpy(last, txt, sizeof last);
+        }
+    }
+    return widest;
+}
+
+static gboolean on_draw(GtkWidget *w, cairo_t *cr, gpointer)
+{
+    TRACE_SCOPE("readout_draw");
+    Readout *rd = get_readout(w);
+    gdk_cairo_set_source_rgba(cr, &rd->color);
+    cairo_move_to(cr, rd->width - rd->text_width, 0);   /* right-aligned */
+    pango_cairo_show_layout(cr, rd->layout);
+    return TRUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+GtkWidget *readout_new(PidId pid, const char *font, const char *color)
+{
+    if (!g_readout_quark)
+        g_readout_quark = g_quark_from_static_string("vroom-readout");
+
+    GtkWidget *area = gtk_drawing_area_new();
+    Readout   *rd   = g_new0(Readout, 1);
+    rd->pid = pid;
+    if (!gdk_rgba_parse(&rd->color, color))
+        rd->color = (GdkRGBA){ 1, 1, 1, 1 };
+    g_object_set_qdata_full(G_OBJECT(area), g_readout_quark, rd, readout_free);
+
+    rd->layout = gtk_widget_create_pango_layout(area, NULL);
+    PangoFontDescription *fd    = pango_font_description_from_string(font);
+    PangoAttrList        *attrs = pango_attr_list_new();
+    pango_attr_list_insert(attrs, pango_attr_font_features_new("tnum 1"));
+    pango_layout_set_font_description(rd->layout, fd);
+    pango_layout_set_attributes(rd->layout, attrs);
+    pango_attr_list_unref(attrs);
+    pango_font_description_free(fd);
+
+    int height;
+    rd->width = widest_value(rd);
+    g_strlcpy(rd->shown, "--", sizeof rd->shown);
+    rd->text_width = text_width(rd->layout, rd->shown);
+    pango_layout_get_pixel_size(rd->layout, NULL, &height);
+
+    gtk_widget_set_size_request(area, rd->width, height);
+    g_signal_connect(area, "draw", G_CALLBACK(on_draw), NULL);
+    return area;
+}
+
+void readout_set_value(GtkWidget *readout, gdouble value)
+{
+    Readout *rd = get_readout(readout);
+    gchar    txt[sizeof rd->shown];
+    obd_format_value(rd->pid, value, txt, sizeof txt);
+    readout_set_text(readout, txt);
+}
+
+void readout_set_text(GtkWidget *readout, const char *text)
+{
+    Readout *rd = get_readout(readout);
+    if (!strcmp(rd->shown, text))
+        return;
+    g_strlcpy(rd->shown, text, sizeof rd->shown);
+    rd->text_width = text_width(rd->layout, rd->shown);
+
+    if (rd->text_width > rd->width) {             /* outside the decoder's range */
+        int height;
+        pango_layout_get_pixel_size(rd->layout, NULL, &height);
+        rd->width = rd->text_width;
+        gtk_widget_set_size_request(readout, rd->width, height);
+    }
+    gtk_widget_queue_draw(readout);
+}
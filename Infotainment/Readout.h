@@ -0,0 +1,32 @@
+/* =========================================================================
+ *  Readout.h — fixed-width numeric value widget for the PID grid
+ * -------------------------------------------------------------------------
+ *  readout_new(pid, font, color)
+ *      A GtkDrawingArea showing one PID's value, right-aligned, in `font`
+ *      ("Sans 38") and `color` ("#00AAFF") with tabular digits.  Its size
+ *      is fixed at creation to the widest text the PID's decoder can
+ *      produce (PidTable.def), so a value change never resizes it or its
+ *      container.  Starts at "--".
+ *
+ *  readout_set_value(readout, value)
+ *      Formats `value` the way obd_format_value() does and shows it.
+ *
+ *  readout_set_text(readout, text)
+ *      Shows `text` ("--" …).  Unchanged text costs a strcmp; otherwise
+ *      the cached layout gets the new run and only this widget's area is
+ *      redrawn.  A text wider than the reserved width (a feed value
+ *      outside the decoder's range) grows the widget once.
+ *
+ *  GTK thread only.
+ * ========================================================================= */
+#ifndef READOUT_H
+#define READOUT_H
+
+#include <gtk/gtk.h>
+#include "PidTable.h"
+
+GtkWidget *readout_new      (PidId pid, const char *font, const char *color);
+void       readout_set_value(GtkWidget *readout, gdouble value);
+void       readout_set_text (GtkWidget *readout, const char *text);
+
+#endif /* READOUT_H */
@@ -4,11 +4,20 @@
  *  • A/B pins form a quadrature encoder; SW pin is a momentary button
  *  • Short press toggles “Volume mode” ↔ “Brightness mode”
  *  • Long press (≥1 s) sends SIGTERM to a running autoapp instance
- *  • Rotation adjusts volume (±5 %) or brightness (±5 units)
- *    and updates both the HUD popup and the Settings sliders.
+ *  • Rotation adjusts volume (±5 %) or brightness (±5 units), updates
+ *    the HUD level bar and publishes the result to DeviceState.h, which
+ *    the Settings sliders follow.  The mode lives there too.
+ *  • While the screen sleeps (IdleManager.h) the first detent or press
+ *    only wakes it.
+ *
+ *  Pin access goes through hal_input(); the wiringPi implementation at the
+ *  bottom of this file is the real backend (WIRINGPI_INPUT_BACKEND).
  * ========================================================================= */
 #include "RotaryEncoder.h"
+#include "Hal.h"
+#ifndef VROOM_NO_WIRINGPI
 #include <wiringPi.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -17,7 +26,12 @@
 #include "Popup.h"
 #include "AudioManager.h"
 #include "BacklightManager.h"
-#include "SettingsWindow.h"
+#include "DeviceState.h"
+#include "Trace.h"
+#include "Quadrature.h"
+#include "IdleManager.h"
+#include "Metrics.h"
+#include "EventLog.h"
 
 /* ---------------------------------------------------------------------- */
 /*  Constants                                                             */
@@ -33,12 +47,11 @@ static const int ROTARY_SW_PIN = 7;
 /* ---------------------------------------------------------------------- */
 /*  Module-wide state                                                     */
 /* ---------------------------------------------------------------------- */
-static volatile bool   g_isVolumeMode   = true;
 static volatile bool   g_buttonPressed  = false;
 static volatile time_t g_pressTimestamp = 0;
+static volatile bool   g_pressWoke      = false;  /* press only woke us */
 
-static volatile uint8_t lastAB = 0;
-static volatile int8_t  qAcc   = 0;
+static QuadState g_quad;
 
 /* Forward declarations for ISRs */
 static void rotary_isr (void);
@@ -49,27 +62,18 @@ static void button_isr (void);
 /* ---------------------------------------------------------------------- */
 void start_rotary_thread(void)
 {
-    if (wiringPiSetup() < 0) {
-        fprintf(stderr, "[Rotary] wiringPiSetup() failed.\n");
+    TRACE_SCOPE("start_rotary_thread");
+    const EncoderPins pins = {
+        .a = ROTARY_A_PIN, .b = ROTARY_B_PIN, .sw = ROTARY_SW_PIN,
+    };
+    const InputBackend *in = hal_input();
+
+    if (!in->start(&pins, rotary_isr, button_isr)) {
+        fprintf(stderr, "[Rotary] %s input backend failed to start.\n", in->name);
         return;
     }
 
-    pinMode(ROTARY_A_PIN,  INPUT);
-    pinMode(ROTARY_B_PIN,  INPUT);
-    pinMode(ROTARY_SW_PIN, INPUT);
-
-    pullUpDnControl(ROTARY_A_PIN,  PUD_UP);
-    pullUpDnControl(ROTARY_B_PIN,  PUD_UP);
-    pullUpDnControl(ROTARY_SW_PIN, PUD_UP);
-
-    lastAB = (digitalRead(ROTARY_A_PIN) << 1) | digitalRead(ROTARY_B_PIN);
-
-    if (wiringPiISR(ROTARY_A_PIN,  INT_EDGE_BOTH,  rotary_isr) < 0 ||
-        wiringPiISR(ROTARY_B_PIN,  INT_EDGE_BOTH,  rotary_isr) < 0 ||
-        wiringPiISR(ROTARY_SW_PIN, INT_EDGE_BOTH,  button_isr)  < 0)
-    {
-        fprintf(stderr, "[Rotary] Failed to attach one or more ISRs.\n");
-    }
+    g_quad.last_ab = (in->read_pin(ROTARY_A_PIN) << 1) | in->read_pin(ROTARY_B_PIN);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -77,6 +81,7 @@ void start_rotary_thread(void)
 /* ---------------------------------------------------------------------- */
 static inline void change_volume(int delta)
 {
+    TRACE_SCOPE("change_volume");
     const char *sink = get_current_sink();
     if (!sink) return;
 
@@ -86,17 +91,25 @@ static inline void change_volume(int delta)
     set_sink_volume_percent(sink, oldVol + delta);
 
     int finalVol = get_sink_volume_percent(sink);
-    if (finalVol >= 0)
-        settings_update_volume_slider(finalVol);
+    if (finalVol >= 0) {
+        TRACE_COUNTER("volume", finalVol);
+        EVLOG(KNOB_VOLUME, finalVol);
+        device_state_set_volume(finalVol);
+        popup_show_level(HUD_MODE_VOLUME, finalVol);
+    }
 }
 
 static inline void change_brightness(int delta)
 {
+    TRACE_SCOPE("change_brightness");
     int oldBri = read_backlight_brightness();
     set_backlight_brightness(oldBri + delta);
 
     int finalBri = read_backlight_brightness();
-    settings_update_brightness_slider(finalBri);
+    TRACE_COUNTER("brightness", finalBri);
+    EVLOG(KNOB_BRIGHTNESS, finalBri);
+    device_state_set_brightness(finalBri);
+    popup_show_level(HUD_MODE_BRIGHTNESS, finalBri * 100 / 31);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -104,35 +117,36 @@ static inline void change_brightness(int delta)
 /* ---------------------------------------------------------------------- */
 static void rotary_isr(void)
 {
-    uint8_t curAB      = (digitalRead(ROTARY_A_PIN) << 1) | digitalRead(ROTARY_B_PIN);
-    uint8_t transition = (lastAB << 2) | curAB;
-
-    int8_t dir = 0;
-    switch (transition) {
-        case 0x1: case 0x7: case 0xE: case 0x8: dir = +1; break;
-        case 0x2: case 0xB: case 0xD: case 0x4: dir = -1; break;
-        default: break;
+    TRACE_THREAD_NAME("rotary-isr");
+    TRACE_SCOPE("rotary_isr");
+    const InputBackend *in = hal_input();
+    uint8_t curAB = (in->read_pin(ROTARY_A_PIN) << 1) | in->read_pin(ROTARY_B_PIN);
+
+    int step = quad_decode(&g_quad, curAB);
+    if (step == 0)
+        return;                         /* mid-detent */
+
+    metrics_inc(METRIC_ENCODER_DETENTS);
+    if (idle_manager_note_input())
+        return;                         /* wake-up detent */
+
+    bool volume_mode = device_state_get().mode == DEVICE_MODE_VOLUME;
+    switch (step) {
+        case +1:
+            if (volume_mode)
+                change_volume(+VOLUME_STEP_PERCENT);
+            else
+                change_brightness(+BRIGHTNESS_STEP_ABSOLUTE);
+            break;
+        case -1:
+            if (volume_mode)
+                change_volume(-VOLUME_STEP_PERCENT);
+            else
+                change_brightness(-BRIGHTNESS_STEP_ABSOLUTE);
+            break;
+        default:
+            break;
     }
-
-    if (dir != 0)
-        qAcc += dir;
-
-    if (qAcc <= -4) {
-        qAcc = 0;
-        if (g_isVolumeMode)
-            change_volume(+VOLUME_STEP_PERCENT);
-        else
-            change_brightness(+BRIGHTNESS_STEP_ABSOLUTE);
-    }
-    else if (qAcc >= 4) {
-        qAcc = 0;
-        if (g_isVolumeMode)
-            change_volume(-VOLUME_STEP_PERCENT);
-        else
-            change_brightness(-BRIGHTNESS_STEP_ABSOLUTE);
-    }
-
-    lastAB = curAB;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -140,26 +154,89 @@ static void rotary_isr(void)
 /* ---------------------------------------------------------------------- */
 static void button_isr(void)
 {
-    int level = digitalRead(ROTARY_SW_PIN);
+    TRACE_THREAD_NAME("button-isr");
+    TRACE_SCOPE("button_isr");
+    int level = hal_input()->read_pin(ROTARY_SW_PIN);
 
     /* Release ------------------------------------------------------------ */
-    if (level == HIGH && g_buttonPressed) {
+    if (level == 1 && g_buttonPressed) {
         g_buttonPressed = false;
         double held = difftime(time(NULL), g_pressTimestamp);
 
-        if (held >= LONG_PRESS_THRESHOLD_SEC) {
+        if (g_pressWoke) {
+            /* Press woke the screen — nothing else to do */
+        } else if (held >= LONG_PRESS_THRESHOLD_SEC) {
             /* Long press → kill Android Auto if running */
-            if (system("pgrep -x autoapp >/dev/null") == 0)
+            if (system("pgrep -x autoapp >/dev/null") == 0) {
+                EVLOG(KNOB_LONG_PRESS);
                 system("pkill -TERM autoapp");
+            }
         } else {
             /* Short press → toggle mode + HUD popup */
-            g_isVolumeMode = !g_isVolumeMode;
-            show_temp_popup(g_isVolumeMode ? "Volume" : "Brightness");
+            TRACE_INSTANT("mode-toggle");
+            bool volume_mode = device_state_toggle_mode() == DEVICE_MODE_VOLUME;
+            EVLOG(KNOB_MODE, volume_mode ? "volume" : "brightness");
+            popup_show_mode(volume_mode ? HUD_MODE_VOLUME : HUD_MODE_BRIGHTNESS);
         }
     }
     /* Press -------------------------------------------------------------- */
-    else if (level == LOW && !g_buttonPressed) {
+    else if (level == 0 && !g_buttonPressed) {
         g_buttonPressed  = true;
         g_pressTimestamp = time(NULL);
+        g_pressWoke      = idle_manager_note_input();
+        metrics_inc(METRIC_ENCODER_PRESSES);
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/*  wiringPi backend                                                      */
+/* ---------------------------------------------------------------------- */
+#ifndef VROOM_NO_WIRINGPI
+static gboolean wpi_start(const EncoderPins *pins, PinIsr ab_isr, PinIsr sw_isr)
+{
+    if (wiringPiSetup() < 0) {
+        fprintf(stderr, "[Rotary] wiringPiSetup() failed.\n");
+        return FALSE;
+    }
+
+    const int all[] = { pins->a, pins->b, pins->sw };
+    for (size_t i = 0; i < G_N_ELEMENTS(all); ++i) {
+        pinMode(all[i], INPUT);
+        pullUpDnControl(all[i], PUD_UP);
+    }
+
+    if (wiringPiISR(pins->a,  INT_EDGE_BOTH, ab_isr) < 0 ||
+        wiringPiISR(pins->b,  INT_EDGE_BOTH, ab_isr) < 0 ||
+        wiringPiISR(pins->sw, INT_EDGE_BOTH, sw_isr) < 0)
+    {
+        fprintf(stderr, "[Rotary] Failed to attach one or more ISRs.\n");
+        return FALSE;
     }
+    return TRUE;
 }
+
+static int wpi_read_pin(int pin)
+{
+    return digitalRead(pin) == HIGH;
+}
+
+const InputBackend WIRINGPI_INPUT_BACKEND = {
+    .name     = "wiringPi",
+    .start    = wpi_start,
+    .read_pin = wpi_read_pin,
+};
+#else
+static gboolean nowpi_start(const EncoderPins *, PinIsr, PinIsr)
+{
+    fprintf(stderr, "[Rotary] built without wiringPi — use --simulate.\n");
+    return FALSE;
+}
+
+static int nowpi_read_pin(int) { return 1; }      /* idle, pulled up */
+
+const InputBackend WIRINGPI_INPUT_BACKEND = {
+    .name     = "none",
+    .start    = nowpi_start,
+    .read_pin = nowpi_read_pin,
+};
+#endif
@@ -4,9 +4,10 @@
  *  start_rotary_thread()
  *      Performs a one-shot GPIO setup:
  *          • configures A, B and SW pins as inputs with pull-ups
- *          • attaches wiringPi edge-triggered ISRs for rotation and press
+ *          • attaches edge-triggered ISRs for rotation and press
  *      Returns immediately — the rest of the work happens inside the
- *      interrupt handlers, so no additional threads are spawned.
+ *      interrupt handlers.  With the wiringPi backend no additional
+ *      threads are spawned; under --simulate a script thread drives them.
  * ========================================================================= */
 #ifndef ROTARYENCODER_H
 #define ROTARYENCODER_H
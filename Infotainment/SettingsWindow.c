@@ -10,14 +10,25 @@
  *
  *  Behaviour
  *  ---------
- *      • Sliders write through to AudioManager / BacklightManager.
- *      • Combo sets the default PulseAudio sink and syncs the volume slider.
- *      • Esc or Back closes the window.
+ *      • Built once at startup; opening / closing only shows / hides it.
+ *      • Sink list, volume and brightness are fetched by a worker task
+ *        (GTask) and applied on the GTK thread when they arrive.
+ *      • Sliders apply live while dragging through two ApplyChannels
+ *        (one write in flight, newest value wins, rate-capped), so the
+ *        pactl / sudo processes never run on the GTK thread.
+ *      • Combo sets the default PulseAudio sink and re-reads its volume
+ *        in a worker task too; only the newest pick is applied.
+ *      • Knob changes arrive through DeviceState.h: one coalesced dispatch
+ *        per main-loop idle with the latest volume / brightness.
+ *      • Esc or Back hides the window.
  *      • Cursor hidden for kiosk UX.
  * ========================================================================= */
 #include "SettingsWindow.h"
 #include "AudioManager.h"
 #include "BacklightManager.h"
+#include "ApplyChannel.h"
+#include "DeviceState.h"
+#include "Trace.h"
 
 #include <glib.h>
 #include <gdk/gdkkeysyms.h>
@@ -29,28 +40,106 @@
 /*  Forward declarations                                              */
 /* ------------------------------------------------------------------ */
 static gboolean on_key_press          (GtkWidget *, GdkEventKey *, gpointer);
+static gboolean on_delete_event       (GtkWidget *, GdkEvent *, gpointer);
 static void     hide_cursor_on_realize(GtkWidget *, gpointer);
 static void     on_back_clicked       (GtkButton *, gpointer);
-static gboolean on_bri_released       (GtkWidget *, GdkEventButton *, gpointer);
-static gboolean on_vol_released       (GtkWidget *, GdkEventButton *, gpointer);
+static void     on_bri_changed        (GtkRange *, gpointer);
+static void     on_vol_changed        (GtkRange *, gpointer);
+static void     on_settings_hide      (GtkWidget *, gpointer);
 static void on_settings_destroy(GtkWidget *, gpointer);
 static void     on_sink_changed       (GtkComboBoxText *, gpointer);
 
 static GtkWidget *create_img_button   (const char *path, int w, int h);
+static void       set_scale_quietly   (GtkWidget *scale, gdouble value);
+static GtkWidget *build_settings_window(GtkWindow *parent);
 
-/* Slider update helpers for the rotary encoder */
-typedef struct { int value; } IntVal;
-static gboolean update_bri_idle(gpointer);
-static gboolean update_vol_idle(gpointer);
+/* Asynchronous refresh of the dynamic widget contents */
+typedef struct {
+    GSList *sinks;            /* char* sink names                       */
+    gchar  *current_sink;     /* may be NULL                            */
+    int     volume;           /* 0-100, −1 if unknown                   */
+    int     brightness;       /* 0-31                                   */
+} SettingsSnapshot;
 
-/* Widget pointers the rotary code can poke */
-static GtkWidget *g_bri_scale = NULL;
-static GtkWidget *g_vol_scale = NULL;
+static void settings_refresh_async(void);
+static void settings_refresh_worker(GTask *, gpointer, gpointer, GCancellable *);
+static void on_settings_refresh_done(GObject *, GAsyncResult *, gpointer);
+static void settings_snapshot_free(gpointer);
+
+/* Sink combo → pactl on a worker, volume slider back on the GTK thread */
+typedef struct {
+    gchar *sink;
+    gint   serial;            /* g_sink_serial when it was picked     */
+} SinkPick;
+
+static void sink_pick_free(gpointer);
+static void sink_change_worker(GTask *, gpointer, gpointer, GCancellable *);
+static void on_sink_change_done(GObject *, GAsyncResult *, gpointer);
+
+/* Knob changes → sliders (GTK thread) */
+static void on_device_state(const DeviceState *, guint changed, gpointer);
+
+/* Pooled window + widget pointers (GTK thread only) */
+static GtkWidget *g_settings_win = NULL;
+static GtkWidget *g_bri_scale    = NULL;
+static GtkWidget *g_vol_scale    = NULL;
+static GtkWidget *g_sink_combo   = NULL;
+
+/* Bumped on every refresh so a slow, stale result never wins */
+static guint g_refresh_serial = 0;
+
+/* Bumped on every sink pick (read by the workers, hence atomic) */
+static gint  g_sink_serial    = 0;
+static GMutex g_sink_lock;            /* one set-default-sink at a time */
+
+/* Live-drag writers (created with the window) */
+static guint         g_apply_rate_hz = 15;
+static ApplyChannel *g_bri_apply     = NULL;
+static ApplyChannel *g_vol_apply     = NULL;
+
+static void apply_brightness(int raw_0_31, gpointer);
+static void apply_volume    (int pct_0_100, gpointer);
 
 /* ------------------------------------------------------------------ */
 /*  Public API                                                        */
 /* ------------------------------------------------------------------ */
-void open_settings_window(GtkWindow *parent)
+void settings_window_init(GtkWindow *parent)
+{
+    TRACE_SCOPE("settings_window_init");
+    if (g_settings_win)                 /* already built */
+        return;
+
+    g_settings_win = build_settings_window(parent);
+    device_state_subscribe(on_device_state,
+                           DEVICE_CHANGED_VOLUME | DEVICE_CHANGED_BRIGHTNESS, NULL);
+
+    /* Prefetch so the very first open already has real values */
+    settings_refresh_async();
+}
+
+void settings_set_apply_rate(guint max_rate_hz)
+{
+    g_apply_rate_hz = max_rate_hz;
+    if (g_bri_apply) apply_channel_set_max_rate(g_bri_apply, max_rate_hz);
+    if (g_vol_apply) apply_channel_set_max_rate(g_vol_apply, max_rate_hz);
+}
+
+GtkWidget *open_settings_window(GtkWindow *parent)
+{
+    TRACE_SCOPE("open_settings_window");
+    if (!g_settings_win)
+        settings_window_init(parent);
+
+    /* Paint immediately with whatever we have; fresh data follows */
+    gtk_window_present(GTK_WINDOW(g_settings_win));
+    settings_refresh_async();
+    return g_settings_win;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Window construction (runs once)                                   */
+/* ------------------------------------------------------------------ */
+static GtkWidget *build_settings_window(GtkWindow *parent)
 {
     GtkWidget *win = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(win), "Settings");
@@ -59,6 +148,8 @@ void open_settings_window(GtkWindow *parent)
     gtk_window_set_modal(GTK_WINDOW(win), TRUE);
 
     g_signal_connect(win, "key-press-event", G_CALLBACK(on_key_press), NULL);
+    g_signal_connect(win, "delete-event",    G_CALLBACK(on_delete_event), NULL);
+    g_signal_connect(win, "hide",            G_CALLBACK(on_settings_hide), NULL);
     g_signal_connect(win, "realize",        G_CALLBACK(hide_cursor_on_realize), NULL);
 
     /* Main vertical box */
@@ -86,26 +177,21 @@ void open_settings_window(GtkWindow *parent)
                                                     0, 100, 1);
     gtk_widget_set_name(bri_scale, "brightness-scale");
     gtk_widget_set_size_request(bri_scale, 600, -1);
-    int bri_raw = read_backlight_brightness();
-    gtk_range_set_value(GTK_RANGE(bri_scale), bri_raw * 100.0 / 31.0);
-    gtk_widget_add_events(bri_scale, GDK_BUTTON_RELEASE_MASK);
-    g_signal_connect(bri_scale, "button-release-event",
-                     G_CALLBACK(on_bri_released), NULL);
+    gtk_range_set_value(GTK_RANGE(bri_scale), 100.0);   /* until refreshed */
+    g_signal_connect(bri_scale, "value-changed",
+                     G_CALLBACK(on_bri_changed), NULL);
     gtk_grid_attach(GTK_GRID(grid), bri_scale, 1, 0, 1, 1);
     g_bri_scale = bri_scale;   /* save for rotary updates */
 
-    /* Row 1 — Audio sink combo -------------------------------------- */
+    /* Row 1 — Audio sink combo (filled by the refresh task) ---------- */
     GtkWidget *lbl_sink = gtk_label_new("Audio Output");
     gtk_widget_set_name(lbl_sink, "custom-label");
     gtk_grid_attach(GTK_GRID(grid), lbl_sink, 0, 1, 1, 1);
 
     GtkWidget *combo = gtk_combo_box_text_new();
-    GSList *sinks = get_audio_sinks();
-    for (GSList *l = sinks; l; l = l->next)
-        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), l->data);
-    g_slist_free_full(sinks, g_free);
-    g_signal_connect(combo, "changed", G_CALLBACK(on_sink_changed), bri_scale);
+    g_signal_connect(combo, "changed", G_CALLBACK(on_sink_changed), NULL);
     gtk_grid_attach(GTK_GRID(grid), combo, 1, 1, 1, 1);
+    g_sink_combo = combo;
 
     /* Row 2 — Volume slider ----------------------------------------- */
     GtkWidget *lbl_vol = gtk_label_new("Volume");
@@ -116,54 +202,111 @@ void open_settings_window(GtkWindow *parent)
                                                     0, 100, 1);
     gtk_widget_set_name(vol_scale, "volume-scale");
     gtk_widget_set_size_request(vol_scale, 600, -1);
-    const char *sink = get_current_sink();
-    int vol = sink ? get_sink_volume_percent(sink) : 0;
-    gtk_range_set_value(GTK_RANGE(vol_scale), vol);
-    gtk_widget_add_events(vol_scale, GDK_BUTTON_RELEASE_MASK);
-    g_signal_connect(vol_scale, "button-release-event",
-                     G_CALLBACK(on_vol_released), NULL);
+    g_signal_connect(vol_scale, "value-changed",
+                     G_CALLBACK(on_vol_changed), NULL);
     gtk_grid_attach(GTK_GRID(grid), vol_scale, 1, 2, 1, 1);
     g_vol_scale = vol_scale;
 
-    gtk_widget_show_all(win);
-    /* When the window is destroyed, invalidate the global slider handles */
+    g_bri_apply = apply_channel_new("bri-apply", apply_brightness, NULL,
+                                    g_apply_rate_hz);
+    g_vol_apply = apply_channel_new("vol-apply", apply_volume, NULL,
+                                    g_apply_rate_hz);
+
+    /* Children visible, toplevel hidden until open_settings_window() */
+    gtk_widget_show_all(vbox);
+    gtk_widget_realize(win);
+
+    /* If the window is ever destroyed, invalidate the global handles */
     g_signal_connect(win, "destroy", G_CALLBACK(on_settings_destroy), NULL);
+    return win;
 }
 
 /* ------------------------------------------------------------------ */
-/*  Rotary-encoder helpers                                            */
+/*  Asynchronous refresh                                              */
 /* ------------------------------------------------------------------ */
-void settings_update_brightness_slider(int raw_0_31)
+static void settings_refresh_async(void)
 {
-    IntVal *d = g_new(IntVal, 1); d->value = raw_0_31;
-    g_idle_add(update_bri_idle, d);
+    GTask *task = g_task_new(NULL, NULL, on_settings_refresh_done,
+                             GUINT_TO_POINTER(++g_refresh_serial));
+    /* Sink name captured here, not read by the worker */
+    g_task_set_task_data(task, g_strdup(get_current_sink()), g_free);
+    g_task_run_in_thread(task, settings_refresh_worker);
+    g_object_unref(task);
 }
-void settings_update_volume_slider(int pct_0_100)
+
+static void settings_refresh_worker(GTask *task, gpointer, gpointer sink,
+                                    GCancellable *)
+/* Worker thread: every pactl / sysfs round trip happens here. */
 {
-    IntVal *d = g_new(IntVal, 1); d->value = pct_0_100;
-    g_idle_add(update_vol_idle, d);
+    TRACE_THREAD_NAME("settings-worker");
+    TRACE_SCOPE("settings_refresh_worker");
+    SettingsSnapshot *snap = g_new0(SettingsSnapshot, 1);
+
+    snap->sinks        = get_audio_sinks();
+    snap->current_sink = g_strdup(sink);
+    snap->volume       = snap->current_sink
+                       ? get_sink_volume_percent(snap->current_sink) : -1;
+    snap->brightness   = read_backlight_brightness();
+
+    g_task_return_pointer(task, snap, settings_snapshot_free);
 }
 
-/* ------------------------------------------------------------------ */
-/*  Internal callbacks                                                */
-/* ------------------------------------------------------------------ */
-static gboolean update_bri_idle(gpointer data)
+static void on_settings_refresh_done(GObject *, GAsyncResult *res,
+                                     gpointer user_data)
+/* GTK thread: push the snapshot into the pooled widgets. */
 {
-    if (g_bri_scale && GTK_IS_RANGE(g_bri_scale))
-        gtk_range_set_value(GTK_RANGE(g_bri_scale),
-            ((IntVal*)data)->value * 100.0 / 31.0);   /* 0-31  →  0-100 % */
-    g_free(data);
-    return G_SOURCE_REMOVE;
+    TRACE_SCOPE("on_settings_refresh_done");
+    SettingsSnapshot *snap = g_task_propagate_pointer(G_TASK(res), NULL);
+    if (!snap)
+        return;
+
+    if (GPOINTER_TO_UINT(user_data) != g_refresh_serial || !g_settings_win) {
+        settings_snapshot_free(snap);    /* a newer refresh is in flight */
+        return;
+    }
+
+    if (g_bri_scale)
+        set_scale_quietly(g_bri_scale, snap->brightness * 100.0 / 31.0);
+    if (g_vol_scale && snap->volume >= 0)
+        set_scale_quietly(g_vol_scale, snap->volume);
+
+    if (g_sink_combo) {
+        /* Repopulating must not look like a user selection */
+        g_signal_handlers_block_by_func(g_sink_combo, on_sink_changed, NULL);
+        gtk_combo_box_text_remove_all(GTK_COMBO_BOX_TEXT(g_sink_combo));
+
+        int idx = 0, active = -1;
+        for (GSList *l = snap->sinks; l; l = l->next, idx++) {
+            gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(g_sink_combo),
+                                           l->data);
+            if (snap->current_sink && strcmp(l->data, snap->current_sink) == 0)
+                active = idx;
+        }
+        gtk_combo_box_set_active(GTK_COMBO_BOX(g_sink_combo), active);
+        g_signal_handlers_unblock_by_func(g_sink_combo, on_sink_changed, NULL);
+    }
+
+    settings_snapshot_free(snap);
 }
 
-/* Volume slider from rotary encoder */
-static gboolean update_vol_idle(gpointer data)
+static void settings_snapshot_free(gpointer p)
 {
-    if (g_vol_scale && GTK_IS_RANGE(g_vol_scale))
-        gtk_range_set_value(GTK_RANGE(g_vol_scale),
-            (gdouble)((IntVal*)data)->value);         /* already 0-100 % */
-    g_free(data);
-    return G_SOURCE_REMOVE;
+    SettingsSnapshot *snap = p;
+    g_slist_free_full(snap->sinks, g_free);
+    g_free(snap->current_sink);
+    g_free(snap);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Knob → sliders                                                    */
+/* ------------------------------------------------------------------ */
+static void on_device_state(const DeviceState *st, guint changed, gpointer)
+/* Only the newest values arrive, however fast the knob was spun. */
+{
+    if ((changed & DEVICE_CHANGED_BRIGHTNESS) && g_bri_scale && st->brightness >= 0)
+        set_scale_quietly(g_bri_scale, st->brightness * 100.0 / 31.0);  /* 0-31 → % */
+    if ((changed & DEVICE_CHANGED_VOLUME) && g_vol_scale && st->volume >= 0)
+        set_scale_quietly(g_vol_scale, st->volume);                    /* already % */
 }
 
 /* ------------------------------------------------------------------ */
@@ -171,20 +314,29 @@ static gboolean update_vol_idle(gpointer data)
 /* ------------------------------------------------------------------ */
 static void on_settings_destroy(GtkWidget *, gpointer)
 {
-    /* Widgets are gone — stop the rotary callbacks from touching them */
-    g_bri_scale = NULL;
-    g_vol_scale = NULL;
+    /* Widgets are gone — stop the state dispatch from touching them */
+    g_settings_win = NULL;
+    g_bri_scale    = NULL;
+    g_vol_scale    = NULL;
+    g_sink_combo   = NULL;
 }
 
 static gboolean on_key_press(GtkWidget *w, GdkEventKey *e, gpointer)
 {
     if (e->keyval == GDK_KEY_Escape) {
-        gtk_widget_destroy(w);
+        gtk_widget_hide(w);
         return TRUE;
     }
     return FALSE;
 }
 
+/* Window-manager close → keep the pooled window, just hide it */
+static gboolean on_delete_event(GtkWidget *w, GdkEvent *, gpointer)
+{
+    gtk_widget_hide(w);
+    return TRUE;
+}
+
 static void hide_cursor_on_realize(GtkWidget *w, gpointer)
 {
     GdkWindow *gw = gtk_widget_get_window(w);
@@ -192,51 +344,113 @@ static void hide_cursor_on_realize(GtkWidget *w, gpointer)
 
     GdkPixbuf *pb = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, 1, 1);
     gdk_pixbuf_fill(pb, 0);
-    // GdkCursor *c = gdk_cursor_new_from_pixbuf(d, pb, 0, 0);
-    // gdk_window_set_cursor(gw, c);
-    // g_object_unref(c);
     GdkCursor *c = gdk_cursor_new_from_pixbuf(d, pb, 0, 0);
-    gdk_window_set_cursor(gw, c);
+    gdk_window_set_cursor(gw, c);       /* the window keeps its own ref */
+    g_object_unref(c);
     g_object_unref(pb);
 }
 
 static void on_back_clicked(GtkButton *, gpointer win)
-{ gtk_widget_destroy(GTK_WIDGET(win)); }
+{ gtk_widget_hide(GTK_WIDGET(win)); }
 
-/* Brightness slider → BacklightManager */
-static gboolean on_bri_released(GtkWidget *s, GdkEventButton *, gpointer)
+/* Brightness slider → brightness ApplyChannel (never blocks) */
+static void on_bri_changed(GtkRange *s, gpointer)
 {
-    double pct = gtk_range_get_value(GTK_RANGE(s));
-    int raw = (int)(pct * 31.0 / 100.0 + 0.5);
-    set_backlight_brightness(raw);
-    return FALSE;
+    double pct = gtk_range_get_value(s);
+    apply_channel_submit(g_bri_apply, (int)(pct * 31.0 / 100.0 + 0.5));
 }
 
-/* Volume slider → AudioManager */
-static gboolean on_vol_released(GtkWidget *s, GdkEventButton *, gpointer)
+/* Volume slider → volume ApplyChannel (never blocks) */
+static void on_vol_changed(GtkRange *s, gpointer)
+{
+    apply_channel_submit(g_vol_apply, (int)(gtk_range_get_value(s) + 0.5));
+}
+
+/* Worker-thread side of the channels */
+static void apply_brightness(int raw_0_31, gpointer)
+{
+    set_backlight_brightness(raw_0_31);
+}
+
+static void apply_volume(int pct_0_100, gpointer)
 {
     const char *sink = get_current_sink();
-    if (sink) {
-        int val = (int)(gtk_range_get_value(GTK_RANGE(s)) + 0.5);
-        set_sink_volume_percent(sink, val);
-    }
-    return FALSE;
+    if (sink)
+        set_sink_volume_percent(sink, pct_0_100);
+}
+
+/* Leaving the screen → print drag-to-effect latency for this visit */
+static void on_settings_hide(GtkWidget *, gpointer)
+{
+    apply_channel_report(g_bri_apply);
+    apply_channel_report(g_vol_apply);
 }
 
-/* Sink combo → set default + refresh volume slider */
-static void on_sink_changed(GtkComboBoxText *c, gpointer vol_scale)
+/* Sink combo → set default + refresh volume slider, both off-thread */
+static void on_sink_changed(GtkComboBoxText *c, gpointer)
 {
+    TRACE_SCOPE("on_sink_changed");
     gchar *sink = gtk_combo_box_text_get_active_text(c);
     if (!sink) return;
 
-    set_default_sink(sink);
-    g_free(sink);
+    SinkPick *pick = g_new0(SinkPick, 1);
+    pick->sink   = sink;
+    pick->serial = g_atomic_int_add(&g_sink_serial, 1) + 1;
 
-    const char *cur = get_current_sink();
-    if (cur) {
-        int v = get_sink_volume_percent(cur);
-        gtk_range_set_value(GTK_RANGE(vol_scale), v);
+    GTask *task = g_task_new(NULL, NULL, on_sink_change_done,
+                             GINT_TO_POINTER(pick->serial));
+    g_task_set_task_data(task, pick, sink_pick_free);
+    g_task_run_in_thread(task, sink_change_worker);
+    g_object_unref(task);
+}
+
+static void sink_change_worker(GTask *task, gpointer, gpointer data,
+                               GCancellable *)
+/* Worker thread.  A pick superseded while it waited for the lock is
+ * skipped, so the newest one is always the last set-default-sink. */
+{
+    TRACE_THREAD_NAME("settings-worker");
+    TRACE_SCOPE("sink_change_worker");
+    SinkPick *pick   = data;
+    int       volume = -1;
+
+    g_mutex_lock(&g_sink_lock);
+    if (pick->serial == g_atomic_int_get(&g_sink_serial)) {
+        set_default_sink(pick->sink);
+        volume = get_sink_volume_percent(pick->sink);
     }
+    g_mutex_unlock(&g_sink_lock);
+
+    g_task_return_int(task, volume);
+}
+
+static void on_sink_change_done(GObject *, GAsyncResult *res,
+                                gpointer user_data)
+{
+    int volume = (int)g_task_propagate_int(G_TASK(res), NULL);
+    if (GPOINTER_TO_INT(user_data) != g_atomic_int_get(&g_sink_serial))
+        return;                          /* a newer pick is in flight */
+    if (g_vol_scale && volume >= 0)
+        set_scale_quietly(g_vol_scale, volume);
+}
+
+static void sink_pick_free(gpointer p)
+{
+    SinkPick *pick = p;
+    g_free(pick->sink);
+    g_free(pick);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Small helper: programmatic slider move (no write-back)            */
+/* ------------------------------------------------------------------ */
+static void set_scale_quietly(GtkWidget *scale, gdouble value)
+{
+    g_signal_handlers_block_by_func(scale, on_bri_changed, NULL);
+    g_signal_handlers_block_by_func(scale, on_vol_changed, NULL);
+    gtk_range_set_value(GTK_RANGE(scale), value);
+    g_signal_handlers_unblock_by_func(scale, on_vol_changed, NULL);
+    g_signal_handlers_unblock_by_func(scale, on_bri_changed, NULL);
 }
 
 /* ------------------------------------------------------------------ */
@@ -1,26 +1,33 @@
 /* =========================================================================
  *  SettingsWindow.h — full-screen volume / brightness dialog
  * -------------------------------------------------------------------------
- *  open_settings_window(parent)
- *      Creates a modal full-screen window with:
+ *  settings_window_init(parent)
+ *      Builds the (hidden) settings window once at startup:
  *          • Brightness slider   (0-31 → 0-100 %)
  *          • Volume slider       (0-100 %)
  *          • Audio-output combo  (lists PulseAudio sinks)
- *          • “Back” button       (closes the dialog)
+ *          • “Back” button       (hides the dialog)
+ *
+ *  open_settings_window(parent)
+ *      Shows the pooled window immediately and refreshes its sink list,
+ *      volume and brightness from a worker thread.  The widgets fill in
+ *      as soon as the (slow, pactl-based) queries return.  Returns the
+ *      window.
  *
- *  settings_update_brightness_slider(val_0-31)
- *  settings_update_volume_slider(val_0-100)
- *      Thread-safe helpers for the rotary encoder ISR.  They queue an
- *      idle callback so the sliders follow hardware changes in real time.
+ *  settings_set_apply_rate(hz)
+ *      Caps how often slider drags are written to pactl / sysfs (writes
+ *      run on worker threads; the newest value always wins).
+ *
+ *  The sliders follow knob changes published to DeviceState.h; bursts
+ *  reach them as one update with the latest values.
  * ========================================================================= */
 #ifndef SETTINGSWINDOW_H
 #define SETTINGSWINDOW_H
 
 #include <gtk/gtk.h>
 
-void open_settings_window(GtkWindow *parent);
-
-void settings_update_brightness_slider(int brightness_0_to_31);
-void settings_update_volume_slider    (int volume_0_to_100);
+void settings_window_init(GtkWindow *parent);
+GtkWidget *open_settings_window(GtkWindow *parent);
+void settings_set_apply_rate(guint max_rate_hz);
 
 #endif /* SETTINGSWINDOW_H */
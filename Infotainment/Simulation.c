@@ -0,0 +1,548 @@
+/* =========================================================================
+ *  Simulation.c — in-process stand-ins for the hardware backends
+ * -------------------------------------------------------------------------
+ *  Selected by `--simulate` (see Hal.h).  Everything above the HAL runs
+ *  unchanged, so a dev workstation exercises the real decode, HUD, apply
+ *  and window code paths:
+ *
+ *  • SIM_INPUT_BACKEND      a "sim-encoder" thread replays a script of
+ *                           detents and presses as Gray-code pin edges
+ *                           and calls the ISRs, exactly like wiringPi.
+ *  • SIM_BACKLIGHT_BACKEND  one integer, 0-31.
+ *  • SIM_AUDIO_BACKEND      three fake sinks with their own volumes.
+ *  • SIM_VEHICLE_BACKEND    a synthetic ECU on the GTK main loop that
+ *                           drives a 60 s idle → accelerate → cruise →
+ *                           brake cycle and emits obd_reader.py-style
+ *                           JSON frames holding the PIDs set_pids()
+ *                           asked for.  One-off requests get canned
+ *                           answers (VIN, two stored DTCs until a
+ *                           Mode 04 clears them) after SIM_REQUEST_MS.
+ *  • SIM_POWER_BACKEND      remembers the governor it was given.
+ *
+ *  Encoder script format (one command per line, '#' starts a comment):
+ *      cw N       N detents clockwise   (volume / brightness up)
+ *      ccw N      N detents anticlockwise
+ *      press MS   hold the push-button for MS milliseconds
+ *      sleep MS   do nothing for MS milliseconds
+ *      repeat     start over from the first line
+ * ========================================================================= */
+#include "Hal.h"
+#include "PidTable.h"
+#include "Trace.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Constants                                                         */
+/* ------------------------------------------------------------------ */
+static const guint SIM_EDGE_INTERVAL_US   = 2000;   /* between Gray steps */
+static const guint SIM_ECU_DEFAULT_HZ     = 2;      /* obd_reader.py rate */
+static const guint SIM_ECU_CONNECT_MS     = 1500;   /* fake ELM327 init   */
+static const guint SIM_REQUEST_MS         = 60;     /* one adapter turn   */
+static const char  SIM_VIN[]              = "1VRSIM0000000042A";
+static const char  SIM_DEFAULT_GOVERNOR[] = "ondemand";
+
+static const char SIM_DEMO_SCRIPT[] =
+    "sleep 3000\n"
+    "cw 3\n"        "sleep 1000\n"
+    "ccw 3\n"       "sleep 1000\n"
+    "press 150\n"   "sleep 800\n"       /* → brightness mode */
+    "ccw 2\n"       "sleep 1000\n"
+    "cw 2\n"        "sleep 800\n"
+    "press 150\n"   "sleep 5000\n"      /* → volume mode     */
+    "repeat\n";
+
+static const char *SIM_SINKS[] = {
+    "sim_output.analog-stereo",
+    "sim_output.hdmi-stereo",
+    "sim_bluez_sink.headset",
+};
+
+/* ------------------------------------------------------------------ */
+/*  Module-wide state                                                 */
+/* ------------------------------------------------------------------ */
+static gchar *g_script_path = NULL;
+static guint  g_ecu_hz      = 0;           /* 0 → SIM_ECU_DEFAULT_HZ */
+
+/* Input */
+static gint        g_pin_level[64];        /* atomic; 1 = released/high */
+static EncoderPins g_pins;
+static PinIsr      g_ab_isr, g_sw_isr;
+
+/* Backlight */
+static gint g_sim_brightness = 31;         /* atomic, starts at full */
+
+/* Audio (guarded by g_audio_lock) */
+static GMutex g_audio_lock;
+static guint  g_default_sink = 0;
+static int    g_sink_volume[G_N_ELEMENTS(SIM_SINKS)] = { 40, 40, 40 };
+
+/* Vehicle (GTK thread only) */
+typedef struct {
+    VehicleFrameFunc on_frame;
+    VehicleLinkFunc  on_link;
+    gpointer         user_data;
+    guint            tick_tag;
+    gint64           t0_us;
+    double           fuel_pct;
+    guint64          pids;
+    gboolean         pids_set;          /* FALSE → every PID */
+    gboolean         connected;         /* tick_tag is the frame tick */
+    guint            min_period_ms;     /* heartbeat floor, 0 → rate */
+    GHashTable      *requests;          /* tag → answer timeout id */
+    gboolean         dtcs_cleared;      /* Mode 04 seen */
+} SimEcu;
+
+static SimEcu g_ecu;
+
+/* Power (guarded by g_power_lock) */
+static GMutex g_power_lock;
+static gchar  g_sim_governor[32];
+
+/* ------------------------------------------------------------------ */
+/*  Tuning                                                            */
+/* ------------------------------------------------------------------ */
+void sim_set_input_script(const char *path)
+{
+    g_free(g_script_path);
+    g_script_path = g_strdup(path);
+}
+
+void sim_set_ecu_rate(guint frames_per_second)
+{
+    g_ecu_hz = frames_per_second;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Input — scripted encoder                                          */
+/* ------------------------------------------------------------------ */
+static void set_pin(int pin, int level)
+{
+    if (pin >= 0 && pin < (int)G_N_ELEMENTS(g_pin_level))
+        g_atomic_int_set(&g_pin_level[pin], level);
+}
+
+static int sim_read_pin(int pin)
+{
+    if (pin < 0 || pin >= (int)G_N_ELEMENTS(g_pin_level))
+        return 1;
+    return g_atomic_int_get(&g_pin_level[pin]);
+}
+
+static void turn_detents(int detents, gboolean clockwise)
+/* ----------------------------------------------------------------------
+ *  One detent is a full Gray cycle starting and ending at AB = 11 (both
+ *  pulled up).  11→01→00→10 is the sequence the ISR counts as "up".
+ * ---------------------------------------------------------------------- */
+{
+    static const guint8 UP[4]   = { 0x1, 0x0, 0x2, 0x3 };
+    static const guint8 DOWN[4] = { 0x2, 0x0, 0x1, 0x3 };
+    const guint8 *seq = clockwise ? UP : DOWN;
+
+    for (int d = 0; d < detents; ++d) {
+        for (int i = 0; i < 4; ++i) {
+            set_pin(g_pins.a, (seq[i] >> 1) & 1);
+            set_pin(g_pins.b,  seq[i]       & 1);
+            g_ab_isr();
+            g_usleep(SIM_EDGE_INTERVAL_US);
+        }
+    }
+}
+
+static void press_button(guint hold_ms)
+{
+    set_pin(g_pins.sw, 0);
+    g_sw_isr();
+    g_usleep((gulong)hold_ms * 1000);
+    set_pin(g_pins.sw, 1);
+    g_sw_isr();
+}
+
+static gpointer encoder_script_thread(gpointer data)
+{
+    gchar **lines = data;
+    TRACE_THREAD_NAME("sim-encoder");
+
+    for (guint i = 0; lines[i]; ++i) {
+        gchar *cmd = g_strstrip(lines[i]);
+        char  *hash = strchr(cmd, '#');
+        if (hash) { *hash = '\0'; g_strstrip(cmd); }
+        if (!*cmd) continue;
+
+        char verb[16];
+        int  arg = 0;
+        if (sscanf(cmd, "%15s %d", verb, &arg) < 1) continue;
+
+        if      (!strcmp(verb, "cw"))     turn_detents(arg, TRUE);
+        else if (!strcmp(verb, "ccw"))    turn_detents(arg, FALSE);
+        else if (!strcmp(verb, "press"))  press_button((guint)MAX(arg, 0));
+        else if (!strcmp(verb, "sleep"))  g_usleep((gulong)MAX(arg, 0) * 1000);
+        else if (!strcmp(verb, "repeat")) i = (guint)-1;     /* ++i → 0 */
+        else g_printerr("[Sim] unknown encoder command '%s'\n", cmd);
+    }
+
+    g_print("[Sim] encoder script finished\n");
+    g_strfreev(lines);
+    return NULL;
+}
+
+static gboolean sim_input_start(const EncoderPins *pins, PinIsr ab_isr, PinIsr sw_isr)
+{
+    gchar *text = NULL;
+    if (g_script_path) {
+        GError *err = NULL;
+        if (!g_file_get_contents(g_script_path, &text, NULL, &err)) {
+            g_printerr("[Sim] %s\n", err->message);
+            g_clear_error(&err);
+            return FALSE;
+        }
+    }
+
+    g_pins   = *pins;
+    g_ab_isr = ab_isr;
+    g_sw_isr = sw_isr;
+    set_pin(pins->a, 1);
+    set_pin(pins->b, 1);
+    set_pin(pins->sw, 1);
+
+    gchar **lines = g_strsplit(text ? text : SIM_DEMO_SCRIPT, "\n", -1);
+    g_free(text);
+    g_thread_unref(g_thread_new("sim-encoder", encoder_script_thread, lines));
+    return TRUE;
+}
+
+const InputBackend SIM_INPUT_BACKEND = {
+    .name     = "sim-encoder",
+    .start    = sim_input_start,
+    .read_pin = sim_read_pin,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Backlight — one integer                                           */
+/* ------------------------------------------------------------------ */
+static int  sim_backlight_read (void)  { return g_atomic_int_get(&g_sim_brightness); }
+static void sim_backlight_write(int v) { g_atomic_int_set(&g_sim_brightness, v); }
+
+const BacklightBackend SIM_BACKLIGHT_BACKEND = {
+    .name  = "sim-backlight",
+    .read  = sim_backlight_read,
+    .write = sim_backlight_write,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Audio — fixed sink set                                            */
+/* ------------------------------------------------------------------ */
+static int find_sink(const char *sink)
+{
+    for (guint i = 0; i < G_N_ELEMENTS(SIM_SINKS); ++i)
+        if (!g_strcmp0(sink, SIM_SINKS[i]))
+            return (int)i;
+    return -1;
+}
+
+static gchar *sim_default_sink(void)
+{
+    g_mutex_lock(&g_audio_lock);
+    gchar *name = g_strdup(SIM_SINKS[g_default_sink]);
+    g_mutex_unlock(&g_audio_lock);
+    return name;
+}
+
+static GSList *sim_list_sinks(void)
+{
+    GSList *list = NULL;
+    for (guint i = 0; i < G_N_ELEMENTS(SIM_SINKS); ++i)
+        list = g_slist_append(list, g_strdup(SIM_SINKS[i]));
+    return list;
+}
+
+static void sim_set_default_sink(const char *sink)
+{
+    int idx = find_sink(sink);
+    if (idx < 0) {
+        g_printerr("[Sim] no such sink '%s'\n", sink);
+        return;
+    }
+    g_mutex_lock(&g_audio_lock);
+    g_default_sink = (guint)idx;
+    g_mutex_unlock(&g_audio_lock);
+}
+
+static int sim_get_volume(const char *sink)
+{
+    int idx = find_sink(sink);
+    if (idx < 0) return -1;
+
+    g_mutex_lock(&g_audio_lock);
+    int vol = g_sink_volume[idx];
+    g_mutex_unlock(&g_audio_lock);
+    return vol;
+}
+
+static void sim_set_volume(const char *sink, int pct)
+{
+    int idx = find_sink(sink);
+    if (idx < 0) return;
+
+    g_mutex_lock(&g_audio_lock);
+    g_sink_volume[idx] = pct;
+    g_mutex_unlock(&g_audio_lock);
+}
+
+const AudioBackend SIM_AUDIO_BACKEND = {
+    .name             = "sim-audio",
+    .default_sink     = sim_default_sink,
+    .list_sinks       = sim_list_sinks,
+    .set_default_sink = sim_set_default_sink,
+    .get_volume       = sim_get_volume,
+    .set_volume       = sim_set_volume,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Vehicle — synthetic ECU                                           */
+/* ------------------------------------------------------------------ */
+static void append_member(GString *js, const char *key, double v, gboolean first)
+/* g_ascii_formatd keeps '.' as decimal point whatever LC_NUMERIC says */
+{
+    char num[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_formatd(num, sizeof num, "%.2f", v);
+    g_string_append_printf(js, "%s\"%s\": %s", first ? "" : ", ", key, num);
+}
+
+static gboolean ecu_tick(gpointer)
+/* ----------------------------------------------------------------------
+ *  60 s drive cycle:  0-10 s idle, 10-25 s accelerate to 100 km/h,
+ *  25-45 s cruise, 45-60 s brake to a stop.  Engine figures are loosely
+ *  derived from speed so the readouts move together.  PIDs the ECU has
+ *  no model for stay NAN and are left out, like an unsupported PID.
+ * ---------------------------------------------------------------------- */
+{
+    TRACE_SCOPE("sim_ecu_tick");
+    double run_s = (g_get_monotonic_time() - g_ecu.t0_us) / 1e6;
+    double t     = fmod(run_s, 60.0);
+
+    double speed, throttle;                         /* km/h, % */
+    if (t < 10)      { speed = 0;                       throttle = 0;  }
+    else if (t < 25) { speed = (t - 10) / 15 * 100;     throttle = 55; }
+    else if (t < 45) { speed = 100 + 3 * sin(t);        throttle = 22; }
+    else             { speed = (60 - t) / 15 * 100;     throttle = 0;  }
+
+    double gear_ratio = speed < 20 ? 110 : speed < 45 ? 65 : speed < 70 ? 45 : 33;
+    double rpm        = MAX(780 + 15 * sin(t * 7), speed * gear_ratio * 0.35);
+    double load       = 18 + throttle * 1.1;
+    double warm       = 1 - exp(-run_s / 120);      /* 0 → 1 over a few min */
+
+    g_ecu.fuel_pct = MAX(g_ecu.fuel_pct - 0.002, 5.0);
+
+    double v[PID_COUNT];
+    for (guint i = 0; i < PID_COUNT; i++)
+        v[i] = NAN;
+
+    v[PID_RPM]             = rpm;
+    v[PID_SPEED]           = speed;
+    v[PID_ENGINE_LOAD]     = load;
+    v[PID_THROTTLE_POS]    = throttle;
+    v[PID_INTAKE_PRESSURE] = 30 + throttle * 1.2;
+    v[PID_TIMING_ADVANCE]  = 10 + rpm / 400 - throttle / 10;
+    v[PID_FUEL_LEVEL]      = g_ecu.fuel_pct;
+    v[PID_MODULE_VOLTAGE]  = 14.1 + 0.05 * sin(t * 3);
+    v[PID_COOLANT_TEMP]    = 20 + 70 * warm;
+    v[PID_INTAKE_AIR_TEMP] = 24 + 8 * warm;
+    v[PID_MAF]             = rpm * load / 4000;
+    v[PID_SHORT_FUEL_TRIM] = 2 * sin(t * 1.3);
+    v[PID_LONG_FUEL_TRIM]  = 1.6;
+    v[PID_FUEL_PRESSURE]   = 381;
+    v[PID_FUEL_RATE]       = 0.8 + load * rpm / 12000;
+    v[PID_OIL_TEMP]        = 20 + 75 * warm * warm;
+    v[PID_BARO_PRESSURE]   = 101;
+    v[PID_AMBIENT_TEMP]    = 18;
+    v[PID_RUN_TIME]        = floor(run_s);
+
+    GString *js = g_string_sized_new(256);
+    g_string_append_c(js, '{');
+    for (guint i = 0; i < PID_COUNT; i++) {
+        if (isnan(v[i]) ||
+            (g_ecu.pids_set && !(g_ecu.pids & (G_GUINT64_CONSTANT(1) << i))))
+            continue;
+        append_member(js, PID_TABLE[i].name, v[i], js->len == 1);
+    }
+    g_string_append(js, "}\n");
+
+    g_ecu.on_frame(js->str, js->len, g_ecu.user_data);
+    g_string_free(js, TRUE);
+    return G_SOURCE_CONTINUE;
+}
+
+static void arm_ecu_tick(void)
+{
+    guint hz = g_ecu_hz ? g_ecu_hz : SIM_ECU_DEFAULT_HZ;
+
+    g_ecu.tick_tag = g_timeout_add(MAX(MAX(1000 / hz, 1), g_ecu.min_period_ms),
+                                   ecu_tick, NULL);
+    g_source_set_name_by_id(g_ecu.tick_tag, "sim-ecu-tick");
+}
+
+static gboolean ecu_connected(gpointer)
+{
+    if (g_ecu.on_link)
+        g_ecu.on_link(TRUE, g_ecu.user_data);
+
+    g_ecu.connected = TRUE;
+    arm_ecu_tick();
+    return G_SOURCE_REMOVE;
+}
+
+static void sim_vehicle_start(VehicleFrameFunc on_frame, VehicleLinkFunc on_link,
+                              gpointer user_data)
+{
+    g_ecu.on_frame  = on_frame;
+    g_ecu.on_link   = on_link;
+    g_ecu.user_data = user_data;
+    g_ecu.t0_us     = g_get_monotonic_time();
+    if (g_ecu.fuel_pct <= 0)
+        g_ecu.fuel_pct = 63.0;
+
+    if (g_ecu.tick_tag)
+        g_source_remove(g_ecu.tick_tag);
+    g_ecu.connected = FALSE;
+    g_ecu.tick_tag  = g_timeout_add(SIM_ECU_CONNECT_MS, ecu_connected, NULL);
+    g_source_set_name_by_id(g_ecu.tick_tag, "sim-ecu-connect");
+}
+
+static void sim_vehicle_stop(void)
+{
+    if (g_ecu.tick_tag) {
+        g_source_remove(g_ecu.tick_tag);
+        g_ecu.tick_tag = 0;
+    }
+    g_ecu.connected = FALSE;
+}
+
+static void sim_vehicle_set_pids(guint64 pid_mask)
+{
+    g_ecu.pids     = pid_mask;              /* next tick already obeys it */
+    g_ecu.pids_set = TRUE;
+}
+
+static void sim_vehicle_set_min_period(guint ms)
+/* Re-arm a running tick so the new rate applies now, not after a beat. */
+{
+    g_ecu.min_period_ms = ms;
+    if (g_ecu.connected && g_ecu.tick_tag) {
+        g_source_remove(g_ecu.tick_tag);
+        arm_ecu_tick();
+    }
+}
+
+static gchar *sim_answer(const char *command)
+/* The reply line minus "A tag" for the few requests the ECU knows. */
+{
+    gchar *hex = NULL;
+    if (!g_ascii_strcasecmp(command, "0902")) {
+        GString *s = g_string_new("0201");
+        for (const char *c = SIM_VIN; *c; c++)
+            g_string_append_printf(s, "%02X", (guint8)*c);
+        hex = g_string_free(s, FALSE);
+    } else if (!strcmp(command, "03")) {
+        hex = g_strdup(g_ecu.dtcs_cleared ? "00" : "0201330420");   /* P0133 P0420 */
+    } else if (!strcmp(command, "07")) {
+        hex = g_strdup("00");
+    } else if (!strcmp(command, "04")) {
+        g_ecu.dtcs_cleared = TRUE;
+        return g_strdup_printf("OK 0 %u 0", SIM_REQUEST_MS);
+    } else {
+        return g_strdup_printf("NODATA 0 %u 0", SIM_REQUEST_MS);
+    }
+    gchar *line = g_strdup_printf("OK 0 %u 0 %s", SIM_REQUEST_MS, hex);
+    g_free(hex);
+    return line;
+}
+
+typedef struct {
+    guint  tag;
+    gchar *command;
+} SimRequest;
+
+static void sim_request_free(gpointer data)
+{
+    SimRequest *req = data;
+    g_free(req->command);
+    g_free(req);
+}
+
+static gboolean sim_answer_request(gpointer data)
+{
+    SimRequest *req = data;
+    g_hash_table_remove(g_ecu.requests, GUINT_TO_POINTER(req->tag));
+
+    gchar *answer = sim_answer(req->command);
+    gchar *line   = g_strdup_printf("A %u %s\n", req->tag, answer);
+    if (g_ecu.on_frame)
+        g_ecu.on_frame(line, strlen(line), g_ecu.user_data);
+    g_free(line);
+    g_free(answer);
+    return G_SOURCE_REMOVE;
+}
+
+static void sim_vehicle_request(guint tag, VehiclePriority, const char *command)
+/* No adapter to share, so the priority changes nothing here. */
+{
+    if (!g_ecu.requests)
+        g_ecu.requests = g_hash_table_new(NULL, NULL);
+
+    SimRequest *req = g_new(SimRequest, 1);
+    req->tag     = tag;
+    req->command = g_ascii_strup(command, -1);
+    guint id = g_timeout_add_full(G_PRIORITY_DEFAULT, SIM_REQUEST_MS,
+                                  sim_answer_request, req, sim_request_free);
+    g_source_set_name_by_id(id, "sim-ecu-request");
+    g_hash_table_insert(g_ecu.requests, GUINT_TO_POINTER(tag), GUINT_TO_POINTER(id));
+}
+
+static void sim_vehicle_cancel(guint tag)
+{
+    guint id = g_ecu.requests
+             ? GPOINTER_TO_UINT(g_hash_table_lookup(g_ecu.requests, GUINT_TO_POINTER(tag)))
+             : 0;
+    if (id) {
+        g_hash_table_remove(g_ecu.requests, GUINT_TO_POINTER(tag));
+        g_source_remove(id);                    /* frees the SimRequest */
+    }
+}
+
+const VehicleBackend SIM_VEHICLE_BACKEND = {
+    .name           = "sim-ecu",
+    .start          = sim_vehicle_start,
+    .stop           = sim_vehicle_stop,
+    .set_pids       = sim_vehicle_set_pids,
+    .set_min_period = sim_vehicle_set_min_period,
+    .request        = sim_vehicle_request,
+    .cancel         = sim_vehicle_cancel,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Power — remembered governor                                       */
+/* ------------------------------------------------------------------ */
+static gchar *sim_get_governor(void)
+{
+    g_mutex_lock(&g_power_lock);
+    gchar *gov = g_strdup(*g_sim_governor ? g_sim_governor : SIM_DEFAULT_GOVERNOR);
+    g_mutex_unlock(&g_power_lock);
+    return gov;
+}
+
+static void sim_set_governor(const char *governor)
+{
+    g_mutex_lock(&g_power_lock);
+    g_strlcpy(g_sim_governor, governor, sizeof g_sim_governor);
+    g_mutex_unlock(&g_power_lock);
+    g_print("[Sim] governor → %s\n", governor);
+}
+
+const PowerBackend SIM_POWER_BACKEND = {
+    .name         = "sim-cpufreq",
+    .get_governor = sim_get_governor,
+    .set_governor = sim_set_governor,
+};
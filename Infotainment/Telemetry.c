@@ -0,0 +1,310 @@
+/* =========================================================================
+ *  Telemetry.c — owns the vehicle backend session
+ * -------------------------------------------------------------------------
+ *  • Poll set = attached views' PIDs | alert PIDs | publisher PIDs;
+ *    pushed to every backend (hal_vehicle_at()) with set_pids() whenever
+ *    any of them changes.  Each source polls the full set; the merge
+ *    picks which one a PID is taken from.
+ *  • The backends run while the poll set is non-empty (or a view is
+ *    attached, so the window still shows its status).
+ *  • The heartbeat floor is passed straight to the backends, which keep
+ *    it across restarts.
+ *  • One JsonParser / ObdFrame decode per line, then the frame goes
+ *    through Merge.c tagged with its source; with one backend it comes
+ *    straight back out.  Alerts see the merged frame before any view
+ *    does, so a busy window never delays an alert.  The MQTT publisher
+ *    (--mqtt) gets it next; it only appends to a buffer.
+ *  • The link is up while any source's is.
+ *  • One-off requests take a slot in g_tm.requests and keep the backends
+ *    running until answered or cancelled.  They go to the first source
+ *    that can query.  Their "A" lines never reach the frame decoder; a
+ *    cancelled request's late answer is dropped.
+ * ========================================================================= */
+#include "Telemetry.h"
+#include "Alerts.h"
+#include "Publisher.h"
+#include "Merge.h"
+#include "Hal.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+/* ------------------------------------------------------------------ */
+/*  State (GTK thread only)                                           */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    gboolean            attached;
+    guint64             pids;
+    TelemetryFrameFunc  on_frame;
+    TelemetryLinkFunc   on_link;
+    gpointer            user_data;
+} ViewSlot;
+
+typedef struct {
+    guint               id;           /* 0 = free slot */
+    TelemetryReplyFunc  done;
+    gpointer            user_data;
+    gint64              sent_us;
+} RequestSlot;
+
+typedef struct {
+    gboolean            running;      /* backends started */
+    gboolean            link_up;      /* any source's link */
+    guint64             source_up;    /* bit i = hal_vehicle_at(i) link */
+    JsonParser         *parser;
+    guint64             session_pids; /* alerts + publisher, always polled */
+    ViewSlot            views[TELEMETRY_VIEW_COUNT];
+    RequestSlot         requests[TELEMETRY_REQUESTS_MAX];
+    guint               n_requests;
+    guint               next_id;
+} TelemetrySession;
+
+static TelemetrySession g_tm;
+
+static void update_session(void);
+
+/* ------------------------------------------------------------------ */
+/*  Requests                                                          */
+/* ------------------------------------------------------------------ */
+static RequestSlot *find_request(guint id)
+{
+    for (guint i = 0; id && i < TELEMETRY_REQUESTS_MAX; i++)
+        if (g_tm.requests[i].id == id)
+            return &g_tm.requests[i];
+    return NULL;
+}
+
+static void finish_request(const ObdReply *reply)
+/* Free the slot before calling back, so `done` may submit again. */
+{
+    RequestSlot *slot = find_request(reply->tag);
+    if (!slot)
+        return;                                 /* cancelled */
+    RequestSlot req = *slot;
+    *slot = (RequestSlot){ 0 };
+    g_tm.n_requests--;
+
+    metrics_inc(METRIC_OBD_REQUESTS);
+    metrics_observe_us(METRIC_OBD_REQUEST_TIME, g_get_monotonic_time() - req.sent_us);
+    metrics_observe_us(METRIC_OBD_STREAM_STALL, (gint64)reply->stall_ms * 1000);
+    req.done(reply, req.user_data);
+    update_session();
+}
+
+static gboolean reply_unsupported(gpointer data)
+{
+    ObdReply reply = { .tag = GPOINTER_TO_UINT(data), .status = OBD_REPLY_UNSUPPORTED };
+    finish_request(&reply);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean is_hex_command(const char *command)
+{
+    gsize n = 0;
+    for (; command[n]; n++)
+        if (!g_ascii_isxdigit(command[n]))
+            return FALSE;
+    return n >= 2 && n % 2 == 0 && n <= 16;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Backend callbacks                                                 */
+/* ------------------------------------------------------------------ */
+static void on_backend_reply(const gchar *line, gsize len)
+{
+    ObdReply reply;
+    if (!obd_reply_parse(line, len, &reply)) {
+        metrics_inc(METRIC_OBD_DROPPED);
+        return;
+    }
+    finish_request(&reply);
+}
+
+static void set_source_link(guint source, gboolean up)
+/* Views hear about the aggregate link only: up while any source is */
+{
+    guint64 bit = G_GUINT64_CONSTANT(1) << source;
+    if (!(g_tm.source_up & bit) == !up)
+        return;
+    g_tm.source_up ^= bit;
+    merge_set_link(source, up);
+
+    if (!g_tm.source_up == !g_tm.link_up)
+        return;
+    g_tm.link_up = !g_tm.link_up;
+    metrics_set(METRIC_OBD_LINK_UP, g_tm.link_up);
+    if (!g_tm.link_up)
+        alerts_reset();
+    for (guint v = 0; v < TELEMETRY_VIEW_COUNT; v++)
+        if (g_tm.views[v].attached && g_tm.views[v].on_link)
+            g_tm.views[v].on_link(g_tm.link_up, g_tm.views[v].user_data);
+}
+
+static void on_backend_frame(const gchar *line, gsize len, gpointer data)
+{
+    TRACE_SCOPE("telemetry_frame");
+    if (len && line[0] == 'A') {
+        on_backend_reply(line, len);
+        return;
+    }
+
+    ObdFrame frame;
+    if (!obd_frame_parse(g_tm.parser, line, len, &frame)) {
+        metrics_inc(METRIC_OBD_DROPPED);
+        return;
+    }
+    metrics_inc(METRIC_OBD_FRAMES);
+    set_source_link(GPOINTER_TO_UINT(data), TRUE);  /* not every backend says */
+    merge_push(GPOINTER_TO_UINT(data), &frame);
+}
+
+static void on_merged_frame(const ObdFrame *frame, gpointer)
+{
+    alerts_feed(frame, frame->t_us);
+    publisher_feed(frame);
+    for (guint v = 0; v < TELEMETRY_VIEW_COUNT; v++)
+        if (g_tm.views[v].attached && g_tm.views[v].on_frame)
+            g_tm.views[v].on_frame(frame, g_tm.views[v].user_data);
+}
+
+static void on_backend_link(gboolean up, gpointer data)
+{
+    set_source_link(GPOINTER_TO_UINT(data), up);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Start / stop / poll set                                           */
+/* ------------------------------------------------------------------ */
+static void update_session(void)
+{
+    guint64  pids = g_tm.session_pids;
+    gboolean want = FALSE;
+    for (guint v = 0; v < TELEMETRY_VIEW_COUNT; v++) {
+        if (!g_tm.views[v].attached) continue;
+        pids |= g_tm.views[v].pids;
+        want  = TRUE;
+    }
+    want |= pids != 0 || g_tm.n_requests;
+
+    guint n = hal_vehicle_count();
+    for (guint i = 0; i < n; i++)
+        hal_vehicle_at(i)->set_pids(pids);
+    if (want && !g_tm.running) {
+        for (guint i = 0; i < n; i++)
+            hal_vehicle_at(i)->start(on_backend_frame, on_backend_link,
+                                     GUINT_TO_POINTER(i));
+        g_tm.running = TRUE;
+    } else if (!want && g_tm.running) {
+        for (guint i = 0; i < n; i++)
+            hal_vehicle_at(i)->stop();
+        g_tm.running   = FALSE;
+        g_tm.source_up = 0;
+        g_tm.link_up   = FALSE;
+        merge_reset();
+        alerts_reset();
+    }
+}
+
+static const VehicleBackend *query_backend(void)
+/* First source that can answer one-off requests, NULL if none */
+{
+    for (guint i = 0; i < hal_vehicle_count(); i++)
+        if (hal_vehicle_at(i)->request)
+            return hal_vehicle_at(i);
+    return NULL;
+}
+
+static void ensure_parser(void)
+{
+    if (g_tm.parser)
+        return;
+    g_tm.parser = json_parser_new();
+    merge_set_output(on_merged_frame, NULL);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                        */
+/* ------------------------------------------------------------------ */
+void telemetry_init(void)
+{
+    if (g_tm.parser)
+        return;
+    ensure_parser();
+    g_tm.session_pids = alerts_pid_mask() | publisher_pid_mask();
+    update_session();
+}
+
+void telemetry_attach_view(TelemetryView view, guint64 pid_mask,
+                           TelemetryFrameFunc on_frame,
+                           TelemetryLinkFunc on_link, gpointer user_data)
+{
+    ensure_parser();                        /* no telemetry_init(): view only */
+
+    g_tm.views[view] = (ViewSlot){ TRUE, pid_mask, on_frame, on_link, user_data };
+    update_session();
+}
+
+void telemetry_set_view_pids(TelemetryView view, guint64 pid_mask)
+{
+    g_tm.views[view].pids = pid_mask;
+    if (g_tm.views[view].attached)
+        update_session();
+}
+
+void telemetry_detach_view(TelemetryView view)
+{
+    g_tm.views[view] = (ViewSlot){ 0 };
+    update_session();
+}
+
+void telemetry_set_heartbeat(guint ms)
+{
+    for (guint i = 0; i < hal_vehicle_count(); i++)
+        hal_vehicle_at(i)->set_min_period(ms);
+    merge_set_min_period(ms);
+}
+
+guint telemetry_request(const char *command, VehiclePriority priority,
+                        TelemetryReplyFunc done, gpointer user_data)
+{
+    if (!is_hex_command(command)) {
+        g_printerr("[OBD] bad request '%s': expected 1-8 hex bytes\n", command);
+        return 0;
+    }
+    RequestSlot *slot = NULL;
+    for (guint i = 0; !slot && i < TELEMETRY_REQUESTS_MAX; i++)
+        if (!g_tm.requests[i].id)
+            slot = &g_tm.requests[i];
+    if (!slot) {
+        g_printerr("[OBD] %d requests pending; '%s' refused\n",
+                   TELEMETRY_REQUESTS_MAX, command);
+        return 0;
+    }
+
+    ensure_parser();
+    if (!++g_tm.next_id)
+        g_tm.next_id = 1;                       /* 0 means "none" */
+    *slot = (RequestSlot){ g_tm.next_id, done, user_data, g_get_monotonic_time() };
+    g_tm.n_requests++;
+
+    const VehicleBackend *vb = query_backend();
+    if (!vb) {                                  /* listen-only backends */
+        g_idle_add(reply_unsupported, GUINT_TO_POINTER(slot->id));
+        return slot->id;
+    }
+    vb->request(slot->id, priority, command);
+    update_session();
+    return slot->id;
+}
+
+void telemetry_cancel(guint id)
+{
+    RequestSlot *slot = find_request(id);
+    if (!slot)
+        return;
+    *slot = (RequestSlot){ 0 };
+    g_tm.n_requests--;
+    const VehicleBackend *vb = query_backend();
+    if (vb && vb->cancel)
+        vb->cancel(id);
+    update_session();
+}
@@ -0,0 +1,74 @@
+/* =========================================================================
+ *  Telemetry.h — the vehicle-data session shared by alerts and dashboard
+ * -------------------------------------------------------------------------
+ *  telemetry_init()
+ *      Call once after hal_init() and popup_init().  Every frame from the
+ *      vehicle backends is decoded here exactly once, merged into one
+ *      time-ordered stream when --sources runs several (Merge.h), and
+ *      handed to the alert engine (Alerts.h), then to every attached
+ *      view.
+ *      When AlertRules.def has rules the backend runs for the whole
+ *      session, polling the rules' PIDs, so alerts reach the HUD from the
+ *      main menu or Android Auto as well.  The same goes for the MQTT
+ *      publisher's PIDs (Publisher.h), which then sees every frame.
+ *      Configure and start the publisher before this call.
+ *
+ *  telemetry_attach_view(view, pid_mask, on_frame, on_link, user_data)
+ *  telemetry_set_view_pids(view, pid_mask)
+ *  telemetry_detach_view(view)
+ *      One slot per TelemetryView (the Vehicle Info window, the overlay
+ *      strip over Android Auto, the idle manager's engine-off detector).
+ *      The backend polls the union of the
+ *      attached views' PIDs plus the alert PIDs, and stops when nobody
+ *      needs anything.  on_frame gets every decoded frame while attached.
+ *
+ *  telemetry_set_heartbeat(ms)
+ *      Stretches every PID's poll interval to at least `ms` (0 restores
+ *      the PidTable.def rates).  The idle manager sets it while parked.
+ *
+ *  telemetry_request(command, priority, done, user_data)
+ *  telemetry_cancel(id)
+ *      One-off query — "0902" VIN, "03" stored DTCs (obd_reply_dtcs()),
+ *      "020C00" freeze-frame RPM, "04" clear codes — interleaved with the
+ *      stream without restarting it (Hal.h for what each priority
+ *      means).  The backend runs while a request is pending.  `done`
+ *      gets the ObdReply exactly once, from the main loop, unless the
+ *      request is cancelled first.  Returns the id, 0 if `command` is not
+ *      hex or TELEMETRY_REQUESTS_MAX are already pending.  The first
+ *      source that can query takes it; if none can (--can alone) the
+ *      answer is OBD_REPLY_UNSUPPORTED.
+ *
+ *  GTK thread only.
+ * ========================================================================= */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <glib.h>
+#include "Hal.h"
+#include "ObdFrame.h"
+
+#define TELEMETRY_REQUESTS_MAX 16
+
+typedef enum {
+    TELEMETRY_VIEW_DASHBOARD,
+    TELEMETRY_VIEW_OVERLAY,
+    TELEMETRY_VIEW_IDLE,
+    TELEMETRY_VIEW_COUNT
+} TelemetryView;
+
+typedef void (*TelemetryFrameFunc)(const ObdFrame *frame, gpointer user_data);
+typedef void (*TelemetryLinkFunc) (gboolean up, gpointer user_data);
+typedef void (*TelemetryReplyFunc)(const ObdReply *reply, gpointer user_data);
+
+void telemetry_init         (void);
+void telemetry_attach_view  (TelemetryView view, guint64 pid_mask,
+                             TelemetryFrameFunc on_frame,
+                             TelemetryLinkFunc on_link, gpointer user_data);
+void telemetry_set_view_pids(TelemetryView view, guint64 pid_mask);
+void telemetry_detach_view  (TelemetryView view);
+void telemetry_set_heartbeat(guint ms);
+guint telemetry_request     (const char *command, VehiclePriority priority,
+                             TelemetryReplyFunc done, gpointer user_data);
+void telemetry_cancel       (guint id);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,244 @@
+/* =========================================================================
+ *  Trace.c — per-thread event buffers + Chrome trace-event JSON writer
+ * -------------------------------------------------------------------------
+ *  • Each thread lazily gets its own fixed-size TraceBuffer on first use;
+ *    buffers are linked into a global list (the only locked operation).
+ *  • Recording appends to the caller's buffer and publishes the new count
+ *    with a release store, so the exporter can read concurrently.
+ *  • A full buffer drops further events and counts them.
+ *  • The JSON file is written once, from trace_shutdown() or atexit().
+ * ========================================================================= */
+#include "Trace.h"
+
+#include <glib.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* ---------------------------------------------------------------------- */
+/*  Constants                                                             */
+/* ---------------------------------------------------------------------- */
+enum { TRACE_EVENTS_PER_THREAD = 16384 };
+
+/* ---------------------------------------------------------------------- */
+/*  Types                                                                 */
+/* ---------------------------------------------------------------------- */
+typedef struct {
+    const char *name;
+    uint64_t    ts_ns;
+    uint64_t    dur_ns;       /* 'X' only   */
+    int64_t     value;        /* 'C' only   */
+    char        phase;        /* X / i / C  */
+} TraceEvent;
+
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;
+    int                 tid;
+    const char         *thread_name;
+    _Atomic uint32_t    count;
+    uint32_t            dropped;
+    TraceEvent          events[TRACE_EVENTS_PER_THREAD];
+} TraceBuffer;
+
+/* ---------------------------------------------------------------------- */
+/*  Module-wide state                                                     */
+/* ---------------------------------------------------------------------- */
+volatile bool g_trace_enabled = false;
+
+static char            *g_out_path  = NULL;
+static uint64_t         g_origin_ns = 0;
+static TraceBuffer     *g_buffers   = NULL;
+static pthread_mutex_t  g_buf_lock  = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool      g_written   = false;
+
+static __thread TraceBuffer *t_buf = NULL;
+
+/* Forward declarations */
+static TraceBuffer *thread_buffer(void);
+static void         record(char phase, const char *name,
+                           uint64_t ts, uint64_t dur, int64_t value);
+static void         write_json(void);
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+void trace_init(const char *out_path)
+{
+    if (!out_path || g_trace_enabled)
+        return;
+
+    g_out_path      = strdup(out_path);
+    g_origin_ns     = trace_now_ns();
+    g_trace_enabled = true;
+    atexit(trace_shutdown);
+
+    trace_set_thread_name("main");
+    trace_instant("trace-start");
+}
+
+void trace_shutdown(void)
+{
+    if (!g_trace_enabled || atomic_exchange(&g_written, true))
+        return;
+    g_trace_enabled = false;                /* stop recording, then dump */
+    write_json();
+}
+
+uint64_t trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void trace_span_record(const TraceSpan *span)
+{
+    if (!g_trace_enabled)
+        return;
+    uint64_t now = trace_now_ns();
+    record('X', span->name, span->start_ns, now - span->start_ns, 0);
+}
+
+void trace_instant(const char *name)
+{
+    if (g_trace_enabled)
+        record('i', name, trace_now_ns(), 0, 0);
+}
+
+void trace_counter(const char *name, int64_t value)
+{
+    if (g_trace_enabled)
+        record('C', name, trace_now_ns(), 0, value);
+}
+
+void trace_set_thread_name(const char *name)
+{
+    TraceBuffer *b = thread_buffer();
+    if (b && !b->thread_name)
+        b->thread_name = name;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Recording                                                             */
+/* ---------------------------------------------------------------------- */
+static TraceBuffer *thread_buffer(void)
+/* Return (allocating on first use) the calling thread's buffer. */
+{
+    if (t_buf)
+        return t_buf;
+
+    TraceBuffer *b = calloc(1, sizeof *b);
+    if (!b)
+        return NULL;
+    b->tid = (int)syscall(SYS_gettid);
+
+    pthread_mutex_lock(&g_buf_lock);
+    b->next   = g_buffers;
+    g_buffers = b;
+    pthread_mutex_unlock(&g_buf_lock);
+
+    t_buf = b;
+    return b;
+}
+
+static void record(char phase, const char *name,
+                   uint64_t ts, uint64_t dur, int64_t value)
+{
+    TraceBuffer *b = thread_buffer();
+    if (!b)
+        return;
+
+    uint32_t n = atomic_load_explicit(&b->count, memory_order_relaxed);
+    if (n >= TRACE_EVENTS_PER_THREAD) {
+        b->dropped++;
+        return;
+    }
+
+    TraceEvent *e = &b->events[n];
+    e->name   = name;
+    e->ts_ns  = ts;
+    e->dur_ns = dur;
+    e->value  = value;
+    e->phase  = phase;
+    atomic_store_explicit(&b->count, n + 1, memory_order_release);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Export                                                                */
+/* ---------------------------------------------------------------------- */
+static void write_string(FILE *fp, const char *s)
+/* Minimal JSON string escaping — names are literals, but stay safe. */
+{
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')      fprintf(fp, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20) fprintf(fp, "\\u%04x", *s);
+        else                               fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_json(void)
+{
+    FILE *fp = fopen(g_out_path, "w");
+    if (!fp) {
+        fprintf(stderr, "[Trace] cannot write %s\n", g_out_path);
+        return;
+    }
+
+    const int pid   = (int)getpid();
+    size_t    total = 0;
+    bool      first = true;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    pthread_mutex_lock(&g_buf_lock);
+    for (TraceBuffer *b = g_buffers; b; b = b->next) {
+        uint32_t n = atomic_load_explicit(&b->count, memory_order_acquire);
+
+        /* Thread-name metadata so tracks are labelled */
+        fprintf(fp, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+                    "\"tid\":%d,\"args\":{\"name\":",
+                first ? "" : ",\n", pid, b->tid);
+        write_string(fp, b->thread_name ? b->thread_name : "thread");
+        fprintf(fp, "}}");
+        first = false;
+
+        for (uint32_t i = 0; i < n; i++) {
+            const TraceEvent *e = &b->events[i];
+            double ts_us = (double)(e->ts_ns - g_origin_ns) / 1e3;
+            char   num[G_ASCII_DTOSTR_BUF_SIZE];     /* '.' whatever the locale */
+
+            fprintf(fp, ",\n{\"ph\":\"%c\",\"name\":", e->phase);
+            write_string(fp, e->name);
+            fprintf(fp, ",\"pid\":%d,\"tid\":%d,\"ts\":%s", pid, b->tid,
+                    g_ascii_formatd(num, sizeof num, "%.3f", ts_us));
+
+            switch (e->phase) {
+                case 'X': fprintf(fp, ",\"dur\":%s",
+                                  g_ascii_formatd(num, sizeof num, "%.3f", e->dur_ns / 1e3));
+                          break;
+                case 'i': fprintf(fp, ",\"s\":\"t\"");                               break;
+                case 'C': fprintf(fp, ",\"args\":{\"value\":%lld}", (long long)e->value); break;
+                default:  break;
+            }
+            fputc('}', fp);
+        }
+        total += n;
+
+        if (b->dropped)
+            fprintf(stderr, "[Trace] tid %d dropped %u events (buffer full)\n",
+                    b->tid, b->dropped);
+    }
+    pthread_mutex_unlock(&g_buf_lock);
+
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    fprintf(stderr, "[Trace] wrote %zu events to %s\n", total, g_out_path);
+}
@@ -0,0 +1,85 @@
+/* =========================================================================
+ *  Trace.h — lightweight span / instant tracing with Chrome JSON export
+ * -------------------------------------------------------------------------
+ *  trace_init(path)
+ *      Enables tracing and arranges for the trace to be written to `path`
+ *      (Chrome trace-event JSON, loadable in chrome://tracing or Perfetto)
+ *      when trace_shutdown() runs or the process exits.  Passing NULL
+ *      leaves tracing disabled; every macro below then costs one branch
+ *      (TRACE_SCOPE: one on entry and one on leaving the block).
+ *
+ *  TRACE_SCOPE("name")
+ *      Records a complete ("X") span from this line to the end of the
+ *      enclosing block.
+ *  TRACE_INSTANT("name")
+ *      Records a zero-length marker.
+ *  TRACE_COUNTER("name", value)
+ *      Records a counter sample (drawn as a graph track).
+ *  TRACE_THREAD_NAME("name")
+ *      Labels the calling thread's track in the viewer.
+ *
+ *  All names must be string literals (or otherwise outlive the process):
+ *  only the pointer is stored.  Events go into a fixed-size buffer owned
+ *  by the calling thread, timestamped with CLOCK_MONOTONIC, so recording
+ *  never takes a lock and is safe from the wiringPi ISR thread.
+ * ========================================================================= */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void trace_init    (const char *out_path);
+void trace_shutdown(void);
+
+extern volatile bool g_trace_enabled;
+
+/* Low-level hooks used by the macros ----------------------------------- */
+typedef struct {
+    const char *name;
+    uint64_t    start_ns;
+} TraceSpan;
+
+uint64_t  trace_now_ns        (void);
+void      trace_span_record   (const TraceSpan *span);
+void      trace_instant       (const char *name);
+void      trace_counter       (const char *name, int64_t value);
+void      trace_set_thread_name(const char *name);
+
+/* Inline so a disabled TRACE_SCOPE is a flag test on entry and a NULL
+ * test on exit — no calls on hot paths such as telemetry_frame(). */
+static inline TraceSpan trace_span_begin(const char *name)
+{
+    TraceSpan s = { NULL, 0 };
+    if (g_trace_enabled) {
+        s.name     = name;
+        s.start_ns = trace_now_ns();
+    }
+    return s;
+}
+
+static inline void trace_span_end(TraceSpan *span)
+{
+    if (span->name)
+        trace_span_record(span);
+}
+
+/* Convenience macros --------------------------------------------------- */
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_CAT(a, b)  TRACE_CAT_(a, b)
+
+#define TRACE_SCOPE(name)                                                  \
+    TraceSpan TRACE_CAT(trace_span_, __LINE__)                             \
+        __attribute__((cleanup(trace_span_end))) = trace_span_begin(name)
+
+#define TRACE_INSTANT(name) \
+    do { if (g_trace_enabled) trace_instant(name); } while (0)
+
+#define TRACE_COUNTER(name, value) \
+    do { if (g_trace_enabled) trace_counter(name, value); } while (0)
+
+#define TRACE_THREAD_NAME(name) \
+    do { if (g_trace_enabled) trace_set_thread_name(name); } while (0)
+
+#endif /* TRACE_H */
@@ -1,46 +1,90 @@
 /* =========================================================================
  *  VehicleInfoWindow.c — fullscreen GTK window for live car data
  * -------------------------------------------------------------------------
- *  • Spawns the helper script (see SCRIPT_PATH) and reads one-line JSON
- *    frames (≤4 KiB ⇒ atomic pipe writes).
- *  • Updates eight value labels and a status label in real time.
+ *  • Receives decoded frames from the telemetry session (Telemetry.h:
+ *    the obd_reader.py child, or the synthetic ECU under --simulate).
+ *  • Pages (VehiclePages.def) each show a few PidTable.def PIDs; only the
+ *    visible page's PIDs are requested from the backend, so flipping
+ *    pages (‹ › buttons, ← → keys) changes what the reader polls.
+ *  • Values are Readout.h widgets: fixed width, tabular digits, and an
+ *    update only redraws the value itself — the grid is never re-laid
+ *    out while data streams in.
+ *  • “Read DTCs” (or the D key) reads the stored trouble codes (Mode 03)
+ *    as a high-priority one-off request between polls and shows them
+ *    on the HUD.
  *  • Tracks best / worst inter-frame latency, printing milestones to stdout.
- *  • Retries the script every RETRY_INTERVAL_SEC until a connection is made.
+ *  • Built once at startup; attached to the telemetry session only while
+ *    shown (attached on "show", detached on "hide").
  * ========================================================================= */
 #include "VehicleInfoWindow.h"
+#include "Telemetry.h"
+#include "ObdFrame.h"
+#include "Readout.h"
+#include "Popup.h"
+#include "Trace.h"
+#include "EventLog.h"
 
 #include <json-glib/json-glib.h>
 #include <gdk/gdkkeysyms.h>
 #include <float.h>
-#include <signal.h>
-#include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
 /* ------------------------------------------------------------------ */
-/*  Settings                                                          */
+/*  Pages                                                             */
 /* ------------------------------------------------------------------ */
-static const char SCRIPT_PATH[]      = "../scripts/obd_reader.py";
-static const int  RETRY_INTERVAL_SEC = 10;
+#define PAGE_MAX_PIDS 8                  /* rows that fit at Sans 38 */
 
-static const char *columns[] = {
-    "RPM", "SPEED", "ENGINE LOAD",
-    "THROTTLE POSITION", "INTAKE PRESSURE",
-    "TIMING ADVANCE", "FUEL LEVEL", "CONTROL MODULE VOLTAGE"
+static const char VALUE_FONT[]  = "Sans 38";
+static const char VALUE_COLOR[] = "#00AAFF";
+
+typedef struct {
+    const char *title;
+    guint       n_pids;
+    PidId       pids[PAGE_MAX_PIDS];
+} VehiclePage;
+
+typedef enum {
+#define PAGE_DEF(id, title, ...) PAGE_##id,
+#include "VehiclePages.def"
+#undef PAGE_DEF
+    PAGE_COUNT
+} PageId;
+
+#define PAGE_N_PIDS(...) (sizeof((const PidId[]){ __VA_ARGS__ }) / sizeof(PidId))
+
+#define PAGE_DEF(id, title, ...) \
+    G_STATIC_ASSERT(PAGE_N_PIDS(__VA_ARGS__) <= PAGE_MAX_PIDS);
+#include "VehiclePages.def"
+#undef PAGE_DEF
+
+/* Not const: --custom-page rewrites PAGE_CUSTOM before the window is built */
+static VehiclePage g_pages[PAGE_COUNT] = {
+#define PAGE_DEF(id, title, ...) \
+    [PAGE_##id] = { title, PAGE_N_PIDS(__VA_ARGS__), { __VA_ARGS__ } },
+#include "VehiclePages.def"
+#undef PAGE_DEF
 };
 
 /* ------------------------------------------------------------------ */
 /*  Context                                                           */
 /* ------------------------------------------------------------------ */
 typedef struct {
-    GtkWidget  *value_lbls[G_N_ELEMENTS(columns)];
+    GtkWidget  *grid;
+    GtkWidget  *values[PAGE_MAX_PIDS];      /* Readout.h */
+} PageWidgets;
+
+typedef struct {
+    PageWidgets pages[PAGE_COUNT];
+    GtkWidget  *stack;
+    GtkWidget  *page_label;
+    guint       page;         /* visible PageId */
     GtkWidget  *status_label;
+    JsonParser *parser;       /* external feed only */
     gboolean    connected;
-
-    GPid        pid;          /* child PID */
-    GIOChannel *io;           /* child's stdout */
-    guint       retry_tag;
+    gboolean    active;       /* window shown → backend running */
+    guint       dtc_request;  /* pending Mode 03, 0 = none */
 
     gint64   start_time;
     gint64   last_time;
@@ -48,26 +92,112 @@ typedef struct {
     gdouble  worst_delta;
 } VehicleCtx;
 
+/* The pooled window (built once) */
+static GtkWidget  *g_vehicle_win   = NULL;
+static gboolean    g_external_feed = FALSE;   /* frames pushed, no backend */
+
 /* ------------------------------------------------------------------ */
 /*  Forward declarations                                              */
 /* ------------------------------------------------------------------ */
+static GtkWidget *build_vehicle_info_window(GtkWindow *parent);
 static void     set_status(VehicleCtx *ctx, gboolean ok);
 static void     set_status_markup(VehicleCtx *ctx, const char *markup);
-static gboolean spawn_reader(VehicleCtx *ctx);
-static gboolean parse_line_cb(GIOChannel *, GIOCondition, gpointer);
-static void     on_obd_child_exit(GPid, gint, gpointer);
+static void     show_page(VehicleCtx *ctx, guint page);
+static void     clear_page(VehicleCtx *ctx);
+static guint64  page_pid_mask(const VehiclePage *page);
+static void     on_page_prev(GtkWidget *, gpointer);
+static void     on_page_next(GtkWidget *, gpointer);
+static void     on_frame(const ObdFrame *frame, gpointer);
+static void     on_link(gboolean up, gpointer);
+static void     apply_frame(VehicleCtx *ctx, const ObdFrame *frame);
+static void     read_dtcs(VehicleCtx *ctx);
+static void     on_dtcs(const ObdReply *reply, gpointer);
+static void     on_read_dtcs(GtkWidget *, gpointer);
 static void     on_back_clicked(GtkWidget *, gpointer);
 static gboolean on_key_press(GtkWidget *, GdkEventKey *, gpointer);
+static gboolean on_delete_event(GtkWidget *, GdkEvent *, gpointer);
+static void     on_show(GtkWidget *, gpointer);
+static void     on_hide(GtkWidget *, gpointer);
 static void     on_destroy(GtkWidget *, gpointer);
 static void     hide_cursor_on_realize(GtkWidget *, gpointer);
 
 /* ------------------------------------------------------------------ */
 /*  Public API                                                        */
 /* ------------------------------------------------------------------ */
-GtkWidget *create_vehicle_info_window(GtkWindow *parent)
+void vehicle_info_window_init(GtkWindow *parent)
+{
+    if (g_vehicle_win)                  /* already built */
+        return;
+    g_vehicle_win = build_vehicle_info_window(parent);
+}
+
+GtkWidget *open_vehicle_info_window(GtkWindow *parent)
+{
+    if (!g_vehicle_win)
+        vehicle_info_window_init(parent);
+    gtk_window_present(GTK_WINDOW(g_vehicle_win));   /* "show" starts the feed */
+    return g_vehicle_win;
+}
+
+void vehicle_info_window_set_external_feed(gboolean external)
+{
+    g_external_feed = external;
+}
+
+gboolean vehicle_info_window_set_custom_page(const char *pid_names)
+/* ----------------------------------------------------------------------
+ *  "RPM,COOLANT TEMP,…" → PAGE_CUSTOM.  Names match PidTable.def
+ *  (case-insensitive).  On any error the default page is kept.
+ * ---------------------------------------------------------------------- */
+{
+    if (g_vehicle_win) {
+        g_printerr("[OBD] custom page must be set before the window is built\n");
+        return FALSE;
+    }
+
+    VehiclePage page  = { .title = g_pages[PAGE_CUSTOM].title };
+    gchar     **names = g_strsplit(pid_names, ",", -1);
+    gboolean    ok    = TRUE;
+
+    for (guint n = 0; ok && names[n]; n++) {
+        const gchar *want = g_strstrip(names[n]);
+        gint i = pid_lookup(want);
+
+        if (i < 0) {
+            g_printerr("[OBD] unknown PID '%s' in custom page\n", want);
+            ok = FALSE;
+        } else if (page.n_pids == PAGE_MAX_PIDS) {
+            g_printerr("[OBD] custom page holds at most %d PIDs\n", PAGE_MAX_PIDS);
+            ok = FALSE;
+        } else {
+            page.pids[page.n_pids++] = (PidId)i;
+        }
+    }
+    g_strfreev(names);
+
+    if (ok && page.n_pids)
+        g_pages[PAGE_CUSTOM] = page;
+    return ok && page.n_pids;
+}
+
+void vehicle_info_window_feed_frame(const gchar *line, gsize len)
+{
+    if (!g_vehicle_win)
+        return;
+    VehicleCtx *ctx = g_object_get_data(G_OBJECT(g_vehicle_win), "vctx");
+    ObdFrame frame;
+    if (obd_frame_parse(ctx->parser, line, len, &frame))
+        apply_frame(ctx, &frame);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Window construction (runs once)                                   */
+/* ------------------------------------------------------------------ */
+static GtkWidget *build_vehicle_info_window(GtkWindow *parent)
 {
     VehicleCtx *ctx = g_new0(VehicleCtx, 1);
     ctx->best_delta  = DBL_MAX;
+    ctx->parser      = json_parser_new();
 
     GtkWidget *win = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(win), "Vehicle Info");
@@ -80,7 +210,10 @@ GtkWidget *create_vehicle_info_window(GtkWindow *parent)
     }
 
     g_signal_connect(win, "destroy",         G_CALLBACK(on_destroy),     ctx);
-    g_signal_connect(win, "key-press-event", G_CALLBACK(on_key_press),   NULL);
+    g_signal_connect(win, "show",            G_CALLBACK(on_show),        ctx);
+    g_signal_connect(win, "hide",            G_CALLBACK(on_hide),        ctx);
+    g_signal_connect(win, "key-press-event", G_CALLBACK(on_key_press),   ctx);
+    g_signal_connect(win, "delete-event",    G_CALLBACK(on_delete_event), NULL);
     g_signal_connect(win, "realize",         G_CALLBACK(hide_cursor_on_realize), NULL);
 
     /*   Layout  */
@@ -105,6 +238,19 @@ GtkWidget *create_vehicle_info_window(GtkWindow *parent)
     g_signal_connect(back, "clicked", G_CALLBACK(on_back_clicked), win);
     gtk_box_pack_start(GTK_BOX(bar), back, FALSE, FALSE, 0);
 
+    /* Page switcher — ‹ title › in the middle of the bar */
+    GtkWidget *pager = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 24);
+    GtkWidget *prev  = gtk_button_new_with_label("‹");
+    GtkWidget *next  = gtk_button_new_with_label("›");
+    ctx->page_label  = gtk_label_new(NULL);
+    g_signal_connect(prev, "clicked", G_CALLBACK(on_page_prev), ctx);
+    g_signal_connect(next, "clicked", G_CALLBACK(on_page_next), ctx);
+    gtk_box_pack_start(GTK_BOX(pager), prev, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(pager), ctx->page_label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(pager), next, FALSE, FALSE, 0);
+    gtk_widget_set_valign(pager, GTK_ALIGN_START);
+    gtk_box_set_center_widget(GTK_BOX(bar), pager);
+
     ctx->status_label = gtk_label_new(NULL);
     gtk_label_set_use_markup(GTK_LABEL(ctx->status_label), TRUE);
     set_status(ctx, FALSE);  /* starts as “Connecting” */
@@ -112,39 +258,143 @@ GtkWidget *create_vehicle_info_window(GtkWindow *parent)
     gtk_widget_set_valign(ctx->status_label, GTK_ALIGN_START);
     gtk_box_pack_end(GTK_BOX(bar), ctx->status_label, FALSE, FALSE, 10);
 
-    /* PID grid */
-    GtkWidget *grid = gtk_grid_new();
-    gtk_grid_set_row_spacing(GTK_GRID(grid), 12);
-    gtk_grid_set_column_spacing(GTK_GRID(grid), 24);
-    gtk_box_pack_start(GTK_BOX(vbox), grid, FALSE, FALSE, 10);
-
-    /* 
-     * Make 8 rows, each with "PID Name" on the left,
-     * and "Value" on the right. Modify the font size & color as you wish.
-     */
-    for (guint i = 0; i < G_N_ELEMENTS(columns); i++) {
-        GtkWidget *key = gtk_label_new(NULL);
-        gchar *km = g_strdup_printf(
-            "<span font_desc='Sans 38' foreground='#FFFFFF'>%s</span>", columns[i]);
-        gtk_label_set_markup(GTK_LABEL(key), km);
-        g_free(km);
-        gtk_widget_set_halign(key, GTK_ALIGN_START);
-        gtk_grid_attach(GTK_GRID(grid), key, 0, i, 1, 1);
-
-        ctx->value_lbls[i] = gtk_label_new(NULL);
-        gtk_label_set_markup(GTK_LABEL(ctx->value_lbls[i]),
-        "<span font_desc='Sans 38' foreground='#00AAFF'>--</span>");
-
-        gtk_widget_set_halign(ctx->value_lbls[i], GTK_ALIGN_END);
-        gtk_grid_attach(GTK_GRID(grid), ctx->value_lbls[i], 1, i, 1, 1);
+    GtkWidget *dtcs = gtk_button_new_with_label("Read DTCs");
+    gtk_widget_set_valign(dtcs, GTK_ALIGN_START);
+    g_signal_connect(dtcs, "clicked", G_CALLBACK(on_read_dtcs), ctx);
+    gtk_box_pack_end(GTK_BOX(bar), dtcs, FALSE, FALSE, 0);
+
+    /* One PID grid per page, stacked */
+    ctx->stack = gtk_stack_new();
+    gtk_box_pack_start(GTK_BOX(vbox), ctx->stack, FALSE, FALSE, 10);
+
+    for (guint p = 0; p < PAGE_COUNT; p++) {
+        const VehiclePage *page = &g_pages[p];
+        GtkWidget *grid = gtk_grid_new();
+        gtk_grid_set_row_spacing(GTK_GRID(grid), 12);
+        gtk_grid_set_column_spacing(GTK_GRID(grid), 24);
+        gtk_container_add(GTK_CONTAINER(ctx->stack), grid);
+        ctx->pages[p].grid = grid;
+
+        /* 
+         * One row per PID on the page, with "PID Name" on the left,
+         * and "Value" on the right. Modify the font size & color as you wish.
+         */
+        for (guint r = 0; r < page->n_pids; r++) {
+            GtkWidget *key = gtk_label_new(NULL);
+            gchar *km = g_strdup_printf(
+                "<span font_desc='Sans 38' foreground='#FFFFFF'>%s</span>",
+                PID_TABLE[page->pids[r]].name);
+            gtk_label_set_markup(GTK_LABEL(key), km);
+            g_free(km);
+            gtk_widget_set_halign(key, GTK_ALIGN_START);
+            gtk_grid_attach(GTK_GRID(grid), key, 0, r, 1, 1);
+
+            GtkWidget *val = readout_new(page->pids[r], VALUE_FONT, VALUE_COLOR);
+            gtk_widget_set_halign(val, GTK_ALIGN_END);
+            gtk_widget_set_valign(val, GTK_ALIGN_CENTER);
+            gtk_grid_attach(GTK_GRID(grid), val, 1, r, 1, 1);
+            ctx->pages[p].values[r] = val;
+        }
     }
 
-    /* Kick off the Python helper */
-    spawn_reader(ctx);
-
+    /* Children visible, toplevel hidden until open_vehicle_info_window() */
+    gtk_widget_show_all(vbox);
+    show_page(ctx, PAGE_ENGINE);
+    gtk_widget_realize(win);
     return win;
 }
 
+/* ------------------------------------------------------------------ */
+/*  Show / hide — one backend session per visit                       */
+/* ------------------------------------------------------------------ */
+static void on_show(GtkWidget *, gpointer data)
+{
+    TRACE_SCOPE("vehicle_info_show");
+    VehicleCtx *ctx = data;
+
+    clear_page(ctx);
+    set_status(ctx, FALSE);
+
+    ctx->start_time  = 0;
+    ctx->last_time   = 0;
+    ctx->best_delta  = DBL_MAX;
+    ctx->worst_delta = 0;
+
+    ctx->active = TRUE;
+    if (!g_external_feed)
+        telemetry_attach_view(TELEMETRY_VIEW_DASHBOARD,
+                              page_pid_mask(&g_pages[ctx->page]),
+                              on_frame, on_link, ctx);
+}
+
+static void on_hide(GtkWidget *, gpointer data)
+{
+    VehicleCtx *ctx = data;
+    if (ctx->active && !g_external_feed)
+        telemetry_detach_view(TELEMETRY_VIEW_DASHBOARD);
+    ctx->active = FALSE;
+    telemetry_cancel(ctx->dtc_request);
+    ctx->dtc_request = 0;
+
+    /* Session summary */
+    if (ctx->start_time && ctx->last_time)
+        EVLOG(OBD_SESSION, (ctx->last_time - ctx->start_time) / 1e6,
+              ctx->best_delta * 1e3, ctx->worst_delta * 1e3);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Pages                                                             */
+/* ------------------------------------------------------------------ */
+static guint64 page_pid_mask(const VehiclePage *page)
+{
+    guint64 mask = 0;
+    for (guint r = 0; r < page->n_pids; r++)
+        mask |= G_GUINT64_CONSTANT(1) << page->pids[r];
+    return mask;
+}
+
+static void clear_page(VehicleCtx *ctx)
+{
+    const PageWidgets *pw = &ctx->pages[ctx->page];
+    for (guint r = 0; r < g_pages[ctx->page].n_pids; r++)
+        readout_set_text(pw->values[r], "--");
+}
+
+static void show_page(VehicleCtx *ctx, guint page)
+/* ----------------------------------------------------------------------
+ *  Switch the visible grid and hand the new PID set to the backend
+ *  right away, so the old page's PIDs stop being polled.  Values start
+ *  at "--": whatever the labels showed last time is stale by now.
+ * ---------------------------------------------------------------------- */
+{
+    TRACE_SCOPE("vehicle_show_page");
+    ctx->page = page % PAGE_COUNT;
+    gtk_stack_set_visible_child(GTK_STACK(ctx->stack), ctx->pages[ctx->page].grid);
+
+    gchar *markup = g_markup_printf_escaped(
+        "<span font_desc='Sans 38' foreground='#FFFFFF'>%s</span>",
+        g_pages[ctx->page].title);
+    gtk_label_set_markup(GTK_LABEL(ctx->page_label), markup);
+    g_free(markup);
+
+    clear_page(ctx);
+    if (ctx->active && !g_external_feed)
+        telemetry_set_view_pids(TELEMETRY_VIEW_DASHBOARD,
+                                page_pid_mask(&g_pages[ctx->page]));
+}
+
+static void on_page_prev(GtkWidget *, gpointer data)
+{
+    VehicleCtx *ctx = data;
+    show_page(ctx, ctx->page + PAGE_COUNT - 1);
+}
+
+static void on_page_next(GtkWidget *, gpointer data)
+{
+    VehicleCtx *ctx = data;
+    show_page(ctx, ctx->page + 1);
+}
+
 /* ------------------------------------------------------------------ */
 /*  Status helpers                                                    */
 /* ------------------------------------------------------------------ */
@@ -168,91 +418,34 @@ static void set_status_markup(VehicleCtx *ctx, const char *markup)
 }
 
 /* ------------------------------------------------------------------ */
-/*  Spawn & I/O                                                       */
+/*  Backend callbacks                                                 */
 /* ------------------------------------------------------------------ */
-static gboolean spawn_reader(VehicleCtx *ctx)
+static void on_frame(const ObdFrame *frame, gpointer data)
 {
-    if (ctx->io) return G_SOURCE_REMOVE;            /* already running */
-
-    gint stdout_fd = -1;
-    gchar *argv[] = {"python3", (gchar *)SCRIPT_PATH, NULL};
-
-    if (!g_spawn_async_with_pipes(
-            NULL, argv, NULL,
-            G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH,
-            NULL, NULL, &ctx->pid,
-            NULL, &stdout_fd, NULL, NULL))
-    {
-        g_printerr("[OBD] Failed to spawn helper.\n");
-        ctx->retry_tag = g_timeout_add_seconds(RETRY_INTERVAL_SEC,
-                                               (GSourceFunc)spawn_reader, ctx);
-        return G_SOURCE_REMOVE;
-    }
-
-    g_child_watch_add(ctx->pid, on_obd_child_exit, ctx);
-
-    ctx->io = g_io_channel_unix_new(stdout_fd);
-    g_io_channel_set_encoding(ctx->io, NULL, NULL);     /* raw bytes */
-    g_io_add_watch(ctx->io, G_IO_IN | G_IO_HUP | G_IO_ERR, parse_line_cb, ctx);
-
-    return G_SOURCE_REMOVE;
+    TRACE_SCOPE("vehicle_frame");
+    apply_frame(data, frame);
 }
 
-static gboolean parse_line_cb(GIOChannel *ch, GIOCondition cond, gpointer data)
+static void on_link(gboolean up, gpointer data)
+/* Link loss drops back to "Connecting"; the first frame marks it up. */
 {
-    VehicleCtx *ctx = data;
-
-    if (cond & (G_IO_HUP | G_IO_ERR)) {
-        set_status(ctx, FALSE);
-        if (ctx->io) {
-            g_io_channel_shutdown(ctx->io, FALSE, NULL);
-            g_io_channel_unref(ctx->io);
-            ctx->io = NULL;
-        }
-        if (!ctx->retry_tag)
-            ctx->retry_tag = g_timeout_add_seconds(
-                RETRY_INTERVAL_SEC, (GSourceFunc)spawn_reader, ctx);
-        return G_SOURCE_REMOVE;
-    }
-
-    gchar *line = NULL;
-    gsize  len  = 0;
-    if (g_io_channel_read_line(ch, &line, &len, NULL, NULL)
-            != G_IO_STATUS_NORMAL || !line)
-    {
-        g_free(line);
-        return TRUE;                                     /* wait for more */
-    }
+    if (!up)
+        set_status(data, FALSE);
+}
 
-    JsonParser *jp = json_parser_new();
-    if (json_parser_load_from_data(jp, line, len, NULL)) {
-        JsonObject *obj = json_node_get_object(json_parser_get_root(jp));
-
-        /* mark connection */
-        if (json_object_get_size(obj) > 0 && !ctx->connected)
-            set_status(ctx, TRUE);
-
-        for (guint i = 0; i < G_N_ELEMENTS(columns); i++) {
-            if (!json_object_has_member(obj, columns[i])) continue;
-            double v = json_object_get_double_member(obj, columns[i]);
-            gchar *txt = NULL;
-            switch (i) {
-                case 0:  txt = g_strdup_printf("%.0f",     v);                  break; /* RPM */
-                case 1:  txt = g_strdup_printf("%.0f mph", v * 0.621371);        break; /* SPEED */
-                case 4:  txt = g_strdup_printf("%.0f kPa", v);                   break; /* PRESSURE */
-                case 5:  txt = g_strdup_printf("%.1f°",    v);                   break; /* ADVANCE */
-                case 7:  txt = g_strdup_printf("%.1f V",   v);                   break; /* VOLTAGE */
-                default: txt = g_strdup_printf("%.1f %%",  v);                   break;
-            }
-            gchar *markup = g_strdup_printf(
-                "<span font_desc='Sans 38' foreground='#00AAFF'>%s</span>", txt);
-            gtk_label_set_markup(GTK_LABEL(ctx->value_lbls[i]), markup);
-            g_free(markup);
-            g_free(txt);
-        }
+static void apply_frame(VehicleCtx *ctx, const ObdFrame *frame)
+/* Show one decoded frame on the visible page and update latency stats. */
+{
+    /* mark connection */
+    if (frame->present && !ctx->connected)
+        set_status(ctx, TRUE);
+
+    const VehiclePage *page = &g_pages[ctx->page];
+    for (guint r = 0; r < page->n_pids; r++) {
+        PidId id = page->pids[r];
+        if (!(frame->present & (G_GUINT64_CONSTANT(1) << id))) continue;
+        readout_set_value(ctx->pages[ctx->page].values[r], frame->value[id]);
     }
-    g_object_unref(jp);
-    g_free(line);
 
     /* ── latency stats ── */
     gint64 now = g_get_monotonic_time();
@@ -260,53 +453,105 @@ static gboolean parse_line_cb(GIOChannel *ch, GIOCondition cond, gpointer data)
         gdouble delta = (now - ctx->last_time) / 1e6;
         if (delta < ctx->best_delta) {
             ctx->best_delta = delta;
-            g_print("[OBD] new best  %.3f ms\n", delta * 1e3);
+            EVLOG(OBD_NEW_BEST, delta * 1e3);
         }
         if (delta > ctx->worst_delta) {
             ctx->worst_delta = delta;
-            g_print("[OBD] new worst %.3f ms\n", delta * 1e3);
+            EVLOG(OBD_NEW_WORST, delta * 1e3);
         }
     } else {
         ctx->start_time = now;
     }
     ctx->last_time = now;
-    return TRUE;
 }
 
-static void on_obd_child_exit(GPid pid, gint, gpointer data)
+/* ------------------------------------------------------------------ */
+/*  Trouble codes                                                     */
+/* ------------------------------------------------------------------ */
+static void read_dtcs(VehicleCtx *ctx)
+{
+    if (ctx->dtc_request || g_external_feed)
+        return;
+    ctx->dtc_request = telemetry_request("03", VEHICLE_PRIORITY_HIGH, on_dtcs, ctx);
+    if (ctx->dtc_request)
+        show_temp_popup("Reading trouble codes…");
+}
+
+static void on_read_dtcs(GtkWidget *, gpointer data)
+{ read_dtcs(data); }
+
+static void on_dtcs(const ObdReply *reply, gpointer data)
 {
     VehicleCtx *ctx = data;
-    g_spawn_close_pid(pid);
-    ctx->pid = 0;
-    if (!ctx->retry_tag)
-        ctx->retry_tag = g_timeout_add_seconds(
-            RETRY_INTERVAL_SEC, (GSourceFunc)spawn_reader, ctx);
+    ctx->dtc_request = 0;
+
+    ObdDtc  codes[3];
+    guint   n   = obd_reply_dtcs(reply, codes, G_N_ELEMENTS(codes));
+    GString *msg = g_string_new(NULL);
+    switch (reply->status) {
+    case OBD_REPLY_OK:
+        for (guint i = 0; i < n; i++)
+            g_string_append_printf(msg, i ? "  %s" : "%s", codes[i]);
+        if (!n)
+            g_string_assign(msg, "No trouble codes");
+        break;
+    case OBD_REPLY_NO_DATA:
+        g_string_assign(msg, "No answer from the ECU");
+        break;
+    case OBD_REPLY_UNSUPPORTED:
+        g_string_assign(msg, "Trouble codes need the OBD adapter");
+        break;
+    default:
+        g_string_assign(msg, "Reading trouble codes failed");
+        break;
+    }
+    show_temp_popup(msg->str);
+    g_string_free(msg, TRUE);
 }
 
 static void on_back_clicked(GtkWidget *, gpointer win)
-{ gtk_widget_destroy(GTK_WIDGET(win)); }
+{ gtk_widget_hide(GTK_WIDGET(win)); }
 
-static gboolean on_key_press(GtkWidget *w, GdkEventKey *e, gpointer)
+static gboolean on_key_press(GtkWidget *w, GdkEventKey *e, gpointer data)
 {
-    if (e->keyval == GDK_KEY_Escape) {
-        gtk_widget_destroy(w);
+    VehicleCtx *ctx = data;
+
+    switch (e->keyval) {
+    case GDK_KEY_Escape:
+        gtk_widget_hide(w);
+        return TRUE;
+    case GDK_KEY_Left:
+        on_page_prev(NULL, ctx);
         return TRUE;
+    case GDK_KEY_Right:
+        on_page_next(NULL, ctx);
+        return TRUE;
+    case GDK_KEY_d:
+    case GDK_KEY_D:
+        on_read_dtcs(NULL, ctx);
+        return TRUE;
+    default:
+        return FALSE;
     }
-    return FALSE;
 }
 
-static void on_destroy(GtkWidget *w, gpointer data)
+/* Window-manager close → keep the pooled window, just hide it */
+static gboolean on_delete_event(GtkWidget *w, GdkEvent *, gpointer)
 {
-    VehicleCtx *ctx = data;
-    if (ctx->pid)  kill(ctx->pid, SIGTERM);
-    if (ctx->io)   g_io_channel_unref(ctx->io);
-    if (ctx->retry_tag) g_source_remove(ctx->retry_tag);
+    gtk_widget_hide(w);
+    return TRUE;
+}
 
-    /* Session summary */
-    if (ctx->start_time && ctx->last_time)
-        g_print("[OBD] session %.1f s   best %.3f ms   worst %.3f ms\n",
-                (ctx->last_time - ctx->start_time) / 1e6,
-                ctx->best_delta * 1e3, ctx->worst_delta * 1e3);
+static void on_destroy(GtkWidget *, gpointer data)
+{
+    VehicleCtx *ctx = data;
+    if (ctx->active && !g_external_feed)
+        telemetry_detach_view(TELEMETRY_VIEW_DASHBOARD);
+    ctx->active = FALSE;
+    telemetry_cancel(ctx->dtc_request);
+    ctx->dtc_request = 0;
+    g_clear_object(&ctx->parser);
+    g_vehicle_win = NULL;
 }
 
 static void hide_cursor_on_realize(GtkWidget *w, gpointer)
@@ -315,10 +560,8 @@ static void hide_cursor_on_realize(GtkWidget *w, gpointer)
     GdkDisplay *d = gdk_window_get_display(gw);
     GdkPixbuf *pb = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, 1, 1);
     gdk_pixbuf_fill(pb, 0);
-    // GdkCursor *c = gdk_cursor_new_from_pixbuf(d, pb, 0, 0);
-    // gdk_window_set_cursor(gw, c);
-    // g_object_unref(c);
     GdkCursor *c = gdk_cursor_new_from_pixbuf(d, pb, 0, 0);
-    gdk_window_set_cursor(gw, c);
+    gdk_window_set_cursor(gw, c);       /* the window keeps its own ref */
+    g_object_unref(c);
     g_object_unref(pb);
 }
@@ -1,19 +1,41 @@
 /* =========================================================================
  *  VehicleInfoWindow.h — live OBD-II dashboard
  * -------------------------------------------------------------------------
- *  create_vehicle_info_window(parent)
- *      Opens a full-screen window that
- *          • spawns  Infotainment/scripts/obd_reader.py
- *          • retries every 10 s until data arrive
+ *  vehicle_info_window_init(parent)
+ *      Builds the (hidden) full-screen dashboard once at startup.
+ *
+ *  open_vehicle_info_window(parent)
+ *      Shows the pooled window.  While it is visible the window
+ *          • attaches to the telemetry session (Telemetry.h), which runs
+ *            the vehicle backend (obd_reader.py, retried every 10 s until
+ *            data arrive, or the --simulate ECU)
  *          • shows connection status (“Connecting” ↔ “Connected”)
- *          • displays eight key PIDs (RPM, SPEED …) in a 2-column grid
- *      The window owns the Python child process and cleans up on close.
+ *          • displays one page of PIDs (VehiclePages.def: Engine, Fuel /
+ *            Electrical, Custom) in a 2-column grid; ‹ › or ← → flip
+ *            pages and the backend polls only the visible page's PIDs
+ *      Hiding the window (Back / Esc) detaches it; the backend keeps
+ *      running only if alert rules need it.
+ *      Returns the window.
+ *
+ *  vehicle_info_window_set_custom_page("RPM,COOLANT TEMP,…")
+ *      Replaces the Custom page's PIDs (PidTable.def names, at most 8).
+ *      Call before vehicle_info_window_init(); FALSE on a bad list.
+ *
+ *  vehicle_info_window_set_external_feed(TRUE)
+ *  vehicle_info_window_feed_frame(line, len)
+ *      Skip the vehicle backend and push frames directly (same
+ *      one-line format obd_reader.py prints) — used by benchmarks.
  * ========================================================================= */
 #ifndef VEHICLEINFOWINDOW_H
 #define VEHICLEINFOWINDOW_H
 
 #include <gtk/gtk.h>
 
-GtkWidget *create_vehicle_info_window(GtkWindow *parent);
+void vehicle_info_window_init(GtkWindow *parent);
+GtkWidget *open_vehicle_info_window(GtkWindow *parent);
+
+gboolean vehicle_info_window_set_custom_page(const char *pid_names);
+void vehicle_info_window_set_external_feed(gboolean external);
+void vehicle_info_window_feed_frame       (const gchar *line, gsize len);
 
 #endif /* VEHICLEINFOWINDOW_H */
@@ -0,0 +1,311 @@
+/* =========================================================================
+ *  VehicleReader.c — real vehicle-data backend (obd_reader.py child)
+ * -------------------------------------------------------------------------
+ *  • Spawns the helper script (see SCRIPT_PATH) with --raw and reads
+ *    one-line raw frames (≤4 KiB ⇒ atomic pipe writes) from its stdout;
+ *    ObdFrame decodes them with the PidTable.def formulas.
+ *  • Control channel: the child's stdin.  The PID set to poll goes out as
+ *    `--pids=` on spawn and as a "P id,id,…" line whenever set_pids()
+ *    changes it, so the script drops off-screen PIDs between queries.
+ *    The heartbeat floor goes the same way: `--min-period=` / "T ms".
+ *  • One-off requests go out as "Q tag prio hex" ("X tag" cancels).
+ *    Their lines are kept until the "A tag …" answer passes through
+ *    read_line_cb, and written again to a respawned reader, so a
+ *    reconnect delays a request instead of losing it.
+ *  • Retries the script every RETRY_INTERVAL_SEC until a connection is
+ *    made, and again whenever it exits or closes its pipe.
+ *  • Exposed as OBD_READER_VEHICLE_BACKEND (see Hal.h); only one reader
+ *    session exists at a time.
+ * ========================================================================= */
+#include "Hal.h"
+#include "Trace.h"
+#include "Metrics.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+static const char SCRIPT_PATH[]      = "../scripts/obd_reader.py";
+static const int  RETRY_INTERVAL_SEC = 10;
+
+/* ------------------------------------------------------------------ */
+/*  Session state                                                     */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    gboolean          active;       /* start() called, stop() not yet */
+    VehicleFrameFunc  on_frame;
+    VehicleLinkFunc   on_link;
+    gpointer          user_data;
+
+    guint64     pids;               /* PID mask to poll */
+    gboolean    pids_set;           /* FALSE → every PID */
+    guint       min_period_ms;      /* 0 → table rates */
+    GPtrArray  *requests;           /* unanswered "Q …\n" lines */
+
+    GPid        pid;                /* child PID */
+    gint        ctl_fd;             /* child's stdin (non-blocking), -1 */
+    GIOChannel *io;                 /* child's stdout */
+    guint       io_tag;
+    guint       retry_tag;
+} ReaderSession;
+
+static ReaderSession g_reader = { .ctl_fd = -1 };
+
+/* ------------------------------------------------------------------ */
+/*  Forward declarations                                              */
+/* ------------------------------------------------------------------ */
+static gboolean spawn_reader(gpointer);
+static void     close_pipe(void);
+static gchar   *format_pid_list(guint64 mask);
+static void     send_pid_set(void);
+static void     send_control(const gchar *line);
+static gboolean forget_request(guint tag);
+static void     schedule_retry(void);
+static gboolean read_line_cb(GIOChannel *, GIOCondition, gpointer);
+static void     on_child_exit(GPid, gint, gpointer);
+
+/* ------------------------------------------------------------------ */
+/*  Backend entry points                                              */
+/* ------------------------------------------------------------------ */
+static void reader_start(VehicleFrameFunc on_frame, VehicleLinkFunc on_link,
+                         gpointer user_data)
+{
+    g_reader.on_frame  = on_frame;
+    g_reader.on_link   = on_link;
+    g_reader.user_data = user_data;
+    g_reader.active    = TRUE;
+    spawn_reader(NULL);                 /* kick off the Python helper */
+}
+
+static void reader_stop(void)
+/* Tear down the current reader (if any) without scheduling a retry. */
+{
+    g_reader.active = FALSE;
+    if (g_reader.retry_tag) {
+        g_source_remove(g_reader.retry_tag);
+        g_reader.retry_tag = 0;
+    }
+    close_pipe();
+    if (g_reader.pid) kill(g_reader.pid, SIGTERM);  /* reaped by on_child_exit */
+}
+
+static void reader_set_pids(guint64 pid_mask)
+{
+    if (g_reader.pids_set && g_reader.pids == pid_mask)
+        return;
+    g_reader.pids     = pid_mask;
+    g_reader.pids_set = TRUE;
+    send_pid_set();                     /* no-op until the child runs */
+}
+
+static void reader_set_min_period(guint ms)
+{
+    if (g_reader.min_period_ms == ms)
+        return;
+    g_reader.min_period_ms = ms;
+
+    gchar *line = g_strdup_printf("T %u\n", ms);
+    send_control(line);
+    g_free(line);
+}
+
+static void reader_request(guint tag, VehiclePriority priority, const char *command)
+{
+    if (!g_reader.requests)
+        g_reader.requests = g_ptr_array_new_with_free_func(g_free);
+
+    gchar *line = g_strdup_printf("Q %u %d %s\n", tag, (int)priority, command);
+    g_ptr_array_add(g_reader.requests, line);
+    send_control(line);                 /* or on the next spawn */
+}
+
+static void reader_cancel(guint tag)
+{
+    if (!forget_request(tag))
+        return;                         /* already answered */
+    gchar *line = g_strdup_printf("X %u\n", tag);
+    send_control(line);
+    g_free(line);
+}
+
+const VehicleBackend OBD_READER_VEHICLE_BACKEND = {
+    .name           = "obd_reader.py",
+    .start          = reader_start,
+    .stop           = reader_stop,
+    .set_pids       = reader_set_pids,
+    .set_min_period = reader_set_min_period,
+    .request        = reader_request,
+    .cancel         = reader_cancel,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Spawn & I/O                                                       */
+/* ------------------------------------------------------------------ */
+static gboolean spawn_reader(gpointer)
+{
+    TRACE_SCOPE("spawn_reader");
+    g_reader.retry_tag = 0;                         /* this timeout is done */
+    if (!g_reader.active) return G_SOURCE_REMOVE;   /* session stopped */
+    if (g_reader.io) return G_SOURCE_REMOVE;        /* already running */
+
+    gint   stdin_fd = -1, stdout_fd = -1;
+    gchar *list     = g_reader.pids_set ? format_pid_list(g_reader.pids) : NULL;
+    gchar *pids_arg = list ? g_strconcat("--pids=", list, NULL) : NULL;
+    gchar *min_arg  = g_strdup_printf("--min-period=%u", g_reader.min_period_ms);
+    gchar *argv[]   = {"python3", (gchar *)SCRIPT_PATH, "--raw", "--control",
+                       min_arg, pids_arg, NULL};
+    g_free(list);
+
+    gboolean ok = g_spawn_async_with_pipes(
+            NULL, argv, NULL,
+            G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH,
+            NULL, NULL, &g_reader.pid,
+            &stdin_fd, &stdout_fd, NULL, NULL);
+    g_free(pids_arg);
+    g_free(min_arg);
+    if (!ok) {
+        g_printerr("[OBD] Failed to spawn helper.\n");
+        schedule_retry();
+        return G_SOURCE_REMOVE;
+    }
+
+    metrics_inc(METRIC_OBD_SPAWNS);
+    fcntl(stdin_fd, F_SETFL, fcntl(stdin_fd, F_GETFL) | O_NONBLOCK);
+    g_reader.ctl_fd = stdin_fd;
+
+    g_child_watch_add(g_reader.pid, on_child_exit, NULL);
+
+    g_reader.io = g_io_channel_unix_new(stdout_fd);
+    g_io_channel_set_encoding(g_reader.io, NULL, NULL);     /* raw bytes */
+    g_reader.io_tag = g_io_add_watch(g_reader.io, G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                     read_line_cb, NULL);
+    g_source_set_name_by_id(g_reader.io_tag, "obd-reader-io");
+
+    /* Unanswered requests; the pipe buffers them until the reader
+     * has connected and starts reading its control channel. */
+    for (guint i = 0; g_reader.requests && i < g_reader.requests->len; i++)
+        send_control(g_reader.requests->pdata[i]);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void close_pipe(void)
+{
+    if (g_reader.ctl_fd >= 0) { close(g_reader.ctl_fd); g_reader.ctl_fd = -1; }
+    if (g_reader.io_tag) { g_source_remove(g_reader.io_tag); g_reader.io_tag = 0; }
+    if (g_reader.io) {
+        g_io_channel_shutdown(g_reader.io, FALSE, NULL);
+        g_io_channel_unref(g_reader.io);
+        g_reader.io = NULL;
+    }
+}
+
+static void schedule_retry(void)
+{
+    if (g_reader.active && !g_reader.retry_tag) {
+        g_reader.retry_tag = g_timeout_add_seconds(
+            RETRY_INTERVAL_SEC, spawn_reader, NULL);
+        g_source_set_name_by_id(g_reader.retry_tag, "obd-reader-retry");
+    }
+}
+
+static gboolean read_line_cb(GIOChannel *ch, GIOCondition cond, gpointer)
+{
+    TRACE_SCOPE("read_line_cb");
+
+    if (cond & (G_IO_HUP | G_IO_ERR)) {
+        g_reader.io_tag = 0;                         /* removed by return */
+        close_pipe();
+        if (g_reader.on_link)
+            g_reader.on_link(FALSE, g_reader.user_data);
+        schedule_retry();
+        return G_SOURCE_REMOVE;
+    }
+
+    gchar *line = NULL;
+    gsize  len  = 0;
+    if (g_io_channel_read_line(ch, &line, &len, NULL, NULL)
+            != G_IO_STATUS_NORMAL || !line)
+    {
+        g_free(line);
+        return TRUE;                                 /* wait for more */
+    }
+
+    guint tag;
+    if (line[0] == 'A' && sscanf(line, "A %u", &tag) == 1)
+        forget_request(tag);
+
+    g_reader.on_frame(line, len, g_reader.user_data);
+    g_free(line);
+    return TRUE;
+}
+
+static void on_child_exit(GPid pid, gint, gpointer)
+{
+    g_spawn_close_pid(pid);
+    if (pid != g_reader.pid)            /* an older session's reader */
+        return;
+    g_reader.pid = 0;
+    schedule_retry();
+}
+
+/* ------------------------------------------------------------------ */
+/*  Control channel                                                   */
+/* ------------------------------------------------------------------ */
+static gchar *format_pid_list(guint64 mask)
+/* Bit mask → "0,1,5" (empty string for no PIDs). */
+{
+    GString *s = g_string_sized_new(64);
+    for (guint i = 0; i < 64; i++)
+        if (mask & (G_GUINT64_CONSTANT(1) << i))
+            g_string_append_printf(s, s->len ? ",%u" : "%u", i);
+    return g_string_free(s, FALSE);
+}
+
+static void send_pid_set(void)
+{
+    if (!g_reader.pids_set)
+        return;
+
+    gchar *list = format_pid_list(g_reader.pids);
+    gchar *line = g_strdup_printf("P %s\n", list);
+    send_control(line);
+    g_free(line);
+    g_free(list);
+}
+
+static gboolean forget_request(guint tag)
+/* Drop the kept line of request `tag`; FALSE if it was not pending. */
+{
+    for (guint i = 0; g_reader.requests && i < g_reader.requests->len; i++) {
+        guint t;
+        if (sscanf(g_reader.requests->pdata[i], "Q %u", &t) == 1 && t == tag) {
+            g_ptr_array_remove_index(g_reader.requests, i);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void send_control(const gchar *line)
+/* ----------------------------------------------------------------------
+ *  One short line per page change or request, far below PIPE_BUF, so
+ *  the write is atomic.  If the pipe is somehow full the update is
+ *  dropped: the child is not reading, and it gets the current state via
+ *  --pids=, --min-period= and the kept requests when it is respawned.
+ *  A child that already exited gives EPIPE: main() ignores SIGPIPE.
+ * ---------------------------------------------------------------------- */
+{
+    if (g_reader.ctl_fd < 0)
+        return;
+
+    if (write(g_reader.ctl_fd, line, strlen(line)) < 0
+            && errno != EPIPE && errno != EAGAIN)
+        g_printerr("[OBD] control write failed: %s\n", g_strerror(errno));
+}
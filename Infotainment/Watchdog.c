@@ -0,0 +1,238 @@
+/* =========================================================================
+ *  Watchdog.c — main-loop heartbeat, stall attribution and histogram
+ * -------------------------------------------------------------------------
+ *  Heartbeat
+ *  ---------
+ *      watchdog_poll() replaces GLib's poll function.  Leaving poll marks
+ *      the start of a busy period (check + dispatch + prepare); entering
+ *      poll again ends it.  `g_busy_since_us` is 0 while the loop sleeps.
+ *
+ *  Watchdog thread
+ *  ---------------
+ *      Wakes every budget/2 ms.  If the current busy period is older than
+ *      the budget, it reports the stall once: it signals the GTK thread
+ *      (SIGUSR2), whose handler records the current GSource and raw
+ *      return addresses; the watchdog thread then symbolises and logs them.
+ * ========================================================================= */
+#include "Watchdog.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "EventLog.h"
+
+#include <glib.h>
+#include <glib-unix.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ---------------------------------------------------------------------- */
+/*  Constants                                                             */
+/* ---------------------------------------------------------------------- */
+enum {
+    HIST_BUCKETS    = 24,     /* 1 µs … 2^23 µs (≈ 8.4 s) and above     */
+    MAX_BT_FRAMES   = 32,
+    CAPTURE_WAIT_MS = 20,     /* how long to wait for the SIGUSR2 handler */
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Module-wide state                                                     */
+/* ---------------------------------------------------------------------- */
+static guint       g_budget_us      = 0;
+static GPollFunc   g_orig_poll      = NULL;
+static pthread_t   g_gtk_thread;
+
+static atomic_llong g_busy_since_us = 0;   /* 0 → loop idle in poll      */
+static atomic_bool  g_stall_flagged = false;
+
+/* Histogram: only touched on the GTK thread */
+static guint64     g_hist[HIST_BUCKETS];
+static guint64     g_iterations     = 0;
+static guint64     g_stalls         = 0;
+static gint64      g_worst_us       = 0;
+
+/* Filled by the SIGUSR2 handler, consumed by the watchdog thread */
+static void        *g_bt_frames[MAX_BT_FRAMES];
+static atomic_int   g_bt_count      = 0;
+static const char  *volatile g_bt_source = NULL;
+static atomic_bool  g_bt_ready      = false;
+
+/* Forward declarations */
+static gint     watchdog_poll(GPollFD *fds, guint nfds, gint timeout);
+static gpointer watchdog_thread(gpointer);
+static void     on_capture_signal(int);
+static gboolean on_dump_signal(gpointer);
+static void     record_iteration(gint64 busy_us);
+static void     install_heartbeat(void);
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+void watchdog_start(unsigned int budget_ms)
+{
+    if (budget_ms == 0 || g_budget_us)
+        return;
+
+    g_budget_us  = budget_ms * 1000u;
+    g_gtk_thread = pthread_self();
+
+    /* backtrace() loads libgcc lazily — do it now, not in the handler */
+    void *warm[1];
+    backtrace(warm, 1);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_capture_signal;
+    sa.sa_flags   = SA_RESTART;            /* don't break pactl reads */
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR2, &sa, NULL);
+
+    g_unix_signal_add(SIGUSR1, on_dump_signal, NULL);
+    install_heartbeat();
+
+    g_thread_unref(g_thread_new("watchdog", watchdog_thread, NULL));
+    g_print("[Watchdog] main-loop budget %u ms (kill -USR1 %d for histogram)\n",
+            budget_ms, (int)getpid());
+}
+
+void watchdog_track_iterations(void)
+{
+    install_heartbeat();
+}
+
+void watchdog_dump(void)
+{
+    if (!g_budget_us)                      /* watchdog not running */
+        return;
+
+    g_print("[Watchdog] %" G_GUINT64_FORMAT " iterations, %" G_GUINT64_FORMAT
+            " stalls > %u ms, worst %.1f ms\n",
+            g_iterations, g_stalls, g_budget_us / 1000u, g_worst_us / 1e3);
+
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        if (!g_hist[i]) continue;
+        gint64 lo = (i == 0) ? 0 : (G_GINT64_CONSTANT(1) << i);
+        if (i == HIST_BUCKETS - 1)
+            g_print("  >= %8" G_GINT64_FORMAT " us : %" G_GUINT64_FORMAT "\n",
+                    lo, g_hist[i]);
+        else
+            g_print("  %8" G_GINT64_FORMAT " - %8" G_GINT64_FORMAT " us : %"
+                    G_GUINT64_FORMAT "\n",
+                    lo, (G_GINT64_CONSTANT(1) << (i + 1)) - 1, g_hist[i]);
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Heartbeat (GTK thread)                                                */
+/* ---------------------------------------------------------------------- */
+static void install_heartbeat(void)
+{
+    if (g_orig_poll)
+        return;
+
+    GMainContext *mc = g_main_context_default();
+    g_orig_poll = g_main_context_get_poll_func(mc);
+    g_main_context_set_poll_func(mc, watchdog_poll);
+}
+
+static gint watchdog_poll(GPollFD *fds, guint nfds, gint timeout)
+{
+    gint64 busy_since = atomic_exchange(&g_busy_since_us, 0);
+    if (busy_since)
+        record_iteration(g_get_monotonic_time() - busy_since);
+
+    gint rc = g_orig_poll(fds, nfds, timeout);
+
+    atomic_store(&g_stall_flagged, false);
+    atomic_store(&g_busy_since_us, g_get_monotonic_time());
+    return rc;
+}
+
+static void record_iteration(gint64 busy_us)
+{
+    metrics_observe_us(METRIC_MAIN_LOOP_BUSY, busy_us);
+    if (!g_budget_us)                      /* only feeding the metric */
+        return;
+
+    int b = busy_us > 0 ? (int)g_bit_storage((gulong)busy_us) - 1 : 0;
+    if (b >= HIST_BUCKETS) b = HIST_BUCKETS - 1;
+
+    g_hist[b]++;
+    g_iterations++;
+    if (busy_us > g_worst_us)
+        g_worst_us = busy_us;
+
+    if (busy_us > (gint64)g_budget_us) {
+        g_stalls++;
+        TRACE_COUNTER("main-loop-stall-us", busy_us);
+        if (atomic_load(&g_stall_flagged))
+            EVLOG(STALL_ENDED, busy_us / 1e3);
+    }
+}
+
+static gboolean on_dump_signal(gpointer)
+{
+    watchdog_dump();
+    return G_SOURCE_CONTINUE;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Culprit capture (SIGUSR2 handler, runs on the stalled GTK thread)     */
+/* ---------------------------------------------------------------------- */
+static void on_capture_signal(int)
+{
+    /* g_main_current_source() only reads the thread's dispatch stack   */
+    GSource *src = g_main_current_source();
+    g_bt_source  = src ? g_source_get_name(src) : NULL;
+
+    atomic_store(&g_bt_count, backtrace(g_bt_frames, MAX_BT_FRAMES));
+    atomic_store(&g_bt_ready, true);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Watchdog thread                                                       */
+/* ---------------------------------------------------------------------- */
+static gpointer watchdog_thread(gpointer)
+{
+    TRACE_THREAD_NAME("watchdog");
+    const gulong tick_us = MAX(g_budget_us / 2, 1000u);
+
+    for (;;) {
+        g_usleep(tick_us);
+
+        gint64 since = atomic_load(&g_busy_since_us);
+        if (!since || atomic_load(&g_stall_flagged))
+            continue;
+
+        gint64 busy = g_get_monotonic_time() - since;
+        if (busy <= (gint64)g_budget_us)
+            continue;
+        if (atomic_load(&g_busy_since_us) != since)
+            continue;                      /* loop moved on meanwhile */
+
+        /* Report each stall once; re-armed when the loop polls again */
+        atomic_store(&g_stall_flagged, true);
+        TRACE_INSTANT("main-loop-stall");
+
+        atomic_store(&g_bt_ready, false);
+        g_bt_source = NULL;
+        pthread_kill(g_gtk_thread, SIGUSR2);
+
+        for (int i = 0; i < CAPTURE_WAIT_MS && !atomic_load(&g_bt_ready); i++)
+            g_usleep(1000);
+
+        const char *src = g_bt_source;
+        fprintf(stderr, "[Watchdog] main loop busy %.1f ms (budget %u ms) in source '%s'\n",
+                busy / 1e3, g_budget_us / 1000u, src ? src : "unnamed");
+
+        if (atomic_load(&g_bt_ready))
+            backtrace_symbols_fd(g_bt_frames, atomic_load(&g_bt_count),
+                                 STDERR_FILENO);
+        else
+            fprintf(stderr, "[Watchdog] (no backtrace: GTK thread did not answer)\n");
+    }
+    return NULL;
+}
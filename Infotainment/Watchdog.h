@@ -0,0 +1,32 @@
+/* =========================================================================
+ *  Watchdog.h — GTK main-loop stall detector + iteration-time histogram
+ * -------------------------------------------------------------------------
+ *  watchdog_start(budget_ms)
+ *      Must be called from the GTK thread before gtk_main().  Wraps the
+ *      default GMainContext's poll function so every loop iteration is
+ *      timestamped (the "heartbeat"), and starts a watchdog thread that
+ *      notices when the loop has been busy for longer than `budget_ms`
+ *      (e.g. 16 ms for one frame, 50 ms for touch responsiveness).
+ *
+ *      On a stall the watchdog logs the name of the GSource being
+ *      dispatched plus a backtrace of the GTK thread, captured by a
+ *      SIGUSR2 handler that interrupts the offending callback.
+ *
+ *  watchdog_track_iterations()
+ *      Installs only the heartbeat, so the iteration times reach
+ *      METRIC_MAIN_LOOP_BUSY (Metrics.h) without a watchdog thread.
+ *      watchdog_start() implies it.
+ *
+ *  watchdog_dump()
+ *      Prints the histogram of main-loop iteration times (log2 buckets,
+ *      µs) and the stall count.  Also triggered at runtime with
+ *          kill -USR1 <pid>
+ * ========================================================================= */
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+void watchdog_start           (unsigned int budget_ms);
+void watchdog_track_iterations(void);
+void watchdog_dump            (void);
+
+#endif /* WATCHDOG_H */
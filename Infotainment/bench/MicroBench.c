@@ -0,0 +1,682 @@
+/* =========================================================================
+ *  MicroBench.c — microbenchmarks for Vroom's hot paths
+ * -------------------------------------------------------------------------
+ *  Cases (see CASES[] below):
+ *
+ *      quad_decode          one full detent through quad_decode() — the
+ *                           state machine behind rotary_isr
+ *      frame_parse          obd_frame_parse() of a typical 8-PID JSON frame
+ *      frame_parse_raw      the same frame as `R id:HEX …` raw reply bytes,
+ *                           decoded through the PidTable.def decoders
+ *      pid_format           obd_format_value() for all eight columns
+ *      frame_decode         raw parse + format, i.e. the per-frame work of
+ *                           the Vehicle Info page minus GTK
+ *      alert_eval           alerts_feed() of that frame against every
+ *                           AlertRules.def rule (steady state, no firing)
+ *      metric_update        metrics_inc() + metrics_observe_us(), what
+ *                           every knob detent and apply write now pays
+ *      event_log            one EVLOG() of a dump-only event, the cost a
+ *                           hot path pays instead of g_print()
+ *      can_decode           dbc_decode() of one 3-signal broadcast from
+ *                           scripts/can/vroom_demo.dbc — per received frame
+ *                           on the --can reader thread
+ *      merge_push           merge_push() of that frame from two live
+ *                           sources in turn: queue, k-way release, per-PID
+ *                           source choice and FUEL RATE derivation — what
+ *                           --sources adds per frame
+ *      value_label          one PID value change the old way: markup
+ *                           string + gtk_label_set_markup(), then the
+ *                           layout pass it triggers on an 8-row grid and
+ *                           the redraw of the value
+ *      value_readout        the same change through readout_set_value()
+ *                           (Readout.h) — what VehicleInfoWindow runs now
+ *      popup_window         one knob event the pre-HUD way: a new
+ *                           toplevel, label and markup, mapped, then
+ *                           destroyed as its 1.5 s timeout used to
+ *      hud_event            the same event through popup_show_level()
+ *                           and the hud-apply idle it queues (Popup.h)
+ *      volume_roundtrip     get_sink_volume_percent + set_sink_volume_percent
+ *      backlight_roundtrip  read_backlight_brightness + set_backlight_brightness
+ *
+ *  The two value_* cases (an offscreen window) and popup_window /
+ *  hud_event (real windows) need a display; without one they run empty
+ *  and report ~0.
+ *
+ *  The two round trips go through the real pactl / sysfs backends with
+ *  --system and through the --simulate backends otherwise (which then
+ *  measures only the manager + HAL overhead).  The backend name is part
+ *  of the result key so baselines never mix the two.
+ *
+ *  Every case runs --warmup untimed samples, then --samples timed ones.
+ *  A sample times `batch` back-to-back calls and records the per-call
+ *  cost in nanoseconds (CLOCK_MONOTONIC) and in counter ticks:
+ *      x86-64   rdtsc        (constant-rate TSC ≈ nominal-clock cycles)
+ *      aarch64  cntvct_el0   (generic timer — 54 MHz on the Pi 5, so it
+ *                             resolves ~18.5 ns, not CPU cycles)
+ *  The tick rate is calibrated at start-up and printed with the results.
+ *
+ *  Output: a table on stdout, optionally JSON (--json=FILE).  --baseline /
+ *  --update-baseline / --tolerance work like UiBench, on p99 ns per call.
+ *
+ *  See scripts/micro_bench.sh for the build line.
+ * ========================================================================= */
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <json-glib/json-glib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/utsname.h>
+
+#include "Quadrature.h"
+#include "ObdFrame.h"
+#include "Alerts.h"
+#include "AudioManager.h"
+#include "BacklightManager.h"
+#include "Hal.h"
+#include "Metrics.h"
+#include "EventLog.h"
+#include "Dbc.h"
+#include "Readout.h"
+#include "Merge.h"
+#include "Popup.h"
+
+/* ------------------------------------------------------------------ */
+/*  Options                                                           */
+/* ------------------------------------------------------------------ */
+static gint     opt_samples      = 20000;
+static gint     opt_sys_samples  = 50;
+static gint     opt_warmup       = 1000;
+static gchar   *opt_filter       = NULL;
+static gboolean opt_system       = FALSE;
+static gdouble  opt_tolerance    = 15.0;
+static gchar   *opt_baseline     = NULL;
+static gboolean opt_update_base  = FALSE;
+static gchar   *opt_json_path    = NULL;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "samples", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_samples,
+      "Timed samples per in-process case (default 20000)", "N" },
+    { "system-samples", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_sys_samples,
+      "Timed samples per pactl / sysfs case (default 50)", "N" },
+    { "warmup", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_warmup,
+      "Untimed samples before measuring (default 1000, max 10 for system cases)", "N" },
+    { "filter", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_filter,
+      "Only run cases whose name contains TEXT", "TEXT" },
+    { "system", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_system,
+      "Use the real pactl / sysfs backends for the round-trip cases", NULL },
+    { "baseline", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_baseline,
+      "Compare p99 ns per call against FILE", "FILE" },
+    { "update-baseline", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_update_base,
+      "Write this run's p99 values to the --baseline file", NULL },
+    { "tolerance", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, &opt_tolerance,
+      "Allowed p99 regression in percent (default 15)", "PCT" },
+    { "json", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_json_path,
+      "Also write results as JSON to FILE", "FILE" },
+    G_OPTION_ENTRY_NULL
+};
+
+/* ------------------------------------------------------------------ */
+/*  Clocks                                                            */
+/* ------------------------------------------------------------------ */
+static inline guint64 read_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    guint64 v;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+    return v;
+#else
+    return 0;
+#endif
+}
+
+static const char *tick_source(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return "rdtsc";
+#elif defined(__aarch64__)
+    return "cntvct_el0";
+#else
+    return "none";
+#endif
+}
+
+static inline guint64 now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64)ts.tv_sec * 1000000000u + (guint64)ts.tv_nsec;
+}
+
+static gdouble calibrate_tick_hz(void)
+/* 100 ms against CLOCK_MONOTONIC is plenty for three significant digits */
+{
+    guint64 n0 = now_ns(), t0 = read_ticks();
+    g_usleep(100000);
+    guint64 n1 = now_ns(), t1 = read_ticks();
+    return n1 > n0 ? (t1 - t0) * 1e9 / (gdouble)(n1 - n0) : 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Cases                                                             */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    const char *name;
+    gboolean    system;          /* pactl / sysfs round trip */
+    guint       batch;           /* calls per timed sample   */
+    void      (*setup)   (void);
+    void      (*run)     (void);
+    void      (*teardown)(void);
+} MicroCase;
+
+static const char SAMPLE_FRAME[] =
+    "{\"RPM\": 2150.00, \"SPEED\": 87.00, \"ENGINE LOAD\": 41.18, "
+    "\"THROTTLE POSITION\": 22.35, \"INTAKE PRESSURE\": 58.00, "
+    "\"TIMING ADVANCE\": 14.50, \"FUEL LEVEL\": 63.14, "
+    "\"CONTROL MODULE VOLTAGE\": 14.12}\n";
+
+/* Same readings as SAMPLE_FRAME, as obd_reader.py --raw writes them */
+static const char SAMPLE_RAW_FRAME[] =
+    "R 0:2198 1:57 2:69 3:39 4:3A 5:9D 6:A1 7:3728\n";
+
+static volatile gint g_sink_int;         /* defeats dead-code elimination */
+static QuadState     g_quad;
+static JsonParser   *g_parser;
+static ObdFrame      g_frame;
+static gchar        *g_sink;
+static int           g_saved_volume = -1;
+static int           g_saved_bri    = -1;
+
+/* quad_decode — one detent up, next call one detent down */
+static void run_quad_decode(void)
+{
+    static const guint8 UP[4]   = { 0x1, 0x0, 0x2, 0x3 };
+    static const guint8 DOWN[4] = { 0x2, 0x0, 0x1, 0x3 };
+    static gboolean up = TRUE;
+    const guint8 *seq = up ? UP : DOWN;
+
+    int d = 0;
+    for (int i = 0; i < 4; ++i)
+        d += quad_decode(&g_quad, seq[i]);
+    g_sink_int = d;
+    up = !up;
+}
+
+static void setup_quad(void) { g_quad = (QuadState){ .last_ab = 0x3 }; }
+
+/* JSON frame */
+static void setup_parser   (void) { g_parser = json_parser_new(); }
+static void teardown_parser(void) { g_clear_object(&g_parser); }
+
+static void run_frame_parse(void)
+{
+    obd_frame_parse(g_parser, SAMPLE_FRAME, sizeof SAMPLE_FRAME - 1, &g_frame);
+    g_sink_int = (gint)g_frame.present;
+}
+
+static void run_frame_parse_raw(void)
+{
+    obd_frame_parse(g_parser, SAMPLE_RAW_FRAME, sizeof SAMPLE_RAW_FRAME - 1,
+                    &g_frame);
+    g_sink_int = (gint)g_frame.present;
+}
+
+static void format_all(void)
+{
+    gchar buf[32];
+    gsize n = 0;
+    for (guint i = 0; i < OBD_FRAME_COLUMNS; i++)
+        if (g_frame.present & (G_GUINT64_CONSTANT(1) << i))
+            n += obd_format_value(i, g_frame.value[i], buf, sizeof buf);
+    g_sink_int = (gint)n;
+}
+
+static void setup_format(void)
+{
+    setup_parser();
+    run_frame_parse();
+}
+
+static void run_frame_decode(void)
+{
+    run_frame_parse_raw();
+    format_all();
+}
+
+static void run_alert_eval(void)
+{
+    static gint64 t_us = G_USEC_PER_SEC;
+    t_us += 200 * 1000;                      /* 5 Hz sample spacing */
+    alerts_feed(&g_frame, t_us);
+}
+
+static void run_metric_update(void)
+{
+    static gint64 us = 0;
+    us = (us + 37) & 0xFFFF;                 /* walk across the buckets */
+    metrics_inc(METRIC_ENCODER_DETENTS);
+    metrics_observe_us(METRIC_APPLY_LATENCY, us);
+}
+
+static void run_event_log(void)
+{
+    static int v = 0;
+    EVLOG(KNOB_VOLUME, v++ & 127);
+}
+
+/* CAN broadcast: ECM_Engine, 0xC9 */
+static DbcTable *g_dbc;
+static gdouble   g_can_values[PID_COUNT];
+
+static void setup_can(void)
+{
+    g_dbc = dbc_load("../scripts/can/vroom_demo.dbc",
+                     "EngineSpeed=RPM,AccelPedal=THROTTLE POSITION,"
+                     "EngineLoad=ENGINE LOAD");
+}
+
+static void run_can_decode(void)
+{
+    static const guint8 data[8] = { 0x1A, 0xF8, 0x3C, 0x00, 0x5A, 0, 0, 0 };
+    if (g_dbc)                               /* DBC missing: logged, 0 */
+        g_sink_int = (gint)dbc_decode(g_dbc, 0xC9, data, 8, g_can_values);
+}
+
+static void teardown_can(void) { g_clear_pointer(&g_dbc, dbc_free); }
+
+/* Two sources merged; each push releases the other source's head */
+static void sink_merged(const ObdFrame *frame, gpointer)
+{
+    g_sink_int = (gint)frame->present;
+}
+
+static void setup_merge(void)
+{
+    static const char *const names[] = { "obd", "can" };
+    setup_format();
+    merge_configure(2, names);
+    merge_set_output(sink_merged, NULL);
+    merge_set_link(0, TRUE);
+    merge_set_link(1, TRUE);
+}
+
+static void run_merge_push(void)
+{
+    static guint n = 0;
+    g_frame.t_us = g_get_monotonic_time();
+    merge_push(n++ & 1, &g_frame);
+}
+
+static void teardown_merge(void)
+{
+    merge_reset();
+    merge_set_output(NULL, NULL);
+    teardown_parser();
+}
+
+/* PID grid value: 8 rows like a Vehicle Info page, row 0 (RPM) changes */
+static gboolean         g_have_display;
+static GtkWidget       *g_grid_win;
+static GtkWidget       *g_grid_value;
+static cairo_surface_t *g_value_surface;
+static cairo_t         *g_value_cr;
+
+static void setup_grid(gboolean readouts)
+{
+    if (!g_have_display)                     /* no display: case runs empty */
+        return;
+    g_grid_win = gtk_offscreen_window_new();
+    GtkWidget *grid = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 12);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 24);
+    gtk_container_add(GTK_CONTAINER(g_grid_win), grid);
+
+    for (guint r = 0; r < 8; r++) {
+        gchar *km = g_strdup_printf(
+            "<span font_desc='Sans 38' foreground='#FFFFFF'>%s</span>",
+            PID_TABLE[r].name);
+        GtkWidget *key = gtk_label_new(NULL);
+        gtk_label_set_markup(GTK_LABEL(key), km);
+        g_free(km);
+        gtk_grid_attach(GTK_GRID(grid), key, 0, (gint)r, 1, 1);
+
+        GtkWidget *val;
+        if (readouts) {
+            val = readout_new((PidId)r, "Sans 38", "#00AAFF");
+        } else {
+            val = gtk_label_new(NULL);
+            gtk_label_set_markup(GTK_LABEL(val),
+                "<span font_desc='Sans 38' foreground='#00AAFF'>--</span>");
+        }
+        gtk_widget_set_halign(val, GTK_ALIGN_END);
+        gtk_grid_attach(GTK_GRID(grid), val, 1, (gint)r, 1, 1);
+        if (r == PID_RPM)
+            g_grid_value = val;
+    }
+    gtk_widget_show_all(g_grid_win);
+    gtk_container_check_resize(GTK_CONTAINER(g_grid_win));
+
+    g_value_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 400, 80);
+    g_value_cr      = cairo_create(g_value_surface);
+}
+
+static void setup_value_label  (void) { setup_grid(FALSE); }
+static void setup_value_readout(void) { setup_grid(TRUE);  }
+
+static gdouble next_rpm(void)
+{
+    static guint i = 0;
+    return 800 + 2 * (i++ % 200);            /* 812 → 814 …, all differ */
+}
+
+static void layout_and_draw(void)
+/* What the frame clock does next: layout pass, then paint the value. */
+{
+    gtk_container_check_resize(GTK_CONTAINER(g_grid_win));
+    gtk_widget_draw(g_grid_value, g_value_cr);
+}
+
+static void run_value_label(void)
+{
+    if (!g_grid_win)
+        return;
+    gchar txt[32];
+    obd_format_value(PID_RPM, next_rpm(), txt, sizeof txt);
+    gchar *markup = g_strdup_printf(
+        "<span font_desc='Sans 38' foreground='#00AAFF'>%s</span>", txt);
+    gtk_label_set_markup(GTK_LABEL(g_grid_value), markup);
+    g_free(markup);
+    layout_and_draw();
+}
+
+static void run_value_readout(void)
+{
+    if (!g_grid_win)
+        return;
+    readout_set_value(g_grid_value, next_rpm());
+    layout_and_draw();
+}
+
+static void teardown_grid(void)
+{
+    g_clear_pointer(&g_value_cr, cairo_destroy);
+    g_clear_pointer(&g_value_surface, cairo_surface_destroy);
+    g_clear_pointer(&g_grid_win, gtk_widget_destroy);
+    g_grid_value = NULL;
+}
+
+/* Knob event on the HUD: old per-event toplevel vs. persistent HUD */
+static void run_popup_window(void)
+/* What show_temp_popup()'s idle did per event before Popup.c kept one
+ * window; the destroy stands in for its 1.5 s hide timeout. */
+{
+    if (!g_have_display)
+        return;
+    GtkWidget *popup = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(popup), "Popup");
+    gtk_window_set_default_size(GTK_WINDOW(popup), 300, 100);
+    gtk_window_set_position(GTK_WINDOW(popup), GTK_WIN_POS_CENTER_ALWAYS);
+
+    GtkWidget *label = gtk_label_new(NULL);
+    gtk_label_set_markup(GTK_LABEL(label),
+        "<span font_desc='Sans 36' foreground='#FFFFFF'>Volume</span>");
+    gtk_container_add(GTK_CONTAINER(popup), label);
+    gtk_widget_show_all(popup);
+    gtk_widget_destroy(popup);
+}
+
+static void setup_hud(void)
+{
+    if (g_have_display)
+        popup_init();
+}
+
+static void run_hud_event(void)
+{
+    if (!g_have_display)
+        return;
+    static int level = 0;
+    popup_show_level(HUD_MODE_VOLUME, level++ % 101);
+    while (g_main_context_iteration(NULL, FALSE))   /* the hud-apply idle */
+        ;
+}
+
+/* Volume round trip (value restored in teardown) */
+static void setup_volume(void)
+{
+    g_sink         = g_strdup(get_current_sink());
+    g_saved_volume = get_sink_volume_percent(g_sink);
+}
+
+static void run_volume(void)
+{
+    int v = get_sink_volume_percent(g_sink);
+    set_sink_volume_percent(g_sink, v);
+    g_sink_int = v;
+}
+
+static void teardown_volume(void)
+{
+    if (g_saved_volume >= 0)
+        set_sink_volume_percent(g_sink, g_saved_volume);
+    g_clear_pointer(&g_sink, g_free);
+}
+
+/* Backlight round trip */
+static void setup_backlight(void) { g_saved_bri = read_backlight_brightness(); }
+
+static void run_backlight(void)
+{
+    int b = read_backlight_brightness();
+    set_backlight_brightness(b);
+    g_sink_int = b;
+}
+
+static void teardown_backlight(void)
+{
+    if (g_saved_bri >= 0)
+        set_backlight_brightness(g_saved_bri);
+}
+
+static const MicroCase CASES[] = {
+    { "quad_decode",         FALSE, 1000, setup_quad,      run_quad_decode,  NULL               },
+    { "frame_parse",         FALSE,   10, setup_parser,    run_frame_parse,  teardown_parser    },
+    { "frame_parse_raw",     FALSE,   10, setup_parser,    run_frame_parse_raw, teardown_parser },
+    { "pid_format",          FALSE,  100, setup_format,    format_all,       teardown_parser    },
+    { "frame_decode",        FALSE,   10, setup_parser,    run_frame_decode, teardown_parser    },
+    { "alert_eval",          FALSE, 1000, setup_format,    run_alert_eval,   teardown_parser    },
+    { "metric_update",       FALSE, 1000, NULL,            run_metric_update, NULL              },
+    { "event_log",           FALSE, 1000, NULL,            run_event_log,    NULL               },
+    { "can_decode",          FALSE, 1000, setup_can,       run_can_decode,   teardown_can       },
+    { "merge_push",          FALSE, 1000, setup_merge,     run_merge_push,   teardown_merge     },
+    { "value_label",         FALSE,   10, setup_value_label,   run_value_label,   teardown_grid },
+    { "value_readout",       FALSE,   10, setup_value_readout, run_value_readout, teardown_grid },
+    { "popup_window",        FALSE,    1, NULL,            run_popup_window, NULL               },
+    { "hud_event",           FALSE,   10, setup_hud,       run_hud_event,    NULL               },
+    { "volume_roundtrip",    TRUE,     1, setup_volume,    run_volume,       teardown_volume    },
+    { "backlight_roundtrip", TRUE,     1, setup_backlight, run_backlight,    teardown_backlight },
+};
+
+/* ------------------------------------------------------------------ */
+/*  Runner                                                            */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    gchar  *key;                 /* name, or name[backend] for system cases */
+    GArray *ns;                  /* per-call, sorted after the run          */
+    GArray *ticks;
+} CaseResult;
+
+static void run_case(const MicroCase *c, CaseResult *r)
+{
+    guint samples = (guint)MAX(c->system ? opt_sys_samples : opt_samples, 1);
+    guint warmup  = (guint)MAX(c->system ? MIN(opt_warmup, 10) : opt_warmup, 0);
+
+    r->ns    = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), samples);
+    r->ticks = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), samples);
+
+    if (c->setup) c->setup();
+
+    for (guint i = 0; i < warmup; i++)
+        for (guint k = 0; k < c->batch; k++)
+            c->run();
+
+    for (guint i = 0; i < samples; i++) {
+        guint64 n0 = now_ns(), t0 = read_ticks();
+        for (guint k = 0; k < c->batch; k++)
+            c->run();
+        guint64 t1 = read_ticks(), n1 = now_ns();
+
+        gdouble ns    = (gdouble)(n1 - n0) / c->batch;
+        gdouble ticks = (gdouble)(t1 - t0) / c->batch;
+        g_array_append_val(r->ns,    ns);
+        g_array_append_val(r->ticks, ticks);
+    }
+
+    if (c->teardown) c->teardown();
+}
+
+/* ------------------------------------------------------------------ */
+/*  Statistics + baseline                                             */
+/* ------------------------------------------------------------------ */
+static gint cmp_double(gconstpointer a, gconstpointer b)
+{
+    gdouble x = *(const gdouble *)a, y = *(const gdouble *)b;
+    return (x > y) - (x < y);
+}
+
+static gdouble percentile(GArray *sorted, gdouble p)
+{
+    if (!sorted->len) return NAN;
+    guint idx = (guint)ceil(p / 100.0 * sorted->len);
+    idx = CLAMP(idx, 1u, sorted->len) - 1;
+    return g_array_index(sorted, gdouble, idx);
+}
+
+static gdouble mean(GArray *a)
+{
+    gdouble sum = 0;
+    for (guint i = 0; i < a->len; i++)
+        sum += g_array_index(a, gdouble, i);
+    return a->len ? sum / a->len : NAN;
+}
+
+static int report(CaseResult *res, guint n, gdouble tick_hz)
+{
+    struct utsname un;
+    if (uname(&un) != 0)
+        g_strlcpy(un.machine, "unknown", sizeof un.machine);
+
+    GKeyFile *base = g_key_file_new();
+    gboolean  have_base = opt_baseline && !opt_update_base &&
+        g_key_file_load_from_file(base, opt_baseline, G_KEY_FILE_NONE, NULL);
+
+    GString *json = g_string_new(NULL);
+    g_string_append_printf(json,
+        "{\"machine\":\"%s\",\"tick_source\":\"%s\",\"tick_hz\":%.0f,\"cases\":[",
+        un.machine, tick_source(), tick_hz);
+    int      rc    = 0;
+    gboolean first = TRUE;
+
+    g_print("\n[MicroBench] %s, %s @ %.1f MHz\n", un.machine, tick_source(), tick_hz / 1e6);
+    g_print("%-34s %7s %10s %10s %10s %10s %10s %10s\n", "case", "samples",
+            "mean ns", "p50 ns", "p90 ns", "p99 ns", "max ns", "p50 ticks");
+
+    for (guint i = 0; i < n; i++) {
+        CaseResult *r = &res[i];
+        if (!r->ns) continue;
+
+        gdouble avg = mean(r->ns);
+        g_array_sort(r->ns,    cmp_double);
+        g_array_sort(r->ticks, cmp_double);
+
+        gdouble p50 = percentile(r->ns, 50), p90 = percentile(r->ns, 90);
+        gdouble p99 = percentile(r->ns, 99), max = percentile(r->ns, 100);
+        gdouble t50 = percentile(r->ticks, 50), t99 = percentile(r->ticks, 99);
+
+        g_print("%-34s %7u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f",
+                r->key, r->ns->len, avg, p50, p90, p99, max, t50);
+
+        if (have_base && g_key_file_has_key(base, "p99_ns", r->key, NULL)) {
+            gdouble ref   = g_key_file_get_double(base, "p99_ns", r->key, NULL);
+            gdouble limit = ref * (1.0 + opt_tolerance / 100.0);
+            if (p99 > limit) {
+                g_print("   REGRESSION (baseline %.1f, limit %.1f)", ref, limit);
+                rc = 1;
+            } else {
+                g_print("   ok (baseline %.1f)", ref);
+            }
+        }
+        g_print("\n");
+
+        if (opt_update_base)
+            g_key_file_set_double(base, "p99_ns", r->key, p99);
+
+        g_string_append_printf(json,
+            "%s{\"name\":\"%s\",\"samples\":%u,"
+            "\"ns\":{\"mean\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f},"
+            "\"ticks\":{\"p50\":%.2f,\"p99\":%.2f}}",
+            first ? "" : ",", r->key, r->ns->len, avg, p50, p90, p99, max, t50, t99);
+        first = FALSE;
+    }
+    g_string_append(json, "]}\n");
+
+    if (opt_update_base && opt_baseline) {
+        if (g_key_file_save_to_file(base, opt_baseline, NULL))
+            g_print("[MicroBench] baseline written to %s\n", opt_baseline);
+    }
+    if (opt_json_path)
+        g_file_set_contents(opt_json_path, json->str, -1, NULL);
+
+    g_string_free(json, TRUE);
+    g_key_file_free(base);
+    return rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Entry point                                                       */
+/* ------------------------------------------------------------------ */
+int main(int argc, char *argv[])
+{
+    GOptionContext *oc = g_option_context_new("- Vroom hot-path microbenchmarks");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, &argc, &argv, &err)) {
+        g_printerr("MicroBench: %s\n", err->message);
+        return 2;
+    }
+    g_option_context_free(oc);
+
+    g_have_display = gtk_init_check(NULL, NULL);
+    hal_init(!opt_system);
+    audio_manager_init();
+
+    gdouble    tick_hz = calibrate_tick_hz();
+    CaseResult res[G_N_ELEMENTS(CASES)] = { 0 };
+
+    for (guint i = 0; i < G_N_ELEMENTS(CASES); i++) {
+        const MicroCase *c = &CASES[i];
+        if (opt_filter && !strstr(c->name, opt_filter))
+            continue;
+
+        res[i].key = c->system
+            ? g_strdup_printf("%s[%s]", c->name,
+                  strstr(c->name, "volume") ? hal_audio()->name : hal_backlight()->name)
+            : g_strdup(c->name);
+
+        g_print("[MicroBench] %s …\n", res[i].key);
+        run_case(c, &res[i]);
+    }
+
+    int rc = report(res, G_N_ELEMENTS(CASES), tick_hz);
+
+    for (guint i = 0; i < G_N_ELEMENTS(CASES); i++) {
+        g_free(res[i].key);
+        if (res[i].ns)    g_array_free(res[i].ns,    TRUE);
+        if (res[i].ticks) g_array_free(res[i].ticks, TRUE);
+    }
+    return rc;
+}
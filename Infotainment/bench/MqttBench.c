@@ -0,0 +1,333 @@
+/* =========================================================================
+ *  MqttBench.c — publish throughput and end-to-end latency of Publisher.c
+ * -------------------------------------------------------------------------
+ *  Runs the real publisher against a broker (a local mosquitto) with a
+ *  subscriber on vroom/pid/# in the same process, so sample and receipt
+ *  times come from one wall clock:
+ *
+ *      stream   --rate frames per second for --seconds, every PID in
+ *               each frame — the shape of the live feed, batched by
+ *               --flush-ms
+ *      burst    --burst frames back to back, as fast as the caller can
+ *               feed — how many samples per second the publisher thread
+ *               gets acknowledged
+ *
+ *  Reports, per phase:
+ *      feed       cost of publisher_feed() on the calling thread (what
+ *                 the GTK thread pays per frame), p50 / p99 / max
+ *      latency    sample timestamp → subscriber receipt, every sample
+ *                 (includes the wait in the batch) and the newest
+ *                 sample of each message (transport only)
+ *      delivered  samples, messages and payload bytes received, and
+ *                 samples per second
+ *
+ *  Payload timestamps are whole milliseconds, so latencies read up to
+ *  1 ms high.  Exits 1 if any sample fed was not delivered, 2 if the
+ *  broker cannot be reached.  The spool goes to a temporary directory.
+ *
+ *  See scripts/mqtt_bench.sh for the build line.
+ * ========================================================================= */
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Publisher.h"
+#include "Mqtt.h"
+
+/* ------------------------------------------------------------------ */
+/*  Options                                                           */
+/* ------------------------------------------------------------------ */
+static gchar *opt_broker   = NULL;
+static gint   opt_rate     = 50;
+static gint   opt_seconds  = 10;
+static gint   opt_burst    = 100000;
+static gint   opt_flush_ms = 200;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "broker", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_broker,
+      "Broker HOST[:PORT] (default 127.0.0.1)", "ADDR" },
+    { "rate", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_rate,
+      "Stream phase frames per second (default 50)", "HZ" },
+    { "seconds", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_seconds,
+      "Stream phase length (default 10)", "SEC" },
+    { "burst", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_burst,
+      "Burst phase frames (default 100000, 0 skips)", "N" },
+    { "flush-ms", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_flush_ms,
+      "Publisher batch age limit (default 200)", "MS" },
+    G_OPTION_ENTRY_NULL
+};
+
+/* ------------------------------------------------------------------ */
+/*  Run state                                                         */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    const char *name;
+    gint64      start_ms, end_ms;       /* wall clock, fed samples */
+    gint64      fed;                    /* samples */
+    GArray     *feed_ns;                /* gint64 per publisher_feed() */
+
+    /* Filled in by the subscriber */
+    gint64      samples, messages, bytes;
+    gint64      last_rx_us;             /* monotonic */
+    gint64      last_rx_ms;             /* wall clock */
+    GArray     *lat_us;                 /* gint64, every sample */
+    GArray     *newest_us;              /* gint64, newest per message */
+} Phase;
+
+enum { STREAM, BURST, N_PHASES };
+
+static Phase       g_phase[N_PHASES] = { { .name = "stream" }, { .name = "burst" } };
+static GMutex      g_lock;              /* subscriber ↔ main, for Phase */
+static atomic_bool g_stop;
+
+/* ------------------------------------------------------------------ */
+/*  Subscriber                                                        */
+/* ------------------------------------------------------------------ */
+static Phase *phase_of(gint64 sample_ms)
+/* Under g_lock; the burst's start_ms is G_MAXINT64 until it begins. */
+{
+    return &g_phase[sample_ms >= g_phase[BURST].start_ms ? BURST : STREAM];
+}
+
+static void on_message(const gchar *payload, gsize len, gint64 rx_us)
+/* "t0:v +dt:v …" → one latency per sample. */
+{
+    const gchar *p = payload;
+    gint64       t = 0, newest = 0;
+    Phase       *ph = NULL;
+
+    g_mutex_lock(&g_lock);
+    for (gboolean first = TRUE; *p; first = FALSE) {
+        gchar *end;
+        gint64 v = g_ascii_strtoll(p + (first ? 0 : 2), &end, 10);
+        if (end == p || *end != ':')
+            break;
+        t = first ? v : t + v;
+        if (!ph)
+            ph = phase_of(t);
+        gint64 lat = rx_us - t * 1000;
+        g_array_append_val(ph->lat_us, lat);
+        ph->samples++;
+        newest = lat;
+
+        p = strchr(end, ' ');
+        if (!p)
+            break;
+    }
+    if (ph) {
+        g_array_append_val(ph->newest_us, newest);
+        ph->messages++;
+        ph->bytes     += (gint64)len;
+        ph->last_rx_us = g_get_monotonic_time();
+        ph->last_rx_ms = rx_us / 1000;
+    }
+    g_mutex_unlock(&g_lock);
+}
+
+static gpointer subscriber_thread(gpointer client)
+{
+    while (!atomic_load(&g_stop)) {
+        gchar *topic, *payload;
+        gsize  len;
+        gint   r = mqtt_receive(client, &topic, &payload, &len, 100);
+        if (r < 0) {
+            g_printerr("MqttBench: subscriber lost the broker\n");
+            break;
+        }
+        if (r == 0)
+            continue;
+        on_message(payload, len, g_get_real_time());
+        g_free(topic);
+        g_free(payload);
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Feeding                                                           */
+/* ------------------------------------------------------------------ */
+static gint64 now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (gint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void feed(Phase *ph, guint64 i)
+{
+    ObdFrame frame = { .present = (G_GUINT64_CONSTANT(1) << PID_COUNT) - 1 };
+    for (guint p = 0; p < PID_COUNT; p++)
+        frame.value[p] = 800.0 + (gdouble)((i * 7 + p * 13) % 4000) / 4.0;
+
+    gint64 t0 = now_ns();
+    publisher_feed(&frame);
+    gint64 ns = now_ns() - t0;
+    g_array_append_val(ph->feed_ns, ns);
+    ph->fed += PID_COUNT;
+}
+
+static void run_stream(Phase *ph)
+{
+    gint64 period = G_USEC_PER_SEC / MAX(opt_rate, 1);
+    gint64 next   = g_get_monotonic_time();
+    ph->start_ms  = g_get_real_time() / 1000;
+    for (guint64 i = 0; i < (guint64)opt_rate * (guint64)opt_seconds; i++) {
+        feed(ph, i);
+        next += period;
+        gint64 left = next - g_get_monotonic_time();
+        if (left > 0)
+            g_usleep((gulong)left);
+    }
+    ph->end_ms = g_get_real_time() / 1000;
+}
+
+static void run_burst(Phase *ph)
+{
+    g_mutex_lock(&g_lock);
+    ph->start_ms = g_get_real_time() / 1000;
+    g_mutex_unlock(&g_lock);
+    for (guint64 i = 0; i < (guint64)opt_burst; i++)
+        feed(ph, i);
+    ph->end_ms = g_get_real_time() / 1000;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Report                                                            */
+/* ------------------------------------------------------------------ */
+static gint cmp_i64(gconstpointer a, gconstpointer b)
+{
+    gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static gint64 pct(GArray *a, double q)
+/* Sorts `a`; nearest-rank percentile. */
+{
+    if (!a->len)
+        return 0;
+    g_array_sort(a, cmp_i64);
+    guint i = (guint)ceil(q * a->len);
+    return g_array_index(a, gint64, MIN(MAX(i, 1u), a->len) - 1);
+}
+
+static void report(Phase *ph)
+{
+    printf("[%s] fed %" G_GINT64_FORMAT " samples in %.2f s\n",
+           ph->name, ph->fed, (ph->end_ms - ph->start_ms) / 1000.0);
+    printf("[%s]   feed      p50 %6.2f µs   p99 %6.2f µs   max %8.2f µs\n",
+           ph->name, pct(ph->feed_ns, 0.50) / 1000.0,
+           pct(ph->feed_ns, 0.99) / 1000.0, pct(ph->feed_ns, 1.0) / 1000.0);
+    printf("[%s]   latency   p50 %6.1f ms   p90 %6.1f ms   p99 %6.1f ms   max %6.1f ms\n",
+           ph->name, pct(ph->lat_us, 0.50) / 1000.0, pct(ph->lat_us, 0.90) / 1000.0,
+           pct(ph->lat_us, 0.99) / 1000.0, pct(ph->lat_us, 1.0) / 1000.0);
+    printf("[%s]   transport p50 %6.1f ms   p90 %6.1f ms   p99 %6.1f ms   max %6.1f ms\n",
+           ph->name, pct(ph->newest_us, 0.50) / 1000.0, pct(ph->newest_us, 0.90) / 1000.0,
+           pct(ph->newest_us, 0.99) / 1000.0, pct(ph->newest_us, 1.0) / 1000.0);
+}
+
+static void report_delivery(Phase *ph)
+/* Rates over first sample fed → last message received. */
+{
+    gdouble secs = MAX(ph->last_rx_ms - ph->start_ms, 1) / 1000.0;
+    printf("[%s]   delivered %" G_GINT64_FORMAT " samples in %" G_GINT64_FORMAT
+           " messages (%.1f KiB)   %.0f samples/s   %.0f msgs/s\n",
+           ph->name, ph->samples, ph->messages, ph->bytes / 1024.0,
+           ph->samples / secs, ph->messages / secs);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Main                                                              */
+/* ------------------------------------------------------------------ */
+static void wait_delivered(Phase *ph)
+/* Until every sample arrived or nothing came for a second. */
+{
+    for (;;) {
+        g_usleep(20 * 1000);
+        g_mutex_lock(&g_lock);
+        gboolean done  = ph->samples >= ph->fed;
+        gboolean quiet = g_get_monotonic_time() - MAX(ph->last_rx_us, 0)
+                         > G_USEC_PER_SEC;
+        g_mutex_unlock(&g_lock);
+        if (done || quiet)
+            return;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *oc = g_option_context_new("- MQTT publisher benchmark");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, &argc, &argv, &err)) {
+        g_printerr("MqttBench: %s\n", err->message);
+        return 2;
+    }
+    g_option_context_free(oc);
+    const char *broker = opt_broker ? opt_broker : "127.0.0.1";
+
+    /* Keep the user's spool out of it */
+    gchar *cache = g_dir_make_tmp("vroom-mqtt-bench-XXXXXX", NULL);
+    g_setenv("XDG_CACHE_HOME", cache, TRUE);
+    g_phase[BURST].start_ms = G_MAXINT64;
+
+    MqttClient *sub = mqtt_connect(broker, "vroom-bench-sub", 60);
+    if (!sub || !mqtt_subscribe(sub, "vroom/pid/#", 0)) {
+        g_printerr("MqttBench: no broker at %s\n", broker);
+        return 2;
+    }
+    for (int i = 0; i < N_PHASES; i++) {
+        g_phase[i].feed_ns   = g_array_new(FALSE, FALSE, sizeof(gint64));
+        g_phase[i].lat_us    = g_array_new(FALSE, FALSE, sizeof(gint64));
+        g_phase[i].newest_us = g_array_new(FALSE, FALSE, sizeof(gint64));
+    }
+    GThread *rx = g_thread_new("mqtt-bench-sub", subscriber_thread, sub);
+
+    publisher_configure(broker, "", (guint)MAX(opt_flush_ms, 1));
+    publisher_start();
+
+    printf("[MqttBench] broker %s, %d PIDs per frame, flush %d ms / %d B\n",
+           broker, PID_COUNT, opt_flush_ms, PUBLISH_FLUSH_BYTES);
+
+    run_stream(&g_phase[STREAM]);
+    wait_delivered(&g_phase[STREAM]);
+    if (opt_burst > 0) {
+        run_burst(&g_phase[BURST]);
+        publisher_shutdown();           /* flushes the tail right away */
+        wait_delivered(&g_phase[BURST]);
+    } else {
+        publisher_shutdown();
+    }
+
+    atomic_store(&g_stop, TRUE);
+    g_thread_join(rx);
+    mqtt_close(sub);
+
+    report(&g_phase[STREAM]);
+    report_delivery(&g_phase[STREAM]);
+    if (opt_burst > 0) {
+        report(&g_phase[BURST]);
+        report_delivery(&g_phase[BURST]);
+    }
+
+    gint64 lost = 0;
+    for (int i = 0; i < N_PHASES; i++)
+        lost += MAX(g_phase[i].fed - g_phase[i].samples, 0);
+    if (lost)
+        printf("[MqttBench] %" G_GINT64_FORMAT " samples not delivered\n", lost);
+
+    /* Empty unless something had to be spooled; then it stays */
+    gchar *spool = g_build_filename(cache, "vroom", "mqtt-spool", NULL);
+    gchar *vroom = g_path_get_dirname(spool);
+    g_rmdir(spool);
+    g_rmdir(vroom);
+    g_rmdir(cache);
+    g_free(spool);
+    g_free(vroom);
+    g_free(cache);
+    return lost ? 1 : 0;
+}
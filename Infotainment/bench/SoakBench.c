@@ -0,0 +1,441 @@
+/* =========================================================================
+ *  SoakBench.c — hours-long leak hunt over the real Vroom code
+ * -------------------------------------------------------------------------
+ *  Boots Vroom the way main.c does, on the simulated backends, and keeps
+ *  every long-lived path busy for as long as asked:
+ *
+ *      knob        a fast encoder script (spins, presses → HUD popups,
+ *                  volume / brightness applies, slider idles)
+ *      telemetry   the synthetic ECU at 20 Hz feeding alerts and views
+ *      windows     Settings → Vehicle Info → overlay, one step every 3 s
+ *      reader      the real obd_reader.py backend started and stopped
+ *                  every 15 s (spawn, pipes, GIOChannel, child watch)
+ *
+ *  Every --interval seconds it samples RSS, malloc'd heap, open fds,
+ *  threads, live GObject instances and live GMainContext sources.  At
+ *  the end the samples after --warmup are split into thirds; a metric
+ *  whose *lowest* value in the last third is above its *highest* value
+ *  in the first third (plus a small allowance) has grown for good, and
+ *  the run fails (exit 1).  Sawtooth use — a popup's timer, a heap that
+ *  breathes — never trips it; a slope that outlasts the noise does.
+ *
+ *  GObject counts need GOBJECT_DEBUG=instance-count, which the harness
+ *  sets for itself before GLib's type system starts.
+ *
+ *  See scripts/soak.sh for the Xvfb wrapper.
+ * ========================================================================= */
+#include <gtk/gtk.h>
+#include <glib-unix.h>
+#include <glib/gstdio.h>
+#include <malloc.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "MainWindow.h"
+#include "SettingsWindow.h"
+#include "VehicleInfoWindow.h"
+#include "AudioManager.h"
+#include "RotaryEncoder.h"
+#include "Popup.h"
+#include "Telemetry.h"
+#include "Overlay.h"
+#include "Hal.h"
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+static const guint SOAK_ECU_HZ           = 20;
+static const guint SOAK_WINDOW_STEP_SEC  = 3;
+static const guint SOAK_READER_CYCLE_SEC = 15;
+static const guint SOAK_READER_UP_SEC    = 5;
+static const guint SOAK_MIN_SAMPLES      = 6;    /* after warm-up */
+
+static const char SOAK_ENCODER_SCRIPT[] =
+    "cw 6\n"        "sleep 120\n"
+    "ccw 6\n"       "sleep 120\n"
+    "press 80\n"    "sleep 300\n"       /* → brightness mode */
+    "ccw 3\n"       "sleep 120\n"
+    "cw 3\n"        "sleep 120\n"
+    "press 80\n"    "sleep 2000\n"      /* → volume mode, HUD hides */
+    "repeat\n";
+
+/* ------------------------------------------------------------------ */
+/*  Metrics                                                           */
+/* ------------------------------------------------------------------ */
+typedef enum {
+    M_RSS_KB, M_HEAP_KB, M_FDS, M_THREADS, M_GOBJECTS, M_SOURCES, M_COUNT
+} Metric;
+
+typedef struct {
+    const char *name;
+    gint64      allowance;       /* growth tolerated before failing */
+} MetricInfo;
+
+static const MetricInfo METRICS[M_COUNT] = {
+    [M_RSS_KB]   = { "rss_kb",   1024 },
+    [M_HEAP_KB]  = { "heap_kb",   512 },
+    [M_FDS]      = { "fds",         0 },
+    [M_THREADS]  = { "threads",     0 },
+    [M_GOBJECTS] = { "gobjects",   16 },
+    [M_SOURCES]  = { "sources",     2 },
+};
+
+typedef struct {
+    gdouble t_s;
+    gint64  v[M_COUNT];
+} Sample;
+
+/* ------------------------------------------------------------------ */
+/*  Options                                                           */
+/* ------------------------------------------------------------------ */
+static gint     opt_minutes    = 240;
+static gint     opt_interval_s = 30;
+static gint     opt_warmup_min = 10;
+static gchar   *opt_csv_path   = NULL;
+static gboolean opt_no_reader  = FALSE;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "minutes", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_minutes,
+      "Length of the run (default 240)", "MIN" },
+    { "interval", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_interval_s,
+      "Seconds between samples (default 30)", "SEC" },
+    { "warmup", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_warmup_min,
+      "Minutes of samples ignored by the growth check (default 10)", "MIN" },
+    { "csv", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_csv_path,
+      "Also write every sample to FILE", "FILE" },
+    { "no-reader", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_no_reader,
+      "Do not cycle the obd_reader.py backend", NULL },
+    G_OPTION_ENTRY_NULL
+};
+
+/* ------------------------------------------------------------------ */
+/*  Run state                                                         */
+/* ------------------------------------------------------------------ */
+static GtkWidget  *g_main_win;
+static GtkWidget  *g_open_win;        /* window shown by the cycle */
+static guint       g_step;
+static gint64      g_t0_us;
+static GArray     *g_samples;         /* of Sample */
+static FILE       *g_csv;
+static gboolean    g_counting_objects;
+
+static GHashTable *g_first_types;     /* GType → count at first sample */
+static GArray     *g_live_sources;    /* of guint, from the last sample */
+static guint       g_scanned_to;      /* highest source ID checked */
+
+/* ------------------------------------------------------------------ */
+/*  Sampling                                                          */
+/* ------------------------------------------------------------------ */
+static gint64 read_rss_kb(void)
+{
+    long pages = 0, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp) {
+        if (fscanf(fp, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        fclose(fp);
+    }
+    return (gint64)resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+static gint64 read_heap_kb(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    return (gint64)(mi.uordblks + mi.hblkhd) / 1024;
+#else
+    return 0;
+#endif
+}
+
+static gint64 count_dir(const char *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (!dir) return -1;
+    gint64 n = 0;
+    while (g_dir_read_name(dir)) n++;
+    g_dir_close(dir);
+    return n;
+}
+
+static void count_objects(GType type, gint64 *total, GHashTable *by_type)
+/* Instances of `type` itself plus, recursively, of every subtype. */
+{
+    int n = g_type_get_instance_count(type);
+    *total += n;
+    if (by_type && n)
+        g_hash_table_insert(by_type, GSIZE_TO_POINTER(type), GINT_TO_POINTER(n));
+
+    guint  n_children;
+    GType *children = g_type_children(type, &n_children);
+    for (guint i = 0; i < n_children; i++)
+        count_objects(children[i], total, by_type);
+    g_free(children);
+}
+
+static gboolean nop_source(gpointer) { return G_SOURCE_REMOVE; }
+
+static gint64 count_sources(void)
+/* ----------------------------------------------------------------------
+ *  GLib cannot list a context's sources, but IDs are handed out in
+ *  order: a throw-away idle tells us the next one.  Only IDs issued
+ *  since the last sample plus the ones alive then need checking, so a
+ *  sample stays cheap however long the run.
+ * ---------------------------------------------------------------------- */
+{
+    guint next = g_idle_add(nop_source, NULL);
+    g_source_remove(next);
+
+    GArray *live = g_array_new(FALSE, FALSE, sizeof(guint));
+    for (guint i = 0; i < g_live_sources->len; i++) {
+        guint id = g_array_index(g_live_sources, guint, i);
+        if (g_main_context_find_source_by_id(NULL, id))
+            g_array_append_val(live, id);
+    }
+    for (guint id = g_scanned_to + 1; id < next; id++)
+        if (g_main_context_find_source_by_id(NULL, id))
+            g_array_append_val(live, id);
+    g_scanned_to = next;
+
+    g_array_free(g_live_sources, TRUE);
+    g_live_sources = live;
+    return live->len;
+}
+
+static gboolean sample_cb(gpointer)
+{
+    Sample s = { .t_s = (g_get_monotonic_time() - g_t0_us) / 1e6 };
+    s.v[M_RSS_KB]  = read_rss_kb();
+    s.v[M_HEAP_KB] = read_heap_kb();
+    s.v[M_FDS]     = count_dir("/proc/self/fd") - 1;     /* minus GDir's own */
+    s.v[M_THREADS] = count_dir("/proc/self/task");
+    s.v[M_SOURCES] = count_sources();
+    count_objects(G_TYPE_OBJECT, &s.v[M_GOBJECTS],
+                  g_samples->len ? NULL : g_first_types);
+    g_array_append_val(g_samples, s);
+
+    guint secs = (guint)s.t_s;
+    g_print("[Soak] %02u:%02u:%02u", secs / 3600, secs / 60 % 60, secs % 60);
+    for (guint m = 0; m < M_COUNT; m++)
+        g_print("  %s %" G_GINT64_FORMAT, METRICS[m].name, s.v[m]);
+    g_print("\n");
+
+    if (g_csv) {
+        fprintf(g_csv, "%.1f", s.t_s);
+        for (guint m = 0; m < M_COUNT; m++)
+            fprintf(g_csv, ",%" G_GINT64_FORMAT, s.v[m]);
+        fprintf(g_csv, "\n");
+        fflush(g_csv);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Load                                                              */
+/* ------------------------------------------------------------------ */
+static gboolean window_step_cb(gpointer)
+/* Settings → Vehicle Info → overlay (as over autoapp) → home, looping. */
+{
+    if (g_open_win)
+        gtk_widget_hide(g_open_win);
+    g_open_win = NULL;
+
+    switch (g_step++ % 4) {
+    case 0: g_open_win = open_settings_window(GTK_WINDOW(g_main_win));     break;
+    case 1: g_open_win = open_vehicle_info_window(GTK_WINDOW(g_main_win)); break;
+    case 2: overlay_show();                                                break;
+    case 3: overlay_hide();                                                break;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static void reader_frame(const gchar *, gsize, gpointer) { }
+
+static gboolean reader_stop_cb(gpointer)
+{
+    OBD_READER_VEHICLE_BACKEND.stop();
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean reader_cycle_cb(gpointer)
+/* Spawn the real reader (it fails or connects, either way exercising the
+ * pipes and watches) and stop it again a few seconds later. */
+{
+    OBD_READER_VEHICLE_BACKEND.set_pids(G_GUINT64_CONSTANT(1));
+    OBD_READER_VEHICLE_BACKEND.start(reader_frame, NULL, NULL);
+    g_timeout_add_seconds(SOAK_READER_UP_SEC, reader_stop_cb, NULL);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean finish_cb(gpointer)
+{
+    gtk_main_quit();
+    return G_SOURCE_REMOVE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Verdict                                                           */
+/* ------------------------------------------------------------------ */
+static void report_type_growth(void)
+/* The five GObject types that gained the most instances since the start. */
+{
+    GHashTable *now = g_hash_table_new(NULL, NULL);
+    gint64      total = 0;
+    count_objects(G_TYPE_OBJECT, &total, now);
+
+    GType top[5] = { 0 };
+    gint  grow[5] = { 0 };
+    GHashTableIter it;
+    gpointer key, val;
+    g_hash_table_iter_init(&it, now);
+    while (g_hash_table_iter_next(&it, &key, &val)) {
+        gint d = GPOINTER_TO_INT(val)
+               - GPOINTER_TO_INT(g_hash_table_lookup(g_first_types, key));
+        for (guint i = 0; i < G_N_ELEMENTS(top); i++)
+            if (d > grow[i]) {
+                memmove(&top[i + 1],  &top[i],  (G_N_ELEMENTS(top) - i - 1) * sizeof top[0]);
+                memmove(&grow[i + 1], &grow[i], (G_N_ELEMENTS(grow) - i - 1) * sizeof grow[0]);
+                top[i]  = (GType)GPOINTER_TO_SIZE(key);
+                grow[i] = d;
+                break;
+            }
+    }
+    for (guint i = 0; i < G_N_ELEMENTS(top) && grow[i] > 0; i++)
+        g_print("[Soak]   %+6d %s\n", grow[i], g_type_name(top[i]));
+    g_hash_table_destroy(now);
+}
+
+static int verdict(void)
+{
+    guint first = 0;
+    while (first < g_samples->len &&
+           g_array_index(g_samples, Sample, first).t_s < opt_warmup_min * 60.0)
+        first++;
+
+    guint n = g_samples->len - first;
+    if (n < SOAK_MIN_SAMPLES) {
+        g_printerr("[Soak] only %u samples after warm-up (need %u) — run longer\n",
+                   n, SOAK_MIN_SAMPLES);
+        return 2;
+    }
+
+    guint third = n / 3;
+    int   rc    = 0;
+    g_print("\n%-10s %12s %12s %10s  verdict\n", "metric", "max 1st 3rd",
+            "min last 3rd", "growth");
+    for (guint m = 0; m < M_COUNT; m++) {
+        gint64 early_max = G_MININT64, late_min = G_MAXINT64;
+        for (guint i = 0; i < third; i++)
+            early_max = MAX(early_max, g_array_index(g_samples, Sample, first + i).v[m]);
+        for (guint i = n - third; i < n; i++)
+            late_min  = MIN(late_min,  g_array_index(g_samples, Sample, first + i).v[m]);
+
+        gint64   growth = late_min - early_max;
+        gboolean leak   = growth > METRICS[m].allowance;
+        if (m == M_GOBJECTS && !g_counting_objects)
+            leak = FALSE;
+        g_print("%-10s %12" G_GINT64_FORMAT " %12" G_GINT64_FORMAT " %10" G_GINT64_FORMAT
+                "  %s\n", METRICS[m].name, early_max, late_min, growth,
+                leak ? "GROWING" : "ok");
+        if (leak) rc = 1;
+    }
+
+    if (g_counting_objects) {
+        g_print("\n[Soak] GObject types with the most new instances:\n");
+        report_type_growth();
+    } else {
+        g_print("\n[Soak] GObject counts unavailable (GOBJECT_DEBUG not honoured)\n");
+    }
+    return rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Entry point                                                       */
+/* ------------------------------------------------------------------ */
+int main(int argc, char *argv[])
+{
+    /* Must precede the first GType: instance counting is read once */
+    const char *dbg = g_getenv("GOBJECT_DEBUG");
+    if (!dbg || !strstr(dbg, "instance-count")) {
+        gchar *val = dbg ? g_strconcat(dbg, ":instance-count", NULL)
+                         : g_strdup("instance-count");
+        g_setenv("GOBJECT_DEBUG", val, TRUE);
+        g_free(val);
+    }
+
+    signal(SIGPIPE, SIG_IGN);            /* as main.c: the reader is cycled */
+
+    GOptionContext *oc = g_option_context_new("- Vroom soak test");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+    g_option_context_add_group(oc, gtk_get_option_group(TRUE));
+
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, &argc, &argv, &err)) {
+        g_printerr("SoakBench: %s\n", err->message);
+        return 2;
+    }
+    g_option_context_free(oc);
+
+    /* Encoder script goes through the simulator's normal file path */
+    gchar *script = NULL;
+    gint   fd     = g_file_open_tmp("vroom-soak-XXXXXX.txt", &script, NULL);
+    if (fd < 0 || write(fd, SOAK_ENCODER_SCRIPT, strlen(SOAK_ENCODER_SCRIPT)) < 0) {
+        g_printerr("SoakBench: cannot write encoder script\n");
+        return 2;
+    }
+    close(fd);
+
+    sim_set_input_script(script);
+    sim_set_ecu_rate(SOAK_ECU_HZ);
+    hal_init(TRUE);
+
+    if (opt_csv_path) {
+        g_csv = fopen(opt_csv_path, "w");
+        if (!g_csv) {
+            g_printerr("SoakBench: cannot open %s\n", opt_csv_path);
+            return 2;
+        }
+        fprintf(g_csv, "t_s");
+        for (guint m = 0; m < M_COUNT; m++)
+            fprintf(g_csv, ",%s", METRICS[m].name);
+        fprintf(g_csv, "\n");
+    }
+
+    gtk_init(&argc, &argv);
+
+    /* Same boot order as main.c */
+    popup_init();
+    telemetry_init();
+    overlay_init();
+    audio_manager_init();
+    start_rotary_thread();
+    g_main_win = create_main_window();
+    gtk_widget_show_all(g_main_win);
+
+    g_t0_us          = g_get_monotonic_time();
+    g_samples        = g_array_new(FALSE, FALSE, sizeof(Sample));
+    g_live_sources   = g_array_new(FALSE, FALSE, sizeof(guint));
+    g_first_types    = g_hash_table_new(NULL, NULL);
+    g_counting_objects = g_type_get_instance_count(GTK_TYPE_WINDOW) > 0;
+
+    g_timeout_add_seconds(SOAK_WINDOW_STEP_SEC, window_step_cb, NULL);
+    if (!opt_no_reader)
+        g_timeout_add_seconds(SOAK_READER_CYCLE_SEC, reader_cycle_cb, NULL);
+    g_timeout_add_seconds((guint)MAX(opt_interval_s, 1), sample_cb, NULL);
+    g_timeout_add_seconds((guint)MAX(opt_minutes, 1) * 60, finish_cb, NULL);
+    g_unix_signal_add(SIGINT, finish_cb, NULL);           /* Ctrl-C: report now */
+
+    g_print("[Soak] %d min, sample every %d s, warm-up %d min%s\n",
+            opt_minutes, opt_interval_s, opt_warmup_min,
+            opt_no_reader ? ", reader cycling off" : "");
+    gtk_main();
+
+    sample_cb(NULL);                    /* final state */
+    if (g_csv) fclose(g_csv);
+    g_unlink(script);
+    g_free(script);
+    return verdict();
+}
@@ -0,0 +1,206 @@
+/* =========================================================================
+ *  StateStress.c — DeviceState under concurrent writers, for TSan
+ * -------------------------------------------------------------------------
+ *  Recreates the access pattern that used to race (the knob ISR reading
+ *  the current sink while the GTK thread replaced it) at full speed:
+ *
+ *      knob threads   read the snapshot's sink and mode, set volume or
+ *                     brightness — what rotary_isr does per detent
+ *      sink thread    cycles the default sink through a few names, as
+ *                     the Settings combo does
+ *      button thread  toggles the mode
+ *      reader threads copy the sink string and range-check every field,
+ *                     like the settings and apply workers
+ *      main loop      one subscriber, as SettingsWindow
+ *
+ *  Fails (exit 1) if a snapshot holds an out-of-range value or a sink
+ *  that was never set, a dispatch runs off the main thread, or the last
+ *  dispatch does not carry the final state.  Also prints how many updates
+ *  collapsed into how many dispatches.
+ *
+ *  Meant to run under ThreadSanitizer; see scripts/state_stress.sh for
+ *  the build line.  Any TSan report fails the run on its own.
+ * ========================================================================= */
+#include <glib.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "DeviceState.h"
+
+/* ------------------------------------------------------------------ */
+/*  Settings                                                          */
+/* ------------------------------------------------------------------ */
+static const char *const SINKS[] = {
+    "alsa_output.platform-bcm2835_audio.analog-stereo",
+    "alsa_output.usb-Generic_USB_Audio-00.analog-stereo",
+    "bluez_sink.00_11_22_33_44_55.a2dp_sink",
+};
+
+/* ------------------------------------------------------------------ */
+/*  Options                                                           */
+/* ------------------------------------------------------------------ */
+static gint opt_seconds = 5;
+static gint opt_knobs   = 2;
+static gint opt_readers = 2;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "seconds", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_seconds,
+      "Length of the run (default 5)", "SEC" },
+    { "knobs", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_knobs,
+      "Knob writer threads (default 2)", "N" },
+    { "readers", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_readers,
+      "Snapshot reader threads (default 2)", "N" },
+    G_OPTION_ENTRY_NULL
+};
+
+/* ------------------------------------------------------------------ */
+/*  Run state                                                         */
+/* ------------------------------------------------------------------ */
+static atomic_bool  g_stop;
+static atomic_llong g_updates;
+static atomic_int   g_errors;
+static GThread     *g_main_thread;
+static guint64      g_dispatches;       /* main thread only */
+static DeviceState  g_last_seen;        /* main thread only */
+
+static void fail(const char *what, const DeviceState *st)
+{
+    if (atomic_fetch_add(&g_errors, 1) < 10)
+        fprintf(stderr, "[Stress] %s: sink=%s volume=%d brightness=%d mode=%d\n",
+                what, st->sink ? st->sink : "(null)", st->volume,
+                st->brightness, st->mode);
+}
+
+static void check(const DeviceState *st)
+{
+    if (st->volume < -1 || st->volume > 100)
+        fail("volume out of range", st);
+    if (st->brightness < -1 || st->brightness > 31)
+        fail("brightness out of range", st);
+    if (st->mode != DEVICE_MODE_VOLUME && st->mode != DEVICE_MODE_BRIGHTNESS)
+        fail("bad mode", st);
+    if (st->sink) {
+        gboolean known = FALSE;
+        for (guint i = 0; i < G_N_ELEMENTS(SINKS); i++)
+            known |= strcmp(st->sink, SINKS[i]) == 0;      /* reads every byte */
+        if (!known)
+            fail("unknown sink", st);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  Threads                                                           */
+/* ------------------------------------------------------------------ */
+static gpointer knob_thread(gpointer data)
+{
+    int v = GPOINTER_TO_INT(data);
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed)) {
+        DeviceState st = device_state_get();
+        check(&st);
+        if (st.mode == DEVICE_MODE_VOLUME)
+            device_state_set_volume(v = (v + 5) % 101);
+        else
+            device_state_set_brightness(v = (v + 5) % 32);
+        atomic_fetch_add_explicit(&g_updates, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static gpointer sink_thread(gpointer)
+{
+    for (guint i = 0; !atomic_load_explicit(&g_stop, memory_order_relaxed); i++) {
+        device_state_set_sink(SINKS[i % G_N_ELEMENTS(SINKS)]);
+        atomic_fetch_add_explicit(&g_updates, 1, memory_order_relaxed);
+        if (i % 64 == 0)
+            g_usleep(50);
+    }
+    return NULL;
+}
+
+static gpointer button_thread(gpointer)
+{
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed)) {
+        device_state_toggle_mode();
+        atomic_fetch_add_explicit(&g_updates, 1, memory_order_relaxed);
+        g_usleep(200);
+    }
+    return NULL;
+}
+
+static gpointer reader_thread(gpointer)
+{
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed)) {
+        DeviceState st = device_state_get();
+        check(&st);
+        gchar *copy = g_strdup(st.sink);        /* what the workers keep */
+        g_free(copy);
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Main loop side                                                    */
+/* ------------------------------------------------------------------ */
+static void on_state(const DeviceState *st, guint, gpointer)
+{
+    if (g_thread_self() != g_main_thread)
+        fail("dispatch off the main thread", st);
+    check(st);
+    g_last_seen = *st;
+    g_dispatches++;
+}
+
+static gboolean stop_run(gpointer loop)
+{
+    atomic_store(&g_stop, true);
+    g_main_loop_quit(loop);
+    return G_SOURCE_REMOVE;
+}
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *oc = g_option_context_new("- DeviceState stress test");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, &argc, &argv, &err)) {
+        g_printerr("StateStress: %s\n", err->message);
+        return 2;
+    }
+    g_option_context_free(oc);
+
+    g_main_thread = g_thread_self();
+    device_state_subscribe(on_state, ~0u, NULL);
+
+    GPtrArray *threads = g_ptr_array_new();
+    for (int i = 0; i < opt_knobs; i++)
+        g_ptr_array_add(threads, g_thread_new("knob", knob_thread, GINT_TO_POINTER(i * 7)));
+    for (int i = 0; i < opt_readers; i++)
+        g_ptr_array_add(threads, g_thread_new("reader", reader_thread, NULL));
+    g_ptr_array_add(threads, g_thread_new("sink", sink_thread, NULL));
+    g_ptr_array_add(threads, g_thread_new("button", button_thread, NULL));
+
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    g_timeout_add_seconds((guint)opt_seconds, stop_run, loop);
+    g_main_loop_run(loop);
+
+    for (guint i = 0; i < threads->len; i++)
+        g_thread_join(threads->pdata[i]);
+    g_ptr_array_free(threads, TRUE);
+
+    /* Drain: the last update must reach the subscriber */
+    while (g_main_context_iteration(NULL, FALSE))
+        ;
+    DeviceState final = device_state_get();
+    if (final.volume != g_last_seen.volume || final.brightness != g_last_seen.brightness
+            || final.mode != g_last_seen.mode || final.sink != g_last_seen.sink)
+        fail("last dispatch is not the final state", &final);
+
+    long long updates = atomic_load(&g_updates);
+    printf("[Stress] %lld updates → %" G_GUINT64_FORMAT " dispatches (%.0f per dispatch), "
+           "%d errors\n", updates, g_dispatches,
+           g_dispatches ? (double)updates / g_dispatches : 0.0, atomic_load(&g_errors));
+    g_main_loop_unref(loop);
+    return atomic_load(&g_errors) ? 1 : 0;
+}
@@ -0,0 +1,339 @@
+/* =========================================================================
+ *  UiBench.c — headless frame-time benchmark for the real Vroom windows
+ * -------------------------------------------------------------------------
+ *  Runs the actual MainWindow / SettingsWindow / VehicleInfoWindow code
+ *  under any X server (Xvfb) or the Broadway backend and drives each
+ *  screen with synthetic input:
+ *
+ *      main-menu            queue_resize of the home screen  @ 60 Hz
+ *      settings             rotary-style slider updates      @ 60 Hz
+ *      vehicle-info-N hz    synthetic OBD frames             @ 10/50/200 Hz
+ *
+ *  Per-frame layout, paint and total frame time come from the window's
+ *  GdkFrameClock (before-paint → layout → paint → after-paint).  Results
+ *  are printed as a table (and optionally JSON).  With --baseline, the
+ *  run fails (exit 1) if any scenario's p99 frame time exceeds the stored
+ *  value by more than --tolerance percent; --update-baseline rewrites it.
+ *
+ *  See scripts/ui_bench.sh for the Xvfb / Broadway wrapper.
+ * ========================================================================= */
+#include <gtk/gtk.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MainWindow.h"
+#include "SettingsWindow.h"
+#include "VehicleInfoWindow.h"
+#include "Hal.h"
+#include "DeviceState.h"
+
+/* ------------------------------------------------------------------ */
+/*  Scenarios                                                         */
+/* ------------------------------------------------------------------ */
+typedef enum { SCN_MAIN_MENU, SCN_SETTINGS, SCN_VEHICLE } ScenarioKind;
+
+typedef struct {
+    const char   *name;
+    ScenarioKind  kind;
+    guint         rate_hz;
+} Scenario;
+
+static const Scenario SCENARIOS[] = {
+    { "main-menu",          SCN_MAIN_MENU,  60 },
+    { "settings",           SCN_SETTINGS,   60 },
+    { "vehicle-info-10hz",  SCN_VEHICLE,    10 },
+    { "vehicle-info-50hz",  SCN_VEHICLE,    50 },
+    { "vehicle-info-200hz", SCN_VEHICLE,   200 },
+};
+
+typedef struct {
+    GArray *frame_ms;
+    GArray *layout_ms;
+    GArray *paint_ms;
+    guint   ticks;
+} ScenarioResult;
+
+/* ------------------------------------------------------------------ */
+/*  Options                                                           */
+/* ------------------------------------------------------------------ */
+static gint     opt_duration_s   = 5;
+static gint     opt_settle_ms    = 500;
+static gdouble  opt_tolerance    = 15.0;
+static gchar   *opt_baseline     = NULL;
+static gboolean opt_update_base  = FALSE;
+static gchar   *opt_json_path    = NULL;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "duration", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_duration_s,
+      "Seconds measured per scenario (default 5)", "SEC" },
+    { "settle", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_settle_ms,
+      "Warm-up before measuring each scenario (default 500)", "MS" },
+    { "baseline", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_baseline,
+      "Compare p99 frame times against FILE", "FILE" },
+    { "update-baseline", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_update_base,
+      "Write this run's p99 values to the --baseline file", NULL },
+    { "tolerance", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, &opt_tolerance,
+      "Allowed p99 regression in percent (default 15)", "PCT" },
+    { "json", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_json_path,
+      "Also write results as JSON to FILE", "FILE" },
+    G_OPTION_ENTRY_NULL
+};
+
+/* ------------------------------------------------------------------ */
+/*  Run state                                                         */
+/* ------------------------------------------------------------------ */
+static GtkWidget      *g_main_win  = NULL;
+static GtkWidget      *g_target    = NULL;     /* window being measured */
+static GdkFrameClock  *g_clock     = NULL;
+static gulong          g_sig[4];
+static guint           g_drive_tag = 0;
+static gint            g_current   = -1;
+static ScenarioResult  g_results[G_N_ELEMENTS(SCENARIOS)];
+
+static gint64 g_t_before = 0, g_t_layout = 0, g_t_paint = 0;
+
+/* Forward declarations */
+static gboolean start_next_scenario(gpointer);
+static gboolean begin_measuring    (gpointer);
+static gboolean stop_measuring     (gpointer);
+static gboolean drive_tick         (gpointer);
+static int      report             (void);
+
+/* ------------------------------------------------------------------ */
+/*  Frame-clock hooks (connected after GTK's own handlers)            */
+/* ------------------------------------------------------------------ */
+static void on_before_paint(GdkFrameClock *, gpointer)
+{
+    g_t_before = g_get_monotonic_time();
+    g_t_layout = g_t_paint = 0;
+}
+
+static void on_layout(GdkFrameClock *, gpointer) { g_t_layout = g_get_monotonic_time(); }
+static void on_paint (GdkFrameClock *, gpointer) { g_t_paint  = g_get_monotonic_time(); }
+
+static void on_after_paint(GdkFrameClock *, gpointer)
+{
+    if (!g_t_before || g_current < 0)
+        return;
+
+    ScenarioResult *r   = &g_results[g_current];
+    gint64          now = g_get_monotonic_time();
+    gint64          lay = g_t_layout ? g_t_layout : g_t_before;
+    gint64          pnt = g_t_paint  ? g_t_paint  : lay;
+
+    gdouble frame  = (now - g_t_before) / 1e3;
+    gdouble layout = (lay - g_t_before) / 1e3;
+    gdouble paint  = (pnt - lay)        / 1e3;
+
+    g_array_append_val(r->frame_ms,  frame);
+    g_array_append_val(r->layout_ms, layout);
+    g_array_append_val(r->paint_ms,  paint);
+    g_t_before = 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Scenario sequencing                                               */
+/* ------------------------------------------------------------------ */
+static gboolean start_next_scenario(gpointer)
+{
+    if (g_target && g_target != g_main_win)
+        gtk_widget_hide(g_target);
+
+    if (++g_current >= (gint)G_N_ELEMENTS(SCENARIOS)) {
+        gtk_main_quit();
+        return G_SOURCE_REMOVE;
+    }
+
+    const Scenario *s = &SCENARIOS[g_current];
+    switch (s->kind) {
+        case SCN_MAIN_MENU: g_target = g_main_win; gtk_window_present(GTK_WINDOW(g_main_win)); break;
+        case SCN_SETTINGS:  g_target = open_settings_window(GTK_WINDOW(g_main_win));          break;
+        case SCN_VEHICLE:   g_target = open_vehicle_info_window(GTK_WINDOW(g_main_win));      break;
+    }
+
+    g_timeout_add(opt_settle_ms, begin_measuring, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean begin_measuring(gpointer)
+{
+    const Scenario *s = &SCENARIOS[g_current];
+    ScenarioResult *r = &g_results[g_current];
+
+    r->frame_ms  = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    r->layout_ms = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    r->paint_ms  = g_array_new(FALSE, FALSE, sizeof(gdouble));
+
+    g_clock = gtk_widget_get_frame_clock(g_target);
+    g_sig[0] = g_signal_connect(g_clock, "before-paint", G_CALLBACK(on_before_paint), NULL);
+    g_sig[1] = g_signal_connect(g_clock, "layout",       G_CALLBACK(on_layout),       NULL);
+    g_sig[2] = g_signal_connect(g_clock, "paint",        G_CALLBACK(on_paint),        NULL);
+    g_sig[3] = g_signal_connect(g_clock, "after-paint",  G_CALLBACK(on_after_paint),  NULL);
+
+    g_drive_tag = g_timeout_add_full(G_PRIORITY_HIGH, MAX(1000u / s->rate_hz, 1u),
+                                     drive_tick, NULL, NULL);
+    g_timeout_add_seconds(opt_duration_s, stop_measuring, NULL);
+
+    g_print("[UiBench] %-20s %3u Hz for %d s …\n", s->name, s->rate_hz, opt_duration_s);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean stop_measuring(gpointer)
+{
+    g_source_remove(g_drive_tag);
+    g_drive_tag = 0;
+    for (guint i = 0; i < G_N_ELEMENTS(g_sig); i++)
+        g_signal_handler_disconnect(g_clock, g_sig[i]);
+    g_clock = NULL;
+
+    g_idle_add(start_next_scenario, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Synthetic input                                                   */
+/* ------------------------------------------------------------------ */
+static gboolean drive_tick(gpointer)
+{
+    const Scenario *s = &SCENARIOS[g_current];
+    guint           n = g_results[g_current].ticks++;
+    double          t = n / (double)s->rate_hz;
+
+    switch (s->kind) {
+    case SCN_MAIN_MENU:
+        gtk_widget_queue_resize(g_main_win);
+        break;
+
+    case SCN_SETTINGS:
+        /* The same path the rotary encoder uses */
+        device_state_set_volume    ((int)(50 + 50 * sin(t * 2.0)));
+        device_state_set_brightness((int)(15 + 15 * cos(t * 2.0)));
+        break;
+
+    case SCN_VEHICLE: {
+        char line[512];
+        int  len = snprintf(line, sizeof line,
+            "{\"RPM\": %.0f, \"SPEED\": %.1f, \"ENGINE LOAD\": %.1f, "
+            "\"THROTTLE POSITION\": %.1f, \"INTAKE PRESSURE\": %.0f, "
+            "\"TIMING ADVANCE\": %.1f, \"FUEL LEVEL\": %.1f, "
+            "\"CONTROL MODULE VOLTAGE\": %.2f}\n",
+            1800 + 1000 * sin(t * 1.3),  60 + 40 * sin(t * 0.2),
+            40 + 30 * sin(t * 2.1),      20 + 15 * sin(t * 1.7),
+            60 + 30 * sin(t * 0.9),      12 + 8 * sin(t * 1.1),
+            55 - t * 0.01,               13.8 + 0.4 * sin(t * 0.5));
+        vehicle_info_window_feed_frame(line, (gsize)len);
+        break;
+    }
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Statistics + baseline                                             */
+/* ------------------------------------------------------------------ */
+static gint cmp_double(gconstpointer a, gconstpointer b)
+{
+    gdouble x = *(const gdouble *)a, y = *(const gdouble *)b;
+    return (x > y) - (x < y);
+}
+
+static gdouble percentile(GArray *sorted, gdouble p)
+{
+    if (!sorted->len) return NAN;
+    guint idx = (guint)ceil(p / 100.0 * sorted->len);
+    idx = CLAMP(idx, 1u, sorted->len) - 1;
+    return g_array_index(sorted, gdouble, idx);
+}
+
+static int report(void)
+{
+    GKeyFile *base = g_key_file_new();
+    gboolean  have_base = opt_baseline && !opt_update_base &&
+        g_key_file_load_from_file(base, opt_baseline, G_KEY_FILE_NONE, NULL);
+
+    GString *json = g_string_new("{\"scenarios\":[");
+    int      rc   = 0;
+
+    g_print("\n%-20s %6s %8s %8s %8s %8s %9s %9s\n", "scenario", "frames",
+            "p50 ms", "p95 ms", "p99 ms", "max ms", "layout99", "paint99");
+
+    for (guint i = 0; i < G_N_ELEMENTS(SCENARIOS); i++) {
+        ScenarioResult *r = &g_results[i];
+        if (!r->frame_ms) continue;
+
+        g_array_sort(r->frame_ms,  cmp_double);
+        g_array_sort(r->layout_ms, cmp_double);
+        g_array_sort(r->paint_ms,  cmp_double);
+
+        gdouble p50 = percentile(r->frame_ms, 50), p95 = percentile(r->frame_ms, 95);
+        gdouble p99 = percentile(r->frame_ms, 99), max = percentile(r->frame_ms, 100);
+        gdouble l99 = percentile(r->layout_ms, 99), q99 = percentile(r->paint_ms, 99);
+
+        g_print("%-20s %6u %8.3f %8.3f %8.3f %8.3f %9.3f %9.3f",
+                SCENARIOS[i].name, r->frame_ms->len, p50, p95, p99, max, l99, q99);
+
+        if (have_base && g_key_file_has_key(base, "p99_frame_ms", SCENARIOS[i].name, NULL)) {
+            gdouble ref   = g_key_file_get_double(base, "p99_frame_ms", SCENARIOS[i].name, NULL);
+            gdouble limit = ref * (1.0 + opt_tolerance / 100.0);
+            if (p99 > limit) {
+                g_print("   REGRESSION (baseline %.3f, limit %.3f)", ref, limit);
+                rc = 1;
+            } else {
+                g_print("   ok (baseline %.3f)", ref);
+            }
+        }
+        g_print("\n");
+
+        if (opt_update_base)
+            g_key_file_set_double(base, "p99_frame_ms", SCENARIOS[i].name, p99);
+
+        g_string_append_printf(json,
+            "%s{\"name\":\"%s\",\"rate_hz\":%u,\"frames\":%u,"
+            "\"frame_ms\":{\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f},"
+            "\"layout_ms_p99\":%.4f,\"paint_ms_p99\":%.4f}",
+            i ? "," : "", SCENARIOS[i].name, SCENARIOS[i].rate_hz,
+            r->frame_ms->len, p50, p95, p99, max, l99, q99);
+    }
+    g_string_append(json, "]}\n");
+
+    if (opt_update_base && opt_baseline) {
+        if (g_key_file_save_to_file(base, opt_baseline, NULL))
+            g_print("[UiBench] baseline written to %s\n", opt_baseline);
+    }
+    if (opt_json_path)
+        g_file_set_contents(opt_json_path, json->str, -1, NULL);
+
+    g_string_free(json, TRUE);
+    g_key_file_free(base);
+    return rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Entry point                                                       */
+/* ------------------------------------------------------------------ */
+int main(int argc, char *argv[])
+{
+    GOptionContext *oc = g_option_context_new("- Vroom UI frame-time benchmark");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+    g_option_context_add_group(oc, gtk_get_option_group(TRUE));
+
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, &argc, &argv, &err)) {
+        g_printerr("UiBench: %s\n", err->message);
+        return 2;
+    }
+    g_option_context_free(oc);
+
+    /* No pactl / sudo on the bench host; frames come from drive_tick() */
+    hal_init(TRUE);
+    vehicle_info_window_set_external_feed(TRUE);
+
+    g_main_win = create_main_window();
+    gtk_widget_show_all(g_main_win);
+
+    g_timeout_add(opt_settle_ms, start_next_scenario, NULL);
+    gtk_main();
+
+    return report();
+}
@@ -1,32 +1,269 @@
 /* =========================================================================
  *  main.c — entry point for the Vroom Infotainment GUI
  * -------------------------------------------------------------------------
- *  1. Initialise GTK.
- *  2. Launch the rotary-encoder helper (GPIO interrupt thread).
- *  3. Build and display the main menu window.
- *  4. Enter the GTK main loop and wait for events forever.
+ *  1. Parse Vroom's own options (--trace, --watchdog, --metrics,
+ *     --slider-rate, --simulate, --can, --sources, --mqtt …) and pick
+ *     the hardware backends.
+ *  2. Initialise GTK.
+ *  3. Build the HUD overlay, start the MQTT publisher and the telemetry
+ *     session that feeds it and the alert rules, arm the idle manager,
+ *     and launch the rotary-encoder helper (GPIO interrupt thread).
+ *  4. Build and display the main menu window.
+ *  5. Enter the GTK main loop and wait for events forever.
+ *  6. On quit, flush the publisher's last batches (or spool them).
  * ========================================================================= */
 #include <gtk/gtk.h>
 #include "MainWindow.h"
 #include "RotaryEncoder.h"
 #include "AudioManager.h"
+#include "Popup.h"
+#include "Trace.h"
+#include "Watchdog.h"
+#include "SettingsWindow.h"
+#include "Hal.h"
+#include "VehicleInfoWindow.h"
+#include "Telemetry.h"
+#include "Overlay.h"
+#include "IdleManager.h"
+#include "Metrics.h"
+#include "EventLog.h"
+#include "Publisher.h"
+#include "Merge.h"
+
+#include <signal.h>
+
+/* ------------------------------------------------------------------ */
+/*  Command-line options                                              */
+/* ------------------------------------------------------------------ */
+static gchar *opt_trace_path  = NULL;
+static gint   opt_watchdog_ms = 0;
+static gint   opt_slider_hz   = 0;
+static gboolean opt_simulate  = FALSE;
+static gchar *opt_sim_script  = NULL;
+static gint   opt_sim_ecu_hz  = 0;
+static gchar *opt_custom_page = NULL;
+static gchar *opt_overlay_pids = NULL;
+static gint   opt_idle_min    = -1;
+static gchar *opt_metrics     = NULL;
+static gchar *opt_can_iface   = NULL;
+static gchar *opt_dbc_path    = NULL;
+static gchar *opt_can_map     = NULL;
+static gchar *opt_mqtt        = NULL;
+static gchar *opt_mqtt_pids   = NULL;
+static gint   opt_mqtt_flush  = 0;
+static gchar *opt_sources     = NULL;
+static gchar *opt_source_prio = NULL;
+static gint   opt_merge_ms    = -1;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "trace", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_trace_path,
+      "Record a Chrome/Perfetto trace and write it to FILE on exit", "FILE" },
+    { "watchdog", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_watchdog_ms,
+      "Report GTK main-loop iterations longer than MS (e.g. 16 or 50)", "MS" },
+    { "slider-rate", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_slider_hz,
+      "Apply slider drags at most HZ times per second (default 15)", "HZ" },
+    { "simulate", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_simulate,
+      "Run without hardware: scripted knob, fake backlight/sinks, synthetic ECU", NULL },
+    { "sim-script", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_sim_script,
+      "Encoder script replayed under --simulate (default: built-in demo)", "FILE" },
+    { "sim-ecu-hz", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_sim_ecu_hz,
+      "Synthetic ECU frame rate under --simulate (default 2)", "HZ" },
+    { "custom-page", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_custom_page,
+      "PIDs on the Vehicle Info \"Custom\" page, e.g. \"RPM,OIL TEMP\"", "LIST" },
+    { "overlay-pids", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_overlay_pids,
+      "PIDs in the strip over Android Auto (default \"SPEED,RPM,CONTROL MODULE VOLTAGE\"; \"\" disables)", "LIST" },
+    { "idle-minutes", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_idle_min,
+      "Dim and slow down after MIN minutes without input (default 10, 0 = only when the engine is off)", "MIN" },
+    { "metrics", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_metrics,
+      "Serve Prometheus metrics on PORT, 127.0.0.1:PORT or unix:PATH", "ADDR" },
+    { "can", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_can_iface,
+      "Decode vehicle data passively from CAN interface IFACE (needs --dbc)", "IFACE" },
+    { "dbc", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_dbc_path,
+      "DBC file describing the broadcasts on --can", "FILE" },
+    { "can-map", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_can_map,
+      "DBC signals feeding PIDs, e.g. \"EngineSpeed=RPM,VehSpeed=SPEED\"", "LIST" },
+    { "sources", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_sources,
+      "Run several vehicle sources and merge them, best first: obd, can (needs --can), sim", "LIST" },
+    { "source-priority", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_source_prio,
+      "Per-PID source order for --sources, e.g. \"RPM=can,obd;FUEL RATE=obd,derived\"", "SPEC" },
+    { "merge-window-ms", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_merge_ms,
+      "Longest --sources holds a frame to put a slower source's in order (default 200)", "MS" },
+    { "mqtt", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_mqtt,
+      "Publish vehicle data to the MQTT broker at HOST[:PORT] (spooled while unreachable)", "ADDR" },
+    { "mqtt-pids", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &opt_mqtt_pids,
+      "PIDs always polled for --mqtt (default \"" PUBLISH_DEFAULT_PIDS "\")", "LIST" },
+    { "mqtt-flush-ms", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_mqtt_flush,
+      "Longest a sample waits in an MQTT batch (default 1000)", "MS" },
+    G_OPTION_ENTRY_NULL
+};
+
+static void parse_options(int *argc, char ***argv)
+/* GTK's own options are left in argv for gtk_init(). */
+{
+    GOptionContext *oc = g_option_context_new("- Vroom Infotainment");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+    g_option_context_set_ignore_unknown_options(oc, TRUE);
+
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, argc, argv, &err)) {
+        g_printerr("Vroom: %s\n", err->message);
+        g_clear_error(&err);
+    }
+    g_option_context_free(oc);
+}
+
+static gboolean select_sources(const char *list, gboolean can_ready)
+/* "obd,can" → vehicle backends 0, 1 … and their names for the merge */
+{
+    static const struct {
+        const char           *name;
+        const VehicleBackend *backend;
+    } KNOWN[] = {
+        { "obd", &OBD_READER_VEHICLE_BACKEND },
+        { "can", &SOCKETCAN_VEHICLE_BACKEND  },
+        { "sim", &SIM_VEHICLE_BACKEND        },
+    };
+    guint       chosen[HAL_MAX_VEHICLES];
+    const char *names[HAL_MAX_VEHICLES];
+    guint       n  = 0;
+    gboolean    ok = TRUE;
+
+    gchar **items = g_strsplit(list, ",", -1);
+    for (guint i = 0; ok && items[i]; i++) {
+        const char *item = g_strstrip(items[i]);
+        guint    k   = 0;
+        gboolean dup = FALSE;
+        while (k < G_N_ELEMENTS(KNOWN) && g_ascii_strcasecmp(item, KNOWN[k].name))
+            k++;
+        for (guint j = 0; j < n; j++)
+            dup |= chosen[j] == k;
+
+        if (k == G_N_ELEMENTS(KNOWN))
+            g_printerr("Vroom: unknown source '%s'\n", item);
+        else if (dup)
+            g_printerr("Vroom: source '%s' given twice\n", item);
+        else if (KNOWN[k].backend == &SOCKETCAN_VEHICLE_BACKEND && !can_ready)
+            g_printerr("Vroom: source 'can' needs a working --can and --dbc\n");
+        else if (n == HAL_MAX_VEHICLES)
+            g_printerr("Vroom: at most %d sources\n", HAL_MAX_VEHICLES);
+        else {
+            chosen[n]  = k;
+            names[n++] = KNOWN[k].name;
+            continue;
+        }
+        ok = FALSE;
+    }
+    g_strfreev(items);
+    if (!ok || !n)
+        return FALSE;
+
+    hal_set_vehicle(KNOWN[chosen[0]].backend);
+    for (guint i = 1; i < n; i++)
+        hal_add_vehicle(KNOWN[chosen[i]].backend);
+    merge_configure(n, names);
+    return TRUE;
+}
+
+/* First paint of the home screen closes the boot timeline */
+static gboolean on_first_draw(GtkWidget *w, cairo_t *, gpointer)
+{
+    TRACE_INSTANT("first-frame");
+    g_signal_handlers_disconnect_by_func(w, on_first_draw, NULL);
+    return FALSE;
+}
 
 int main(int argc, char *argv[])
 {
-    /* GTK must be initialised before any widgets are created */
-    gtk_init(&argc, &argv);
+    evlog_init();                        /* kill -QUIT / crash → event dump */
+
+    /* A child that dies between two pipe writes (obd_reader.py's control
+     * stdin) must not take the UI down; write() reports EPIPE instead. */
+    signal(SIGPIPE, SIG_IGN);
+
+    parse_options(&argc, &argv);
+    trace_init(opt_trace_path);          /* no-op without --trace */
+    if (opt_slider_hz > 0)
+        settings_set_apply_rate((guint)opt_slider_hz);
+
+    sim_set_input_script(opt_sim_script);
+    if (opt_sim_ecu_hz > 0)
+        sim_set_ecu_rate((guint)opt_sim_ecu_hz);
+    hal_init(opt_simulate);              /* real hardware unless --simulate */
+    gboolean can_ready = FALSE;
+    if (opt_can_iface && !opt_dbc_path)
+        g_printerr("Vroom: --can needs --dbc; keeping %s\n", hal_vehicle()->name);
+    else if (opt_can_iface)
+        can_ready = can_reader_configure(opt_can_iface, opt_dbc_path, opt_can_map);
+    if (opt_sources && !select_sources(opt_sources, can_ready))
+        g_printerr("Vroom: bad --sources; keeping %s\n", hal_vehicle()->name);
+    else if (!opt_sources && can_ready)
+        hal_set_vehicle(&SOCKETCAN_VEHICLE_BACKEND);    /* also under --simulate */
+    if (opt_source_prio && !merge_set_priority(opt_source_prio))
+        g_printerr("Vroom: bad --source-priority; using --sources order\n");
+    if (opt_merge_ms >= 0)
+        merge_set_window((guint)opt_merge_ms);
+    if (opt_custom_page)
+        vehicle_info_window_set_custom_page(opt_custom_page);
+    if (opt_overlay_pids)
+        overlay_set_pids(opt_overlay_pids);
+    if (opt_idle_min >= 0)
+        idle_manager_set_timeout((guint)opt_idle_min);
+    if (opt_mqtt && !publisher_configure(opt_mqtt, opt_mqtt_pids,
+                                         (guint)MAX(opt_mqtt_flush, 0)))
+        g_printerr("Vroom: bad --mqtt-pids; not publishing\n");
+
+    {
+        TRACE_SCOPE("boot");
+
+        /* GTK must be initialised before any widgets are created */
+        {
+            TRACE_SCOPE("gtk_init");
+            gtk_init(&argc, &argv);
+        }
+
+        /* One persistent HUD, updated in place by the knob */
+        popup_init();
 
-    /* Prime AudioManager so the rotary knob has a sink from the start */
-    audio_manager_init();
+        /* Batches → broker / spool on its own thread (no-op without --mqtt) */
+        publisher_start();
 
-    /* Rotary encoder: sets up GPIO interrupts + helper thread */
-    start_rotary_thread();
+        /* Vehicle data + alert rules (backend runs if any rule needs it) */
+        telemetry_init();
 
-    /* Build the full-screen home screen */
-    GtkWidget *main_window = create_main_window();
-    gtk_widget_show_all(main_window);
+        /* Telemetry strip shown over autoapp */
+        overlay_init();
+
+        /* Engine-off / no-input sleep (wakes on knob or touch) */
+        idle_manager_init();
+
+        /* Prime AudioManager so the rotary knob has a sink from the start */
+        audio_manager_init();
+
+        /* Rotary encoder: sets up GPIO interrupts + helper thread */
+        start_rotary_thread();
+
+        /* Build the full-screen home screen */
+        GtkWidget *main_window = create_main_window();
+        g_signal_connect(main_window, "draw", G_CALLBACK(on_first_draw), NULL);
+        {
+            TRACE_SCOPE("show_main_window");
+            gtk_widget_show_all(main_window);
+        }
+    }
+
+    /* Stall detector (no-op unless --watchdog was given) */
+    if (opt_watchdog_ms > 0)
+        watchdog_start((unsigned int)opt_watchdog_ms);
+
+    /* Scrape endpoint; also times loop iterations for the histogram */
+    if (opt_metrics && metrics_serve(opt_metrics))
+        watchdog_track_iterations();
 
     /* Hand control to GTK until the user quits */
     gtk_main();
+
+    publisher_shutdown();
+    watchdog_dump();
+    trace_shutdown();
     return 0;
 }
@@ -0,0 +1,871 @@
+/* =========================================================================
+ *  VroomStats.c — `vroom-stats`, trip-log analytics for obd_reader.py logs
+ * -------------------------------------------------------------------------
+ *  Input: one or more files captured from obd_reader.py's stdout, i.e.
+ *  one flat JSON object per line ({"RPM": 814.0, "SPEED": 0.0, …}).  Each
+ *  file is one trip.  Frames are assumed evenly spaced (--interval).
+ *
+ *  Pipeline
+ *      1. Every file is mmapped and cut into ~CHUNK_BYTES pieces at line
+ *         boundaries.  Worker threads (one per core by default) parse the
+ *         pieces with a hand-rolled scanner straight into per-chunk
+ *         columnar float arrays (NaN = PID absent in that frame), then run
+ *         the vector kernels over their own chunk: count / min / max /
+ *         sum, time-in-band counts and idle frames.
+ *      2. Chunk partials are merged per trip and overall (cheap, serial).
+ *      3. Percentiles need the whole column: per (trip, PID) and per PID
+ *         overall, values are gathered and quick-selected, again in
+ *         parallel.
+ *
+ *  The kernels use GCC vector extensions (4 × float), which compile to
+ *  NEON on the Pi 5 and SSE on x86 without intrinsics.
+ *
+ *  Build: see docs/Setup.MD ("Trip log analytics").
+ * ========================================================================= */
+#include <glib.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Constants                                                         */
+/* ------------------------------------------------------------------ */
+#define MAX_COLS   64                      /* distinct PID names        */
+#define MAX_BANDS  16                      /* edges per --band spec     */
+#define MAX_SPECS   8                      /* --band options            */
+
+static const gsize  CHUNK_BYTES     = 8u << 20;
+static const gsize  COL_INIT_ROWS   = 4096;
+static const double PERCENTILES[]   = { 50.0, 90.0, 99.0 };
+
+static const char DEFAULT_BAND[]    = "RPM:0,1000,2000,3000,4000,5000,6000";
+
+/* ------------------------------------------------------------------ */
+/*  Options                                                           */
+/* ------------------------------------------------------------------ */
+static gint     opt_threads    = 0;        /* 0 → one per core          */
+static gdouble  opt_interval   = 0.5;      /* seconds between frames    */
+static gdouble  opt_idle_speed = 1.0;      /* km/h                      */
+static gchar  **opt_bands      = NULL;
+static gchar   *opt_json_path  = NULL;
+static gboolean opt_summary    = FALSE;
+
+static const GOptionEntry OPTION_ENTRIES[] = {
+    { "threads", 'j', G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &opt_threads,
+      "Worker threads (default: one per core)", "N" },
+    { "interval", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, &opt_interval,
+      "Seconds between frames in the logs (default 0.5)", "SEC" },
+    { "idle-speed", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, &opt_idle_speed,
+      "Engine running below this SPEED counts as idle (default 1 km/h)", "KMH" },
+    { "band", 'b', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING_ARRAY, &opt_bands,
+      "Time-in-band histogram, e.g. RPM:0,1000,2000 (repeatable; default RPM bands)", "PID:E0,E1,…" },
+    { "json", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &opt_json_path,
+      "Write results as JSON to FILE ('-' for stdout)", "FILE" },
+    { "summary", 's', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &opt_summary,
+      "Print only the all-trips summary", NULL },
+    G_OPTION_ENTRY_NULL
+};
+
+/* ------------------------------------------------------------------ */
+/*  Types                                                             */
+/* ------------------------------------------------------------------ */
+typedef float   v4f __attribute__((vector_size(16)));
+typedef int32_t v4i __attribute__((vector_size(16)));
+
+typedef struct {
+    guint64 count;
+    double  sum;
+    float   min, max;
+} ColAgg;
+
+typedef struct {
+    gchar  *pid;                           /* column name               */
+    gint    col;                           /* resolved after parsing    */
+    guint   n_edges;
+    float   edge[MAX_BANDS];               /* band i = [edge i, edge i+1) */
+} BandSpec;
+
+typedef struct {
+    guint        trip;
+    const char  *begin, *end;
+
+    gsize        rows, cap;
+    float       *col[MAX_COLS];
+    guint64      bad_lines;
+
+    ColAgg       agg[MAX_COLS];
+    guint64      band[MAX_SPECS][MAX_BANDS];
+    guint64      idle_rows;
+} Chunk;
+
+typedef struct {
+    gchar       *path;
+    GMappedFile *map;
+    guint        first_chunk, n_chunks;
+
+    gsize        rows;
+    guint64      bad_lines, idle_rows;
+    ColAgg       agg[MAX_COLS];
+    guint64      band[MAX_SPECS][MAX_BANDS];
+    float        pct[MAX_COLS][G_N_ELEMENTS(PERCENTILES)];
+} Trip;
+
+/* ------------------------------------------------------------------ */
+/*  Module-wide state                                                 */
+/* ------------------------------------------------------------------ */
+static GMutex    g_key_lock;
+static gchar    *g_key_name[MAX_COLS];
+static gsize     g_key_len [MAX_COLS];
+static guint     g_key_count;              /* atomic reads, locked writes */
+
+static BandSpec  g_spec[MAX_SPECS];
+static guint     g_n_specs;
+
+static Chunk    *g_chunks;
+static guint     g_n_chunks;
+static Trip     *g_trips;
+static guint     g_n_trips;
+static Trip      g_all;                    /* merged over every trip     */
+
+/* ------------------------------------------------------------------ */
+/*  Column registry                                                   */
+/* ------------------------------------------------------------------ */
+static gint key_intern(const char *s, gsize n)
+/* Global PID name → column id.  Workers cache results locally. */
+{
+    g_mutex_lock(&g_key_lock);
+    gint id = -1;
+    for (guint i = 0; i < g_key_count; i++)
+        if (g_key_len[i] == n && !memcmp(g_key_name[i], s, n)) { id = (gint)i; break; }
+
+    if (id < 0 && g_key_count < MAX_COLS) {
+        id = (gint)g_key_count;
+        g_key_name[id] = g_strndup(s, n);
+        g_key_len [id] = n;
+        g_atomic_int_set((gint *)&g_key_count, (gint)g_key_count + 1);
+    }
+    g_mutex_unlock(&g_key_lock);
+    return id;
+}
+
+static gint key_lookup(const char *name)
+{
+    for (guint i = 0; i < g_key_count; i++)
+        if (!strcmp(g_key_name[i], name))
+            return (gint)i;
+    return -1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Columnar storage                                                  */
+/* ------------------------------------------------------------------ */
+static void fill_nan(float *p, gsize n)
+{
+    for (gsize i = 0; i < n; i++)
+        p[i] = NAN;
+}
+
+static float *chunk_column(Chunk *c, gint id)
+{
+    if (!c->col[id]) {
+        c->col[id] = g_new(float, c->cap);
+        fill_nan(c->col[id], c->cap);
+    }
+    return c->col[id];
+}
+
+static void chunk_grow(Chunk *c)
+{
+    gsize old = c->cap;
+    c->cap = old ? old * 2 : COL_INIT_ROWS;
+    for (guint i = 0; i < MAX_COLS; i++) {
+        if (!c->col[i]) continue;
+        c->col[i] = g_renew(float, c->col[i], c->cap);
+        fill_nan(c->col[i] + old, c->cap - old);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  Streaming scanner                                                 */
+/* ------------------------------------------------------------------ */
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+};
+
+static inline const char *skip_ws(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+static const char *parse_number(const char *p, const char *end, float *out)
+/* ----------------------------------------------------------------------
+ *  Fast path for what json.dumps prints for sensor values: optional
+ *  sign, ≤18 significant digits, optional fraction.  Exponents and very
+ *  long mantissas fall back to g_ascii_strtod on a bounded copy.
+ * ---------------------------------------------------------------------- */
+{
+    const char *start = p;
+    gboolean    neg   = FALSE;
+    guint64     mant  = 0;
+    gint        digits = 0, frac = 0;
+
+    if (p < end && *p == '-') { neg = TRUE; p++; }
+    while (p < end && (guint)(*p - '0') < 10) {
+        if (digits++ >= 18) goto slow;
+        mant = mant * 10 + (guint)(*p++ - '0');
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && (guint)(*p - '0') < 10) {
+            if (digits++ >= 18) goto slow;
+            mant = mant * 10 + (guint)(*p++ - '0');
+            frac++;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) goto slow;
+    if (p == start || (neg && p == start + 1)) { *out = NAN; return p; }
+
+    *out = (float)((neg ? -(double)mant : (double)mant) / POW10[frac]);
+    return p;
+
+slow: {
+        char  buf[64];
+        gsize n = 0;
+        while (start + n < end && n < sizeof buf - 1 &&
+               strchr("+-.0123456789eE", start[n]))
+            n++;
+        memcpy(buf, start, n);
+        buf[n] = '\0';
+        *out = (float)g_ascii_strtod(buf, NULL);
+        return start + n;
+    }
+}
+
+static const char *skip_string(const char *p, const char *end)
+/* p points just past the opening quote; returns just past the closing one */
+{
+    while (p < end && *p != '"') {
+        if (*p == '\\' && p + 1 < end) p++;
+        p++;
+    }
+    return p < end ? p + 1 : end;
+}
+
+typedef struct {
+    const char *name;
+    gsize       len;
+    gint        id;
+} LocalKey;
+
+static gboolean parse_line(Chunk *c, const char *p, const char *end,
+                           LocalKey *cache, guint *n_cache)
+/* One frame into row c->rows.  Returns FALSE for a malformed line. */
+{
+    p = skip_ws(p, end);
+    if (p >= end || *p != '{') return FALSE;
+    p++;
+
+    gsize row = c->rows;
+    for (;;) {
+        p = skip_ws(p, end);
+        if (p >= end) return FALSE;
+        if (*p == '}') return TRUE;
+        if (*p == ',') { p++; continue; }
+        if (*p != '"') return FALSE;
+
+        const char *key = ++p;
+        p = skip_string(p, end);
+        gsize klen = (gsize)(p - 1 - key);
+
+        p = skip_ws(p, end);
+        if (p >= end || *p != ':') return FALSE;
+        p = skip_ws(p + 1, end);
+        if (p >= end) return FALSE;
+
+        float v;
+        if (*p == '"') { p = skip_string(p + 1, end); continue; }   /* text */
+        else if (*p == 'n') { v = NAN; p += 4; }                     /* null */
+        else if (*p == 't') { v = 1;   p += 4; }
+        else if (*p == 'f') { v = 0;   p += 5; }
+        else                 p = parse_number(p, end, &v);
+
+        /* Resolve column: a linear scan of the frame's few keys beats
+         * hashing, and the order is almost always the same each line. */
+        gint id = -1;
+        for (guint i = 0; i < *n_cache; i++)
+            if (cache[i].len == klen && !memcmp(cache[i].name, key, klen)) {
+                id = cache[i].id;
+                break;
+            }
+        if (id < 0) {
+            id = key_intern(key, klen);
+            if (id < 0) continue;                                    /* full */
+            cache[*n_cache] = (LocalKey){ key, klen, id };
+            (*n_cache)++;
+        }
+        chunk_column(c, id)[row] = v;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  Vector kernels                                                    */
+/* ------------------------------------------------------------------ */
+static inline v4f load4(const float *p)
+{
+    v4f v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static void kernel_agg(const float *x, gsize n, ColAgg *a)
+/* ----------------------------------------------------------------------
+ *  count / sum / min / max over non-NaN lanes.  NaN compares false, so
+ *  the select masks skip absent values without a separate test.  Float
+ *  partial sums are flushed to double every 4096 elements.
+ * ---------------------------------------------------------------------- */
+{
+    const v4f pinf = { INFINITY, INFINITY, INFINITY, INFINITY };
+    v4f vmin = pinf, vmax = -pinf, vsum = { 0 };
+    v4i vcnt = { 0 };
+    double sum = 0;
+
+    gsize i = 0;
+    while (i + 4 <= n) {
+        gsize stop = MIN(n & ~(gsize)3, i + 4096);
+        for (; i < stop; i += 4) {
+            v4f v  = load4(x + i);
+            v4i ok = v == v;
+            v4i lt = v < vmin;
+            v4i gt = v > vmax;
+            vsum += (v4f)((v4i)v & ok);
+            vcnt -= ok;
+            vmin  = (v4f)(((v4i)v & lt) | ((v4i)vmin & ~lt));
+            vmax  = (v4f)(((v4i)v & gt) | ((v4i)vmax & ~gt));
+        }
+        sum += (double)vsum[0] + vsum[1] + vsum[2] + vsum[3];
+        vsum = (v4f){ 0 };
+    }
+
+    float   mn = a->min, mx = a->max;
+    guint64 cnt = 0;
+    for (int l = 0; l < 4; l++) {
+        cnt += (guint64)vcnt[l];
+        mn = MIN(mn, vmin[l]);
+        mx = MAX(mx, vmax[l]);
+    }
+    for (; i < n; i++) {
+        float v = x[i];
+        if (v != v) continue;
+        cnt++;
+        sum += v;
+        mn = MIN(mn, v);
+        mx = MAX(mx, v);
+    }
+
+    a->count += cnt;
+    a->sum   += sum;
+    a->min    = mn;
+    a->max    = mx;
+}
+
+static void kernel_bands(const float *x, gsize n, const BandSpec *s, guint64 *out)
+{
+    v4i cnt[MAX_BANDS] = { { 0 } };
+    guint nb = s->n_edges - 1;
+
+    gsize i = 0;
+    for (; i + 4 <= n; i += 4) {
+        v4f v = load4(x + i);
+        for (guint b = 0; b < nb; b++)
+            cnt[b] -= (v >= s->edge[b]) & (v < s->edge[b + 1]);
+    }
+    for (guint b = 0; b < nb; b++)
+        out[b] += (guint64)cnt[b][0] + cnt[b][1] + cnt[b][2] + cnt[b][3];
+
+    for (; i < n; i++)
+        for (guint b = 0; b < nb; b++)
+            if (x[i] >= s->edge[b] && x[i] < s->edge[b + 1])
+                out[b]++;
+}
+
+static guint64 kernel_idle(const float *rpm, const float *speed, gsize n, float max_speed)
+/* Engine turning (RPM > 0) while SPEED is below the idle threshold */
+{
+    v4i cnt = { 0 };
+    gsize i = 0;
+    for (; i + 4 <= n; i += 4)
+        cnt -= (load4(rpm + i) > 0.0f) & (load4(speed + i) < max_speed);
+
+    guint64 total = (guint64)cnt[0] + cnt[1] + cnt[2] + cnt[3];
+    for (; i < n; i++)
+        total += rpm[i] > 0.0f && speed[i] < max_speed;
+    return total;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Percentiles                                                       */
+/* ------------------------------------------------------------------ */
+static float select_kth(float *a, gsize n, gsize k)
+/* Hoare quickselect, median-of-three pivot; partially orders `a` */
+{
+    gsize lo = 0, hi = n - 1;
+    while (lo < hi) {
+        gsize mid = lo + (hi - lo) / 2;
+        float x = a[lo], y = a[mid], z = a[hi];
+        float pivot = MAX(MIN(x, y), MIN(MAX(x, y), z));
+
+        gsize i = lo, j = hi;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                float t = a[i]; a[i] = a[j]; a[j] = t;
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j)      hi = j;
+        else if (k >= i) lo = i;
+        else             break;
+    }
+    return a[k];
+}
+
+static void percentiles_of(float *vals, gsize n, float *out)
+{
+    gsize lo = 0;
+    for (guint p = 0; p < G_N_ELEMENTS(PERCENTILES); p++) {
+        if (!n) { out[p] = NAN; continue; }
+        gsize k = (gsize)ceil(PERCENTILES[p] / 100.0 * n);
+        k = CLAMP(k, 1, n) - 1;
+        /* ascending ks: everything before `lo` is already ≤ a[lo] */
+        out[p] = select_kth(vals + lo, n - lo, k - lo) ;
+        lo = k;
+    }
+}
+
+static gsize gather(const Trip *t, gint col, float *dst)
+/* Non-NaN values of one column across a trip's chunks */
+{
+    gsize n = 0;
+    for (guint c = t->first_chunk; c < t->first_chunk + t->n_chunks; c++) {
+        const float *x = g_chunks[c].col[col];
+        if (!x) continue;
+        for (gsize r = 0; r < g_chunks[c].rows; r++)
+            if (x[r] == x[r])
+                dst[n++] = x[r];
+    }
+    return n;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Workers                                                           */
+/* ------------------------------------------------------------------ */
+static gint g_next_job;                    /* atomic work index */
+
+static void process_chunk(Chunk *c)
+{
+    LocalKey cache[MAX_COLS];
+    guint    n_cache = 0;
+
+    for (const char *p = c->begin; p < c->end; ) {
+        const char *nl = memchr(p, '\n', (gsize)(c->end - p));
+        const char *eol = nl ? nl : c->end;
+
+        if (eol > p) {
+            if (c->rows == c->cap)
+                chunk_grow(c);
+            if (parse_line(c, p, eol, cache, &n_cache))
+                c->rows++;
+            else {
+                c->bad_lines++;
+                /* roll back partial writes of the rejected line */
+                for (guint i = 0; i < MAX_COLS; i++)
+                    if (c->col[i]) c->col[i][c->rows] = NAN;
+            }
+        }
+        p = eol + 1;
+    }
+
+    /* Per-chunk aggregates.  Every slot is initialised, including PIDs
+     * other chunks register later, so merging never sees a zero min. */
+    for (guint i = 0; i < MAX_COLS; i++) {
+        c->agg[i] = (ColAgg){ 0, 0, INFINITY, -INFINITY };
+        if (c->col[i])
+            kernel_agg(c->col[i], c->rows, &c->agg[i]);
+    }
+}
+
+static gpointer parse_worker(gpointer)
+{
+    for (;;) {
+        guint j = (guint)g_atomic_int_add(&g_next_job, 1);
+        if (j >= g_n_chunks) break;
+        process_chunk(&g_chunks[j]);
+    }
+    return NULL;
+}
+
+static void chunk_bands_and_idle(Chunk *c, gint rpm, gint speed)
+{
+    for (guint s = 0; s < g_n_specs; s++)
+        if (g_spec[s].col >= 0 && c->col[g_spec[s].col])
+            kernel_bands(c->col[g_spec[s].col], c->rows, &g_spec[s], c->band[s]);
+
+    if (rpm >= 0 && speed >= 0 && c->col[rpm] && c->col[speed])
+        c->idle_rows = kernel_idle(c->col[rpm], c->col[speed], c->rows,
+                                   (float)opt_idle_speed);
+}
+
+static gpointer band_worker(gpointer)
+{
+    gint rpm = key_lookup("RPM"), speed = key_lookup("SPEED");
+    for (;;) {
+        guint j = (guint)g_atomic_int_add(&g_next_job, 1);
+        if (j >= g_n_chunks) break;
+        chunk_bands_and_idle(&g_chunks[j], rpm, speed);
+    }
+    return NULL;
+}
+
+/* Percentile jobs: (trip, col) pairs, then (all, col) */
+static gpointer percentile_worker(gpointer)
+{
+    guint ncols = g_key_count;
+    guint njobs = (g_n_trips + 1) * ncols;
+    float *buf  = NULL;
+    gsize  cap  = 0;
+
+    for (;;) {
+        guint j = (guint)g_atomic_int_add(&g_next_job, 1);
+        if (j >= njobs) break;
+
+        guint ti  = j / ncols;
+        gint  col = (gint)(j % ncols);
+        Trip *t   = ti < g_n_trips ? &g_trips[ti] : &g_all;
+        gsize need = t->agg[col].count;
+
+        if (need > cap) { g_free(buf); cap = need; buf = g_new(float, cap); }
+        gsize n = 0;
+        if (t == &g_all)
+            for (guint k = 0; k < g_n_trips; k++)
+                n += gather(&g_trips[k], col, buf + n);
+        else
+            n = gather(t, col, buf);
+
+        percentiles_of(buf, n, t->pct[col]);
+    }
+    g_free(buf);
+    return NULL;
+}
+
+static void run_parallel(GThreadFunc fn, guint threads)
+{
+    g_atomic_int_set(&g_next_job, 0);
+    GThread *th[threads];
+    for (guint i = 0; i < threads; i++)
+        th[i] = g_thread_new("vroom-stats", fn, NULL);
+    for (guint i = 0; i < threads; i++)
+        g_thread_join(th[i]);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Setup                                                             */
+/* ------------------------------------------------------------------ */
+static gboolean parse_band_spec(const char *text, BandSpec *s)
+{
+    const char *colon = strrchr(text, ':');
+    if (!colon) return FALSE;
+
+    s->pid     = g_strndup(text, (gsize)(colon - text));
+    s->col     = -1;
+    s->n_edges = 0;
+
+    gchar **edges = g_strsplit(colon + 1, ",", -1);
+    for (guint i = 0; edges[i] && s->n_edges < MAX_BANDS; i++)
+        s->edge[s->n_edges++] = (float)g_ascii_strtod(edges[i], NULL);
+    g_strfreev(edges);
+
+    if (s->n_edges < 2) return FALSE;
+    /* open-ended top band */
+    if (s->n_edges < MAX_BANDS)
+        s->edge[s->n_edges++] = INFINITY;
+    return TRUE;
+}
+
+static void plan_chunks(void)
+/* Cut every mapped file into line-aligned pieces of ~CHUNK_BYTES */
+{
+    GArray *arr = g_array_new(FALSE, TRUE, sizeof(Chunk));
+
+    for (guint t = 0; t < g_n_trips; t++) {
+        Trip       *trip = &g_trips[t];
+        const char *p    = g_mapped_file_get_contents(trip->map);
+        const char *end  = p + g_mapped_file_get_length(trip->map);
+
+        trip->first_chunk = arr->len;
+        while (p < end) {
+            const char *cut = p + MIN(CHUNK_BYTES, (gsize)(end - p));
+            if (cut < end) {
+                const char *nl = memchr(cut, '\n', (gsize)(end - cut));
+                cut = nl ? nl + 1 : end;
+            }
+            Chunk c = { .trip = t, .begin = p, .end = cut };
+            g_array_append_val(arr, c);
+            p = cut;
+        }
+        trip->n_chunks = arr->len - trip->first_chunk;
+    }
+
+    g_n_chunks = arr->len;
+    g_chunks   = (Chunk *)g_array_free(arr, FALSE);
+}
+
+static void merge_agg(ColAgg *dst, const ColAgg *src)
+{
+    dst->count += src->count;
+    dst->sum   += src->sum;
+    dst->min    = MIN(dst->min, src->min);
+    dst->max    = MAX(dst->max, src->max);
+}
+
+static void merge_into(Trip *dst, const Chunk *c)
+{
+    dst->rows      += c->rows;
+    dst->bad_lines += c->bad_lines;
+    dst->idle_rows += c->idle_rows;
+    for (guint i = 0; i < g_key_count; i++)
+        merge_agg(&dst->agg[i], &c->agg[i]);
+    for (guint s = 0; s < g_n_specs; s++)
+        for (guint b = 0; b < MAX_BANDS; b++)
+            dst->band[s][b] += c->band[s][b];
+}
+
+static void reset_trip_aggs(Trip *t)
+{
+    for (guint i = 0; i < MAX_COLS; i++)
+        t->agg[i] = (ColAgg){ 0, 0, INFINITY, -INFINITY };
+}
+
+/* ------------------------------------------------------------------ */
+/*  Output                                                            */
+/* ------------------------------------------------------------------ */
+static void print_trip(const Trip *t, const char *title)
+{
+    double secs = t->rows * opt_interval;
+    g_print("\n== %s: %" G_GSIZE_FORMAT " frames, %.1f min, idle %.1f min",
+            title, t->rows, secs / 60, t->idle_rows * opt_interval / 60);
+    if (t->bad_lines)
+        g_print(", %" G_GUINT64_FORMAT " bad lines", t->bad_lines);
+    g_print("\n");
+
+    g_print("   %-26s %9s %9s %9s %9s %9s %9s %9s\n",
+            "PID", "count", "min", "mean", "max", "p50", "p90", "p99");
+    for (guint i = 0; i < g_key_count; i++) {
+        const ColAgg *a = &t->agg[i];
+        if (!a->count) continue;
+        g_print("   %-26s %9" G_GUINT64_FORMAT " %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                g_key_name[i], a->count, a->min, a->sum / a->count, a->max,
+                t->pct[i][0], t->pct[i][1], t->pct[i][2]);
+    }
+
+    for (guint s = 0; s < g_n_specs; s++) {
+        const BandSpec *sp = &g_spec[s];
+        if (sp->col < 0) continue;
+        g_print("   %s time in band:\n", sp->pid);
+        for (guint b = 0; b + 1 < sp->n_edges; b++) {
+            guint64 n = t->band[s][b];
+            g_print("     [%7.0f, %7.0f)  %8.1f min  %5.1f %%\n",
+                    sp->edge[b], sp->edge[b + 1], n * opt_interval / 60,
+                    t->rows ? 100.0 * n / t->rows : 0.0);
+        }
+    }
+}
+
+static void json_num(GString *js, double v)
+{
+    if (isfinite(v)) {
+        char buf[G_ASCII_DTOSTR_BUF_SIZE];
+        g_string_append(js, g_ascii_formatd(buf, sizeof buf, "%.9g", v));
+    } else {
+        g_string_append(js, "null");
+    }
+}
+
+static void json_trip(GString *js, const Trip *t, const char *name)
+{
+    g_string_append(js, "{\"trip\":");
+    gchar *q = g_strescape(name, NULL);
+    g_string_append_printf(js, "\"%s\",\"frames\":%" G_GSIZE_FORMAT
+                           ",\"bad_lines\":%" G_GUINT64_FORMAT ",\"seconds\":",
+                           q, t->rows, t->bad_lines);
+    g_free(q);
+    json_num(js, t->rows * opt_interval);
+    g_string_append(js, ",\"idle_seconds\":");
+    json_num(js, t->idle_rows * opt_interval);
+
+    g_string_append(js, ",\"pids\":{");
+    gboolean first = TRUE;
+    for (guint i = 0; i < g_key_count; i++) {
+        const ColAgg *a = &t->agg[i];
+        if (!a->count) continue;
+        g_string_append_printf(js, "%s\"%s\":{\"count\":%" G_GUINT64_FORMAT,
+                               first ? "" : ",", g_key_name[i], a->count);
+        g_string_append(js, ",\"min\":");  json_num(js, a->min);
+        g_string_append(js, ",\"mean\":"); json_num(js, a->sum / a->count);
+        g_string_append(js, ",\"max\":");  json_num(js, a->max);
+        g_string_append(js, ",\"p50\":");  json_num(js, t->pct[i][0]);
+        g_string_append(js, ",\"p90\":");  json_num(js, t->pct[i][1]);
+        g_string_append(js, ",\"p99\":");  json_num(js, t->pct[i][2]);
+        g_string_append_c(js, '}');
+        first = FALSE;
+    }
+    g_string_append(js, "},\"bands\":{");
+
+    first = TRUE;
+    for (guint s = 0; s < g_n_specs; s++) {
+        const BandSpec *sp = &g_spec[s];
+        if (sp->col < 0) continue;
+        g_string_append_printf(js, "%s\"%s\":[", first ? "" : ",", sp->pid);
+        for (guint b = 0; b + 1 < sp->n_edges; b++) {
+            g_string_append(js, b ? ",{\"lo\":" : "{\"lo\":");
+            json_num(js, sp->edge[b]);
+            g_string_append(js, ",\"hi\":");
+            json_num(js, sp->edge[b + 1]);
+            g_string_append(js, ",\"seconds\":");
+            json_num(js, t->band[s][b] * opt_interval);
+            g_string_append_c(js, '}');
+        }
+        g_string_append_c(js, ']');
+        first = FALSE;
+    }
+    g_string_append(js, "}}");
+}
+
+static void write_json(void)
+{
+    GString *js = g_string_new("{\"trips\":[");
+    if (!opt_summary)
+        for (guint t = 0; t < g_n_trips; t++) {
+            if (t) g_string_append_c(js, ',');
+            json_trip(js, &g_trips[t], g_trips[t].path);
+        }
+    g_string_append(js, "],\"all\":");
+    json_trip(js, &g_all, "all");
+    g_string_append(js, "}\n");
+
+    if (!strcmp(opt_json_path, "-"))
+        fputs(js->str, stdout);
+    else if (!g_file_set_contents(opt_json_path, js->str, (gssize)js->len, NULL))
+        g_printerr("vroom-stats: cannot write %s\n", opt_json_path);
+    g_string_free(js, TRUE);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Entry point                                                       */
+/* ------------------------------------------------------------------ */
+int main(int argc, char *argv[])
+{
+    GOptionContext *oc = g_option_context_new("LOG… - aggregate obd_reader.py trip logs");
+    g_option_context_add_main_entries(oc, OPTION_ENTRIES, NULL);
+
+    GError *err = NULL;
+    if (!g_option_context_parse(oc, &argc, &argv, &err) || argc < 2) {
+        g_printerr("vroom-stats: %s\n", err ? err->message : "no log files given");
+        g_clear_error(&err);
+        return 2;
+    }
+    g_option_context_free(oc);
+
+    if (opt_interval <= 0) opt_interval = 0.5;
+    guint threads = opt_threads > 0 ? (guint)opt_threads : g_get_num_processors();
+
+    /* --band specs */
+    const char *const default_bands[] = { DEFAULT_BAND, NULL };
+    const char *const *bands = opt_bands ? (const char *const *)opt_bands : default_bands;
+    for (guint i = 0; bands[i] && g_n_specs < MAX_SPECS; i++) {
+        if (parse_band_spec(bands[i], &g_spec[g_n_specs]))
+            g_n_specs++;
+        else
+            g_printerr("vroom-stats: ignoring bad --band '%s'\n", bands[i]);
+    }
+
+    /* Map inputs */
+    gint64 t0 = g_get_monotonic_time();
+    gsize  bytes = 0;
+    g_trips = g_new0(Trip, (gsize)argc - 1);
+    for (int i = 1; i < argc; i++) {
+        GMappedFile *m = g_mapped_file_new(argv[i], FALSE, &err);
+        if (!m) {
+            g_printerr("vroom-stats: %s\n", err->message);
+            g_clear_error(&err);
+            continue;
+        }
+        Trip *t = &g_trips[g_n_trips++];
+        t->path = argv[i];
+        t->map  = m;
+        bytes  += g_mapped_file_get_length(m);
+    }
+    if (!g_n_trips)
+        return 1;
+
+    /* 1. Parse + per-chunk aggregates */
+    plan_chunks();
+    run_parallel(parse_worker, MIN(threads, MAX(g_n_chunks, 1u)));
+
+    for (guint s = 0; s < g_n_specs; s++)
+        g_spec[s].col = key_lookup(g_spec[s].pid);
+    run_parallel(band_worker, MIN(threads, MAX(g_n_chunks, 1u)));
+
+    /* 2. Merge */
+    reset_trip_aggs(&g_all);
+    for (guint t = 0; t < g_n_trips; t++) {
+        Trip *trip = &g_trips[t];
+        reset_trip_aggs(trip);
+        for (guint c = trip->first_chunk; c < trip->first_chunk + trip->n_chunks; c++)
+            merge_into(trip, &g_chunks[c]);
+        g_all.rows      += trip->rows;
+        g_all.bad_lines += trip->bad_lines;
+        g_all.idle_rows += trip->idle_rows;
+        for (guint i = 0; i < g_key_count; i++)
+            merge_agg(&g_all.agg[i], &trip->agg[i]);
+        for (guint s = 0; s < g_n_specs; s++)
+            for (guint b = 0; b < MAX_BANDS; b++)
+                g_all.band[s][b] += trip->band[s][b];
+    }
+
+    /* 3. Percentiles */
+    run_parallel(percentile_worker, threads);
+
+    gint64 elapsed = g_get_monotonic_time() - t0;
+
+    /* Report */
+    if (!opt_json_path || strcmp(opt_json_path, "-")) {
+        if (!opt_summary)
+            for (guint t = 0; t < g_n_trips; t++)
+                print_trip(&g_trips[t], g_trips[t].path);
+        print_trip(&g_all, "all trips");
+    }
+    if (opt_json_path)
+        write_json();
+
+    g_printerr("[vroom-stats] %.1f MiB, %" G_GSIZE_FORMAT " frames, %u threads, "
+               "%.3f s (%.0f MiB/s)\n",
+               bytes / 1048576.0, g_all.rows, threads, elapsed / 1e6,
+               elapsed ? bytes / 1048576.0 / (elapsed / 1e6) : 0.0);
+
+    for (guint c = 0; c < g_n_chunks; c++)
+        for (guint i = 0; i < MAX_COLS; i++)
+            g_free(g_chunks[c].col[i]);
+    g_free(g_chunks);
+    for (guint t = 0; t < g_n_trips; t++)
+        g_mapped_file_unref(g_trips[t].map);
+    g_free(g_trips);
+    return 0;
+}
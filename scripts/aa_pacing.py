@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+aa_pacing.py ― measure Android Auto frame pacing on the Pi's display
+====================================================================
+
+Records DRM vblank events (one per page flip the compositor / autoapp
+asks for) through ftrace while autoapp is on screen, plus the CPU time
+autoapp and Vroom use over the same window.  Run it once with the
+telemetry overlay and once without, then compare:
+
+    # overlay on (default PIDs)
+    ./VroomSystem &                       ... start Android Auto, then:
+    sudo scripts/aa_pacing.py --label overlay    --seconds 60 --out overlay.json
+
+    # overlay off
+    ./VroomSystem --overlay-pids="" &     ... start Android Auto, then:
+    sudo scripts/aa_pacing.py --label no-overlay --seconds 60 --out base.json
+
+    scripts/aa_pacing.py --compare base.json overlay.json
+
+Reported per run: flips/s, inter-flip interval p50 / p90 / p99 / max,
+"late" flips (interval > 1.5 × median, i.e. a missed frame), and CPU %
+of autoapp and VroomSystem.  Needs root for /sys/kernel/tracing.
+"""
+
+import argparse
+import json
+import os
+import re
+import select
+import sys
+import time
+
+TRACING    = "/sys/kernel/tracing"
+EVENT      = "events/drm/drm_vblank_event/enable"
+EVENT_LINE = re.compile(r"\s(\d+\.\d+): drm_vblank_event: crtc=(\d+).*?time=(\d+)")
+CLK_TCK    = os.sysconf("SC_CLK_TCK")
+
+
+# ---------------------------------------------------------------------------
+#  Helpers
+# ---------------------------------------------------------------------------
+def find_pid(name):
+    """First process whose comm is `name` (truncated to 15 chars), or None."""
+    for entry in os.listdir("/proc"):
+        if not entry.isdigit():
+            continue
+        try:
+            with open("/proc/%s/comm" % entry) as fh:
+                if fh.read().strip() == name[:15]:
+                    return int(entry)
+        except OSError:
+            pass
+    return None
+
+
+def cpu_ticks(pid):
+    """utime + stime of `pid` in clock ticks, or None if it is gone."""
+    if pid is None:
+        return None
+    try:
+        with open("/proc/%d/stat" % pid) as fh:
+            fields = fh.read().rsplit(")", 1)[1].split()
+        return int(fields[11]) + int(fields[12])
+    except OSError:
+        return None
+
+
+def percentile(sorted_vals, p):
+    if not sorted_vals:
+        return 0.0
+    k = (len(sorted_vals) - 1) * p / 100.0
+    lo, hi = int(k), min(int(k) + 1, len(sorted_vals) - 1)
+    return sorted_vals[lo] + (sorted_vals[hi] - sorted_vals[lo]) * (k - lo)
+
+
+def write_tracing(path, value):
+    with open(os.path.join(TRACING, path), "w") as fh:
+        fh.write(value)
+
+
+# ---------------------------------------------------------------------------
+#  Capture
+# ---------------------------------------------------------------------------
+def capture(seconds, crtc):
+    """Vblank timestamps (s) on `crtc` for `seconds`, via trace_pipe."""
+    write_tracing("trace", "")                   # drop stale events
+    write_tracing(EVENT, "1")
+    stamps = []
+    try:
+        with open(os.path.join(TRACING, "trace_pipe"), "rb", buffering=0) as pipe:
+            deadline = time.monotonic() + seconds
+            pending  = b""
+            while True:
+                left = deadline - time.monotonic()
+                if left <= 0:
+                    break
+                ready, _, _ = select.select([pipe], [], [], left)
+                if not ready:
+                    continue
+                *lines, pending = (pending + os.read(pipe.fileno(), 65536)).split(b"\n")
+                for line in lines:
+                    m = EVENT_LINE.search(line.decode("ascii", "replace"))
+                    if m and int(m.group(2)) == crtc:
+                        stamps.append(int(m.group(3)) / 1e9)
+    finally:
+        write_tracing(EVENT, "0")
+    return stamps
+
+
+def summarize(label, seconds, stamps, cpu):
+    gaps = sorted((b - a) * 1e3 for a, b in zip(stamps, stamps[1:]))
+    p50  = percentile(gaps, 50)
+    return {
+        "label":       label,
+        "seconds":     seconds,
+        "flips":       len(stamps),
+        "flips_per_s": len(stamps) / seconds if seconds else 0.0,
+        "p50_ms":      p50,
+        "p90_ms":      percentile(gaps, 90),
+        "p99_ms":      percentile(gaps, 99),
+        "max_ms":      gaps[-1] if gaps else 0.0,
+        "late":        sum(1 for g in gaps if g > 1.5 * p50),
+        "cpu_pct":     cpu,
+    }
+
+
+def print_runs(runs):
+    cols = ("label", "flips_per_s", "p50_ms", "p90_ms", "p99_ms", "max_ms", "late")
+    print("%-12s %8s %8s %8s %8s %8s %6s   cpu %%" % cols)
+    for r in runs:
+        cpu = "  ".join("%s=%.1f" % kv for kv in sorted(r["cpu_pct"].items()))
+        print("%-12s %8.2f %8.2f %8.2f %8.2f %8.2f %6d   %s" % (
+            r["label"], r["flips_per_s"], r["p50_ms"], r["p90_ms"],
+            r["p99_ms"], r["max_ms"], r["late"], cpu))
+
+
+# ---------------------------------------------------------------------------
+#  Main
+# ---------------------------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("--label",   default="run")
+    ap.add_argument("--seconds", type=float, default=30.0)
+    ap.add_argument("--crtc",    type=int,   default=0)
+    ap.add_argument("--out",     help="write the summary as JSON")
+    ap.add_argument("--compare", nargs="+", metavar="JSON",
+                    help="print saved summaries side by side and exit")
+    args = ap.parse_args()
+
+    if args.compare:
+        runs = []
+        for path in args.compare:
+            with open(path) as fh:
+                runs.append(json.load(fh))
+        print_runs(runs)
+        return 0
+
+    if not os.access(os.path.join(TRACING, EVENT), os.W_OK):
+        print("aa_pacing: cannot enable %s/%s (run as root, tracefs mounted?)"
+              % (TRACING, EVENT), file=sys.stderr)
+        return 1
+
+    procs  = {name: find_pid(name) for name in ("autoapp", "VroomSystem")}
+    before = {name: cpu_ticks(pid) for name, pid in procs.items()}
+    t0     = time.monotonic()
+    stamps = capture(args.seconds, args.crtc)
+    wall   = time.monotonic() - t0
+    after  = {name: cpu_ticks(pid) for name, pid in procs.items()}
+
+    cpu = {}
+    for name in procs:
+        if before[name] is not None and after[name] is not None:
+            cpu[name] = 100.0 * (after[name] - before[name]) / CLK_TCK / wall
+        else:
+            print("aa_pacing: %s not running" % name, file=sys.stderr)
+
+    summary = summarize(args.label, wall, stamps, cpu)
+    print_runs([summary])
+    if args.out:
+        with open(args.out, "w") as fh:
+            json.dump(summary, fh, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
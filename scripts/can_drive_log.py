@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+can_drive_log.py ― synthetic powertrain CAN traffic for canplayer
+================================================================
+
+Encodes every signal of a DBC file as a slow sine sweep across its
+[min|max] range and writes a candump log (`candump -l` format) that
+canplayer replays onto a virtual bus, so Vroom's passive CAN mode can
+be exercised without a car:
+
+    sudo modprobe vcan
+    sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+
+    scripts/can_drive_log.py --dbc scripts/can/vroom_demo.dbc -o drive.log
+    canplayer -I drive.log -l i vcan0=can0 &                # real-time loop
+    cd Infotainment && ./VroomSystem --simulate --can=vcan0 \
+        --dbc=../scripts/can/vroom_demo.dbc \
+        --can-map="$(cat ../scripts/can/vroom_demo.map)"
+
+--filler adds frames on IDs the DBC does not define, to load the bus the
+way the other ECUs would; Vroom's kernel filters should keep them out of
+userspace entirely.  `canplayer -t` ignores the timestamps and replays as
+fast as vcan accepts, which is well beyond a real 500 kbit/s bus — use
+it to look for drops (vroom_can_frames_dropped_total, see --metrics).
+
+Signals are encoded bit by bit from the DBC numbering, independently of
+Dbc.c's word / shift tables, so a replay also cross-checks the decoder.
+Multiplexed signals are left at zero.
+"""
+
+import argparse
+import math
+import random
+import re
+import sys
+
+BO_LINE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)")
+SG_LINE = re.compile(r"^\s+SG_\s+(\w+)\s*(M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+                     r"\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]")
+
+CAN_EFF_FLAG = 0x80000000
+CAN_EFF_MASK = 0x1FFFFFFF
+
+
+# ---------------------------------------------------------------------------
+#  DBC
+# ---------------------------------------------------------------------------
+def load_dbc(path):
+    """[{id, extended, dlc, signals: [{name, start, length, motorola, …}]}]"""
+    messages = []
+    with open(path) as fh:
+        for line in fh:
+            m = BO_LINE.match(line)
+            if m:
+                raw = int(m.group(1))
+                messages.append({"name": m.group(2),
+                                 "id": raw & (CAN_EFF_MASK if raw & CAN_EFF_FLAG else 0x7FF),
+                                 "extended": bool(raw & CAN_EFF_FLAG),
+                                 "dlc": int(m.group(3)), "signals": []})
+                continue
+            s = SG_LINE.match(line)
+            if s and messages and not s.group(2):
+                lo, hi = float(s.group(9) or 0), float(s.group(10) or 0)
+                messages[-1]["signals"].append({
+                    "name": s.group(1), "start": int(s.group(3)),
+                    "length": int(s.group(4)), "motorola": s.group(5) == "0",
+                    "signed": s.group(6) == "-", "factor": float(s.group(7)),
+                    "offset": float(s.group(8)), "min": lo, "max": hi})
+    return messages
+
+
+def encode(sig, phys, data):
+    """Quantise `phys` into the signal's raw field of bytearray `data`."""
+    n = sig["length"]
+    raw = int(round((phys - sig["offset"]) / sig["factor"]))
+    lo, hi = (-(1 << (n - 1)), (1 << (n - 1)) - 1) if sig["signed"] else (0, (1 << n) - 1)
+    raw = max(lo, min(hi, raw)) & ((1 << n) - 1)
+
+    pos = sig["start"]
+    for i in range(n):
+        if sig["motorola"]:                 # MSB first, sawtooth numbering
+            bit = (raw >> (n - 1 - i)) & 1
+        else:                               # LSB first, linear numbering
+            bit = (raw >> i) & 1
+        byte, off = divmod(pos, 8)
+        if bit:
+            data[byte] |= 1 << off
+        else:
+            data[byte] &= ~(1 << off) & 0xFF
+        if sig["motorola"]:
+            pos = pos + 15 if off == 0 else pos - 1
+        else:
+            pos += 1
+    return sig["offset"] + sig["factor"] * (raw - ((1 << n) if sig["signed"] and raw >> (n - 1) else 0))
+
+
+def sweep(sig, t, period):
+    lo, hi = sig["min"], sig["max"]
+    if lo >= hi:                            # no range in the DBC: raw range
+        lo = sig["offset"]
+        hi = sig["offset"] + sig["factor"] * ((1 << sig["length"]) - 1)
+    return lo + (hi - lo) * (0.5 - 0.5 * math.cos(2 * math.pi * t / period))
+
+
+def frame_id(msg):
+    return ("%08X" if msg["extended"] else "%03X") % msg["id"]
+
+
+# ---------------------------------------------------------------------------
+#  Main
+# ---------------------------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("--dbc", required=True)
+    ap.add_argument("-o", "--out", default="-", help="log file (default stdout)")
+    ap.add_argument("--seconds", type=float, default=60.0)
+    ap.add_argument("--rate", type=float, default=50.0,
+                    help="frames per second per DBC message (default 50)")
+    ap.add_argument("--filler", type=float, default=0.0,
+                    help="extra frames per second on IDs outside the DBC")
+    ap.add_argument("--period", type=float, default=30.0,
+                    help="seconds per min → max → min sweep (default 30)")
+    ap.add_argument("--iface", default="can0", help="interface name in the log")
+    ap.add_argument("--expect", help="also write 'time id signal value' lines")
+    args = ap.parse_args()
+
+    messages = load_dbc(args.dbc)
+    if not messages:
+        print("can_drive_log: no messages in %s" % args.dbc, file=sys.stderr)
+        return 1
+    used = {m["id"] for m in messages if not m["extended"]}
+    spare = [i for i in range(0x7FF) if i not in used]
+
+    out = sys.stdout if args.out == "-" else open(args.out, "w")
+    exp = open(args.expect, "w") if args.expect else None
+    rnd = random.Random(1)
+    t0 = 1700000000.0
+
+    events = []                             # (time, kind, message)
+    for m in messages:
+        events += [(k / args.rate, 0, m) for k in range(int(args.seconds * args.rate))]
+    if args.filler > 0:
+        events += [(k / args.filler, 1, None) for k in range(int(args.seconds * args.filler))]
+    events.sort(key=lambda e: (e[0], e[1]))
+
+    for t, kind, m in events:
+        if kind == 1:
+            fid = "%03X" % rnd.choice(spare)
+            data = bytes(rnd.getrandbits(8) for _ in range(8))
+        else:
+            fid, data = frame_id(m), bytearray(m["dlc"])
+            for sig in m["signals"]:
+                value = encode(sig, sweep(sig, t, args.period), data)
+                if exp:
+                    exp.write("%.6f %s %s %.9g\n" % (t, fid, sig["name"], value))
+        out.write("(%.6f) %s %s#%s\n" % (t0 + t, args.iface, fid, bytes(data).hex().upper()))
+
+    if out is not sys.stdout:
+        out.close()
+    if exp:
+        exp.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
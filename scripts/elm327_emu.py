@@ -0,0 +1,551 @@
+#!/usr/bin/env python3
+"""
+elm327_emu.py ― ELM327 adapter and ECUs on a pseudo-terminal
+============================================================
+
+Opens a pty that behaves like an ELM327 on ISO 15765-4 CAN (11 bit,
+500 kbaud) with one or more ECUs behind it, so the OBD path can be
+measured without the car:
+
+    scripts/elm327_emu.py --scenario scripts/elm327/two_ecus.json \\
+        --link /tmp/elm327 &
+    scripts/obd_reader.py --raw --port=/tmp/elm327
+
+scripts/obd_bench.py runs the two together and reports samples/s and
+latency.  The pty path is printed on stdout ("pty /dev/pts/5") and, with
+--link, kept behind a fixed symlink.
+
+Adapter
+-------
+AT commands: Z WS D I @1 E0/1 H0/1 L0/1 S0/1 M0/1 CAF0/1 AT0/1/2 ST hh
+SP h TP h SPA h TPA h DP DPN RV SH hhh CRA PC plus the OBD requests
+themselves.  Unknown commands answer "?", an empty line repeats the last
+command, and every answer ends with the ">" prompt.  Echo is on after a
+reset, headers off, spaces on, as on the real chip.  With headers on the
+replies are CAN frames ("7E8 04 41 0C 1A F8 00 00 00"); without, the
+data bytes, and multi-frame (ISO-TP) replies use the ELM's "0: … 1: …"
+layout.  Mode 01 requests may carry up to six PIDs, and a trailing
+response count ("010C1") stops waiting after that many ECUs answered.
+After ATSP0 the first request prints "SEARCHING...".  ATSH 7E0 … 7E7
+addresses one ECU; 7DF (the default) all of them.
+
+ECUs
+----
+Each ECU answers the PidTable.def rows it is given (Mode 01 and 22),
+the Mode 01 supported-PID bitmaps (00, 20, 40 …) that follow from them,
+and — for the first ECU — the VIN (0902), stored DTCs (03, 07, 0A) and
+clear codes (04).  Values sweep each PID's range over its `period_s`:
+the bytes are encoded by inverting the table formula, so obd_reader.py
+decodes the same values the scenario describes.  Each reply of a PID
+moves the sweep one step; the values depend only on the request order.
+
+Timing model (all scaled by --time-scale, 0 answers instantly)
+--------------------------------------------------------------
+    request  = serial in + adapter_ms + response + serial out
+    response = slowest answering ECU + settle_ms, or the count-th one
+               with a response count; ST timeout (default 200 ms) when
+               nobody answers ("NO DATA")
+    ECU      = latency_ms + uniform(0, jitter_ms), the PID's override
+               if that is larger; each PID is dropped with probability
+               no_data (ECU, or the PID's override)
+    serial   = 10 bits per byte at `baud` (0 = unpaced)
+
+Random draws come from one generator seeded with --seed, in request
+order, so the same request sequence gets the same answers and the same
+modelled times.  The sleeps themselves are wall-clock and land within
+scheduler jitter of the model; --log records both per request.
+
+Scenario (JSON, every key optional)
+-----------------------------------
+    {"adapter_ms": 1.0, "settle_ms": 10, "search_ms": 300, "baud": 115200,
+     "voltage": 12.6, "vin": "VROOMEMU000000001", "dtcs": ["P0133"],
+     "ecus": [{"header": "7E8", "pids": "*", "latency_ms": 20,
+               "jitter_ms": 10, "no_data": 0.0},
+              {"header": "7E9", "pids": ["SPEED"], "latency_ms": 35}],
+     "pids": {"RPM": {"range": [750, 3500], "period_s": 30,
+                      "latency_ms": 25, "no_data": 0.01}}}
+
+"pids": "*" means every PidTable.def row.  Command-line --latency-ms,
+--jitter-ms and --no-data override every ECU's values.
+
+Statistics go to stderr every --stats-interval seconds and on exit
+(SIGINT / SIGTERM): requests, PIDs asked and answered, NO DATA count and
+the share of time the adapter was busy.
+"""
+
+import argparse
+import json
+import math
+import os
+import random
+import re
+import select
+import signal
+import sys
+import time
+import tty
+
+TABLE_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          "..", "Infotainment", "PidTable.def")
+
+ELM_VERSION = "ELM327 v1.5"
+PROTOCOL    = "ISO 15765-4 (CAN 11/500)"
+CAN_PAD     = 0x00
+MAX_PIDS    = 6         # Mode 01 PIDs per request (SAE J1979)
+
+DEFAULT_SCENARIO = {
+    "adapter_ms": 1.0,
+    "settle_ms":  10.0,
+    "search_ms":  300.0,
+    "baud":       115200,
+    "voltage":    12.6,
+    "vin":        "VROOMEMU000000001",
+    "dtcs":       ["P0133"],
+    "ecus": [{"header": "7E8", "pids": "*", "latency_ms": 20.0,
+              "jitter_ms": 10.0, "no_data": 0.0}],
+    "pids": {},
+}
+
+# Plausible sweeps in the table's units; other PIDs use the middle half
+# of what their bytes can encode.
+DEFAULT_RANGES = {
+    "RPM": (750, 3500), "SPEED": (0, 120), "ENGINE LOAD": (15, 80),
+    "THROTTLE POSITION": (12, 70), "INTAKE PRESSURE": (30, 100),
+    "TIMING ADVANCE": (5, 35), "FUEL LEVEL": (40, 60),
+    "CONTROL MODULE VOLTAGE": (13.6, 14.4), "COOLANT TEMP": (80, 96),
+    "INTAKE AIR TEMP": (20, 45), "MAF AIR FLOW": (2, 40),
+    "SHORT FUEL TRIM": (-5, 5), "LONG FUEL TRIM": (-3, 3),
+    "FUEL RATE": (0.8, 12), "OIL TEMP": (85, 110),
+    "BAROMETRIC PRESSURE": (99, 102), "AMBIENT AIR TEMP": (12, 18),
+}
+
+
+# ---------------------------------------------------------------------------
+#  PID table (parsed the same way as obd_reader.py)
+# ---------------------------------------------------------------------------
+def split_args(text):
+    """Split a PID_DEF(...) argument list on top-level commas."""
+    args, depth, quote, cur = [], 0, False, ""
+    for ch in text:
+        if ch == '"':
+            quote = not quote
+        elif not quote and ch == "(":
+            depth += 1
+        elif not quote and ch == ")":
+            depth -= 1
+        elif not quote and depth == 0 and ch == ",":
+            args.append(cur.strip())
+            cur = ""
+            continue
+        cur += ch
+    args.append(cur.strip())
+    return args
+
+
+def load_pid_table(path):
+    rows = []
+    with open(path, encoding="utf-8") as fh:
+        for line in fh:
+            m = re.match(r"\s*PID_DEF\((.*)\)\s*$", line)
+            if not m:
+                continue
+            (ident, name, mode, pid, nbytes, formula,
+             _unit, _fmt, _scale, rate) = split_args(m.group(1))
+            rows.append({"name": name.strip('"'), "mode": int(mode, 0),
+                         "pid": int(pid, 0), "bytes": int(nbytes, 0),
+                         "formula": compile(formula, ident, "eval"),
+                         "rate": float(rate)})
+    return rows
+
+
+def decode_raw(row, raw):
+    """Table formula over the big-endian integer `raw` of the reply bytes."""
+    data = raw.to_bytes(row["bytes"], "big")
+    env = {k: (data[i] if i < len(data) else 0) for i, k in enumerate("ABCD")}
+    return float(eval(row["formula"], {"__builtins__": {}}, env))
+
+
+class Signal:
+    """One PID's value sweep, encoded back into reply bytes."""
+
+    def __init__(self, row, cfg):
+        self.row   = row
+        self.top   = (1 << (8 * row["bytes"])) - 1
+        self.b     = decode_raw(row, 0)
+        self.a     = decode_raw(row, 1) - self.b
+        mid        = self.top // 2
+        self.linear = self.a != 0 and abs(decode_raw(row, mid) - (self.a * mid + self.b)) \
+            <= 1e-6 * max(1.0, abs(self.a * mid))
+        lo, hi = cfg.get("range") or DEFAULT_RANGES.get(row["name"]) or (None, None)
+        if not self.linear:                         # sweep the raw bytes
+            lo, hi = self.top * 0.25, self.top * 0.75
+        elif lo is None:                            # middle half of what they encode
+            lo, hi = self.b + self.a * self.top * 0.25, self.b + self.a * self.top * 0.75
+        self.lo, self.hi = lo, hi
+        self.steps = max(2, int(cfg.get("period_s", 30.0) * row["rate"]))
+        self.n = 0
+
+    def next_bytes(self):
+        x = 0.5 - 0.5 * math.cos(2 * math.pi * self.n / self.steps)
+        self.n += 1
+        v = self.lo + (self.hi - self.lo) * x
+        raw = int(round((v - self.b) / self.a)) if self.linear else int(round(v))
+        return list(max(0, min(self.top, raw)).to_bytes(self.row["bytes"], "big"))
+
+
+# ---------------------------------------------------------------------------
+#  ECUs
+# ---------------------------------------------------------------------------
+class Ecu:
+    def __init__(self, cfg, rows, pid_cfg, primary, scenario, overrides):
+        self.reply_id = int(cfg.get("header", "7E8"), 16)
+        self.latency  = cfg.get("latency_ms", 20.0) / 1000.0
+        self.jitter   = cfg.get("jitter_ms", 0.0) / 1000.0
+        self.no_data  = cfg.get("no_data", 0.0)
+        for key, scale in (("latency_ms", 1000.0), ("jitter_ms", 1000.0), ("no_data", 1.0)):
+            if overrides.get(key) is not None:
+                setattr(self, key.replace("_ms", ""), overrides[key] / scale)
+
+        wanted = cfg.get("pids", "*")
+        names = {r["name"] for r in rows} if wanted == "*" else {n.upper() for n in wanted}
+        self.rows = {(r["mode"], r["pid"]): r for r in rows if r["name"] in names}
+        self.pid_cfg = pid_cfg
+        self.primary = primary
+        self.vin     = scenario["vin"].encode("ascii")[:17].ljust(17, b"0")
+        self.dtcs    = list(scenario["dtcs"]) if primary else []
+
+    def pid_latency(self, row):
+        return self.pid_cfg.get(row["name"], {}).get("latency_ms", 0.0) / 1000.0
+
+    def pid_no_data(self, row):
+        return self.pid_cfg.get(row["name"], {}).get("no_data", self.no_data)
+
+    def bitmap(self, base):
+        """Mode 01 supported PIDs base+1 … base+0x20; None past the chain."""
+        pids = [p for (m, p) in self.rows if m == 0x01]
+        if base and not any(p > base for p in pids):
+            return None
+        bits = 0
+        for p in pids:
+            if base < p <= base + 0x20:
+                bits |= 1 << (32 - (p - base))
+        if any(p > base + 0x20 for p in pids):
+            bits |= 1                               # next bitmap exists
+        return list(bits.to_bytes(4, "big"))
+
+    def answer(self, req, rng, signals):
+        """(payload bytes, seconds, PIDs answered) — payload None when the
+        ECU stays quiet."""
+        mode, delay, out = req[0], self.latency + rng.uniform(0, self.jitter), None
+        answered = set()
+        if mode == 0x01 and len(req) >= 2:
+            out = [0x41]
+            for pid in req[1:1 + MAX_PIDS]:
+                if pid % 0x20 == 0:
+                    bits = self.bitmap(pid)
+                    if bits:
+                        out += [pid] + bits
+                    continue
+                row = self.rows.get((0x01, pid))
+                if row is None or rng.random() < self.pid_no_data(row):
+                    continue
+                delay = max(delay, self.pid_latency(row))
+                out += [pid] + signals[row["name"]].next_bytes()
+                answered.add(row["name"])
+            out = out if len(out) > 1 else None
+        elif mode == 0x22 and len(req) == 3:
+            row = self.rows.get((0x22, req[1] << 8 | req[2]))
+            if row and rng.random() >= self.pid_no_data(row):
+                delay = max(delay, self.pid_latency(row))
+                out = [0x62, req[1], req[2]] + signals[row["name"]].next_bytes()
+                answered.add(row["name"])
+        elif self.primary and mode == 0x09 and req[1:] == [0x00]:
+            out = [0x49, 0x00, 0x40, 0x00, 0x00, 0x00]       # supports 0902
+        elif self.primary and mode == 0x09 and req[1:] == [0x02]:
+            out = [0x49, 0x02, 0x01] + list(self.vin)
+        elif self.primary and mode in (0x03, 0x07, 0x0A) and len(req) == 1:
+            out = [0x40 + mode, len(self.dtcs)] + [b for d in self.dtcs for b in dtc_bytes(d)]
+        elif self.primary and mode == 0x04 and len(req) == 1:
+            self.dtcs = []
+            out = [0x44]
+        return (out, delay, answered) if out else (None, 0.0, answered)
+
+
+def dtc_bytes(code):
+    """"P0133" → two bytes."""
+    system = "PCBU".index(code[0].upper())
+    value = int(code[1:], 16)
+    return [(system << 6) | (value >> 8), value & 0xFF]
+
+
+def can_frames(payload):
+    """ISO-TP segmentation into 8-byte CAN data fields."""
+    if len(payload) <= 7:
+        return [[len(payload)] + payload + [CAN_PAD] * (7 - len(payload))]
+    frames = [[0x10 | (len(payload) >> 8), len(payload) & 0xFF] + payload[:6]]
+    rest, seq = payload[6:], 1
+    while rest:
+        chunk, rest = rest[:7], rest[7:]
+        frames.append([0x20 | (seq & 0xF)] + chunk + [CAN_PAD] * (7 - len(chunk)))
+        seq += 1
+    return frames
+
+
+# ---------------------------------------------------------------------------
+#  Adapter
+# ---------------------------------------------------------------------------
+class Elm327:
+    def __init__(self, fd, scenario, ecus, signals, rng, time_scale, log):
+        self.fd, self.scenario, self.ecus = fd, scenario, ecus
+        self.signals, self.rng, self.scale, self.log = signals, rng, time_scale, log
+        self.baud = scenario["baud"]
+        self.last = ""
+        self.t0 = time.monotonic()
+        self.stats = {"requests": 0, "obd": 0, "pids": 0, "answered": 0,
+                      "no_data": 0, "busy": 0.0}
+        self.reset()
+
+    def reset(self):
+        self.echo, self.headers, self.linefeeds, self.spaces = True, False, False, True
+        self.timeout = 0x32 * 4.096 / 1000.0        # ATST 32
+        self.auto, self.searched = True, False
+        self.target = None                           # ATSH physical address
+
+    # -- output -------------------------------------------------------------
+    def eol(self):
+        return "\r\n" if self.linefeeds else "\r"
+
+    def hexbytes(self, data):
+        return (" " if self.spaces else "").join("%02X" % b for b in data)
+
+    def wait_until(self, deadline):
+        delay = deadline - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+
+    def send(self, text, at=None):
+        """Write `text` once the model says it has crossed the serial line."""
+        if at is not None:
+            self.cursor = max(self.cursor, at)
+        if self.baud:
+            self.cursor += len(text) * 10.0 / self.baud * self.scale
+        self.wait_until(self.cursor)
+        os.write(self.fd, text.encode("ascii"))
+
+    # -- commands -----------------------------------------------------------
+    def handle(self, line):
+        cmd = line.replace(" ", "").upper()
+        if not cmd:
+            cmd = self.last
+        self.last = cmd
+        start = time.monotonic()
+        self.cursor = start + (len(line) + 1) * 10.0 / self.baud * self.scale if self.baud else start
+        self.stats["requests"] += 1
+        if self.echo:
+            self.send(line + self.eol())
+        self.cursor += self.scenario["adapter_ms"] / 1000.0 * self.scale
+
+        if cmd.startswith("AT"):
+            reply, modelled = self.at_command(cmd[2:]), 0.0
+            self.send(reply + self.eol() + self.eol() + ">")
+        else:
+            modelled = self.obd_request(cmd)
+        self.stats["busy"] += time.monotonic() - start
+        if self.log:
+            self.log.write("%.3f,%s,%.2f,%.2f\n" % ((start - self.t0) * 1000, cmd,
+                                                    modelled * 1000,
+                                                    (time.monotonic() - start) * 1000))
+
+    def at_command(self, c):
+        if c in ("Z", "WS"):
+            self.reset()
+            return self.eol() + ELM_VERSION
+        if c == "D":
+            self.reset()
+            return "OK"
+        if c == "I":
+            return ELM_VERSION
+        if c == "@1":
+            return "OBDII to RS232 Interpreter"
+        if c == "RV":
+            return "%.1fV" % self.scenario["voltage"]
+        if c == "DP":
+            return ("AUTO, " if self.auto else "") + PROTOCOL
+        if c == "DPN":
+            return ("A" if self.auto else "") + "6"
+        flags = {"E": "echo", "H": "headers", "L": "linefeeds", "S": "spaces"}
+        if len(c) == 2 and c[0] in flags and c[1] in "01":
+            setattr(self, flags[c[0]], c[1] == "1")
+            return "OK"
+        m = re.fullmatch(r"(SP|TP)(A?)([0-9A-C])", c)
+        if m:
+            self.auto = m.group(3) == "0" or m.group(2) == "A"
+            self.searched = not self.auto
+            return "OK"
+        m = re.fullmatch(r"ST([0-9A-F]{1,2})", c)
+        if m:
+            value = int(m.group(1), 16) or 0x32
+            self.timeout = value * 4.096 / 1000.0
+            return "OK"
+        m = re.fullmatch(r"SH([0-9A-F]{3})", c)
+        if m:
+            addr = int(m.group(1), 16)
+            self.target = None if addr == 0x7DF else addr + 8
+            return "OK"
+        if c in ("CRA", "PC", "M0", "M1", "CAF0", "CAF1", "AT0", "AT1", "AT2",
+                 "CFC0", "CFC1", "R0", "R1", "V0", "V1"):
+            return "OK"
+        return "?"
+
+    def obd_request(self, cmd):
+        """Answer one OBD request; returns the modelled response time."""
+        count = None
+        if len(cmd) % 2 and re.fullmatch(r"[0-9A-F]+", cmd):
+            count, cmd = int(cmd[-1], 16), cmd[:-1]
+        if not cmd or not re.fullmatch(r"[0-9A-F]+", cmd):
+            self.send("?" + self.eol() + self.eol() + ">")
+            return 0.0
+        req = list(bytes.fromhex(cmd))
+        self.stats["obd"] += 1
+        if req[0] == 0x01:
+            self.stats["pids"] += len([p for p in req[1:1 + MAX_PIDS] if p % 0x20])
+        elif req[0] == 0x22:
+            self.stats["pids"] += 1
+
+        if self.auto and not self.searched:
+            self.send("SEARCHING..." + self.eol())
+            self.cursor += self.scenario["search_ms"] / 1000.0 * self.scale
+            self.searched = True
+
+        answers, answered = [], set()
+        for ecu in self.ecus:
+            if self.target is not None and ecu.reply_id != self.target:
+                continue
+            payload, delay, pids = ecu.answer(req, self.rng, self.signals)
+            if payload:
+                answers.append((delay, ecu.reply_id, payload))
+                answered |= pids
+        answers.sort(key=lambda a: a[0])
+        if count:
+            answers = answers[:count]
+        self.stats["answered"] += len(answered)
+
+        t_req = self.cursor
+        if not answers:
+            self.stats["no_data"] += 1
+            self.send("NO DATA" + self.eol() + self.eol() + ">",
+                      at=t_req + self.timeout * self.scale)
+            return self.timeout
+
+        for delay, reply_id, payload in answers:
+            self.send(self.format(reply_id, payload), at=t_req + delay * self.scale)
+        settle = 0.0 if count else self.scenario["settle_ms"] / 1000.0
+        modelled = answers[-1][0] + settle
+        self.send(self.eol() + ">", at=t_req + modelled * self.scale)
+        return modelled
+
+    def format(self, reply_id, payload):
+        frames = can_frames(payload)
+        if self.headers:
+            return "".join(("%03X" % reply_id) + (" " if self.spaces else "")
+                           + self.hexbytes(f) + self.eol() for f in frames)
+        if len(frames) == 1:
+            return self.hexbytes(payload) + self.eol()
+        lines = ["%03X" % len(payload),
+                 "0:" + (" " if self.spaces else "") + self.hexbytes(payload[:6])]
+        rest, n = payload[6:], 1
+        while rest:
+            lines.append("%X:" % (n & 0xF) + (" " if self.spaces else "") + self.hexbytes(rest[:7]))
+            rest, n = rest[7:], n + 1
+        return "".join(l + self.eol() for l in lines)
+
+
+# ---------------------------------------------------------------------------
+#  Main
+# ---------------------------------------------------------------------------
+def load_scenario(path):
+    scenario = dict(DEFAULT_SCENARIO)
+    if path:
+        with open(path, encoding="utf-8") as fh:
+            scenario.update(json.load(fh))
+    return scenario
+
+
+def print_stats(elm, final=False):
+    s, elapsed = elm.stats, max(time.monotonic() - elm.t0, 1e-9)
+    print("[ELM] %s%d requests (%.1f/s), %d OBD, PIDs %d asked / %d answered, "
+          "%d NO DATA, adapter busy %.0f%%"
+          % ("final: " if final else "", s["requests"], s["requests"] / elapsed, s["obd"],
+             s["pids"], s["answered"], s["no_data"], 100.0 * s["busy"] / elapsed),
+          file=sys.stderr, flush=True)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("--scenario", help="JSON bus description (default: one ECU, all PIDs)")
+    ap.add_argument("--link", help="symlink to the pty, e.g. /tmp/elm327")
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--time-scale", type=float, default=1.0,
+                    help="multiply every modelled delay (0 = answer at once)")
+    ap.add_argument("--latency-ms", type=float, help="override every ECU's latency")
+    ap.add_argument("--jitter-ms", type=float, help="override every ECU's jitter")
+    ap.add_argument("--no-data", type=float, help="override every ECU's NO DATA rate")
+    ap.add_argument("--stats-interval", type=float, default=0.0,
+                    help="seconds between statistics lines (0 = only on exit)")
+    ap.add_argument("--log", help="CSV per request: t_ms,command,modelled_ms,actual_ms")
+    args = ap.parse_args()
+
+    scenario = load_scenario(args.scenario)
+    rows = load_pid_table(TABLE_PATH)
+    overrides = {"latency_ms": args.latency_ms, "jitter_ms": args.jitter_ms,
+                 "no_data": args.no_data}
+    ecus = [Ecu(cfg, rows, scenario["pids"], i == 0, scenario, overrides)
+            for i, cfg in enumerate(scenario["ecus"])]
+    signals = {r["name"]: Signal(r, scenario["pids"].get(r["name"], {})) for r in rows}
+
+    master, slave = os.openpty()
+    tty.setraw(slave)               # no newline translation or tty echo
+    path = os.ttyname(slave)        # slave stays open: no EIO between readers
+    if args.link:
+        if os.path.islink(args.link):
+            os.unlink(args.link)
+        os.symlink(path, args.link)
+    log = open(args.log, "w", buffering=1) if args.log else None
+    if log:
+        log.write("t_ms,command,modelled_ms,actual_ms\n")
+
+    elm = Elm327(master, scenario, ecus, signals, random.Random(args.seed),
+                 args.time_scale, log)
+
+    def finish(*_):
+        print_stats(elm, final=True)
+        if args.link and os.path.islink(args.link):
+            os.unlink(args.link)
+        sys.exit(0)
+    signal.signal(signal.SIGINT, finish)
+    signal.signal(signal.SIGTERM, finish)
+
+    print("pty %s" % path, flush=True)
+    print("[ELM] %s with %d ECU(s) on %s" % (ELM_VERSION, len(ecus), path),
+          file=sys.stderr, flush=True)
+
+    pending = b""
+    next_stats = time.monotonic() + args.stats_interval if args.stats_interval > 0 else None
+    while True:
+        wait = None if next_stats is None else max(0.0, next_stats - time.monotonic())
+        ready, _, _ = select.select([master], [], [], wait)
+        if next_stats is not None and time.monotonic() >= next_stats:
+            print_stats(elm)
+            next_stats += args.stats_interval
+        if not ready:
+            continue
+        pending += os.read(master, 4096)
+        while b"\r" in pending:
+            line, pending = pending.split(b"\r", 1)
+            text = line.replace(b"\n", b"").decode("ascii", "replace").strip()
+            if text or line == b"":
+                elm.handle(text)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+idle_power.py ― Pi 5 board power and Vroom CPU time, awake vs. asleep
+====================================================================
+
+Samples the Pi 5 PMIC rails (`vcgencmd pmic_read_adc`) once a second and
+sums current × voltage over every rail that reports both, alongside the
+CPU time VroomSystem and its obd_reader.py child use over the same
+window and the CPU governor in force.  Run it once with Vroom awake and
+once after it has gone to sleep, then compare:
+
+    ./VroomSystem --idle-minutes=1 &
+    scripts/idle_power.py --label awake  --seconds 60 --out awake.json
+    # leave the knob and screen alone until "[Idle] enter" is logged
+    scripts/idle_power.py --label asleep --seconds 60 --out asleep.json
+
+    scripts/idle_power.py --compare awake.json asleep.json
+
+Reported per run: mean / min / max board power (W), CPU % of VroomSystem
+and obd_reader.py, and the governor.  The PMIC rails cover the SoC, RAM
+and I/O, not the display: measure the panel's backlight on its own 5 V
+feed (USB meter) if that figure is wanted too.
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+RAIL_LINE = re.compile(r"^\s*(\S+)_([AV])\s+\w+\(\d+\)=([\d.]+)[AV]\s*$")
+GOVERNOR  = "/sys/devices/system/cpu/cpufreq/policy0/scaling_governor"
+CLK_TCK   = os.sysconf("SC_CLK_TCK")
+
+
+# ---------------------------------------------------------------------------
+#  Helpers
+# ---------------------------------------------------------------------------
+def find_pid(match):
+    """First process whose command line contains `match`, or None."""
+    for entry in os.listdir("/proc"):
+        if not entry.isdigit():
+            continue
+        try:
+            with open("/proc/%s/cmdline" % entry, "rb") as fh:
+                argv = fh.read().split(b"\0")
+        except OSError:
+            continue
+        if any(match.encode() in os.path.basename(arg) for arg in argv[:2]):
+            return int(entry)
+    return None
+
+
+def cpu_ticks(pid):
+    """utime + stime of `pid` in clock ticks, or None if it is gone."""
+    if pid is None:
+        return None
+    try:
+        with open("/proc/%d/stat" % pid) as fh:
+            fields = fh.read().rsplit(")", 1)[1].split()
+        return int(fields[11]) + int(fields[12])
+    except OSError:
+        return None
+
+
+def board_watts():
+    """Σ I·V over the PMIC rails, or None without vcgencmd / a Pi 5."""
+    try:
+        out = subprocess.run(["vcgencmd", "pmic_read_adc"], capture_output=True,
+                             text=True, timeout=2).stdout
+    except (OSError, subprocess.TimeoutExpired):
+        return None
+
+    amps, volts = {}, {}
+    for line in out.splitlines():
+        m = RAIL_LINE.match(line)
+        if m:
+            (amps if m.group(2) == "A" else volts)[m.group(1)] = float(m.group(3))
+    rails = amps.keys() & volts.keys()
+    return sum(amps[r] * volts[r] for r in rails) if rails else None
+
+
+def governor():
+    try:
+        with open(GOVERNOR) as fh:
+            return fh.read().strip()
+    except OSError:
+        return "?"
+
+
+# ---------------------------------------------------------------------------
+#  Capture
+# ---------------------------------------------------------------------------
+def capture(label, seconds):
+    procs  = {"VroomSystem": find_pid("VroomSystem"),
+              "obd_reader":  find_pid("obd_reader.py")}
+    before = {name: cpu_ticks(pid) for name, pid in procs.items()}
+    gov    = governor()
+    t0     = time.monotonic()
+
+    watts = []
+    while time.monotonic() - t0 < seconds:
+        w = board_watts()
+        if w is not None:
+            watts.append(w)
+        time.sleep(1.0)
+
+    wall  = time.monotonic() - t0
+    after = {name: cpu_ticks(pid) for name, pid in procs.items()}
+    cpu   = {}
+    for name in procs:
+        if before[name] is not None and after[name] is not None:
+            cpu[name] = 100.0 * (after[name] - before[name]) / CLK_TCK / wall
+        else:
+            print("idle_power: %s not running" % name, file=sys.stderr)
+
+    return {
+        "label":    label,
+        "seconds":  wall,
+        "samples":  len(watts),
+        "mean_w":   sum(watts) / len(watts) if watts else 0.0,
+        "min_w":    min(watts, default=0.0),
+        "max_w":    max(watts, default=0.0),
+        "governor": gov,
+        "cpu_pct":  cpu,
+    }
+
+
+def print_runs(runs):
+    print("%-10s %8s %8s %8s  %-12s cpu %%" % ("label", "mean W", "min W",
+                                              "max W", "governor"))
+    for r in runs:
+        cpu = "  ".join("%s=%.2f" % kv for kv in sorted(r["cpu_pct"].items()))
+        print("%-10s %8.3f %8.3f %8.3f  %-12s %s" % (
+            r["label"], r["mean_w"], r["min_w"], r["max_w"], r["governor"], cpu))
+    if len(runs) == 2 and runs[0]["mean_w"]:
+        delta = runs[1]["mean_w"] - runs[0]["mean_w"]
+        print("%s → %s: %+.3f W (%+.1f %%)" % (
+            runs[0]["label"], runs[1]["label"], delta,
+            100.0 * delta / runs[0]["mean_w"]))
+
+
+# ---------------------------------------------------------------------------
+#  Main
+# ---------------------------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("--label",   default="run")
+    ap.add_argument("--seconds", type=float, default=30.0)
+    ap.add_argument("--out",     help="write the summary as JSON")
+    ap.add_argument("--compare", nargs="+", metavar="JSON",
+                    help="print saved summaries side by side and exit")
+    args = ap.parse_args()
+
+    if args.compare:
+        runs = []
+        for path in args.compare:
+            with open(path) as fh:
+                runs.append(json.load(fh))
+        print_runs(runs)
+        return 0
+
+    if board_watts() is None:
+        print("idle_power: no PMIC readings (needs a Pi 5 and vcgencmd); "
+              "reporting CPU time only", file=sys.stderr)
+
+    summary = capture(args.label, args.seconds)
+    print_runs([summary])
+    if args.out:
+        with open(args.out, "w") as fh:
+            json.dump(summary, fh, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,26 @@
+#!/bin/sh
+# ==========================================================================
+#  micro_bench.sh ― build and run the hot-path microbenchmarks
+# ==========================================================================
+#
+#  Usage:  scripts/micro_bench.sh [MicroBench options…]
+#
+#  Examples:
+#      scripts/micro_bench.sh --baseline=bench/micro_baseline.ini --update-baseline
+#      scripts/micro_bench.sh --baseline=bench/micro_baseline.ini   # exit 1 on regression
+#      scripts/micro_bench.sh --system --json=/tmp/micro.json       # real pactl + sysfs
+#
+#  Built with -O2 and without wiringPi so the same line works on the Pi 5
+#  and on x86 dev boxes; keep one baseline file per machine.
+set -e
+
+cd "$(dirname "$0")/../Infotainment"
+
+gcc -O2 -Wall -Wextra -DVROOM_NO_WIRINGPI -o MicroBench -I. \
+    bench/MicroBench.c ObdFrame.c PidTable.c Alerts.c AudioManager.c BacklightManager.c \
+    Hal.c Simulation.c VehicleReader.c RotaryEncoder.c Popup.c \
+    SettingsWindow.c ApplyChannel.c Trace.c Telemetry.c IdleManager.c Metrics.c EventLog.c \
+    Dbc.c DeviceState.c Readout.c Mqtt.c Publisher.c Merge.c \
+    `pkg-config --cflags --libs gtk+-3.0 json-glib-1.0` -lm
+
+exec ./MicroBench "$@"
@@ -0,0 +1,36 @@
+#!/bin/sh
+# ==========================================================================
+#  mqtt_bench.sh ― MQTT publisher throughput / latency against mosquitto
+# ==========================================================================
+#
+#  Usage:  scripts/mqtt_bench.sh [MqttBench options…]
+#
+#  Examples:
+#      scripts/mqtt_bench.sh                                # private broker
+#      scripts/mqtt_bench.sh --rate=20 --flush-ms=1000      # the default batching
+#      scripts/mqtt_bench.sh --broker=192.168.1.10 --burst=0
+#
+#  Without --broker a private mosquitto (package `mosquitto`) is started
+#  on port 18830 for the run and stopped afterwards; with it, the given
+#  broker is used as is.
+set -e
+
+cd "$(dirname "$0")/../Infotainment"
+
+gcc -O2 -Wall -Wextra -o MqttBench -I. \
+    bench/MqttBench.c Publisher.c Mqtt.c Metrics.c PidTable.c \
+    `pkg-config --cflags --libs gio-unix-2.0 json-glib-1.0` -lm
+
+case " $* " in
+    *" --broker="*)
+        exec ./MqttBench "$@"
+        ;;
+esac
+
+PORT=18830
+mosquitto -p $PORT >/dev/null 2>&1 &
+BROKER=$!
+trap 'kill $BROKER 2>/dev/null' EXIT
+sleep 0.5
+
+./MqttBench --broker=127.0.0.1:$PORT "$@"
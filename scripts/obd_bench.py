@@ -0,0 +1,346 @@
+#!/usr/bin/env python3
+"""
+obd_bench.py ― OBD path throughput and latency against elm327_emu.py
+====================================================================
+
+Starts scripts/elm327_emu.py on a pty with a scenario and a fixed seed,
+points a reader at it for --seconds and reports what came out:
+
+    scripts/obd_bench.py --scenario scripts/elm327/typical.json
+    scripts/obd_bench.py --scenario scripts/elm327/lossy.json --pids RPM,SPEED
+    scripts/obd_bench.py --reader raw --pids-per-request 6 --json /tmp/obd.json
+
+Readers
+-------
+    obd   scripts/obd_reader.py --raw --port=<pty>, exactly as Vroom runs
+          it (needs python-OBD).  Samples/s and frames/s on its stdout,
+          each PID's update interval, and sample age: the time a line
+          was read here minus its "@" sampling stamp (both
+          CLOCK_MONOTONIC).
+    raw   a minimal ELM327 client in this script (ATZ E0 H1 L0 S0 SP6,
+          then the PIDs round robin, --pids-per-request per Mode 01
+          request).  Request round trips without python-OBD in the way —
+          the ceiling the adapter and ECU model allow.
+
+Both report the emulator's own per-request times (modelled and actual,
+from its --log) and its final statistics.  Same scenario, seed and
+reader give the same request sequence and modelled times; wall-clock
+figures vary within scheduler jitter.  obd_reader.py's vehicle profile
+goes to a temporary cache, so the real car's profile is left alone.
+
+Exit status: 0, 1 if no sample arrived, 2 if the emulator or reader did
+not start.
+"""
+
+import argparse
+import json
+import os
+import re
+import select
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import tty
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TABLE_PATH = os.path.join(HERE, "..", "Infotainment", "PidTable.def")
+FRAME_LINE = re.compile(r"^@(\d+) R (.*)$")
+
+
+# ---------------------------------------------------------------------------
+#  Helpers
+# ---------------------------------------------------------------------------
+def load_rows():
+    """(name, mode, pid, bytes) per PidTable.def row, in dense-ID order."""
+    rows = []
+    with open(TABLE_PATH, encoding="utf-8") as fh:
+        for line in fh:
+            m = re.match(r'\s*PID_DEF\(\s*\w+\s*,\s*"([^"]*)"\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)', line)
+            if m:
+                rows.append((m.group(1), int(m.group(2), 0), int(m.group(3), 0),
+                             int(m.group(4), 0)))
+    return rows
+
+
+def percentiles(values):
+    if not values:
+        return {"n": 0}
+    v = sorted(values)
+    pick = lambda q: v[min(len(v) - 1, int(q * len(v)))]
+    return {"n": len(v), "p50": pick(0.50), "p90": pick(0.90), "p99": pick(0.99),
+            "max": v[-1]}
+
+
+def fmt_ms(p):
+    if not p.get("n"):
+        return "-"
+    return "p50 %.1f  p90 %.1f  p99 %.1f  max %.1f ms" % (p["p50"], p["p90"], p["p99"], p["max"])
+
+
+def start_emulator(args, workdir):
+    link, log = os.path.join(workdir, "elm327"), os.path.join(workdir, "elm.csv")
+    cmd = [sys.executable, os.path.join(HERE, "elm327_emu.py"), "--link", link,
+           "--log", log, "--seed", str(args.seed), "--time-scale", str(args.time_scale)]
+    if args.scenario:
+        cmd += ["--scenario", args.scenario]
+    emu = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    line = emu.stdout.readline()
+    if not line.startswith("pty "):
+        return emu, None, log
+    return emu, link, log
+
+
+def stop(proc):
+    """SIGTERM, then the stderr it wrote."""
+    if proc.poll() is None:
+        proc.send_signal(signal.SIGTERM)
+    try:
+        _, err = proc.communicate(timeout=5)
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        _, err = proc.communicate()
+    return err or ""
+
+
+def emulator_times(log):
+    modelled, actual = [], []
+    with open(log) as fh:
+        next(fh, None)
+        for line in fh:
+            _, command, m, a = line.rstrip("\n").rsplit(",", 3)
+            if not command.startswith("AT"):
+                modelled.append(float(m))
+                actual.append(float(a))
+    return percentiles(modelled), percentiles(actual)
+
+
+# ---------------------------------------------------------------------------
+#  obd_reader.py
+# ---------------------------------------------------------------------------
+def run_obd_reader(args, link, workdir, rows, wanted):
+    env = dict(os.environ, XDG_CACHE_HOME=os.path.join(workdir, "cache"))
+    cmd = [sys.executable, os.path.join(HERE, "obd_reader.py"), "--raw", "--cold",
+           "--port=" + link]
+    if wanted is not None:
+        cmd.append("--pids=" + ",".join(str(i) for i in wanted))
+    reader = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                              text=True, env=env)
+    out = reader.stdout.fileno()    # read raw: select() can't see a buffered line
+
+    frames, samples, ages, last, gaps = 0, 0, [], {}, {}
+    t_first, deadline = None, time.monotonic() + args.connect_timeout
+    pending, eof = b"", False
+    while not eof:
+        left = deadline - time.monotonic()
+        ready, _, _ = select.select([out], [], [], max(0.0, min(left, 0.2)))
+        if not ready:
+            if left <= 0 or reader.poll() is not None:
+                break
+            continue
+        chunk = b""
+        while ready:                    # everything written so far, then stamp
+            data = os.read(out, 65536)
+            if not data:
+                eof = True
+                break
+            chunk += data
+            ready, _, _ = select.select([out], [], [], 0)
+        now = time.monotonic()
+        *lines, pending = (pending + chunk).split(b"\n")
+        for line in lines:
+            m = FRAME_LINE.match(line.decode("ascii", "replace").strip())
+            if not m:
+                continue
+            if t_first is None:                  # connected: time the window
+                t_first = now
+                deadline = now + args.seconds
+            frames += 1
+            ages.append((now - int(m.group(1)) / 1e6) * 1000)
+            for item in m.group(2).split():
+                pid = int(item.split(":")[0])
+                samples += 1
+                if pid in last:
+                    gaps.setdefault(pid, []).append((now - last[pid]) * 1000)
+                last[pid] = now
+        if left <= 0:                   # what was readable at the deadline counts
+            break
+
+    err = stop(reader)
+    if t_first is None:
+        print(err.strip(), file=sys.stderr)
+        return None
+    elapsed = max(time.monotonic() - t_first, 1e-9)
+    return {
+        "reader": "obd", "seconds": elapsed, "frames": frames, "samples": samples,
+        "frames_per_s": frames / elapsed, "samples_per_s": samples / elapsed,
+        "sample_age_ms": percentiles(ages),
+        "update_interval_ms": {rows[p][0]: percentiles(g)["p50"] for p, g in gaps.items()},
+    }
+
+
+# ---------------------------------------------------------------------------
+#  Raw ELM327 client
+# ---------------------------------------------------------------------------
+class RawElm:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+
+    def command(self, text, timeout=5.0):
+        """Lines of the answer, without echo and prompt; None on timeout."""
+        os.write(self.fd, (text + "\r").encode("ascii"))
+        buf, deadline = b"", time.monotonic() + timeout
+        while not buf.endswith(b">"):
+            ready, _, _ = select.select([self.fd], [], [], max(0.0, deadline - time.monotonic()))
+            if not ready:
+                return None
+            buf += os.read(self.fd, 4096)
+        lines = [l.strip() for l in re.split(r"[\r\n]+", buf[:-1].decode("ascii", "replace"))]
+        return [l for l in lines if l and l != text]
+
+
+def payloads(lines):
+    """Header-on CAN lines ("7E8064100…", spaces off) → ISO-TP payloads."""
+    out, partial = [], {}
+    for line in lines:
+        if not re.fullmatch(r"[0-9A-F]{5,}", line):
+            continue
+        ecu, data = line[:3], bytes.fromhex(line[3:])
+        kind = data[0] >> 4
+        if kind == 0:
+            out.append(data[1:1 + (data[0] & 0xF)])
+        elif kind == 1:
+            partial[ecu] = [((data[0] & 0xF) << 8) | data[1], bytearray(data[2:])]
+        elif kind == 2 and ecu in partial:
+            size, got = partial[ecu]
+            got += data[1:]
+            if len(got) >= size:
+                out.append(bytes(got[:size]))
+                del partial[ecu]
+    return out
+
+
+def run_raw(args, link, rows, wanted):
+    elm = RawElm(link)
+    for init in ("ATZ", "ATE0", "ATH1", "ATL0", "ATS0", "ATSP6"):
+        if elm.command(init) is None:
+            return None
+    elm.command("0100")                          # bus "search" outside the window
+
+    ids = wanted if wanted is not None else range(len(rows))
+    mode01 = [rows[i] for i in ids if rows[i][1] == 0x01]
+    other = [rows[i] for i in ids if rows[i][1] != 0x01]
+    size = {r[2]: r[3] for r in mode01}
+    per = max(1, min(args.pids_per_request, 6))
+    batches = ["01" + "".join("%02X" % r[2] for r in mode01[i:i + per])
+               for i in range(0, len(mode01), per)]
+    batches += ["%02X%04X" % (r[1], r[2]) for r in other]
+    if not batches:
+        return None
+
+    requests, samples, no_data, rtts = 0, 0, 0, []
+    t0 = time.monotonic()
+    deadline = t0 + args.seconds
+    while time.monotonic() < deadline:
+        for req in batches:
+            t = time.monotonic()
+            lines = elm.command(req)
+            rtts.append((time.monotonic() - t) * 1000)
+            requests += 1
+            if lines is None or any("NO DATA" in l for l in lines):
+                no_data += 1
+                continue
+            for p in payloads(lines):
+                if p[:1] == b"\x41":             # PID, data, PID, data …
+                    i = 1
+                    while i < len(p) and p[i] in size:
+                        i += 1 + size[p[i]]
+                        samples += 1
+                elif p[:1] == b"\x62":
+                    samples += 1
+    elapsed = time.monotonic() - t0
+    os.close(elm.fd)
+    return {
+        "reader": "raw", "seconds": elapsed, "requests": requests, "samples": samples,
+        "no_data": no_data, "requests_per_s": requests / elapsed,
+        "samples_per_s": samples / elapsed, "request_ms": percentiles(rtts),
+    }
+
+
+# ---------------------------------------------------------------------------
+#  Main
+# ---------------------------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    ap.add_argument("--scenario", help="elm327_emu.py scenario (default: its built-in one)")
+    ap.add_argument("--reader", choices=("obd", "raw"), default="obd")
+    ap.add_argument("--seconds", type=float, default=20.0)
+    ap.add_argument("--pids", help="PidTable.def names, comma-separated (default: all)")
+    ap.add_argument("--pids-per-request", type=int, default=1,
+                    help="Mode 01 PIDs per request for --reader raw (1-6)")
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--time-scale", type=float, default=1.0)
+    ap.add_argument("--connect-timeout", type=float, default=30.0,
+                    help="seconds obd_reader.py may take to the first frame")
+    ap.add_argument("--json", help="write the results here as well")
+    args = ap.parse_args()
+
+    rows = load_rows()
+    wanted = None
+    if args.pids:
+        names = [r[0] for r in rows]
+        try:
+            wanted = [names.index(n.strip().upper()) for n in args.pids.split(",")]
+        except ValueError:
+            print("obd_bench: unknown PID in --pids=%s" % args.pids, file=sys.stderr)
+            return 2
+
+    workdir = tempfile.mkdtemp(prefix="obd_bench.")
+    try:
+        emu, link, log = start_emulator(args, workdir)
+        if link is None:
+            print("obd_bench: emulator did not start\n" + stop(emu), file=sys.stderr)
+            return 2
+        if args.reader == "obd":
+            result = run_obd_reader(args, link, workdir, rows, wanted)
+        else:
+            result = run_raw(args, link, rows, wanted)
+        emu_stats = [l for l in stop(emu).splitlines() if "final:" in l]
+        if result is None:
+            print("obd_bench: reader did not connect", file=sys.stderr)
+            return 2
+        modelled, actual = emulator_times(log)
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    result.update({"scenario": args.scenario or "built-in", "seed": args.seed,
+                   "emulator_modelled_ms": modelled, "emulator_actual_ms": actual})
+
+    print("scenario      %s (seed %d, reader %s, %.1f s)"
+          % (result["scenario"], args.seed, result["reader"], result["seconds"]))
+    print("samples       %d  (%.1f/s)" % (result["samples"], result["samples_per_s"]))
+    if result["reader"] == "obd":
+        print("frames        %d  (%.1f/s)" % (result["frames"], result["frames_per_s"]))
+        print("sample age    %s" % fmt_ms(result["sample_age_ms"]))
+        for name, gap in sorted(result["update_interval_ms"].items()):
+            print("  %-24s every %.0f ms" % (name, gap))
+    else:
+        print("requests      %d  (%.1f/s), %d NO DATA"
+              % (result["requests"], result["requests_per_s"], result["no_data"]))
+        print("round trip    %s" % fmt_ms(result["request_ms"]))
+    print("emulator      modelled %s" % fmt_ms(modelled))
+    print("              actual   %s" % fmt_ms(actual))
+    for line in emu_stats:
+        print(line)
+
+    if args.json:
+        with open(args.json, "w") as fh:
+            json.dump(result, fh, indent=2)
+    return 0 if result["samples"] else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -3,46 +3,611 @@
 obd_reader.py ― Polls the car's OBD-II bus and streams data to stdout
 ====================================================================
 
-Every 0.5 s the script:
+The PID set comes from Infotainment/PidTable.def, the same table the C
+side compiles into its decoders.  Each row gives the mode/PID to send, the
+reply length, the decode formula and a default poll rate.
 
-1. Queries a small set of useful PIDs (RPM, speed, etc.).
-2. Builds a JSON dictionary: {"RPM": 814, "SPEED": 0, …}.
-3. Writes the JSON as **one line** to stdout and flushes immediately.
+The script loops forever:
+
+1. Queries every PID whose poll interval (1 / rate_hz) has elapsed.
+2. Writes the results as **one line** to stdout and flushes immediately:
+     default   JSON keyed by PID name   {"RPM": 814.0, "SPEED": 0.0, …}
+     --raw     dense IDs + reply bytes  @81234567 R 0:0CB8 1:00
+   Vroom runs the script with --raw so the decoding happens in C; the
+   JSON form is what you capture to files for vroom-stats.  The "@"
+   field is when the round was sampled (mean of its reply times, µs of
+   CLOCK_MONOTONIC), so Vroom can order these frames against other
+   sources such as the CAN decoder.
+
+Only the *active* PIDs are polled: all of them by default, the dense IDs
+given with --pids=0,1,5, and — with --control — whatever the latest
+"P id,id,…" line on stdin says.  Vroom sends one whenever the Vehicle
+Info page changes; PIDs that leave the set are skipped from the very next
+query on, so a page refreshes at a rate set by its own PID count.
+
+While the car is parked Vroom stretches every poll interval to a
+heartbeat with "T ms" (or --min-period=ms on spawn); "T 0" goes back to
+the table rates and re-polls the active PIDs at once.
+
+The adapter is the first ELM327 python-OBD finds, or --port=PATH: an
+rfcomm link, or the pty of scripts/elm327_emu.py for tests without a car.
+
+One-off requests
+----------------
+"Q tag prio hex" on the control channel queues a single query — "0902"
+(VIN), "03" (stored DTCs), "020C00" (freeze-frame RPM), "04" (clear
+codes) — without stopping the stream; "X tag" drops it if it has not
+started yet.  The answer is one stdout line:
+
+    A tag status wait_ms run_ms stall_ms [hex,hex,…]
+
+status is OK, NODATA or ERROR; the hex fields are each ECU's reply with
+the response mode byte (0x40 + mode) removed.  wait_ms is the time spent
+queued here, run_ms the adapter time, and stall_ms how long the request
+held up a streaming PID that was due.
+
+Priorities: 2 (high) takes the next free adapter turn, between two
+streaming queries; 1 (normal) runs after the round's frame is written;
+0 (low) only when no streaming PID is due.  At most one request runs
+per streaming round, so the live stream is delayed by at most one
+request per frame however many are queued; idle gaps take them one at a
+time, rechecking the stream in between.  The vehicle profile check runs
+after the user's requests.
+
+Vehicle profiles
+----------------
+The first connect to a car is *cold*: ELM327 protocol auto-search, then
+the VIN (Mode 09 PID 02) and the Mode 01 supported-PID bitmaps (PIDs 00,
+20, 40, … as far as the chain goes) are read and stored with the adapter
+port and protocol in PROFILE_PATH, keyed by VIN.  Every later connect is
+*warm*: the last car's port and protocol are set directly, python-OBD's
+own supported-command sweep is skipped, and Mode 01 PIDs the bitmaps do
+not list are never queried (each would cost a full adapter timeout).
+Rows in other modes have no bitmap and are always queried.
+
+A warm start re-validates in the background — the VIN, then the bitmaps
+one range at a time, a single query per idle gap between polls — and
+switches profile (or learns a new one) if another car answers.  A failed warm connect falls back to a
+cold one.  Connect and first-data times go to stderr and into the
+profile; `obd_reader.py --profiles` compares cold and warm per car, and
+`--cold` ignores the cache for one run.
 """
 
+import heapq
+import itertools
 import json
-import time
-import sys
+import os
+import re
+import select
 import signal
+import statistics
+import sys
+import time
+
 import obd   # python-OBD auto-detects the first /dev/ttyUSB* ELM327 device
 
-# Exit cleanly when the parent C program sends SIGINT (e.g. on window close)
-signal.signal(signal.SIGINT, lambda *_: sys.exit(0))
+# Exit cleanly when the parent C program sends SIGINT/SIGTERM (window hidden)
+signal.signal(signal.SIGINT,  lambda *_: sys.exit(0))
+signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+
+TABLE_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          "..", "Infotainment", "PidTable.def")
+PROFILE_PATH = os.path.join(os.environ.get("XDG_CACHE_HOME")
+                            or os.path.expanduser("~/.cache"),
+                            "vroom", "obd_profiles.json")
+RAW_OUTPUT = "--raw" in sys.argv[1:]
+CONTROL    = "--control" in sys.argv[1:]
+COLD_START = "--cold" in sys.argv[1:]
+PORT       = next((a[len("--port="):] for a in sys.argv[1:]
+                   if a.startswith("--port=")), None)     # None = auto-detect
+TIMINGS_KEPT = 10      # connect times remembered per car and kind
+IDLE_SLEEP = 0.01      # seconds between schedule checks when nothing is due
+IDLE_MAX   = 0.25      # longest wait for a control line with nothing active
+min_period = 0.0       # heartbeat floor on every poll interval (s)
+
+
+# ---------------------------------------------------------------------------
+#  PID table
+# ---------------------------------------------------------------------------
+def split_args(text):
+    """Split a PID_DEF(...) argument list on top-level commas."""
+    args, depth, quote, cur = [], 0, False, ""
+    for ch in text:
+        if ch == '"':
+            quote = not quote
+        elif not quote and ch == "(":
+            depth += 1
+        elif not quote and ch == ")":
+            depth -= 1
+        elif not quote and depth == 0 and ch == ",":
+            args.append(cur.strip())
+            cur = ""
+            continue
+        cur += ch
+    args.append(cur.strip())
+    return args
+
+
+def load_pid_table(path):
+    """Return one dict per PID_DEF row, in dense-ID order."""
+    rows = []
+    with open(path, encoding="utf-8") as fh:
+        for line in fh:
+            m = re.match(r"\s*PID_DEF\((.*)\)\s*$", line)
+            if not m:
+                continue
+            (ident, name, mode, pid, nbytes, formula,
+             unit, _fmt, _scale, rate) = split_args(m.group(1))
+            rows.append({
+                "id":      len(rows),
+                "ident":   ident,
+                "name":    name.strip('"'),
+                "mode":    int(mode, 0),
+                "pid":     int(pid, 0),
+                "bytes":   int(nbytes, 0),
+                "formula": compile(formula, ident, "eval"),
+                "unit":    unit.strip('"'),
+                "period":  1.0 / float(rate),
+            })
+    return rows
+
+
+def make_command(row):
+    """python-OBD command that returns the reply's data bytes untouched."""
+    pid_len = 2 if row["mode"] == 0x22 else 1           # Mode 22 PIDs are 16-bit
+    request = "%02X%0*X" % (row["mode"], pid_len * 2, row["pid"])
+    skip    = 1 + pid_len                               # mode + PID echo
+
+    return obd.OBDCommand(
+        row["ident"], row["name"], request.encode(),
+        skip + row["bytes"],
+        lambda messages: bytes(messages[0].data[skip:]),
+    )
+
+
+def decode(row, data):
+    """Evaluate the table formula over the reply bytes A, B, C, D."""
+    a = {k: (data[i] if i < len(data) else 0) for i, k in enumerate("ABCD")}
+    return float(eval(row["formula"], {"__builtins__": {}}, a))
+
+
+# ---------------------------------------------------------------------------
+#  Vehicle profiles
+# ---------------------------------------------------------------------------
+class ProfiledOBD(obd.OBD):
+    """obd.OBD without the supported-command sweep it runs on connect:
+    the profile's bitmaps say what to query, and queries use force=True.
+    The sweep is the private OBD.__load_commands (python-OBD 0.7); a
+    release without it still works, only the connect is slower."""
+    def _OBD__load_commands(self):
+        pass
+
+
+if not callable(getattr(obd.OBD, "_OBD__load_commands", None)):
+    print("[OBD] python-OBD %s has no OBD.__load_commands; its supported-"
+          "command sweep will run on every connect"
+          % getattr(obd, "__version__", "?"), file=sys.stderr, flush=True)
+
+
+def vin_command():
+    """Mode 09 PID 02; every frame is mode, PID, count/sequence + data."""
+    def decoder(messages):
+        raw = b"".join(bytes(m.data[3:]) for m in messages)
+        text = bytes(c for c in raw if 0x30 <= c <= 0x5A).decode("ascii")
+        return text[-17:] if len(text) >= 17 else None
+    return obd.OBDCommand("VIN", "Vehicle Identification Number", b"0902",
+                          0, decoder)
+
+
+def bitmap_command(base):
+    """Mode 01 PID base (00, 20, …): which of base+1 … base+32 exist.
+    Replies from several ECUs are OR-ed together."""
+    def decoder(messages):
+        bits = bytearray(4)
+        for m in messages:
+            for i, b in enumerate(bytes(m.data[2:6])):
+                bits[i] |= b
+        return bytes(bits)
+    return obd.OBDCommand("PIDS_%02X" % base, "Supported PIDs", b"01%02X" % base,
+                          6, decoder)
+
+
+def read_vin(connection):
+    result = connection.query(vin_command(), force=True)
+    return None if result.is_null() else result.value
+
+
+def read_bitmap(connection, base):
+    """('BE3FA813', more) for PID base; more is False at the end of the
+    chain (PID base+0x20 not supported) and (None, False) without reply."""
+    result = connection.query(bitmap_command(base), force=True)
+    if result.is_null():
+        return None, False
+    return result.value.hex().upper(), bool(result.value[3] & 1) and base < 0xE0
+
+
+def read_bitmaps(connection):
+    """['BE3FA813', …] for 0100, 0120, … until a range says no more."""
+    bitmaps, base, more = [], 0x00, True
+    while more:
+        bitmap, more = read_bitmap(connection, base)
+        if bitmap:
+            bitmaps.append(bitmap)
+        base += 0x20
+    return bitmaps
+
+
+def is_supported(row, bitmaps):
+    """Mode 01 PIDs by their bitmap bit; everything else is tried."""
+    if row["mode"] != 0x01 or not bitmaps or row["pid"] == 0:
+        return True
+    index, offset = divmod(row["pid"] - 1, 32)
+    if index >= len(bitmaps):
+        return False
+    return bool(int(bitmaps[index], 16) & (0x80000000 >> offset))
+
+
+def load_profiles():
+    try:
+        with open(PROFILE_PATH, encoding="utf-8") as fh:
+            return json.load(fh)
+    except (OSError, ValueError):
+        return {"last": None, "vehicles": {}}
+
+
+def save_profiles(profiles):
+    """Write via a temp file so a power cut never leaves half a cache."""
+    os.makedirs(os.path.dirname(PROFILE_PATH), exist_ok=True)
+    tmp = PROFILE_PATH + ".tmp"
+    with open(tmp, "w", encoding="utf-8") as fh:
+        json.dump(profiles, fh, indent=1, sort_keys=True)
+    os.replace(tmp, PROFILE_PATH)
+
+
+def profile_key(vin, connection):
+    """Cars without Mode 09 are told apart by adapter port only."""
+    return vin or "port:" + connection.port_name()
+
+
+def apply_profile(profile):
+    for row in PIDS:
+        row["supported"] = is_supported(row, profile.get("bitmaps"))
+    skipped = [row["name"] for row in PIDS if not row["supported"]]
+    if skipped:
+        print("[OBD] not supported by this car, skipped: " + ", ".join(skipped),
+              file=sys.stderr, flush=True)
+
+
+def record_timing(profile, kind, connect_s, first_s):
+    times = profile.setdefault(kind, [])
+    times.append([round(connect_s, 3), round(first_s, 3)])
+    del times[:-TIMINGS_KEPT]
+
+
+def learn_profile(connection, profiles, vin=None, bitmaps=None):
+    """Cold path: read what the car supports and store it.  bitmaps=[]
+    leaves them to the background re-validation."""
+    vin = vin or read_vin(connection)
+    key = profile_key(vin, connection)
+    old = profiles["vehicles"].get(key, {})
+    profile = dict(old, port=connection.port_name(),
+                   protocol=connection.protocol_id(),
+                   protocol_name=connection.protocol_name(),
+                   bitmaps=read_bitmaps(connection) if bitmaps is None else bitmaps,
+                   validated=int(time.time()))
+    profiles["vehicles"][key] = profile
+    profiles["last"] = key
+    return key, profile
+
+
+def connect(profiles):
+    """Open the adapter; returns (connection, key, profile, kind)."""
+    last = None if COLD_START else profiles["vehicles"].get(profiles["last"])
+    if last:
+        connection = ProfiledOBD(PORT or last["port"], baudrate=115200,
+                                 protocol=last["protocol"], fast=False, timeout=1)
+        if connection.status() == obd.OBDStatus.CAR_CONNECTED:
+            return connection, profiles["last"], last, "warm"
+        print("[OBD] cached protocol %s on %s failed; auto-searching"
+              % (last["protocol"], last["port"]), file=sys.stderr, flush=True)
+        connection.close()
+
+    connection = ProfiledOBD(PORT, baudrate=115200, fast=False, timeout=1)
+    key, profile = learn_profile(connection, profiles)
+    return connection, key, profile, "cold"
+
+
+fresh_bitmaps = []     # bitmaps the running re-validation has read so far
+
+
+def revalidate(connection, profiles, key, profile, step):
+    """One background query after a warm start, so an idle gap never
+    costs the stream more than one adapter round trip.  Step 0 checks
+    the VIN, step n ≥ 1 reads the bitmap for PID 0x20·(n−1); returns the
+    (possibly new) key and profile and the next step, None when done."""
+    if step == 0:
+        vin = read_vin(connection)
+        new_key = profile_key(vin, connection)
+        if new_key == key:
+            return key, profile, 1
+        print("[OBD] VIN %s is not the cached car; switching profile" % new_key,
+              file=sys.stderr, flush=True)
+        known = new_key in profiles["vehicles"]
+        if known:
+            profile = profiles["vehicles"][new_key]
+            profiles["last"] = new_key
+        else:                           # bitmaps follow, one step at a time
+            new_key, profile = learn_profile(connection, profiles, vin, [])
+        apply_profile(profile)
+        save_profiles(profiles)
+        return new_key, profile, 1
+
+    if step == 1:
+        fresh_bitmaps.clear()
+    bitmap, more = read_bitmap(connection, (step - 1) * 0x20)
+    if bitmap:
+        fresh_bitmaps.append(bitmap)
+    if more:
+        return key, profile, step + 1
+
+    bitmaps = list(fresh_bitmaps)
+    if bitmaps and bitmaps != profile.get("bitmaps"):
+        print("[OBD] supported PIDs changed; updating profile",
+              file=sys.stderr, flush=True)
+        profile["bitmaps"] = bitmaps
+        apply_profile(profile)
+    profile["validated"] = int(time.time())
+    save_profiles(profiles)
+    return key, profile, None
+
+
+def report_profiles():
+    """--profiles: cached cars and median cold / warm connect times."""
+    profiles = load_profiles()
+    if not profiles["vehicles"]:
+        print("no vehicle profiles in " + PROFILE_PATH)
+        return
+    print("%-20s %-32s %5s  %-17s %-17s" % ("vehicle", "protocol", "PIDs",
+                                              "cold conn/first", "warm conn/first"))
+    for key, p in sorted(profiles["vehicles"].items()):
+        count = sum(bin(int(b, 16)).count("1") for b in p.get("bitmaps", []))
+        cols = []
+        for kind in ("cold", "warm"):
+            runs = p.get(kind, [])
+            cols.append("%6.2f / %6.2f s" % (statistics.median(r[0] for r in runs),
+                                             statistics.median(r[1] for r in runs))
+                        if runs else "%17s" % "-")
+        print("%-20s %-32s %5d  %s %s  (%d cold, %d warm)"
+              % (key, p.get("protocol_name", "?"), count, cols[0], cols[1],
+                 len(p.get("cold", [])), len(p.get("warm", []))))
+
+
+# ---------------------------------------------------------------------------
+#  Active set + control channel
+# ---------------------------------------------------------------------------
+def parse_ids(text):
+    """'0,1,5' → {0, 1, 5}; unknown IDs are ignored."""
+    ids = {int(tok) for tok in text.split(",") if tok.strip().isdigit()}
+    return {i for i in ids if i < len(PIDS)}
+
+
+def set_active(ids):
+    """Make exactly `ids` active; newly added PIDs are due at once."""
+    for row in PIDS:
+        if row["id"] in ids and not row["active"]:
+            row["due"] = 0.0
+        row["active"] = row["id"] in ids
+
+
+def set_min_period(text):
+    """'5000' → poll nothing more often than every 5 s; '0' → table rates."""
+    global min_period
+    try:
+        seconds = max(int(text.strip()), 0) / 1000.0
+    except ValueError:
+        return
+    if seconds < min_period:
+        for row in PIDS:                # leaving the heartbeat: refresh now
+            row["due"] = 0.0
+    min_period = seconds
+
+
+# ---------------------------------------------------------------------------
+#  One-off requests
+# ---------------------------------------------------------------------------
+PRIO_LOW, PRIO_NORMAL, PRIO_HIGH = 0, 1, 2
+_requests = []                  # heap of (-prio, seq, tag, command, t_queued)
+_cancelled = set()
+_request_seq = itertools.count()
+
+
+def queue_request(text):
+    """'7 2 03' → tag 7, high priority, Mode 03."""
+    parts = text.split(None, 2)
+    if len(parts) != 3:
+        return
+    try:
+        tag, prio = int(parts[0]), min(max(int(parts[1]), PRIO_LOW), PRIO_HIGH)
+        command = bytes.fromhex(parts[2])
+    except ValueError:
+        print("[OBD] bad request line: Q " + text, file=sys.stderr, flush=True)
+        return
+    _cancelled.discard(tag)
+    heapq.heappush(_requests, (-prio, next(_request_seq), tag, command,
+                               time.monotonic()))
+
+
+def cancel_request(text):
+    if text.strip().isdigit():
+        _cancelled.add(int(text))
+
+
+def next_request(min_prio):
+    """Pop the most urgent live request of at least `min_prio`, or None."""
+    while _requests and _requests[0][2] in _cancelled:
+        _cancelled.discard(heapq.heappop(_requests)[2])
+    if _requests and -_requests[0][0] >= min_prio:
+        return heapq.heappop(_requests)
+    return None
+
+
+def request_command(command):
+    """python-OBD command that keeps every ECU's reply, minus the mode echo."""
+    return obd.OBDCommand("REQ_" + command.hex().upper(), "One-off request",
+                          command.hex().upper().encode(), 0,
+                          lambda messages: [bytes(m.data[1:]) for m in messages])
+
+
+def run_request(connection, request, stream_due):
+    """Send one request and write its A line.  `stream_due` is when the
+    next streaming PID falls due, for the stall figure."""
+    _, _, tag, command, queued = request
+    start = time.monotonic()
+    try:
+        result = connection.query(request_command(command), force=True)
+        replies = None if result.is_null() else result.value
+        status = "OK" if replies else "NODATA"
+    except Exception as exc:            # a bad request must not end the stream
+        print("[OBD] request %s failed: %s" % (command.hex().upper(), exc),
+              file=sys.stderr, flush=True)
+        replies, status = None, "ERROR"
+    end = time.monotonic()
+    stall = max(0.0, end - max(start, stream_due))
+
+    fields = ["A", str(tag), status, "%d" % ((start - queued) * 1000),
+              "%d" % ((end - start) * 1000), "%d" % (stall * 1000)]
+    if replies and any(replies):        # Mode 04 answers with no data
+        fields.append(",".join(data.hex().upper() for data in replies))
+    print(" ".join(fields), flush=True)
+
+
+def next_stream_due(active):
+    return min((row["due"] for row in active), default=float("inf"))
+
+
+_control_buf = b""
+
+def poll_control(timeout):
+    """Apply pending control lines, waiting up to `timeout` seconds."""
+    global _control_buf
+    if not CONTROL:
+        if timeout:
+            time.sleep(timeout)
+        return
+
+    ready, _, _ = select.select([sys.stdin.fileno()], [], [], timeout)
+    if not ready:
+        return
+    chunk = os.read(sys.stdin.fileno(), 4096)
+    if not chunk:
+        sys.exit(0)                     # Vroom closed the pipe → it is gone
+
+    *lines, _control_buf = (_control_buf + chunk).split(b"\n")
+    for line in lines:
+        if line.startswith(b"P"):
+            set_active(parse_ids(line[1:].decode("ascii", "ignore")))
+        elif line.startswith(b"T"):
+            set_min_period(line[1:].decode("ascii", "ignore"))
+        elif line.startswith(b"Q"):
+            queue_request(line[1:].decode("ascii", "ignore"))
+        elif line.startswith(b"X"):
+            cancel_request(line[1:].decode("ascii", "ignore"))
+
+
+# ---------------------------------------------------------------------------
+#  Main loop
+# ---------------------------------------------------------------------------
+if "--profiles" in sys.argv[1:]:
+    report_profiles()
+    sys.exit(0)
+
+PIDS = load_pid_table(TABLE_PATH)
+for row in PIDS:
+    row["command"]   = make_command(row)
+    row["due"]       = 0.0
+    row["active"]    = True
+    row["supported"] = True
+
+for arg in sys.argv[1:]:
+    if arg.startswith("--pids="):
+        set_active(parse_ids(arg[len("--pids="):]))
+    elif arg.startswith("--min-period="):
+        set_min_period(arg[len("--min-period="):])
 
 # Open the OBD-II serial link (blocking until the adapter is ready)
-connection = obd.OBD(fast=False, baudrate=115200, timeout=1)
-
-# PID set for the dashboard
-PIDS = {
-    "RPM":                     obd.commands.RPM,
-    "SPEED":                   obd.commands.SPEED,
-    "ENGINE LOAD":             obd.commands.ENGINE_LOAD,
-    "THROTTLE POSITION":       obd.commands.THROTTLE_POS,
-    "INTAKE PRESSURE":         obd.commands.INTAKE_PRESSURE,
-    "TIMING ADVANCE":          obd.commands.TIMING_ADVANCE,
-    "FUEL LEVEL":              obd.commands.FUEL_LEVEL,
-    "CONTROL MODULE VOLTAGE":  obd.commands.CONTROL_MODULE_VOLTAGE,
-}
+t_start  = time.monotonic()
+profiles = load_profiles()
+connection, profile_id, profile, connect_kind = connect(profiles)
+t_connected = time.monotonic() - t_start
+apply_profile(profile)
+revalidate_step = 0 if connect_kind == "warm" else None  # cold: just read
+first_data = None
+pending_timing = None   # kept until the VIN check confirms the car
 
 while True:
-    frame = {}
-    for label, cmd in PIDS.items():
-        result = connection.query(cmd, force=True)   # ask ECU every time
-        if not result.is_null():
-            val = result.value
-            # python-OBD sometimes returns a Pint Quantity; strip the unit
-            frame[label] = (
-                float(val.magnitude) if hasattr(val, "magnitude") else val
-            )
-    print(json.dumps(frame), flush=True)  # one atomic JSON line
-    time.sleep(0.5)
+    poll_control(0)
+    now    = time.monotonic()
+    active = [row for row in PIDS if row["active"] and row["supported"]]
+    due    = [row for row in active if row["due"] <= now]
+    if not due:
+        request = next_request(PRIO_LOW)    # idle gap: one, then recheck
+        if request:
+            run_request(connection, request, next_stream_due(active))
+            continue
+    if not due and first_data is not None and revalidate_step is not None:
+        checked_id = profile_id
+        profile_id, profile, revalidate_step = revalidate(
+            connection, profiles, profile_id, profile, revalidate_step)
+        if pending_timing and profile_id == checked_id:
+            record_timing(profile, *pending_timing)
+            save_profiles(profiles)
+        pending_timing = None           # another car: not a warm start for it
+        continue
+    if not due:
+        next_due = min((row["due"] for row in active), default=now + IDLE_MAX)
+        poll_control(min(max(next_due - now, IDLE_SLEEP),
+                         max(IDLE_MAX, min_period)))
+        continue
+
+    results = []
+    replied   = 0.0                     # sum of reply times, for the stamp
+    slot_free = True                    # one request per streaming round
+    for row in due:
+        poll_control(0)                 # page may have changed mid-round
+        if not row["active"]:
+            continue
+        if slot_free:
+            request = next_request(PRIO_HIGH)
+            if request:
+                run_request(connection, request, 0.0)
+                slot_free = False
+        row["due"] = now + max(row["period"], min_period)
+        result = connection.query(row["command"], force=True)
+        if result.is_null() or len(result.value) < row["bytes"]:
+            continue
+        results.append((row, result.value))
+        replied += time.monotonic()
+
+    if results and first_data is None:
+        first_data = time.monotonic() - t_start
+        pending_timing = (connect_kind, t_connected, first_data)
+        if connect_kind == "cold":
+            record_timing(profile, *pending_timing)
+            save_profiles(profiles)
+            pending_timing = None
+        print("[OBD] %s connect %.2f s, first data %.2f s (%s, %s)"
+              % (connect_kind, t_connected, first_data, profile_id,
+                 profile.get("protocol_name", "?")), file=sys.stderr, flush=True)
+
+    if results and RAW_OUTPUT:
+        print("@%d R " % (replied / len(results) * 1e6)
+              + " ".join("%d:%s" % (row["id"], data.hex().upper())
+                         for row, data in results), flush=True)
+    elif results:
+        print(json.dumps({row["name"]: decode(row, data)
+                          for row, data in results}), flush=True)   # one atomic line
+
+    if slot_free:                       # frame is out: normal requests next
+        request = next_request(PRIO_NORMAL)
+        if request:
+            run_request(connection, request, next_stream_due(active))
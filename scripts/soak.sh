@@ -0,0 +1,28 @@
+#!/bin/sh
+# ==========================================================================
+#  soak.sh ― build and run the long-run leak harness under Xvfb
+# ==========================================================================
+#
+#  Usage:  scripts/soak.sh [SoakBench options…]
+#
+#  Examples:
+#      scripts/soak.sh --minutes=240 --csv=/tmp/soak.csv    # a drive's worth
+#      scripts/soak.sh --minutes=20 --interval=10 --warmup=2  # quick check
+#
+#  Exit status 1 means at least one metric kept growing after warm-up;
+#  the table at the end says which, and the GObject types that grew.
+#  Needs the `xvfb` package (xvfb-run); runs from Infotainment/ so
+#  images/ and ../scripts/obd_reader.py resolve as they do for Vroom.
+set -e
+
+cd "$(dirname "$0")/../Infotainment"
+
+gcc -O2 -Wall -Wextra -g -DVROOM_NO_WIRINGPI -o SoakBench -I. \
+    bench/SoakBench.c MainWindow.c SettingsWindow.c VehicleInfoWindow.c \
+    AudioManager.c BacklightManager.c Popup.c Trace.c ApplyChannel.c \
+    Hal.c Simulation.c VehicleReader.c RotaryEncoder.c ObdFrame.c PidTable.c \
+    Telemetry.c Alerts.c Overlay.c IdleManager.c Metrics.c EventLog.c \
+    DeviceState.c Readout.c Mqtt.c Publisher.c Merge.c \
+    `pkg-config --cflags --libs gtk+-3.0 json-glib-1.0` -lm
+
+exec xvfb-run -a -s "-screen 0 800x480x24" ./SoakBench "$@"
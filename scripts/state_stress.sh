@@ -0,0 +1,25 @@
+#!/bin/sh
+# ==========================================================================
+#  state_stress.sh ― DeviceState stress test under ThreadSanitizer
+# ==========================================================================
+#
+#  Usage:  scripts/state_stress.sh [StateStress options…]
+#
+#  Examples:
+#      scripts/state_stress.sh                        # 5 s, 2 knobs, 2 readers
+#      scripts/state_stress.sh --seconds=60 --knobs=4
+#
+#  Exit status 1 on a failed check or any ThreadSanitizer report
+#  (halt_on_error), so it can gate a change to DeviceState.c or to the
+#  code that calls it from the knob ISRs.
+set -e
+
+cd "$(dirname "$0")/../Infotainment"
+
+gcc -O1 -Wall -Wextra -g -fsanitize=thread -o StateStress -I. \
+    bench/StateStress.c DeviceState.c Trace.c \
+    `pkg-config --cflags --libs glib-2.0` -lpthread
+
+# GLib itself is not TSan-instrumented; tsan-glib.supp says why
+TSAN_OPTIONS="halt_on_error=1 exitcode=1 suppressions=../scripts/tsan-glib.supp $TSAN_OPTIONS" \
+    exec ./StateStress "$@"
@@ -0,0 +1,49 @@
+#!/bin/sh
+# ==========================================================================
+#  ui_bench.sh ― build and run the headless UI frame-time benchmark
+# ==========================================================================
+#
+#  Usage:  scripts/ui_bench.sh [xvfb|broadway] [UiBench options…]
+#
+#  xvfb      (default) runs under a virtual X server at the Pi display's
+#            800x480 resolution — needs the `xvfb` package (xvfb-run).
+#  broadway  runs against GTK's Broadway backend — needs broadwayd, which
+#            ships with libgtk-3-bin.
+#
+#  Examples:
+#      scripts/ui_bench.sh xvfb --baseline=bench/ui_baseline.ini --update-baseline
+#      scripts/ui_bench.sh xvfb --baseline=bench/ui_baseline.ini   # exit 1 on regression
+#
+#  Paths passed to UiBench are relative to Infotainment/ (images/ lives
+#  there, so the benchmark must run from that directory).
+set -e
+
+BACKEND=${1:-xvfb}
+[ $# -gt 0 ] && shift
+
+cd "$(dirname "$0")/../Infotainment"
+
+gcc -O2 -Wall -Wextra -DVROOM_NO_WIRINGPI -o UiBench -I. \
+    bench/UiBench.c MainWindow.c SettingsWindow.c VehicleInfoWindow.c \
+    AudioManager.c BacklightManager.c Popup.c Trace.c ApplyChannel.c \
+    Hal.c Simulation.c VehicleReader.c RotaryEncoder.c ObdFrame.c PidTable.c \
+    Telemetry.c Alerts.c Overlay.c IdleManager.c Metrics.c EventLog.c \
+    DeviceState.c Readout.c Mqtt.c Publisher.c Merge.c \
+    `pkg-config --cflags --libs gtk+-3.0 json-glib-1.0` -lm
+
+case "$BACKEND" in
+    xvfb)
+        exec xvfb-run -a -s "-screen 0 800x480x24" ./UiBench "$@"
+        ;;
+    broadway)
+        broadwayd :5 >/dev/null 2>&1 &
+        BWPID=$!
+        trap 'kill $BWPID 2>/dev/null' EXIT
+        sleep 1
+        GDK_BACKEND=broadway BROADWAY_DISPLAY=:5 ./UiBench "$@"
+        ;;
+    *)
+        echo "unknown backend '$BACKEND' (use xvfb or broadway)" >&2
+        exit 2
+        ;;
+esac